@@ -0,0 +1,26 @@
+/*****************************************************************************/
+/* Flight data recorder log storage driver                                   */
+/*                                                                           */
+/* Copyright (C) 2017 Laszlo Arvai                                           */
+/* All rights reserved.                                                      */
+/*                                                                           */
+/* This software may be modified and distributed under the terms             */
+/* of the GNU General Public License.  See the LICENSE file for details.     */
+/*****************************************************************************/
+
+#ifndef __drvFDRStorage_h
+#define __drvFDRStorage_h
+
+/*****************************************************************************/
+/* Include files                                                             */
+/*****************************************************************************/
+#include <sysTypes.h>
+
+/*****************************************************************************/
+/* Function prototypes                                                       */
+/*****************************************************************************/
+bool drvFDRStorageOpen(const char* in_name);
+bool drvFDRStorageWrite(uint8_t* in_buffer, uint16_t in_length);
+void drvFDRStorageClose(void);
+
+#endif
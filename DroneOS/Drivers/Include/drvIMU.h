@@ -29,6 +29,9 @@
 #define drvIMU_SC_MAGNETIC			0x04
 #define drvIMU_SC_BAROMETRIC		0x08
 
+/// Read function return value when the sensor doesn't require read before the next task cycle
+#define drvIMU_READ_AT_TASK_CYCLE	0xffffffff
+
 /*****************************************************************************/
 /* Types                                                                     */
 /*****************************************************************************/
@@ -38,12 +41,32 @@ typedef enum
 {
 	drvIMU_CF_Unknown,		/// Invalid
 	drvIMU_CF_Detect,			/// Detect sensor existence
-	drvIMU_CF_SelfTest		/// Run self test of the sensor
+	drvIMU_CF_SelfTest,		/// Run self test of the sensor
+	drvIMU_CF_StartAcquisition,	/// Configures sampling and starts continuous data acquisition
+	drvIMU_CF_GetStatistics	/// Gets acquisition statistics
 } drvIMUControlFunction;
 
-typedef void (*drvIMUCallbackFunction)(bool in_success, void* in_interupt_param);
+/// Raw inertial sensor sample
+typedef struct
+{
+	uint32_t Timestamp;				// reconstructed sampling time [us] (sysHighresTimer time base)
+	int16_t Acceleration[3];	// raw acceleration (X, Y, Z)
+	int16_t Gyro[3];					// raw angular rate (X, Y, Z)
+} drvIMUSample;
+
+/// Compensated barometric sensor sample
+typedef struct
+{
+	uint32_t Timestamp;				// sampling time (middle of the pressure conversion) [us] (sysHighresTimer time base)
+	int32_t Pressure;					// pressure [Pa]
+	int32_t Temperature;			// temperature [0.01 degC]
+} drvIMUBarometerSample;
+
+typedef void (*drvIMUCallbackFunction)(bool in_success, uint32_t in_callback_param, void* in_interupt_param);
+typedef void (*drvIMUSampleCallbackFunction)(uint8_t in_sensor_index, drvIMUSample* in_sample, void* in_interrupt_param);
+typedef void (*drvIMUBarometerCallbackFunction)(uint8_t in_sensor_index, drvIMUBarometerSample* in_sample, void* in_interrupt_param);
 typedef void (*drvIMUSensorControlFunction)(drvIMUControlFunction in_function, void* in_function_parameter);
-typedef void (*drvIMUSensorReadFunction)(void);
+typedef uint32_t (*drvIMUSensorReadFunction)(void);	// returns the time until the next read is required [us] or drvIMU_READ_AT_TASK_CYCLE
 
 /// Sensor detect function parameter
 typedef struct
@@ -59,11 +82,38 @@ typedef struct
 	bool Success;
 } drvIMUSelfTestParameter;
 
+/// Acquisition start function parameter
+typedef struct
+{
+	bool Success;
+	uint16_t SampleRate;							// requested sample rate [Hz]
+	uint16_t FilterFrequency;					// requested low pass filter frequency [Hz] (0 - no filter)
+	uint8_t Watermark;								// number of samples to collect in the sensor before they are read
+	uint8_t SensorIndex;							// passed to the sample callback
+	uint16_t Oversampling;						// requested oversampling ratio of barometric sensors (0 - highest)
+	drvIMUSampleCallbackFunction SampleCallback;	// called from the bus interrupt for every sample
+	drvIMUBarometerCallbackFunction BarometerCallback;	// called from the bus interrupt for every barometric sample
+	uint16_t ActualSampleRate;				// [out] sample rate set in the sensor [Hz]
+	float AccelerationScale;					// [out] acceleration resolution [g/LSB]
+	float GyroScale;									// [out] angular rate resolution [deg/s/LSB]
+} drvIMUAcquisitionParameter;
+
+/// Acquisition statistics function parameter
+typedef struct
+{
+	uint32_t SampleCount;				// number of samples delivered
+	uint32_t BurstReadCount;		// number of sample block reads
+	uint32_t TransactionCount;	// number of bus transactions of the data acquisition
+	uint32_t OverflowCount;			// number of sensor buffer overflows
+	uint32_t LostSampleCount;		// estimated number of samples lost in buffer overflows
+	uint32_t ErrorCount;				// number of failed reads
+} drvIMUStatisticsParameter;
+
 /*****************************************************************************/
 /* Function prototypes                                                       */
 /*****************************************************************************/
 void drvIMUInit(void);
-void drvIMUStartWriteAndReadBlock(uint8_t in_address, uint8_t* in_write_buffer, uint8_t in_write_buffer_length, uint8_t* in_read_buffer, uint8_t in_read_buffer_length, drvIMUCallbackFunction in_callback_function);
-void drvIMUStartWriteAndWriteBlock(uint8_t in_address, uint8_t* in_buffer1, uint8_t in_buffer1_length, uint8_t* in_buffer2, uint8_t in_buffer2_length, drvIMUCallbackFunction in_callback_function);
+void drvIMUStartWriteAndReadBlock(uint8_t in_address, uint8_t* in_write_buffer, uint8_t in_write_buffer_length, uint8_t* in_read_buffer, uint8_t in_read_buffer_length, drvIMUCallbackFunction in_callback_function, uint32_t in_callback_param);
+void drvIMUStartWriteAndWriteBlock(uint8_t in_address, uint8_t* in_buffer1, uint8_t in_buffer1_length, uint8_t* in_buffer2, uint8_t in_buffer2_length, drvIMUCallbackFunction in_callback_function, uint32_t in_callback_param);
 
 #endif
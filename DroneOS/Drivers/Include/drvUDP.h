@@ -15,6 +15,28 @@
 /* Includes                                                                  */
 /*****************************************************************************/
 #include <sysTypes.h>
+#include <halIODefinitions.h>
+
+/*****************************************************************************/
+/* Constants                                                                 */
+/*****************************************************************************/
+
+/// Number of transmitter buffers (packets) can be allocated or waiting for transmission at the same time
+#ifndef drvUDP_TRANSMITTER_SLOT_COUNT
+#define drvUDP_TRANSMITTER_SLOT_COUNT 4
+#endif
+
+/*****************************************************************************/
+/* Types                                                                     */
+/*****************************************************************************/
+
+/// State of the transmitter slot
+typedef enum
+{
+	drvUDP_TSS_Free,
+	drvUDP_TSS_Reserved,
+	drvUDP_TSS_ReadyToSend
+} drvUDPTransmitterSlotState;
 
 /*****************************************************************************/
 /* Function prototypes                                                       */
@@ -22,7 +44,7 @@
 void drvUDPInit(void);
 
 uint8_t* drvUDPAllocTransmitBuffer(void);
-void drvUDPTransmitData(uint16_t in_data_length, uint32_t in_destination_address);
+void drvUDPTransmitData(uint8_t* in_buffer, uint16_t in_data_length, uint32_t in_destination_address);
 uint32_t drvUDPGetLocalIPAddress(void);
 bool drvUDPIsConnected(void);
 
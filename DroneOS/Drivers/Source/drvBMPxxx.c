@@ -11,42 +11,130 @@
 /*****************************************************************************/
 /* Includes                                                                  */
 /*****************************************************************************/
+#include <sysHighresTimer.h>
+#include <sysRTOS.h>
 #include <drvIMU.h>
 #include <imuCommunication.h>
 
 /*****************************************************************************/
 /* Constants                                                                 */
 /*****************************************************************************/
-#define drvBMP085_DATA_BUFFER_SIZE 16
+
+// I2C address
+#define drvBMP085_I2C_ADDRESS 0x77
 
 // register addresses
 #define drvBMP085_CALIBRATION_DATA_START  	0xAA
 #define drvBMP085_CHIP_ID    		          	0xD0
 #define drvBMP085_VERSION		              	0xD1
 #define drvBMP085_CTRL_REG                	0xF4
-#define drvBMP085_TEMP_MEASUREMENT        	0x2E
-#define drvBMP085_PRESSURE_MEASUREMENT    	0x34
 #define drvBMP085_CONVERSION_REGISTER_MSB 	0xF6
 #define drvBMP085_CONVERSION_REGISTER_LSB 	0xF7
 #define drvBMP085_CONVERSION_REGISTER_XLSB	0xF8
 
+// control register values
+#define drvBMP085_TEMP_MEASUREMENT        	0x2E
+#define drvBMP085_PRESSURE_MEASUREMENT    	0x34
+#define drvBMP085_OSS_SHIFT									6
+#define drvBMP085_SCO												(1<<5)	// start of conversion bit, cleared by the sensor when the conversion is finished
+
 // Chip ID register value
 #define drvBMP085_CI_VALUE                  0x55
 
 #define drvBMP085_CALIBRATION_DATA_LENGTH  11   /* 16 bit values */
-#define drvBMP085_TEMP_CONVERSION_TIME     5
+#define drvBMP085_TEMP_CONVERSION_TIME     4500	// maximum temperature conversion time [us]
+
+// control register and conversion result registers are read in one block
+#define drvBMP085_RESULT_LENGTH (drvBMP085_CONVERSION_REGISTER_XLSB - drvBMP085_CTRL_REG + 1)
+#define drvBMP085_RESULT_CTRL_POS 0
+#define drvBMP085_RESULT_MSB_POS (drvBMP085_CONVERSION_REGISTER_MSB - drvBMP085_CTRL_REG)
+
+// number of pressure conversions between two temperature conversions
+#ifndef drvBMP085_PRESSURE_PER_TEMPERATURE
+#define drvBMP085_PRESSURE_PER_TEMPERATURE 8
+#endif
+
+/*****************************************************************************/
+/* Types                                                                     */
+/*****************************************************************************/
+
+/// Conversion running in the sensor
+typedef enum
+{
+	drvBMP085_CT_None,
+	drvBMP085_CT_Pressure,
+	drvBMP085_CT_Temperature
+} drvBMP085ConversionType;
+
+/// Oversampling settings
+typedef struct
+{
+	uint16_t Oversampling;			// number of internal samples
+	uint8_t OversamplingSetting;	// oss field of the control register
+	uint16_t ConversionTime;		// maximum pressure conversion time [us]
+} drvBMP085OversamplingInfo;
+
+/// Calibration coefficients (in the order of the EEPROM)
+typedef struct
+{
+	int16_t AC1;
+	int16_t AC2;
+	int16_t AC3;
+	uint16_t AC4;
+	uint16_t AC5;
+	uint16_t AC6;
+	int16_t B1;
+	int16_t B2;
+	int16_t MB;
+	int16_t MC;
+	int16_t MD;
+} drvBMP085CalibrationData;
 
 /*****************************************************************************/
 /* Module global variables                                                   */
 /*****************************************************************************/
-static uint8_t l_i2c_address;
-static uint8_t l_data_buffer[drvBMP085_DATA_BUFFER_SIZE ];
+static drvBMP085CalibrationData l_calibration;
+
+static const drvBMP085OversamplingInfo l_oversampling_info[] =
+{
+	{ 1, 0, 4500 },
+	{ 2, 1, 7500 },
+	{ 4, 2, 13500 },
+	{ 8, 3, 25500 }
+};
+
+// acquisition settings
+static const drvBMP085OversamplingInfo* l_oversampling = &l_oversampling_info[0];
+static uint8_t l_sensor_index;
+static drvIMUBarometerCallbackFunction l_sample_callback = sysNULL;
+static drvIMUStatisticsParameter l_statistics;
+
+// asynchronous conversion state machine
+static volatile bool l_transfer_in_progress = false;
+static imuTransaction l_result_read_transaction;
+static imuTransaction l_convert_transaction;
+static uint8_t l_result_buffer[drvBMP085_RESULT_LENGTH];
+static uint8_t l_convert_command;
+static bool l_result_read_submitted;
+static drvBMP085ConversionType l_conversion = drvBMP085_CT_None;				// conversion running in the sensor
+static drvBMP085ConversionType l_next_conversion = drvBMP085_CT_None;		// conversion started by the submitted transactions
+static sysHighresTimestamp l_conversion_timestamp;											// start time of the running conversion
+static uint16_t l_conversion_time;																			// maximum time of the running conversion [us]
+static uint8_t l_pressure_conversion_count;															// pressure conversions since the last temperature conversion
+static bool l_temperature_valid;
+static bool l_discard_result;																						// conversion command could be ignored, next result is not reliable
+static uint16_t l_raw_temperature;																			// last UT value
 
 /*****************************************************************************/
 /* Local functions                                                           */
 /*****************************************************************************/
 static void drvBMP085Detect(drvIMUDetectParameter* in_parameter);
-
+static bool drvBMP085CheckCalibration(void);
+static void drvBMP085StartAcquisition(drvIMUAcquisitionParameter* in_parameter);
+static uint32_t drvBMP085Read(void);
+static void drvBMP085ConversionStarted(imuTransaction* in_transaction, void* in_interrupt_param);
+static void drvBMP085ProcessResult(drvBMP085ConversionType in_conversion, sysHighresTimestamp in_conversion_timestamp, void* in_interrupt_param);
+static bool drvBMP085Compensate(uint32_t in_raw_pressure, uint16_t in_raw_temperature, uint8_t in_oss, drvIMUBarometerSample* out_sample);
 
 /*****************************************************************************/
 /* Function implementation                                                   */
@@ -54,10 +142,9 @@ static void drvBMP085Detect(drvIMUDetectParameter* in_parameter);
 
 ///////////////////////////////////////////////////////////////////////////////
 /// @brief Starts any sensor control (configuration) function
-/// @param in_imu_i2c I2C bus for IMU sensor
 /// @param in_function Functon code to start
 /// @param in_function_parameter Function parameter (if applicable)
-void drvMPU085Control(drvIMUControlFunction in_function, void* in_function_parameter)
+void drvBMP085Control(drvIMUControlFunction in_function, void* in_function_parameter)
 {
 	// start function
 	switch(in_function)
@@ -67,6 +154,21 @@ void drvMPU085Control(drvIMUControlFunction in_function, void* in_function_param
 			drvBMP085Detect((drvIMUDetectParameter*)in_function_parameter);
 			break;
 
+		// the sensor has no self test, the calibration EEPROM is checked
+		case drvIMU_CF_SelfTest:
+			((drvIMUSelfTestParameter*)in_function_parameter)->Success = drvBMP085CheckCalibration();
+			break;
+
+		// start continuous conversions
+		case drvIMU_CF_StartAcquisition:
+			drvBMP085StartAcquisition((drvIMUAcquisitionParameter*)in_function_parameter);
+			break;
+
+		// get acquisition statistics
+		case drvIMU_CF_GetStatistics:
+			*((drvIMUStatisticsParameter*)in_function_parameter) = l_statistics;
+			break;
+
 		case drvIMU_CF_Unknown:
 		default:
 			// TODO: error
@@ -75,562 +177,309 @@ void drvMPU085Control(drvIMUControlFunction in_function, void* in_function_param
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-/// @brief Sensor detection function
+/// @brief Sensor detection function (BMP085 and BMP180 have the same chip ID)
 /// @param in_parameter Detection function parameter
 static void drvBMP085Detect(drvIMUDetectParameter* in_parameter)
 {
-#if 0
 	bool success = true;
-	uint8_t id_value;
-	uint8_t reg;
-
-	// try primary address first
-	l_i2c_address = drvMPU6050_I2C_PRI_ADDRESS;
-	imuReadByteRegister(l_i2c_address, drvMPU6050_WHO_AM_I, &id_value, &success);
-	if(!success)
-	{
-		// if not found try secondary address
-		l_i2c_address = drvMPU6050_I2C_SEC_ADDRESS;
-		imuReadByteRegister(l_i2c_address, drvMPU6050_WHO_AM_I, &id_value, &success);
-	}
-
-	// check if found
-	if(success && ((id_value & drvMPU6050_WHO_AM_I_MASK) == drvMPU6050_WHO_AM_I_VALUE))
-	{
-		// sensor found
+	uint8_t chip_id = 0;
+	uint8_t buffer[drvBMP085_CALIBRATION_DATA_LENGTH * 2];
+	uint16_t* coefficient;
+	uint8_t i;
 
-		// enable I2C bypass
-		imuReadByteRegister(l_i2c_address, drvMPU6050_USER_CTRL, &reg, &success);
-		reg &= ~drvMPU6050_UC_I2C_MST_EN;
-		imuWriteByteRegister(l_i2c_address, drvMPU6050_USER_CTRL, reg, &success);
-
-		imuReadByteRegister(l_i2c_address, drvMPU6050_INT_PIN_CFG, &reg, &success);
-		reg |= drvMPU6050_IPC_I2C_BYPASS_EN;
-		imuWriteByteRegister(l_i2c_address, drvMPU6050_INT_PIN_CFG, reg, &success);
-
-		imuReadByteRegister(l_i2c_address, drvMPU6050_PWR_MGMT_1, &reg, &success);
-		reg &= ~drvMPU6050_PM1_SLEEP;
-		imuWriteByteRegister(l_i2c_address, drvMPU6050_PWR_MGMT_1, reg, &success);
+	// check chip ID
+	imuReadRegisterBlock(drvBMP085_I2C_ADDRESS, drvBMP085_CHIP_ID, &chip_id, 1, &success);
+	if (!success || chip_id != drvBMP085_CI_VALUE)
+		return;
 
+	// read calibration coefficients (big endian words)
+	imuReadRegisterBlock(drvBMP085_I2C_ADDRESS, drvBMP085_CALIBRATION_DATA_START, buffer, sizeof(buffer), &success);
+	if (!success)
+		return;
 
+	coefficient = (uint16_t*)&l_calibration;
+	for (i = 0; i < drvBMP085_CALIBRATION_DATA_LENGTH; i++)
+		coefficient[i] = ((uint16_t)buffer[2 * i] << 8) | buffer[2 * i + 1];
 
+	// check if found
+	if (drvBMP085CheckCalibration())
+	{
 		// set result
 		in_parameter->Success = true;
-		in_parameter->Class = drvIMU_SC_ACCELERATION | drvIMU_SC_GYRO;
-		in_parameter->Config = drvMPU6050Control;
-
+		in_parameter->Class = drvIMU_SC_BAROMETRIC;
+		in_parameter->Control = drvBMP085Control;
+		in_parameter->Read = drvBMP085Read;
 	}
-#endif
 }
 
-
-#if 0
-
-/*
- * Copyright (c) 2011 Sony Ericsson Mobile Communications AB.
- * Copyright (c) 2010 Christoph Mair <christoph.mair@gmail.com>
- *
- * NOTE:
- * This file has been created by Sony Ericsson Mobile Communications AB.
- * This file contains code from bmp085.c
- *
- * This driver supports the bmp180 digital barometric pressure
- * and temperature sensor from Bosch Sensortec.
- *
- * A pressure measurement is issued by reading from pressure0_input.
- * The return value ranges from 30000 to 110000 pascal with a resulution
- * of 1 pascal (0.01 millibar) which enables measurements from 9000m above
- * to 500m below sea level.
- *
- * The temperature can be read from temp0_input. Values range from
- * -400 to 850 representing the ambient temperature in degree celsius
- * multiplied by 10.The resolution is 0.1 celsius.
- *
- * Because ambient pressure is temperature dependent, a temperature
- * measurement will be executed automatically even if the user is reading
- * from pressure0_input. This happens if the last temperature measurement
- * has been executed more then one second ago.
- *
- * To decrease RMS noise from pressure measurements, the bmp180 can
- * autonomously calculate the average of up to eight samples. This is
- * set up by writing to the oversampling sysfs file. Accepted values
- * are 0, 1, 2 and 3. 2^x when x is the value written to this file
- * specifies the number of samples used to calculate the ambient pressure.
- * RMS noise is specified with six pascal (without averaging) and decreases
- * down to 3 pascal when using an oversampling setting of 3.
- *
- * This program is free software; you can redistribute it and/or modify
- * it under the terms of the GNU General Public License as published by
- * the Free Software Foundation; either version 2 of the License, or
- * (at your option) any later version.
- *
- * This program is distributed in the hope that it will be useful,
- * but WITHOUT ANY WARRANTY; without even the implied warranty of
- * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
- * GNU General Public License for more details.
- *
- * You should have received a copy of the GNU General Public License
- * along with this program; if not, write to the Free Software
- * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
- */
-#include <linux/module.h>
-#include <linux/init.h>
-#include <linux/i2c.h>
-#include <linux/slab.h>
-#include <linux/delay.h>
-#include <linux/input.h>
-#include <linux/bmp180.h>
-#define BMP180_CHIP_ID                  0x55
-#define BMP180_CALIBRATION_DATA_START   0xAA
-#define BMP180_CALIBRATION_DATA_LENGTH  11   /* 16 bit values */
-#define BMP180_CHIP_ID_REG              0xD0
-#define BMP180_VERSION_REG              0xD1
-#define BMP180_CTRL_REG                 0xF4
-#define BMP180_TEMP_MEASUREMENT         0x2E
-#define BMP180_PRESSURE_MEASUREMENT     0x34
-#define BMP180_CONVERSION_REGISTER_MSB  0xF6
-#define BMP180_CONVERSION_REGISTER_LSB  0xF7
-#define BMP180_CONVERSION_REGISTER_XLSB 0xF8
-#define BMP180_TEMP_CONVERSION_TIME     5
-#define BMP180_VENDORID                 0x0001
-struct bmp180_calibration_data {
-	s16 AC1, AC2, AC3;
-	u16 AC4, AC5, AC6;
-	s16 B1, B2;
-	s16 MB, MC, MD;
-};
-struct bmp180_data {
-	struct i2c_client *client;
-	struct mutex lock;
-	struct mutex power_lock;
-	struct bmp180_calibration_data calibration;
-	u32 raw_temperature;
-	u32 raw_pressure;
-	unsigned char oversampling_setting;
-	u32 last_temp_measurement;
-	s32 b6; /* calculated temperature correction coefficient */
-	struct input_dev *ip_dev;
-	struct delayed_work work_data;
-	unsigned long delay_jiffies;
-	struct bmp180_platform_data *pdata;
-	bool power;
-};
-static inline s32 bmp180_read_calibration_data(struct i2c_client *client)
-{
-	u16 tmp[BMP180_CALIBRATION_DATA_LENGTH];
-	struct bmp180_data *data = i2c_get_clientdata(client);
-	struct bmp180_calibration_data *cali = &(data->calibration);
-	s32 status = i2c_smbus_read_i2c_block_data(client,
-				BMP180_CALIBRATION_DATA_START,
-				sizeof(tmp),
-				(u8 *)tmp);
-	if (status < 0)
-		return status;
-	if (status != sizeof(tmp))
-		return -EIO;
-	cali->AC1 = be16_to_cpu(tmp[0]);
-	cali->AC2 = be16_to_cpu(tmp[1]);
-	cali->AC3 = be16_to_cpu(tmp[2]);
-	cali->AC4 = be16_to_cpu(tmp[3]);
-	cali->AC5 = be16_to_cpu(tmp[4]);
-	cali->AC6 = be16_to_cpu(tmp[5]);
-	cali->B1 = be16_to_cpu(tmp[6]);
-	cali->B2 = be16_to_cpu(tmp[7]);
-	cali->MB = be16_to_cpu(tmp[8]);
-	cali->MC = be16_to_cpu(tmp[9]);
-	cali->MD = be16_to_cpu(tmp[10]);
-	return 0;
-}
-static inline s32 bmp180_update_raw_temperature(struct bmp180_data *data)
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Checks calibration coefficients (according to the datasheet none of them can be 0 or 0xffff)
+/// @return True if calibration data is valid
+static bool drvBMP085CheckCalibration(void)
 {
-	u16 tmp;
-	s32 status;
-	mutex_lock(&data->lock);
-	status = i2c_smbus_write_byte_data(data->client, BMP180_CTRL_REG,
-						BMP180_TEMP_MEASUREMENT);
-	if (status != 0) {
-		dev_err(&data->client->dev,
-			"Error while requesting temperature measurement.\n");
-		goto exit;
-	}
-	msleep(BMP180_TEMP_CONVERSION_TIME);
-	status = i2c_smbus_read_i2c_block_data(data->client,
-					BMP180_CONVERSION_REGISTER_MSB,
-					sizeof(tmp), (u8 *)&tmp);
-	if (status < 0)
-		goto exit;
-	if (status != sizeof(tmp)) {
-		dev_err(&data->client->dev,
-			"Error while reading temperature measurement result\n");
-		status = -EIO;
-		goto exit;
+	uint16_t* coefficient;
+	uint8_t i;
+
+	coefficient = (uint16_t*)&l_calibration;
+	for (i = 0; i < drvBMP085_CALIBRATION_DATA_LENGTH; i++)
+	{
+		if (coefficient[i] == 0 || coefficient[i] == 0xffff)
+			return false;
 	}
-	data->raw_temperature = be16_to_cpu(tmp);
-	data->last_temp_measurement = jiffies;
-	status = 0;   /* everything ok, return 0 */
-exit:
-	mutex_unlock(&data->lock);
-	return status;
+
+	return true;
 }
-static inline s32 bmp180_update_raw_pressure(struct bmp180_data *data)
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Selects oversampling and starts continuous conversions. Conversions are started
+/// immediately after reading the result of the previous conversion therefore the sampling rate is
+/// determined only by the conversion time of the selected oversampling.
+/// @param in_parameter Acquisition function parameter
+static void drvBMP085StartAcquisition(drvIMUAcquisitionParameter* in_parameter)
 {
-	u32 tmp = 0;
-	s32 status;
-	mutex_lock(&data->lock);
-	status = i2c_smbus_write_byte_data(data->client, BMP180_CTRL_REG,
-					BMP180_PRESSURE_MEASUREMENT +
-					(data->oversampling_setting<<6));
-	if (status != 0) {
-		dev_err(&data->client->dev,
-			"Error while requesting pressure measurement.\n");
-		goto exit;
-	}
-	/* wait for the end of conversion */
-	msleep(2+(3 << data->oversampling_setting));
-	/* copy data into a u32 (4 bytes), but skip the first byte. */
-	status = i2c_smbus_read_i2c_block_data(data->client,
-					BMP180_CONVERSION_REGISTER_MSB,
-					3, ((u8 *)&tmp)+1);
-	if (status < 0)
-		goto exit;
-	if (status != 3) {
-		dev_err(&data->client->dev,
-			"Error while reading pressure measurement results\n");
-		status = -EIO;
-		goto exit;
+	uint8_t i;
+
+	// select the highest oversampling not above the requested one
+	l_oversampling = &l_oversampling_info[sizeof(l_oversampling_info) / sizeof(l_oversampling_info[0]) - 1];
+	if (in_parameter->Oversampling != 0)
+	{
+		for (i = 0; i < sizeof(l_oversampling_info) / sizeof(l_oversampling_info[0]); i++)
+		{
+			if (l_oversampling_info[i].Oversampling <= in_parameter->Oversampling)
+				l_oversampling = &l_oversampling_info[i];
+		}
 	}
-	data->raw_pressure = be32_to_cpu((tmp));
-	data->raw_pressure >>= (8-data->oversampling_setting);
-	status = 0;   /* everything ok, return 0 */
-exit:
-	mutex_unlock(&data->lock);
-	return status;
-}
-/*
- * This function starts the temperature measurement and returns the value
- * in tenth of a degree celsius.
- */
-static inline s32 bmp180_get_temperature(struct bmp180_data *data,
-						int *temperature)
-{
-	struct bmp180_calibration_data *cali = &data->calibration;
-	long x1, x2;
-	int status;
-	status = bmp180_update_raw_temperature(data);
-	if (status != 0)
-		goto exit;
-	x1 = ((data->raw_temperature - cali->AC6) * cali->AC5) >> 15;
-	x2 = (cali->MC << 11) / (x1 + cali->MD);
-	data->b6 = x1 + x2 - 4000;
-	/* if NULL just update b6. Used for pressure only measurements */
-	if (temperature != NULL)
-		*temperature = (x1+x2+8) >> 4;
-exit:
-	return status;
+
+	// store acquisition settings
+	l_sample_callback = in_parameter->BarometerCallback;
+	l_sensor_index = in_parameter->SensorIndex;
+
+	sysMemZero(&l_statistics, sizeof(l_statistics));
+
+	// the first conversion is temperature
+	l_conversion = drvBMP085_CT_None;
+	l_pressure_conversion_count = 0;
+	l_temperature_valid = false;
+	l_discard_result = false;
+	l_transfer_in_progress = false;
+
+	// set result
+	in_parameter->Success = true;
+	in_parameter->ActualSampleRate = (uint16_t)(1000000ul * drvBMP085_PRESSURE_PER_TEMPERATURE / (drvBMP085_PRESSURE_PER_TEMPERATURE * (uint32_t)l_oversampling->ConversionTime + drvBMP085_TEMP_CONVERSION_TIME));
 }
-/*
- * This function starts the pressure measurement and returns the value
- * in millibar. Since the pressure depends on the ambient temperature,
- * a temperature measurement is executed if the last known value is older
- * than one second.
- */
-static inline s32 bmp180_get_pressure(struct bmp180_data *data, int *pressure)
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Advances the conversion state machine. When the running conversion is finished its result
+/// is read and the next conversion is started in one transaction chain. Results are processed from
+/// the bus interrupt.
+/// @return Time until the running conversion is finished [us]
+static uint32_t drvBMP085Read(void)
 {
-	struct bmp180_calibration_data *cali = &data->calibration;
-	s32 x1, x2, x3, b3;
-	u32 b4, b7;
-	s32 p;
-	int status;
-	/* alt least every second force an update of the ambient temperature */
-	if (data->last_temp_measurement + 1*HZ < jiffies) {
-		status = bmp180_get_temperature(data, NULL);
-		if (status != 0)
-			goto exit;
+	uint32_t ellapsed_time;
+	imuTransaction* first_transaction;
+
+	// wait for the previous transactions
+	if (l_transfer_in_progress)
+		return l_oversampling->ConversionTime;
+
+	// wait for the end of the conversion
+	if (l_conversion != drvBMP085_CT_None)
+	{
+		ellapsed_time = sysHighresTimerGetTimeSince(l_conversion_timestamp);
+		if (ellapsed_time < l_conversion_time)
+			return l_conversion_time - ellapsed_time;
 	}
-	status = bmp180_update_raw_pressure(data);
-	if (status != 0)
-		goto exit;
-	x1 = (data->b6 * data->b6) >> 12;
-	x1 *= cali->B2;
-	x1 >>= 11;
-	x2 = cali->AC2 * data->b6;
-	x2 >>= 11;
-	x3 = x1 + x2;
-	b3 = (((((s32)cali->AC1) * 4 + x3) << data->oversampling_setting) + 2);
-	b3 >>= 2;
-	x1 = (cali->AC3 * data->b6) >> 13;
-	x2 = (cali->B1 * ((data->b6 * data->b6) >> 12)) >> 16;
-	x3 = (x1 + x2 + 2) >> 2;
-	b4 = (cali->AC4 * (u32)(x3 + 32768)) >> 15;
-	b7 = ((u32)data->raw_pressure - b3) *
-		(50000 >> data->oversampling_setting);
-	p = ((b7 < 0x80000000) ? ((b7 << 1) / b4) : ((b7 / b4) * 2));
-	x1 = p >> 8;
-	x1 *= x1;
-	x1 = (x1 * 3038) >> 16;
-	x2 = (-7357 * p) >> 16;
-	p += (x1 + x2 + 3791) >> 4;
-	*pressure = p;
-exit:
-	return status;
-}
-static int bmp180_perform_suspend(struct bmp180_data *dd)
-{
-	int rc = 0;
-	mutex_lock(&dd->power_lock);
-	if (dd->power) {
-		dd->power = false;
-		cancel_delayed_work(&dd->work_data);
-		if ((dd->pdata) && (dd->pdata->gpio_setup))
-			rc = dd->pdata->gpio_setup(dd->power);
+
+	// temperature is converted first and after every drvBMP085_PRESSURE_PER_TEMPERATURE pressure conversions
+	if (!l_temperature_valid || l_pressure_conversion_count >= drvBMP085_PRESSURE_PER_TEMPERATURE)
+	{
+		l_next_conversion = drvBMP085_CT_Temperature;
+		l_convert_command = drvBMP085_TEMP_MEASUREMENT;
 	}
-	mutex_unlock(&dd->power_lock);
-	return rc;
-}
-static int bmp180_perform_resume(struct bmp180_data *dd)
-{
-	int rc = 0;
-	mutex_lock(&dd->power_lock);
-	if (!dd->power) {
-		dd->power = true;
-		if ((dd->pdata) && (dd->pdata->gpio_setup))
-			rc = dd->pdata->gpio_setup(dd->power);
-		schedule_delayed_work(&dd->work_data, dd->delay_jiffies);
+	else
+	{
+		l_next_conversion = drvBMP085_CT_Pressure;
+		l_convert_command = drvBMP085_PRESSURE_MEASUREMENT | (l_oversampling->OversamplingSetting << drvBMP085_OSS_SHIFT);
 	}
-	mutex_unlock(&dd->power_lock);
-	return rc;
-}
-#if defined(CONFIG_PM)
-static int bmp180_suspend(struct device *dev)
-{
-	struct i2c_client *client = to_i2c_client(dev);
-	struct bmp180_data *dd;
-	dd = i2c_get_clientdata(client);
-	return bmp180_perform_suspend(dd);
-}
-static int bmp180_resume(struct device *dev)
-{
-	struct i2c_client *client = to_i2c_client(dev);
-	struct bmp180_data *dd;
-	dd = i2c_get_clientdata(client);
-	return bmp180_perform_resume(dd);
-}
-static const struct dev_pm_ops bmp180_pm = {
-	.suspend = bmp180_suspend,
-	.resume  = bmp180_resume,
-};
-#endif
-/* time interval in milliseconds between measurements */
-static ssize_t bmp180_rate_show(struct device *dev,
-				struct device_attribute *attr,
-				char *buf)
-{
-	struct bmp180_data *dd = dev_get_drvdata(dev);
-	return snprintf(buf, PAGE_SIZE, "%d\n",
-			jiffies_to_msecs(dd->delay_jiffies));
-}
-static ssize_t bmp180_rate_store(struct device *dev,
-					struct device_attribute *attr,
-					const char *buf, size_t count)
-{
-	struct bmp180_data *dd = dev_get_drvdata(dev);
-	unsigned long val;
-	int err = strict_strtoul(buf, 10, &val);
-	if ((!err) && (val >= 1)) {
-		dd->delay_jiffies = msecs_to_jiffies(val);
-		return strnlen(buf, count);
+
+	imuTransactionInitWrite(&l_convert_transaction, drvBMP085_I2C_ADDRESS, drvBMP085_CTRL_REG, &l_convert_command, 1, drvBMP085ConversionStarted);
+
+	// read result of the finished conversion before starting the next one
+	if (l_conversion != drvBMP085_CT_None)
+	{
+		imuTransactionInitRead(&l_result_read_transaction, drvBMP085_I2C_ADDRESS, drvBMP085_CTRL_REG, l_result_buffer, drvBMP085_RESULT_LENGTH, sysNULL);
+		l_result_read_transaction.Next = &l_convert_transaction;
+		l_result_read_submitted = true;
+		first_transaction = &l_result_read_transaction;
 	}
-	return -EINVAL;
-}
-/* 0=ultra low power, 1=standard, 2=high resolution, 3=ultra high resolution */
-static ssize_t bmp180_resolution_show(struct device *dev,
-					struct device_attribute *attr,
-					char *buf)
-{
-	struct bmp180_data *dd = dev_get_drvdata(dev);
-	return snprintf(buf, PAGE_SIZE, "%u\n", dd->oversampling_setting);
-}
-static ssize_t bmp180_resolution_store(struct device *dev,
-					struct device_attribute *attr,
-					const char *buf, size_t count)
-{
-	struct bmp180_data *dd = dev_get_drvdata(dev);
-	unsigned long val;
-	int err = strict_strtoul(buf, 10, &val);
-	if ((!err) && (val >= 0) && (val <= 3)) {
-		dd->oversampling_setting = val;
-		return strnlen(buf, count);
+	else
+	{
+		l_result_read_submitted = false;
+		first_transaction = &l_convert_transaction;
 	}
-	return -EINVAL;
-}
-static struct device_attribute attributes[] = {
-	__ATTR(bmp180_rate, 0644, bmp180_rate_show, bmp180_rate_store),
-	__ATTR(bmp180_resolution, 0644, bmp180_resolution_show,
-						bmp180_resolution_store)
-};
-static int add_sysfs_interfaces(struct device *dev)
-{
-	int i;
-	for (i = 0; i < ARRAY_SIZE(attributes); i++)
-		if (device_create_file(dev, attributes + i))
-			goto undo;
-	return 0;
-undo:
-	for (; i >= 0 ; i--)
-		device_remove_file(dev, attributes + i);
-	dev_err(dev, "%s: failed to create sysfs interface\n", __func__);
-	return -ENODEV;
-}
-static void remove_sysfs_interfaces(struct device *dev)
-{
-	int i;
-	for (i = 0; i < ARRAY_SIZE(attributes); i++)
-		device_remove_file(dev, attributes + i);
-}
-static int bmp180_open(struct input_dev *dev)
-{
-	struct bmp180_data *dd = input_get_drvdata(dev);
-	return bmp180_perform_resume(dd);
-}
-static void bmp180_close(struct input_dev *dev)
-{
-	struct bmp180_data *dd = input_get_drvdata(dev);
-	bmp180_perform_suspend(dd);
+
+	l_transfer_in_progress = true;
+
+	if (!imuTransactionSubmit(first_transaction))
+		l_transfer_in_progress = false;
+
+	return l_oversampling->ConversionTime;
 }
-static void bmp180_work_f(struct work_struct *work)
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Conversion command finished callback (it is the last transaction of the chain)
+/// @param in_transaction Finished transaction
+/// @param in_interrupt_param Interrupt parameter
+static void drvBMP085ConversionStarted(imuTransaction* in_transaction, void* in_interrupt_param)
 {
-	int err, pressure = 0, temperature = 0;
-	struct bmp180_data *dd = container_of(work, struct bmp180_data,
-						work_data.work);
-	mutex_lock(&dd->power_lock);
-	if (dd->power) {
-		schedule_delayed_work(&dd->work_data, dd->delay_jiffies);
-		err = bmp180_get_temperature(dd, &temperature);
-		if (!err)
-			input_report_abs(dd->ip_dev, ABS_MISC, temperature);
-		err = bmp180_get_pressure(dd, &pressure);
-		if (!err) {
-			input_report_abs(dd->ip_dev, ABS_PRESSURE, pressure);
-			input_sync(dd->ip_dev);
+	sysHighresTimestamp timestamp;
+	drvBMP085ConversionType finished_conversion;
+
+	timestamp = sysHighresTimerGetTimestamp();
+
+	finished_conversion = l_conversion;
+	l_conversion = drvBMP085_CT_None;
+
+	// process result of the previous conversion
+	if (l_result_read_submitted)
+	{
+		l_statistics.TransactionCount++;
+
+		if (l_result_read_transaction.Status == imuTS_Success)
+			drvBMP085ProcessResult(finished_conversion, l_conversion_timestamp, in_interrupt_param);
+		else
+			l_statistics.ErrorCount++;
+	}
+
+	// store state of the new conversion
+	if (in_transaction->Status != imuTS_Aborted)
+		l_statistics.TransactionCount++;
+
+	if (in_transaction->Status == imuTS_Success)
+	{
+		l_conversion = l_next_conversion;
+		l_conversion_timestamp = timestamp;
+
+		if (l_conversion == drvBMP085_CT_Pressure)
+		{
+			l_conversion_time = l_oversampling->ConversionTime;
+			l_pressure_conversion_count++;
+		}
+		else
+		{
+			l_conversion_time = drvBMP085_TEMP_CONVERSION_TIME;
+			l_pressure_conversion_count = 0;
 		}
 	}
-	mutex_unlock(&dd->power_lock);
+	else
+	{
+		if (in_transaction->Status == imuTS_Failed)
+			l_statistics.ErrorCount++;
+	}
+
+	l_transfer_in_progress = false;
 }
-static int bmp180_probe(struct i2c_client *client,
-			const struct i2c_device_id *id)
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Processes conversion result. Temperature is stored, pressure is compensated and delivered.
+/// @param in_conversion Type of the finished conversion
+/// @param in_conversion_timestamp Start time of the finished conversion
+/// @param in_interrupt_param Interrupt parameter
+static void drvBMP085ProcessResult(drvBMP085ConversionType in_conversion, sysHighresTimestamp in_conversion_timestamp, void* in_interrupt_param)
 {
-	struct bmp180_data *dd;
-	unsigned char version;
-	int err = 0;
-	version = i2c_smbus_read_byte_data(client, BMP180_CHIP_ID_REG);
-	if (version != BMP180_CHIP_ID) {
-		printk(KERN_ERR "BMP180: wanted chip id 0x%X, "
-				"found chip id 0x%X on client i2c addr 0x%X\n",
-				BMP180_CHIP_ID, version, client->addr);
-		err = -ENODEV;
-		goto exit_early;
-	}
-	dd = kzalloc(sizeof(struct bmp180_data), GFP_KERNEL);
-	if (!dd) {
-		err = -ENOMEM;
-		goto exit_early;
-	}
-	/* initialize */
-	mutex_init(&dd->lock);
-	mutex_init(&dd->power_lock);
-	dd->power = true;
-	dd->oversampling_setting = BMP180_ULTRA_HIGH_RESOLUTION;
-	dd->last_temp_measurement = 0;
-	dd->delay_jiffies = msecs_to_jiffies(200);
-	i2c_set_clientdata(client, dd);
-	dd->client = client;
-	dd->pdata = client->dev.platform_data;
-	if ((dd->pdata) && (dd->pdata->gpio_setup)) {
-		err = dd->pdata->gpio_setup(dd->power);
-		if (err)
-			goto exit_free_dd;
+	uint32_t raw_value;
+	drvIMUBarometerSample sample;
+
+	// result registers contain the previous result while the conversion is running and the new
+	// conversion command (sent after the read) might be ignored, therefore the next result is discarded as well
+	if ((l_result_buffer[drvBMP085_RESULT_CTRL_POS] & drvBMP085_SCO) != 0 || l_discard_result)
+	{
+		l_discard_result = ((l_result_buffer[drvBMP085_RESULT_CTRL_POS] & drvBMP085_SCO) != 0);
+		l_statistics.ErrorCount++;
+		l_statistics.LostSampleCount++;
+		return;
 	}
-	err = bmp180_read_calibration_data(client);
-	if (err)
-		goto exit_free_dd;
-	version = i2c_smbus_read_byte_data(client, BMP180_VERSION_REG);
-	if (version < 0)
-		goto exit_free_dd;
-	/* create input device */
-	dd->ip_dev = input_allocate_device();
-	if (!dd->ip_dev) {
-		err = -ENOMEM;
-		goto exit_free_dd;
+
+	raw_value = ((uint32_t)l_result_buffer[drvBMP085_RESULT_MSB_POS] << 16) | ((uint32_t)l_result_buffer[drvBMP085_RESULT_MSB_POS + 1] << 8) | l_result_buffer[drvBMP085_RESULT_MSB_POS + 2];
+
+	if (in_conversion == drvBMP085_CT_Temperature)
+	{
+		// temperature is 16 bit
+		l_raw_temperature = (uint16_t)(raw_value >> 8);
+		l_temperature_valid = true;
 	}
-	input_set_drvdata(dd->ip_dev, dd);
-	dd->ip_dev->open       = bmp180_open;
-	dd->ip_dev->close      = bmp180_close;
-	dd->ip_dev->name       = BMP180_CLIENT_NAME;
-	dd->ip_dev->id.vendor  = BMP180_VENDORID;
-	dd->ip_dev->id.product = 1;
-	dd->ip_dev->id.version = 1;
-	__set_bit(EV_ABS,       dd->ip_dev->evbit);
-	__set_bit(ABS_PRESSURE, dd->ip_dev->absbit);
-	__set_bit(ABS_MISC,     dd->ip_dev->absbit);
-	input_set_abs_params(dd->ip_dev, ABS_PRESSURE, 30000, 110000, 0, 0);
-	input_set_abs_params(dd->ip_dev, ABS_MISC, -400, 850, 0, 0);
-	err = input_register_device(dd->ip_dev);
-	if (err) {
-		input_free_device(dd->ip_dev);
-		goto exit_free_dd;
+	else
+	{
+		// pressure resolution depends on the oversampling setting
+		if (!drvBMP085Compensate(raw_value >> (8 - l_oversampling->OversamplingSetting), l_raw_temperature, l_oversampling->OversamplingSetting, &sample))
+		{
+			l_statistics.ErrorCount++;
+			l_statistics.LostSampleCount++;
+			return;
+		}
+
+		sample.Timestamp = in_conversion_timestamp + l_oversampling->ConversionTime / 2;
+
+		if (l_sample_callback != sysNULL)
+			l_sample_callback(l_sensor_index, &sample, in_interrupt_param);
+
+		l_statistics.SampleCount++;
 	}
-	err = add_sysfs_interfaces(&dd->ip_dev->dev);
-	if (err)
-		goto exit_unregister;
-	INIT_DELAYED_WORK(&dd->work_data, bmp180_work_f);
-	dev_info(&dd->client->dev, "BMP180 ver. %d.%d found.\n",
-			(version & 0x0F), (version & 0xF0) >> 4);
-	goto exit;
-exit_unregister:
-	input_unregister_device(dd->ip_dev);
-exit_free_dd:
-	kfree(dd);
-exit_early:
-	printk(KERN_ERR "%s: error %d\n", __func__, err);
-exit:
-	return err;
-}
-static int bmp180_remove(struct i2c_client *client)
-{
-	struct bmp180_data *dd = i2c_get_clientdata(client);
-	remove_sysfs_interfaces(&dd->ip_dev->dev);
-	input_unregister_device(dd->ip_dev);
-	kfree(dd);
-	return 0;
-}
-static const struct i2c_device_id bmp180_id[] = {
-	{ BMP180_CLIENT_NAME, 0 },
-	{ }
-};
-static struct i2c_driver bmp180_driver = {
-	.driver = {
-		.owner = THIS_MODULE,
-		.name  = BMP180_CLIENT_NAME,
-#if defined(CONFIG_PM)
-		.pm    = &bmp180_pm,
-#endif
-	},
-	.id_table      = bmp180_id,
-	.probe         = bmp180_probe,
-	.remove        = bmp180_remove,
-};
-static int __init bmp180_init(void)
-{
-	return i2c_add_driver(&bmp180_driver);
 }
-static void __exit bmp180_exit(void)
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Calculates temperature compensated pressure (integer calculation according to the
+/// datasheet). Shifts are used as in the datasheet because its example values depend on the
+/// rounding of negative values.
+/// @param in_raw_pressure Uncompensated pressure value (UP)
+/// @param in_raw_temperature Uncompensated temperature value (UT)
+/// @param in_oss Oversampling setting of the pressure conversion
+/// @param out_sample Compensated pressure [Pa] and temperature [0.01 degC]
+/// @return False if the raw values can't be compensated (they would cause division by zero)
+static bool drvBMP085Compensate(uint32_t in_raw_pressure, uint16_t in_raw_temperature, uint8_t in_oss, drvIMUBarometerSample* out_sample)
 {
-	i2c_del_driver(&bmp180_driver);
-}
-MODULE_AUTHOR("Marcus Bauer <marcus.bauer@sonyericsson.com>");
-MODULE_DESCRIPTION("BMP180 driver");
-MODULE_LICENSE("GPL");
-module_init(bmp180_init);
-module_exit(bmp180_exit);
+	int32_t x1, x2, x3;
+	int32_t b3, b5, b6;
+	uint32_t b4, b7;
+	int32_t pressure;
 
-#endif
+	// temperature
+	x1 = (((int32_t)in_raw_temperature - l_calibration.AC6) * l_calibration.AC5) >> 15;
+	if (x1 + l_calibration.MD == 0)
+		return false;
+
+	x2 = ((int32_t)l_calibration.MC << 11) / (x1 + l_calibration.MD);
+	b5 = x1 + x2;
+
+	// B5 is in 1/16 of 0.1 degC
+	out_sample->Temperature = (b5 * 10 + 8) >> 4;
+
+	// pressure
+	b6 = b5 - 4000;
+	x1 = (l_calibration.B2 * ((b6 * b6) >> 12)) >> 11;
+	x2 = (l_calibration.AC2 * b6) >> 11;
+	x3 = x1 + x2;
+	b3 = ((((int32_t)l_calibration.AC1 * 4 + x3) << in_oss) + 2) >> 2;
+
+	x1 = (l_calibration.AC3 * b6) >> 13;
+	x2 = (l_calibration.B1 * ((b6 * b6) >> 12)) >> 16;
+	x3 = ((x1 + x2) + 2) >> 2;
+	b4 = (l_calibration.AC4 * (uint32_t)(x3 + 32768)) >> 15;
+	if (b4 == 0)
+		return false;
+
+	b7 = ((uint32_t)in_raw_pressure - b3) * (50000 >> in_oss);
+
+	if (b7 < 0x80000000ul)
+		pressure = (int32_t)((b7 << 1) / b4);
+	else
+		pressure = (int32_t)((b7 / b4) << 1);
+
+	x1 = (pressure >> 8) * (pressure >> 8);
+	x1 = (x1 * 3038) >> 16;
+	x2 = (-7357 * pressure) >> 16;
+
+	out_sample->Pressure = pressure + ((x1 + x2 + 3791) >> 4);
+
+	return true;
+}
@@ -22,7 +22,7 @@
 /*****************************************************************************/
 /* Constants                                                                 */
 /*****************************************************************************/
-#define drvESP8266_TRANSMITTER_DATA_BUFFER_LENGTH 512
+#define drvESP8266_TRANSMITTER_SLOT_BUFFER_LENGTH 256
 #define drvESP8266_RECEIVER_BUFFER_LENGTH 512
 #define drvESP8266_TRANSMITTER_COMMAND_BUFFER_LENGTH 64
 #define drvESP8266_PARSER_BUFFER_LENGTH 32
@@ -76,13 +76,20 @@ typedef enum
 typedef enum
 {
 	drvESP8266_TM_Idle,
-	drvESP8266_TM_Reserved,
-	drvESP8266_TM_ReadyToSend,
 	drvESP8266_TM_SendingCommand,
 	drvESP8266_TM_SendingData,
 	drvESP8266_TM_SendingFinishing
 } drvESP8266TransmitterMode;
 
+/// Transmitter slot (one UDP packet waiting for transmission)
+typedef struct
+{
+	uint8_t Buffer[drvESP8266_TRANSMITTER_SLOT_BUFFER_LENGTH];
+	uint16_t Length;
+	uint32_t DestinationAddress;
+	volatile drvUDPTransmitterSlotState State;
+} drvESP8266TransmitterSlot;
+
 /// Result of the tokenizing received data block
 typedef enum
 {
@@ -165,6 +172,7 @@ static void drvESP8266CommandSendWithTimeout(sysConstString in_command, uint32_t
 static void drvESP8266CommandFlush(uint32_t in_timeout);
 static void drvESP8266ReceiverBufferClear(void);
 static void drvESP8266TransmitterDataBufferClear(void);
+static void drvESP8266ReleaseTransmitterSlot(void);
 static void drvESP8266SwitchToNextReceivedBlock(void);
 //static void drvESP8266StartTimeout(uint32_t in_delay);
 static void drvESP8266CommandSequenceStart(drvESP8266CommunicationState in_new_communiation_state, drvESP8266CommandTableEntry* in_command_table, drvESP8266CommunicationState in_success_communication_state, drvESP8266CommunicationState in_timeout_communication_state);
@@ -216,13 +224,12 @@ static uint32_t l_remote_ip_address;
 static sysTick l_device_announce_time_stamp;
 
 // transmitter variables
-static sysChar l_transmitter_data_buffer[drvESP8266_TRANSMITTER_DATA_BUFFER_LENGTH];
-static uint16_t l_transmitter_data_buffer_length;
+static drvESP8266TransmitterSlot l_transmitter_slots[drvUDP_TRANSMITTER_SLOT_COUNT];
+static uint8_t l_transmitter_push_index;
+static uint8_t l_transmitter_pop_index;
 static sysChar l_transmitter_command_buffer[drvESP8266_TRANSMITTER_COMMAND_BUFFER_LENGTH];
 static uint16_t l_transmitter_command_buffer_length;
 static drvESP8266TransmitterMode l_transmitter_mode;
-static sysTick l_transmitter_timestamp;
-static uint32_t l_transmitter_ip_address;
 
 // receiver variables
 static volatile drvESP8266ReceiverMode l_receiver_mode = drvESP8266_RM_Command;
@@ -318,50 +325,69 @@ void drvUDPInit(void)
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-/// @brief Allocates and reserves transmitter buffer
+/// @brief Allocates and reserves transmitter buffer. Buffers are allocated from the transmitter slots in the
+/// order of the transmission, so more than one packet can be waiting for transmission.
 /// @return Transmitter data buffer address or sysNULL if transmitter is not available
 uint8_t* drvUDPAllocTransmitBuffer(void)
 {
+	drvESP8266TransmitterSlot* slot;
 	uint8_t* buffer = sysNULL;
 
 	// prepare for atomic access
 	sysCriticalSectionBegin();
 
-	// transmitter should be in idle mode 
-	if (l_transmitter_mode == drvESP8266_TM_Idle)
+	// reserve transmitter slot if it is free
+	slot = &l_transmitter_slots[l_transmitter_push_index];
+	if (slot->State == drvUDP_TSS_Free)
 	{
-		// reserve transmitter buffer
-		l_transmitter_mode = drvESP8266_TM_Reserved;
+		slot->State = drvUDP_TSS_Reserved;
+		buffer = slot->Buffer;
+
+		l_transmitter_push_index = (l_transmitter_push_index + 1) % drvUDP_TRANSMITTER_SLOT_COUNT;
 	}
 
 	// exit atommic operation
 	sysCriticalSectionEnd();
 
-	// if buffer could be reserved
-	if (l_transmitter_mode == drvESP8266_TM_Reserved)
-	{
-		buffer = (uint8_t*)l_transmitter_data_buffer;
-		l_transmitter_timestamp = sysGetSystemTick();
-	}
-
 	return buffer;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 /// @brief Transmits data which is already placed in the transmitter buffer
+/// @param in_buffer Transmitter buffer returned by drvUDPAllocTransmitBuffer
 /// @param in_data_length Number of bytes to send
 /// @param in_destination_address IP address of the destination
-void drvUDPTransmitData(uint16_t in_data_length, uint32_t in_destination_address)
+void drvUDPTransmitData(uint8_t* in_buffer, uint16_t in_data_length, uint32_t in_destination_address)
 {
+	drvESP8266TransmitterSlot* slot;
+	uint8_t slot_index;
+
+	// find slot of the buffer
+	slot_index = 0;
+	while (slot_index < drvUDP_TRANSMITTER_SLOT_COUNT && l_transmitter_slots[slot_index].Buffer != in_buffer)
+		slot_index++;
+
 	// transmitter buffer must be reserved first
-	if (l_transmitter_mode != drvESP8266_TM_Reserved)
+	if (slot_index >= drvUDP_TRANSMITTER_SLOT_COUNT)
+		return;
+
+	slot = &l_transmitter_slots[slot_index];
+
+	if (slot->State != drvUDP_TSS_Reserved)
 		return;
 
+	// invalid packets are released by the thread without sending (zero length)
+	if (in_data_length > drvESP8266_TRANSMITTER_SLOT_BUFFER_LENGTH)
+		in_data_length = 0;
+
 	// store length
-	l_transmitter_data_buffer_length = in_data_length;
-	l_transmitter_ip_address = in_destination_address;
+	slot->Length = in_data_length;
+	slot->DestinationAddress = in_destination_address;
+
+	sysCriticalSectionBegin();
+	slot->State = drvUDP_TSS_ReadyToSend;
+	sysCriticalSectionEnd();
 
-	l_transmitter_mode = drvESP8266_TM_ReadyToSend;
 	sysTaskNotifyGive(l_task_event);
 }
 
@@ -413,7 +439,6 @@ static void drvESP8266Thread(void* in_param)
 	l_receiver_buffer_pop_index = 0;
 	l_receiver_buffer_push_index = 0;
 	l_receiver_buffer_block_start_index = 0;
-	l_transmitter_data_buffer_length = 0;
 	l_transmitter_mode = drvESP8266_TM_Idle;
 	l_timeout_value = 0;
 	l_command_sequence_table = sysNULL;
@@ -552,10 +577,11 @@ static void drvESP8266ProcessResponse(void)
 			l_transmitter_mode = drvESP8266_TM_SendingData;
 
 			// send data
-			halUARTSendBlock(l_uart_index, (uint8_t*)l_transmitter_data_buffer, l_transmitter_data_buffer_length);
+			halUARTSendBlock(l_uart_index, l_transmitter_slots[l_transmitter_pop_index].Buffer, l_transmitter_slots[l_transmitter_pop_index].Length);
 			return;
 
 		case drvESP8266_RBT_SendOK:
+			drvESP8266ReleaseTransmitterSlot();
 			l_transmitter_mode = drvESP8266_TM_Idle;
 
 			// notify com manager about the empty buffer
@@ -810,43 +836,41 @@ static void drvESP8266ProcessCommunicationTimeout(void)
 /// @breief Handles transmitter section
 static void drvESP8266HandleTransmitter(void)
 {
+	drvESP8266TransmitterSlot* slot;
 	sysStringLength pos;
 
-	// do nothing when transmitter is idle
-	if (l_transmitter_mode == drvESP8266_TM_Idle)
+	// do nothing when transmitter is busy
+	if (l_transmitter_mode != drvESP8266_TM_Idle)
 		return;
 
-	switch (l_transmitter_mode)
-	{
-		case drvESP8266_TM_ReadyToSend:
-			// packet is ready to send, check is modem is connected
-			if (l_communication_state == drvESP8266_CS_Connected)
-			{
-				// start packet sending
-				if (l_transmitter_data_buffer_length == 0)
-				{
-					l_transmitter_mode = drvESP8266_TM_Idle;
-				}
-				else
-				{
-					l_transmitter_mode = drvESP8266_TM_SendingCommand;
+	// check if the next packet is ready to send
+	slot = &l_transmitter_slots[l_transmitter_pop_index];
+	if (slot->State != drvUDP_TSS_ReadyToSend)
+		return;
 
-					pos = sysCopyConstString(l_transmitter_command_buffer, drvESP8266_TRANSMITTER_COMMAND_BUFFER_LENGTH, 0, (sysConstString)"AT+CIPSEND=0,");
-					pos = sysWordToStringPos(l_transmitter_command_buffer, drvESP8266_TRANSMITTER_COMMAND_BUFFER_LENGTH, pos, l_transmitter_data_buffer_length, 0, 0, 0);
-					pos = sysCopyConstString(l_transmitter_command_buffer, drvESP8266_TRANSMITTER_COMMAND_BUFFER_LENGTH, pos, (sysConstString)",\"");
-					pos = drvESP8266AppendIPAddresToCommand(pos, l_transmitter_ip_address);
-					pos = sysCopyConstString(l_transmitter_command_buffer, drvESP8266_TRANSMITTER_COMMAND_BUFFER_LENGTH, pos, (sysConstString)"\",");
-					pos = sysWordToStringPos(l_transmitter_command_buffer, drvESP8266_TRANSMITTER_COMMAND_BUFFER_LENGTH, pos, cfgGetUInt16Value(cfgVAL_WIFI_REMOTE), 0, 0, 0);
+	// packet is ready to send, check is modem is connected
+	if (l_communication_state == drvESP8266_CS_Connected)
+	{
+		// start packet sending
+		if (slot->Length == 0)
+		{
+			drvESP8266ReleaseTransmitterSlot();
+		}
+		else
+		{
+			l_transmitter_mode = drvESP8266_TM_SendingCommand;
 
-					l_transmitter_command_buffer_length = pos;
+			pos = sysCopyConstString(l_transmitter_command_buffer, drvESP8266_TRANSMITTER_COMMAND_BUFFER_LENGTH, 0, (sysConstString)"AT+CIPSEND=0,");
+			pos = sysWordToStringPos(l_transmitter_command_buffer, drvESP8266_TRANSMITTER_COMMAND_BUFFER_LENGTH, pos, slot->Length, 0, 0, 0);
+			pos = sysCopyConstString(l_transmitter_command_buffer, drvESP8266_TRANSMITTER_COMMAND_BUFFER_LENGTH, pos, (sysConstString)",\"");
+			pos = drvESP8266AppendIPAddresToCommand(pos, slot->DestinationAddress);
+			pos = sysCopyConstString(l_transmitter_command_buffer, drvESP8266_TRANSMITTER_COMMAND_BUFFER_LENGTH, pos, (sysConstString)"\",");
+			pos = sysWordToStringPos(l_transmitter_command_buffer, drvESP8266_TRANSMITTER_COMMAND_BUFFER_LENGTH, pos, cfgGetUInt16Value(cfgVAL_WIFI_REMOTE), 0, 0, 0);
 
-					drvESP8266CommandFlush(drvESP8266_DATA_SEND_TIMEOUT);
-				}
-			}
-			break;
+			l_transmitter_command_buffer_length = pos;
 
-		default:
-		  break;
+			drvESP8266CommandFlush(drvESP8266_DATA_SEND_TIMEOUT);
+		}
 	}
 }
 // </editor-fold>
@@ -1129,7 +1153,6 @@ void drvESP8266UARTTxEmptyCallback(void* in_interrupt_param)
 	// flag transmitter buffer free
 	if (l_transmitter_mode == drvESP8266_TM_SendingData)
 	{
-		l_transmitter_data_buffer_length = 0;
 		l_transmitter_mode = drvESP8266_TM_SendingFinishing;
 	}
 	else
@@ -1169,11 +1192,25 @@ static void drvESP8266ReceiverBufferClear(void)
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-/// @brief Clear transmitter data buffer
+/// @brief Clear transmitter data buffer (drops all packets waiting for transmission)
 static void drvESP8266TransmitterDataBufferClear(void)
 {
-	l_transmitter_data_buffer_length = 0;
 	l_transmitter_mode = drvESP8266_TM_Idle;
+
+	while (l_transmitter_slots[l_transmitter_pop_index].State == drvUDP_TSS_ReadyToSend)
+		drvESP8266ReleaseTransmitterSlot();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Releases the transmitter slot from the head of the transmission queue
+static void drvESP8266ReleaseTransmitterSlot(void)
+{
+	sysCriticalSectionBegin();
+
+	l_transmitter_slots[l_transmitter_pop_index].State = drvUDP_TSS_Free;
+	l_transmitter_pop_index = (l_transmitter_pop_index + 1) % drvUDP_TRANSMITTER_SLOT_COUNT;
+
+	sysCriticalSectionEnd();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -15,7 +15,7 @@
 #include <sysRTOS.h>
 #include <drvIMU.h>
 #include <imuCommunication.h>
-#include <math.h>
+#include <mathVector.h>
 
 /*****************************************************************************/
 /* Constants                                                                 */
@@ -144,7 +144,6 @@
 // CONFIG Register
 // DLPF is Digital Low Pass Filter for both gyro and accelerometers.
 // These are the names for the bits.
-// Use these only with the sysBV() macro.
 #define drvMPU6050_DLPF_CFG0     (1<<0)
 #define drvMPU6050_DLPF_CFG1     (1<<1)
 #define drvMPU6050_DLPF_CFG2     (1<<2)
@@ -174,13 +173,13 @@
 
 // Combined definitions for the DLPF_CFG values
 #define drvMPU6050_DLPF_CFG_0 (0)
-#define drvMPU6050_DLPF_CFG_1 (sysBV(drvMPU6050_DLPF_CFG0))
-#define drvMPU6050_DLPF_CFG_2 (sysBV(drvMPU6050_DLPF_CFG1))
-#define drvMPU6050_DLPF_CFG_3 (sysBV(drvMPU6050_DLPF_CFG1)|sysBV(drvMPU6050_DLPF_CFG0))
-#define drvMPU6050_DLPF_CFG_4 (sysBV(drvMPU6050_DLPF_CFG2))
-#define drvMPU6050_DLPF_CFG_5 (sysBV(drvMPU6050_DLPF_CFG2)|sysBV(drvMPU6050_DLPF_CFG0))
-#define drvMPU6050_DLPF_CFG_6 (sysBV(drvMPU6050_DLPF_CFG2)|sysBV(drvMPU6050_DLPF_CFG1))
-#define drvMPU6050_DLPF_CFG_7 (sysBV(drvMPU6050_DLPF_CFG2)|sysBV(drvMPU6050_DLPF_CFG1)|sysBV(drvMPU6050_DLPF_CFG0))
+#define drvMPU6050_DLPF_CFG_1 (drvMPU6050_DLPF_CFG0)
+#define drvMPU6050_DLPF_CFG_2 (drvMPU6050_DLPF_CFG1)
+#define drvMPU6050_DLPF_CFG_3 (drvMPU6050_DLPF_CFG1|drvMPU6050_DLPF_CFG0)
+#define drvMPU6050_DLPF_CFG_4 (drvMPU6050_DLPF_CFG2)
+#define drvMPU6050_DLPF_CFG_5 (drvMPU6050_DLPF_CFG2|drvMPU6050_DLPF_CFG0)
+#define drvMPU6050_DLPF_CFG_6 (drvMPU6050_DLPF_CFG2|drvMPU6050_DLPF_CFG1)
+#define drvMPU6050_DLPF_CFG_7 (drvMPU6050_DLPF_CFG2|drvMPU6050_DLPF_CFG1|drvMPU6050_DLPF_CFG0)
 
 // Alternative names for the combined definitions
 // This name uses the bandwidth (Hz) for the accelometer,
@@ -612,7 +611,27 @@
 #define drvMPU6050_SELF_TEST_MEASUREMENT_CYCLE_COUNT 100
 
 
+// FIFO settings
+#define drvMPU6050_FIFO_SIZE 1024
+#define drvMPU6050_FIFO_SAMPLE_SIZE 12	// acceleration (6 bytes) and gyro (6 bytes) data
+
+// maximum number of samples read from the FIFO in one I2C transaction
+#ifndef drvMPU6050_FIFO_MAX_BURST_SAMPLE_COUNT
+#define drvMPU6050_FIFO_MAX_BURST_SAMPLE_COUNT 16
+#endif
+
+#define drvMPU6050_FIFO_MAX_SAMPLE_COUNT (drvMPU6050_FIFO_SIZE / drvMPU6050_FIFO_SAMPLE_SIZE)
+#define drvMPU6050_FIFO_MAX_BURST_COUNT ((drvMPU6050_FIFO_MAX_SAMPLE_COUNT + drvMPU6050_FIFO_MAX_BURST_SAMPLE_COUNT - 1) / drvMPU6050_FIFO_MAX_BURST_SAMPLE_COUNT)
+#define drvMPU6050_FIFO_BUFFER_SIZE (drvMPU6050_FIFO_MAX_SAMPLE_COUNT * drvMPU6050_FIFO_SAMPLE_SIZE)
+
+// sample timestamp reconstruction
+#define drvMPU6050_SAMPLE_PERIOD_FRACTION_BITS 8													// sample period is stored in 1/256us units
+#define drvMPU6050_SAMPLE_PERIOD_FRACTION_MASK ((1ul << drvMPU6050_SAMPLE_PERIOD_FRACTION_BITS) - 1)
+#define drvMPU6050_PERIOD_ESTIMATION_MIN_SAMPLE_COUNT 64									// minimum number of samples to estimate sample period
+#define drvMPU6050_PERIOD_ESTIMATION_MAX_TIME 8000000ul										// maximum length of the sample period estimation window [us]
+
 #define GET_INT16_FROM_DATA_BUFER(x) ((int16_t)(((int16_t)l_data_buffer[x] << 8) + (int16_t)l_data_buffer[x+1]))
+#define GET_INT16_FROM_BUFFER(b, x) ((int16_t)(((uint16_t)(b)[x] << 8) | (uint16_t)(b)[x+1]))
 
 /*****************************************************************************/
 /* Default settings                                                          */
@@ -625,6 +644,33 @@
 static uint8_t l_i2c_address;
 static uint8_t l_sensor_resolution;
 static uint8_t l_data_buffer[drvMPU6050_DATA_BUFFER_SIZE ];
+static uint16_t l_sample_rate;
+
+// FIFO acquisition
+static uint8_t l_fifo_buffer[drvMPU6050_FIFO_BUFFER_SIZE];
+static uint8_t l_fifo_watermark;
+static uint8_t l_sensor_index;
+static drvIMUSampleCallbackFunction l_sample_callback = sysNULL;
+static drvIMUStatisticsParameter l_statistics;
+
+// asynchronous FIFO read
+static volatile bool l_read_in_progress = false;
+static imuTransaction l_fifo_count_transaction;
+static uint8_t l_fifo_count_buffer[2];
+static imuTransaction l_fifo_read_transactions[drvMPU6050_FIFO_MAX_BURST_COUNT];
+static imuTransaction l_fifo_reset_transactions[2];
+static const uint8_t l_fifo_reset_value = drvMPU6050_UC_FIFO_RESET;
+static const uint8_t l_fifo_enable_value = drvMPU6050_UC_FIFO_EN;
+static sysHighresTimestamp l_burst_read_timestamp;				// timestamp of the FIFO count read
+static uint32_t l_burst_sample_age;											// age of the next sample to process [1/256us]
+static bool l_burst_success;
+
+// sample timestamp reconstruction
+static uint32_t l_sample_period;												// estimated sample period [1/256us]
+static sysHighresTimestamp l_sample_timestamp;					// timestamp of the last sample [us]
+static uint32_t l_sample_timestamp_fraction;						// fractional part of the last sample timestamp [1/256us]
+static sysHighresTimestamp l_period_reference_timestamp;	// start of the sample period estimation window
+static uint32_t l_period_reference_sample_count;				// number of samples taken since the start of the estimation window
 
 /*****************************************************************************/
 /* Local functions                                                           */
@@ -633,6 +679,15 @@ static void drvMPU6050Detect(drvIMUDetectParameter* in_parameter);
 static void drvMPU6050SelfTest(drvIMUSelfTestParameter* in_parameter);
 static void drvMPU6050FindRevision(bool* inout_success);
 static void drvMPU6050SetSampleRateAndLowPassFilter(uint16_t in_sample_rate_hz, uint16_t in_filter_frequency_hz, bool* inout_success);
+static void drvMPU6050StartAcquisition(drvIMUAcquisitionParameter* in_parameter);
+static uint32_t drvMPU6050Read(void);
+static void drvMPU6050FIFOCountReceived(imuTransaction* in_transaction, void* in_interrupt_param);
+static void drvMPU6050StartFIFOSampleRead(uint16_t in_sample_count, sysHighresTimestamp in_read_timestamp);
+static void drvMPU6050FIFOSamplesReceived(imuTransaction* in_transaction, void* in_interrupt_param);
+static void drvMPU6050StartFIFOReset(void);
+static void drvMPU6050FIFOResetFinished(imuTransaction* in_transaction, void* in_interrupt_param);
+static void drvMPU6050ResetFIFO(bool* inout_success);
+static void drvMPU6050RestartTimestamps(void);
 
 
 /*****************************************************************************/
@@ -659,6 +714,16 @@ void drvMPU6050Control(drvIMUControlFunction in_function, void* in_function_para
 			drvMPU6050SelfTest((drvIMUSelfTestParameter*)in_function_parameter);
 			break;
 
+		// start FIFO based data acquisition
+		case drvIMU_CF_StartAcquisition:
+			drvMPU6050StartAcquisition((drvIMUAcquisitionParameter*)in_function_parameter);
+			break;
+
+		// get acquisition statistics
+		case drvIMU_CF_GetStatistics:
+			*((drvIMUStatisticsParameter*)in_function_parameter) = l_statistics;
+			break;
+
 		case drvIMU_CF_Unknown:
 		default:
 			// TODO: error
@@ -698,6 +763,7 @@ static void drvMPU6050Detect(drvIMUDetectParameter* in_parameter)
 		in_parameter->Success = true;
 		in_parameter->Class = drvIMU_SC_ACCELERATION | drvIMU_SC_GYRO;
 		in_parameter->Control = drvMPU6050Control;
+		in_parameter->Read = drvMPU6050Read;
 	}
 }
 
@@ -707,6 +773,7 @@ static void drvMPU6050Detect(drvIMUDetectParameter* in_parameter)
 static void drvMPU6050SelfTest(drvIMUSelfTestParameter* in_parameter)
 {
 	bool success = true;
+	bool restore_success = true;
 	uint8_t i;
 	uint8_t accel_int_trim[3];
 	uint8_t gyro_int_trim[3];
@@ -808,8 +875,8 @@ static void drvMPU6050SelfTest(drvIMUSelfTestParameter* in_parameter)
 		// convert factory trims to right units
 		for(i = 0; i < 3; i++)
 		{
-			accel_float_trim[i] = 4096 * 0.34f * powf(0.92f / 0.34f, (accel_int_trim[i] - 1) / 30.0f);
-			gyro_float_trim[i] = 25 * 131.0f * powf(1.046f, gyro_int_trim[i] - 1);
+			accel_float_trim[i] = 4096 * 0.34f * mathPower(0.92f / 0.34f, (accel_int_trim[i] - 1) / 30.0f);
+			gyro_float_trim[i] = 25 * 131.0f * mathPower(1.046f, (float)(gyro_int_trim[i] - 1));
 		}
 
 		// Y gyro trim is negative
@@ -838,11 +905,13 @@ static void drvMPU6050SelfTest(drvIMUSelfTestParameter* in_parameter)
 				success = false;
 			}
 		}
-
-		// turn off self test
-		imuWriteByteRegister(l_i2c_address, drvMPU6050_RA_GYRO_CONFIG, drvMPU6050_FS_SEL_250, &success );
-		imuWriteByteRegister(l_i2c_address, drvMPU6050_RA_ACCEL_CONFIG, drvMPU6050_AC_AFS_SEL_8G, &success);
 	}
+
+	// turn off self test (even if the test is failed)
+	imuWriteByteRegister(l_i2c_address, drvMPU6050_RA_GYRO_CONFIG, drvMPU6050_FS_SEL_250, &restore_success);
+	imuWriteByteRegister(l_i2c_address, drvMPU6050_RA_ACCEL_CONFIG, drvMPU6050_AC_AFS_SEL_8G, &restore_success);
+
+	in_parameter->Success = success && restore_success;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -851,7 +920,7 @@ static void drvMPU6050SetSampleRateAndLowPassFilter(uint16_t in_sample_rate_hz,
 {
 	uint8_t filter_value;
 	uint16_t gyro_sample_rate = 1000;
-	uint8_t divisor;
+	uint16_t divisor;
 
 	// choose next highest filter frequency available
 	if (in_filter_frequency_hz == 0)
@@ -926,7 +995,9 @@ static void drvMPU6050SetSampleRateAndLowPassFilter(uint16_t in_sample_rate_hz,
 		divisor = 1;
 	}
 
-	imuWriteByteRegister(l_i2c_address, drvMPU6050_RA_SMPLRT_DIV, divisor - 1, inout_success);
+	imuWriteByteRegister(l_i2c_address, drvMPU6050_RA_SMPLRT_DIV, (uint8_t)(divisor - 1), inout_success);
+
+	l_sample_rate = gyro_sample_rate / divisor;
 
 	sysHighresTimerDelay(1000);
 }
@@ -1004,3 +1075,303 @@ static void drvMPU6050FindRevision(bool* inout_success)
 
 	*inout_success = success;
 }
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Configures the sensor for FIFO based data acquisition
+/// @param in_parameter Acquisition function parameter
+static void drvMPU6050StartAcquisition(drvIMUAcquisitionParameter* in_parameter)
+{
+	bool success = true;
+
+	// find revision number of the chip (sets resolution)
+	drvMPU6050FindRevision(&success);
+
+	// set sample rate and low pass filter
+	drvMPU6050SetSampleRateAndLowPassFilter(in_parameter->SampleRate, in_parameter->FilterFrequency, &success);
+
+	// set ranges
+	imuWriteByteRegister(l_i2c_address, drvMPU6050_RA_GYRO_CONFIG, drvMPU6050_FS_SEL_2000, &success);
+	imuWriteByteRegister(l_i2c_address, drvMPU6050_RA_ACCEL_CONFIG, drvMPU6050_AC_AFS_SEL_8G, &success);
+
+	// store acquisition settings
+	l_sample_callback = in_parameter->SampleCallback;
+	l_sensor_index = in_parameter->SensorIndex;
+	l_fifo_watermark = in_parameter->Watermark;
+	if (l_fifo_watermark == 0)
+		l_fifo_watermark = 1;
+	if (l_fifo_watermark > drvMPU6050_FIFO_SIZE / drvMPU6050_FIFO_SAMPLE_SIZE / 2)
+		l_fifo_watermark = drvMPU6050_FIFO_SIZE / drvMPU6050_FIFO_SAMPLE_SIZE / 2;
+
+	sysMemZero(&l_statistics, sizeof(l_statistics));
+
+	// store acceleration and gyro data in the FIFO
+	imuWriteByteRegister(l_i2c_address, drvMPU6050_RA_FIFO_EN, drvMPU6050_ACCEL_FIFO_EN | drvMPU6050_XG_FIFO_EN | drvMPU6050_YG_FIFO_EN | drvMPU6050_ZG_FIFO_EN, &success);
+
+	// start with an empty FIFO
+	drvMPU6050ResetFIFO(&success);
+
+	// set result
+	in_parameter->Success = success;
+	in_parameter->ActualSampleRate = l_sample_rate;
+	in_parameter->AccelerationScale = (l_sensor_resolution == drvMPU6050_FULL_RESOLUTION) ? (1.0f / 4096) : (1.0f / 2048);
+	in_parameter->GyroScale = 1.0f / 16.4f;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Starts reading of the FIFO count. The FIFO count is checked on every call, samples are read
+/// in bursts when the number of the stored samples reaches the watermark level. All transfers are
+/// asynchronous, samples are delivered from the bus interrupt.
+/// @return The FIFO needs to be read only at the task cycle
+static uint32_t drvMPU6050Read(void)
+{
+	// previous read is still in progress
+	if (l_read_in_progress)
+		return drvIMU_READ_AT_TASK_CYCLE;
+
+	l_read_in_progress = true;
+
+	imuTransactionInitRead(&l_fifo_count_transaction, l_i2c_address, drvMPU6050_RA_FIFO_COUNTH, l_fifo_count_buffer, 2, drvMPU6050FIFOCountReceived);
+	if (!imuTransactionSubmit(&l_fifo_count_transaction))
+		l_read_in_progress = false;
+
+	return drvIMU_READ_AT_TASK_CYCLE;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief FIFO count read finished callback. Starts FIFO reset on overflow or reading of the samples.
+/// @param in_transaction Finished transaction
+/// @param in_interrupt_param Interrupt parameter
+static void drvMPU6050FIFOCountReceived(imuTransaction* in_transaction, void* in_interrupt_param)
+{
+	uint16_t fifo_count;
+	uint16_t sample_count;
+	sysHighresTimestamp read_timestamp;
+	uint32_t ellapsed_time;
+
+	sysUNUSED(in_interrupt_param);
+
+	read_timestamp = sysHighresTimerGetTimestamp();
+	l_statistics.TransactionCount++;
+
+	if (in_transaction->Status != imuTS_Success)
+	{
+		l_statistics.ErrorCount++;
+		l_read_in_progress = false;
+		return;
+	}
+
+	fifo_count = ((uint16_t)l_fifo_count_buffer[0] << 8) | l_fifo_count_buffer[1];
+
+	// check for overflow (oldest data is overwritten, FIFO content is no longer aligned to samples)
+	if (fifo_count > drvMPU6050_FIFO_SIZE - drvMPU6050_FIFO_SAMPLE_SIZE || (fifo_count % drvMPU6050_FIFO_SAMPLE_SIZE) != 0)
+	{
+		// all samples since the last read are lost
+		ellapsed_time = read_timestamp - l_sample_timestamp;
+		if (ellapsed_time < drvMPU6050_PERIOD_ESTIMATION_MAX_TIME && l_sample_period > 0)
+			l_statistics.LostSampleCount += (ellapsed_time << drvMPU6050_SAMPLE_PERIOD_FRACTION_BITS) / l_sample_period;
+
+		l_statistics.OverflowCount++;
+
+		drvMPU6050StartFIFOReset();
+
+		return;
+	}
+
+	// wait for the watermark level
+	sample_count = fifo_count / drvMPU6050_FIFO_SAMPLE_SIZE;
+	if (sample_count < l_fifo_watermark)
+	{
+		l_read_in_progress = false;
+		return;
+	}
+
+	drvMPU6050StartFIFOSampleRead(sample_count, read_timestamp);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Reconstructs sample timestamps and starts reading of the given number of samples from the FIFO
+/// @param in_sample_count Number of samples to read
+/// @param in_read_timestamp Timestamp of the FIFO count read
+static void drvMPU6050StartFIFOSampleRead(uint16_t in_sample_count, sysHighresTimestamp in_read_timestamp)
+{
+	uint32_t ellapsed_time;
+	int32_t sample_time;
+	uint32_t sample_age;
+	uint16_t burst_sample_count;
+	uint8_t burst_index;
+	uint8_t* buffer;
+
+	// update sample period estimation using the number of samples taken since the start of the estimation window
+	l_period_reference_sample_count += in_sample_count;
+	ellapsed_time = in_read_timestamp - l_period_reference_timestamp;
+	if (l_period_reference_sample_count >= drvMPU6050_PERIOD_ESTIMATION_MIN_SAMPLE_COUNT)
+		l_sample_period = (ellapsed_time << drvMPU6050_SAMPLE_PERIOD_FRACTION_BITS) / l_period_reference_sample_count;
+
+	// predict time of the newest sample relative to the read time [1/256us]
+	sample_time = (int32_t)((l_sample_timestamp - in_read_timestamp) << drvMPU6050_SAMPLE_PERIOD_FRACTION_BITS) + (int32_t)l_sample_timestamp_fraction + (int32_t)(in_sample_count * l_sample_period);
+
+	// newest sample must be taken within one sample period before the read
+	if (sample_time > 0)
+		sample_time = 0;
+
+	if (sample_time < -(int32_t)l_sample_period)
+		sample_time = -(int32_t)l_sample_period;
+
+	// store newest sample time for the next prediction
+	sample_age = (uint32_t)(-sample_time);
+	l_sample_timestamp = in_read_timestamp - ((sample_age + drvMPU6050_SAMPLE_PERIOD_FRACTION_MASK) >> drvMPU6050_SAMPLE_PERIOD_FRACTION_BITS);
+	l_sample_timestamp_fraction = (((sample_age + drvMPU6050_SAMPLE_PERIOD_FRACTION_MASK) & ~drvMPU6050_SAMPLE_PERIOD_FRACTION_MASK) - sample_age);
+
+	// restart estimation window from the newest sample
+	if (ellapsed_time > drvMPU6050_PERIOD_ESTIMATION_MAX_TIME)
+	{
+		l_period_reference_timestamp = l_sample_timestamp;
+		l_period_reference_sample_count = 0;
+	}
+
+	// age of the oldest sample
+	l_burst_read_timestamp = in_read_timestamp;
+	l_burst_sample_age = sample_age + (in_sample_count - 1) * l_sample_period;
+	l_burst_success = true;
+
+	// build burst read chain (every burst is read into a separate part of the buffer)
+	burst_index = 0;
+	buffer = l_fifo_buffer;
+	while (in_sample_count > 0)
+	{
+		burst_sample_count = in_sample_count;
+		if (burst_sample_count > drvMPU6050_FIFO_MAX_BURST_SAMPLE_COUNT)
+			burst_sample_count = drvMPU6050_FIFO_MAX_BURST_SAMPLE_COUNT;
+
+		imuTransactionInitRead(&l_fifo_read_transactions[burst_index], l_i2c_address, drvMPU6050_RA_FIFO_R_W, buffer, (uint8_t)(burst_sample_count * drvMPU6050_FIFO_SAMPLE_SIZE), drvMPU6050FIFOSamplesReceived);
+		if (burst_index > 0)
+			l_fifo_read_transactions[burst_index - 1].Next = &l_fifo_read_transactions[burst_index];
+
+		buffer += burst_sample_count * drvMPU6050_FIFO_SAMPLE_SIZE;
+		in_sample_count -= burst_sample_count;
+		burst_index++;
+	}
+
+	if (!imuTransactionSubmit(&l_fifo_read_transactions[0]))
+		l_read_in_progress = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief FIFO burst read finished callback. Reconstructs sample timestamps and calls sample callback.
+/// @param in_transaction Finished transaction
+/// @param in_interrupt_param Interrupt parameter
+static void drvMPU6050FIFOSamplesReceived(imuTransaction* in_transaction, void* in_interrupt_param)
+{
+	uint8_t* buffer;
+	uint8_t* buffer_end;
+	drvIMUSample sample;
+
+	if (in_transaction->Status != imuTS_Aborted)
+		l_statistics.TransactionCount++;
+
+	if (in_transaction->Status == imuTS_Success && l_burst_success)
+	{
+		l_statistics.BurstReadCount++;
+
+		// process samples
+		buffer = in_transaction->Buffer;
+		buffer_end = buffer + in_transaction->Length;
+		while (buffer < buffer_end)
+		{
+			sample.Timestamp = l_burst_read_timestamp - ((l_burst_sample_age + drvMPU6050_SAMPLE_PERIOD_FRACTION_MASK) >> drvMPU6050_SAMPLE_PERIOD_FRACTION_BITS);
+			sample.Acceleration[0] = GET_INT16_FROM_BUFFER(buffer, 0);
+			sample.Acceleration[1] = GET_INT16_FROM_BUFFER(buffer, 2);
+			sample.Acceleration[2] = GET_INT16_FROM_BUFFER(buffer, 4);
+			sample.Gyro[0] = GET_INT16_FROM_BUFFER(buffer, 6);
+			sample.Gyro[1] = GET_INT16_FROM_BUFFER(buffer, 8);
+			sample.Gyro[2] = GET_INT16_FROM_BUFFER(buffer, 10);
+
+			if (l_sample_callback != sysNULL)
+				l_sample_callback(l_sensor_index, &sample, in_interrupt_param);
+
+			l_statistics.SampleCount++;
+
+			l_burst_sample_age -= l_sample_period;
+			buffer += drvMPU6050_FIFO_SAMPLE_SIZE;
+		}
+	}
+	else
+	{
+		l_burst_success = false;
+	}
+
+	// wait for the last burst
+	if (in_transaction->Next != sysNULL)
+		return;
+
+	// FIFO content is unknown after a failed read
+	if (!l_burst_success)
+	{
+		l_statistics.ErrorCount++;
+		drvMPU6050StartFIFOReset();
+	}
+	else
+	{
+		l_read_in_progress = false;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Starts asynchronous FIFO reset (used from the bus interrupt)
+static void drvMPU6050StartFIFOReset(void)
+{
+	imuTransactionInitWrite(&l_fifo_reset_transactions[0], l_i2c_address, drvMPU6050_RA_USER_CTRL, (uint8_t*)&l_fifo_reset_value, 1, sysNULL);
+	imuTransactionInitWrite(&l_fifo_reset_transactions[1], l_i2c_address, drvMPU6050_RA_USER_CTRL, (uint8_t*)&l_fifo_enable_value, 1, drvMPU6050FIFOResetFinished);
+	l_fifo_reset_transactions[0].Next = &l_fifo_reset_transactions[1];
+
+	if (!imuTransactionSubmit(&l_fifo_reset_transactions[0]))
+		l_read_in_progress = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Asynchronous FIFO reset finished callback
+/// @param in_transaction Finished transaction
+/// @param in_interrupt_param Interrupt parameter
+static void drvMPU6050FIFOResetFinished(imuTransaction* in_transaction, void* in_interrupt_param)
+{
+	sysUNUSED(in_interrupt_param);
+
+	if (in_transaction->Status == imuTS_Success)
+	{
+		l_statistics.TransactionCount += 2;
+		drvMPU6050RestartTimestamps();
+	}
+	else
+	{
+		l_statistics.TransactionCount += (in_transaction->Status == imuTS_Aborted) ? 1 : 2;
+		l_statistics.ErrorCount++;
+	}
+
+	l_read_in_progress = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Clears and enables FIFO and restarts sample timestamp reconstruction
+/// @param inout_success Operation result
+static void drvMPU6050ResetFIFO(bool* inout_success)
+{
+	// reset FIFO (FIFO is disabled during reset) and enable FIFO
+	imuWriteByteRegister(l_i2c_address, drvMPU6050_RA_USER_CTRL, drvMPU6050_UC_FIFO_RESET, inout_success);
+	imuWriteByteRegister(l_i2c_address, drvMPU6050_RA_USER_CTRL, drvMPU6050_UC_FIFO_EN, inout_success);
+	l_statistics.TransactionCount += 2;
+
+	drvMPU6050RestartTimestamps();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Restarts sample timestamp reconstruction from the FIFO start time
+static void drvMPU6050RestartTimestamps(void)
+{
+	l_sample_timestamp = sysHighresTimerGetTimestamp();
+	l_sample_timestamp_fraction = 0;
+	l_period_reference_timestamp = l_sample_timestamp;
+	l_period_reference_sample_count = 0;
+
+	if (l_sample_rate > 0)
+		l_sample_period = (1000000ul << drvMPU6050_SAMPLE_PERIOD_FRACTION_BITS) / l_sample_rate;
+}
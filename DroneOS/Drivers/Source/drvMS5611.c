@@ -8,20 +8,23 @@
 /* of the GNU General Public License.  See the LICENSE file for details.     */
 /*****************************************************************************/
 
-///////////////////////////////////////////////////////////////////////////////
-// Include files
+/*****************************************************************************/
+/* Includes                                                                  */
+/*****************************************************************************/
+#include <sysHighresTimer.h>
+#include <sysRTOS.h>
 #include <drvIMU.h>
+#include <imuCommunication.h>
 
 /*****************************************************************************/
 /* Constants                                                                 */
 /*****************************************************************************/
-#define drvMS5611_DATA_BUFFER_SIZE 16
 
 // I2C addresses
 #define drvMS5611_I2C_PRI_ADDRESS 0x76
 #define drvMS5611_I2C_SEC_ADDRESS 0x77
 
-// Register address
+// Commands
 #define drvMS5611_RA_ADC           	0x00
 #define drvMS5611_RA_RESET         	0x1E
 
@@ -46,17 +49,82 @@
 #define drvMS5611_D2_OSR_2048   		0x56
 #define drvMS5611_D2_OSR_4096   		0x58
 
+#define drvMS5611_PROM_WORD_COUNT 8
+#define drvMS5611_PROM_CRC_MASK 0x000f
+#define drvMS5611_ADC_RESULT_LENGTH 3
+
+// number of pressure conversions between two temperature conversions
+#ifndef drvMS5611_PRESSURE_PER_TEMPERATURE
+#define drvMS5611_PRESSURE_PER_TEMPERATURE 8
+#endif
+
+/*****************************************************************************/
+/* Types                                                                     */
+/*****************************************************************************/
+
+/// Conversion running in the sensor
+typedef enum
+{
+	drvMS5611_CT_None,
+	drvMS5611_CT_Pressure,
+	drvMS5611_CT_Temperature
+} drvMS5611ConversionType;
+
+/// Oversampling ratio settings
+typedef struct
+{
+	uint16_t Oversampling;
+	uint8_t PressureCommand;
+	uint8_t TemperatureCommand;
+	uint16_t ConversionTime;	// maximum conversion time [us]
+} drvMS5611OversamplingInfo;
+
 /*****************************************************************************/
 /* Module global variables                                                   */
 /*****************************************************************************/
 static uint8_t l_i2c_address;
-static uint8_t l_data_buffer[drvMS5611_DATA_BUFFER_SIZE ];
+static uint16_t l_prom[drvMS5611_PROM_WORD_COUNT];
+
+static const drvMS5611OversamplingInfo l_oversampling_info[] =
+{
+	{ 256,  drvMS5611_D1_OSR_256,  drvMS5611_D2_OSR_256,  600 },
+	{ 512,  drvMS5611_D1_OSR_512,  drvMS5611_D2_OSR_512,  1170 },
+	{ 1024, drvMS5611_D1_OSR_1024, drvMS5611_D2_OSR_1024, 2280 },
+	{ 2048, drvMS5611_D1_OSR_2048, drvMS5611_D2_OSR_2048, 4540 },
+	{ 4096, drvMS5611_D1_OSR_4096, drvMS5611_D2_OSR_4096, 9040 }
+};
+
+// acquisition settings
+static const drvMS5611OversamplingInfo* l_oversampling = &l_oversampling_info[0];
+static uint8_t l_sensor_index;
+static drvIMUBarometerCallbackFunction l_sample_callback = sysNULL;
+static drvIMUStatisticsParameter l_statistics;
+
+// asynchronous conversion state machine
+static volatile bool l_transfer_in_progress = false;												// transactions or the conversion timer are pending
+static imuTransaction l_adc_read_transaction;
+static imuTransaction l_convert_transaction;
+static uint8_t l_adc_buffer[drvMS5611_ADC_RESULT_LENGTH];
+static bool l_adc_read_submitted;
+static drvMS5611ConversionType l_conversion = drvMS5611_CT_None;					// conversion running in the sensor
+static drvMS5611ConversionType l_next_conversion = drvMS5611_CT_None;		// conversion started by the submitted transactions
+static sysHighresTimestamp l_conversion_timestamp;											// start time of the running conversion
+static uint8_t l_pressure_conversion_count;															// pressure conversions since the last temperature conversion
+static uint32_t l_raw_temperature;																			// last D2 value (0 - not yet converted)
 
 /*****************************************************************************/
 /* Local functions                                                           */
 /*****************************************************************************/
 static void drvMS5611Detect(drvIMUDetectParameter* in_parameter);
-
+static void drvMS5611ReadPROM(bool* inout_success);
+static bool drvMS5611CheckPROM(void);
+static void drvMS5611StartAcquisition(drvIMUAcquisitionParameter* in_parameter);
+static uint32_t drvMS5611Read(void);
+static bool drvMS5611StartTransfer(void);
+static void drvMS5611ConversionStarted(imuTransaction* in_transaction, void* in_interrupt_param);
+static void drvMS5611ConversionFinished(void* in_interrupt_param);
+static void drvMS5611ProcessResult(drvMS5611ConversionType in_conversion, sysHighresTimestamp in_conversion_timestamp, void* in_interrupt_param);
+static void drvMS5611Compensate(uint32_t in_raw_pressure, uint32_t in_raw_temperature, drvIMUBarometerSample* out_sample);
 
 /*****************************************************************************/
 /* Function implementation                                                   */
@@ -64,7 +132,6 @@ static void drvMS5611Detect(drvIMUDetectParameter* in_parameter);
 
 ///////////////////////////////////////////////////////////////////////////////
 /// @brief Starts any sensor control (configuration) function
-/// @param in_imu_i2c I2C bus for IMU sensor
 /// @param in_function Functon code to start
 /// @param in_function_parameter Function parameter (if applicable)
 void drvMS5611Control(drvIMUControlFunction in_function, void* in_function_parameter)
@@ -77,6 +144,21 @@ void drvMS5611Control(drvIMUControlFunction in_function, void* in_function_param
 			drvMS5611Detect((drvIMUDetectParameter*)in_function_parameter);
 			break;
 
+		// the sensor has no self test, the calibration PROM is checked
+		case drvIMU_CF_SelfTest:
+			((drvIMUSelfTestParameter*)in_function_parameter)->Success = drvMS5611CheckPROM();
+			break;
+
+		// start continuous conversions
+		case drvIMU_CF_StartAcquisition:
+			drvMS5611StartAcquisition((drvIMUAcquisitionParameter*)in_function_parameter);
+			break;
+
+		// get acquisition statistics
+		case drvIMU_CF_GetStatistics:
+			*((drvIMUStatisticsParameter*)in_function_parameter) = l_statistics;
+			break;
+
 		case drvIMU_CF_Unknown:
 		default:
 			// TODO: error
@@ -85,409 +167,321 @@ void drvMS5611Control(drvIMUControlFunction in_function, void* in_function_param
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-/// @brief Sensor detection function
+/// @brief Sensor detection function. The sensor has no identification register, it is
+/// identified by the CRC of the calibration PROM.
 /// @param in_parameter Detection function parameter
 static void drvMS5611Detect(drvIMUDetectParameter* in_parameter)
 {
 	bool success = true;
-	uint8_t reg;
 
 	// try primary address first
 	l_i2c_address = drvMS5611_I2C_PRI_ADDRESS;
-	imuReadByteRegister(l_i2c_address, drvMPU6050_WHO_AM_I, &id_value, &success);
+	drvMS5611ReadPROM(&success);
 	if(!success)
 	{
 		// if not found try secondary address
-		l_i2c_address = drvMPU6050_I2C_SEC_ADDRESS;
-		imuReadByteRegister(l_i2c_address, drvMPU6050_WHO_AM_I, &id_value, &success);
+		success = true;
+		l_i2c_address = drvMS5611_I2C_SEC_ADDRESS;
+		drvMS5611ReadPROM(&success);
 	}
 
 	// check if found
-	if(success && ((id_value & drvMPU6050_WHO_AM_I_MASK) == drvMPU6050_WHO_AM_I_VALUE))
+	if(success && drvMS5611CheckPROM())
 	{
-		// sensor found
-
-		// enable I2C pa
-		imuReadByteRegister(i2c_address, drvMPU6050_USER_CTRL, &reg, &success);
-		reg &= drvMPU6050_UC_I2C_MST_EN;
-		//imuWriteByteRegsiter(l_i2c_address, drvMPU6050_USER_CTRL, reg, &success);
-
-		// set
+		// set result
 		in_parameter->Success = true;
-		in_parameter->Class = drvIMU_SC_ACCELERATION | drvIMU_SC_GYRO;
-		in_parameter->Config = drvMPU6050Control;
-
+		in_parameter->Class = drvIMU_SC_BAROMETRIC;
+		in_parameter->Control = drvMS5611Control;
+		in_parameter->Read = drvMS5611Read;
 	}
 }
 
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Reads calibration PROM content
+/// @param inout_success Operation result
+static void drvMS5611ReadPROM(bool* inout_success)
+{
+	uint8_t i;
+	uint8_t buffer[2];
 
-#if 0
-#define DEBUG_MODULE "MS5611"
+	for (i = 0; i < drvMS5611_PROM_WORD_COUNT; i++)
+	{
+		imuReadRegisterBlock(l_i2c_address, drvMS5611_C0 + 2 * i, buffer, 2, inout_success);
+		l_prom[i] = ((uint16_t)buffer[0] << 8) | buffer[1];
+	}
+}
 
-#include "FreeRTOS.h"
-#include "task.h"
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Checks CRC4 of the calibration PROM (stored in the lowest 4 bits of the last word)
+/// @return True if PROM content is valid
+static bool drvMS5611CheckPROM(void)
+{
+	uint16_t remainder = 0;
+	uint16_t data;
+	uint8_t i;
+	uint8_t bit;
 
-#include "ms5611.h"
-#include "i2cdev.h"
-#include "debug.h"
-#include "eprintf.h"
+	// coefficients must be programmed (empty PROM or floating bus would pass the CRC check)
+	for (i = 1; i < drvMS5611_PROM_WORD_COUNT - 1; i++)
+	{
+		if (l_prom[i] == 0 || l_prom[i] == 0xffff)
+			return false;
+	}
 
-#include "math.h"
+	for (i = 0; i < drvMS5611_PROM_WORD_COUNT * 2; i++)
+	{
+		data = l_prom[i >> 1];
+
+		// CRC field is zero during calculation
+		if (i == drvMS5611_PROM_WORD_COUNT * 2 - 1)
+			data &= ~drvMS5611_PROM_CRC_MASK;
+
+		if ((i & 1) == 0)
+			remainder ^= data >> 8;
+		else
+			remainder ^= data & 0xff;
+
+		for (bit = 0; bit < 8; bit++)
+		{
+			if ((remainder & 0x8000) != 0)
+				remainder = (remainder << 1) ^ 0x3000;
+			else
+				remainder = remainder << 1;
+		}
+	}
 
-#define EXTRA_PRECISION      5 // trick to add more precision to the pressure and temp readings
-#define CONVERSION_TIME_MS   10 // conversion time in milliseconds. 10 is minimum
-#define PRESSURE_PER_TEMP 5 // Length of reading cycle: 1x temp, rest pressure. Good values: 1-10
-#define FIX_TEMP 25         // Fixed Temperature. ASL is a function of pressure and temperature, but as the temperature changes so much (blow a little towards the flie and watch it drop 5 degrees) it corrupts the ASL estimates.
-                            // TLDR: Adjusting for temp changes does more harm than good.
+	return ((remainder >> 12) & drvMS5611_PROM_CRC_MASK) == (l_prom[drvMS5611_PROM_WORD_COUNT - 1] & drvMS5611_PROM_CRC_MASK);
+}
 
-typedef struct
-{
-  uint16_t psens;
-  uint16_t off;
-  uint16_t tcs;
-  uint16_t tco;
-  uint16_t tref;
-  uint16_t tsens;
-} CalReg;
-
-static uint8_t devAddr;
-static I2C_TypeDef *I2Cx;
-static bool isInit;
-
-static CalReg   calReg;
-static uint32_t lastPresConv;
-static uint32_t lastTempConv;
-static int32_t  tempCache;
-
-static uint8_t readState=0;
-static uint32_t lastConv=0;
-static int32_t tempDeltaT;
-
-bool ms5611Init(I2C_TypeDef *i2cPort)
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Selects oversampling ratio and starts continuous conversions. The result is read by the high
+/// resolution timer at the end of the conversion and the next conversion is started immediately, therefore
+/// the sampling rate is determined by the conversion time and the bus transfer time (not by the task cycle).
+/// @param in_parameter Acquisition function parameter
+static void drvMS5611StartAcquisition(drvIMUAcquisitionParameter* in_parameter)
 {
-  if (isInit)
-    return TRUE;
+	uint8_t i;
 
-  I2Cx = i2cPort;
-  devAddr = MS5611_ADDR_CSB_LOW;
+	// select the highest oversampling ratio not above the requested one
+	l_oversampling = &l_oversampling_info[sizeof(l_oversampling_info) / sizeof(l_oversampling_info[0]) - 1];
+	if (in_parameter->Oversampling != 0)
+	{
+		for (i = 0; i < sizeof(l_oversampling_info) / sizeof(l_oversampling_info[0]); i++)
+		{
+			if (l_oversampling_info[i].Oversampling <= in_parameter->Oversampling)
+				l_oversampling = &l_oversampling_info[i];
+		}
+	}
 
-  ms5611Reset(); // reset the device to populate its internal PROM registers
-  vTaskDelay(M2T(5));
-  if (ms5611ReadPROM() == FALSE) // reads the PROM into object variables for later use
-  {
-    return FALSE;
-  }
+	// store acquisition settings
+	l_sample_callback = in_parameter->BarometerCallback;
+	l_sensor_index = in_parameter->SensorIndex;
 
-  isInit = TRUE;
+	sysMemZero(&l_statistics, sizeof(l_statistics));
 
-  return TRUE;
-}
+	// the first conversion is temperature
+	l_conversion = drvMS5611_CT_None;
+	l_pressure_conversion_count = 0;
+	l_raw_temperature = 0;
+	sysHighresTimerStopCallback();
+	l_transfer_in_progress = false;
 
-bool ms5611SelfTest(void)
-{
-  bool testStatus = TRUE;
-  int32_t rawPress;
-  int32_t rawTemp;
-  int32_t deltaT;
-  float pressure;
-  float temperature;
-
-  if (!isInit)
-    return FALSE;
-
-  ms5611StartConversion(MS5611_D1 + MS5611_OSR_4096);
-  vTaskDelay(M2T(CONVERSION_TIME_MS));
-  rawPress = ms5611GetConversion(MS5611_D1 + MS5611_OSR_4096);
-
-  ms5611StartConversion(MS5611_D2 + MS5611_OSR_4096);
-  vTaskDelay(M2T(CONVERSION_TIME_MS));
-  rawTemp = ms5611GetConversion(MS5611_D2 + MS5611_OSR_4096);
-
-  deltaT = ms5611CalcDeltaTemp(rawTemp);
-  temperature = ms5611CalcTemp(deltaT);
-  pressure = ms5611CalcPressure(rawPress, deltaT);
-
-  if (ms5611EvaluateSelfTest(MS5611_ST_PRESS_MIN, MS5611_ST_PRESS_MAX, pressure, "pressure") &&
-      ms5611EvaluateSelfTest(MS5611_ST_TEMP_MIN, MS5611_ST_TEMP_MAX, temperature, "temperature"))
-  {
-    DEBUG_PRINT("Self test [OK].\n");
-  }
-  else
-  {
-   testStatus = FALSE;
-  }
-
-  return testStatus;
+	// set result
+	in_parameter->Success = true;
+	in_parameter->ActualSampleRate = (uint16_t)(1000000ul * drvMS5611_PRESSURE_PER_TEMPERATURE / ((drvMS5611_PRESSURE_PER_TEMPERATURE + 1) * (uint32_t)l_oversampling->ConversionTime));
 }
 
-bool ms5611EvaluateSelfTest(float min, float max, float value, char* string)
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Starts the conversions when they are not running (first call or recovery after a failed transaction).
+/// The running conversions are continued by the bus and timer callbacks.
+/// @return Always drvIMU_READ_AT_TASK_CYCLE
+static uint32_t drvMS5611Read(void)
 {
-  if (value < min || value > max)
-  {
-    DEBUG_PRINT("Self test %s [FAIL]. low: %0.2f, high: %0.2f, measured: %0.2f\n",
-                string, min, max, value);
-    return FALSE;
-  }
-  return TRUE;
-}
+	if (!l_transfer_in_progress)
+	{
+		l_transfer_in_progress = true;
 
-float ms5611GetPressure(uint8_t osr)
-{
-  // see datasheet page 7 for formulas
-  int32_t rawPress = ms5611RawPressure(osr);
-  int64_t dT = (int64_t)ms5611GetDeltaTemp(osr);
-  if (dT == 0)
-  {
-    return 0;
-  }
-  int64_t off = (((int64_t)calReg.off) << 16) + ((calReg.tco * dT) >> 7);
-  int64_t sens = (((int64_t)calReg.psens) << 15) + ((calReg.tcs * dT) >> 8);
-  if (rawPress != 0)
-  {
-    return ((((rawPress * sens) >> 21) - off) >> (15 - EXTRA_PRECISION))
-        / ((1 << EXTRA_PRECISION) * 100.0);
-  }
-  else
-  {
-    return 0;
-  }
+		if (!drvMS5611StartTransfer())
+			l_transfer_in_progress = false;
+	}
+
+	return drvIMU_READ_AT_TASK_CYCLE;
 }
 
-float ms5611CalcPressure(int32_t rawPress, int32_t dT)
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Submits the transaction chain which reads the result of the finished conversion (if there is any)
+/// and starts the next conversion
+/// @return True if the transactions are submitted
+static bool drvMS5611StartTransfer(void)
 {
-  int64_t off;
-  int64_t sens;
+	imuTransaction* first_transaction;
 
-  if (rawPress == 0 || dT == 0)
-  {
-    return 0;
-  }
+	// temperature is converted first and after every drvMS5611_PRESSURE_PER_TEMPERATURE pressure conversions
+	if (l_raw_temperature == 0 || l_pressure_conversion_count >= drvMS5611_PRESSURE_PER_TEMPERATURE)
+	{
+		l_next_conversion = drvMS5611_CT_Temperature;
+		imuTransactionInitWrite(&l_convert_transaction, l_i2c_address, l_oversampling->TemperatureCommand, sysNULL, 0, drvMS5611ConversionStarted);
+	}
+	else
+	{
+		l_next_conversion = drvMS5611_CT_Pressure;
+		imuTransactionInitWrite(&l_convert_transaction, l_i2c_address, l_oversampling->PressureCommand, sysNULL, 0, drvMS5611ConversionStarted);
+	}
 
-  off = (((int64_t)calReg.off) << 16) + ((calReg.tco * (int64_t)dT) >> 7);
-  sens = (((int64_t)calReg.psens) << 15) + ((calReg.tcs * (int64_t)dT) >> 8);
+	// read result of the finished conversion before starting the next one
+	if (l_conversion != drvMS5611_CT_None)
+	{
+		imuTransactionInitRead(&l_adc_read_transaction, l_i2c_address, drvMS5611_RA_ADC, l_adc_buffer, drvMS5611_ADC_RESULT_LENGTH, sysNULL);
+		l_adc_read_transaction.Next = &l_convert_transaction;
+		l_adc_read_submitted = true;
+		first_transaction = &l_adc_read_transaction;
+	}
+	else
+	{
+		l_adc_read_submitted = false;
+		first_transaction = &l_convert_transaction;
+	}
 
-  return ((((rawPress * sens) >> 21) - off) >> (15 - EXTRA_PRECISION))
-          / ((1 << EXTRA_PRECISION) * 100.0);
+	return imuTransactionSubmit(first_transaction);
 }
 
-float ms5611GetTemperature(uint8_t osr)
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Conversion timer callback: reads the result and starts the next conversion
+/// @param in_interrupt_param Interrupt parameter
+static void drvMS5611ConversionFinished(void* in_interrupt_param)
 {
-  // see datasheet page 7 for formulas
-  int32_t dT;
-
-  dT = ms5611GetDeltaTemp(osr);
-  if (dT != 0)
-  {
-    return ms5611CalcTemp(dT);
-  }
-  else
-  {
-    return 0;
-  }
-}
+	sysUNUSED(in_interrupt_param);
 
-int32_t ms5611GetDeltaTemp(uint8_t osr)
-{
-  int32_t rawTemp = ms5611RawTemperature(osr);
-  if (rawTemp != 0)
-  {
-    return ms5611CalcDeltaTemp(rawTemp);
-  }
-  else
-  {
-    return 0;
-  }
+	if (!drvMS5611StartTransfer())
+		l_transfer_in_progress = false;
 }
 
-float ms5611CalcTemp(int32_t deltaT)
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Conversion command finished callback (it is the last transaction of the chain)
+/// @param in_transaction Finished transaction
+/// @param in_interrupt_param Interrupt parameter
+static void drvMS5611ConversionStarted(imuTransaction* in_transaction, void* in_interrupt_param)
 {
-  if (deltaT == 0)
-  {
-    return 0;
-  }
-  else
-  {
-    return (float)(((1 << EXTRA_PRECISION) * 2000)
-            + (((int64_t)deltaT * calReg.tsens) >> (23 - EXTRA_PRECISION)))
-            / ((1 << EXTRA_PRECISION)* 100.0);
-  }
-}
+	sysHighresTimestamp timestamp;
+	drvMS5611ConversionType finished_conversion;
 
-int32_t ms5611CalcDeltaTemp(int32_t rawTemp)
-{
-  if (rawTemp == 0)
-  {
-    return 0;
-  }
-  else
-  {
-    return rawTemp - (((int32_t)calReg.tref) << 8);
-  }
-}
+	timestamp = sysHighresTimerGetTimestamp();
 
-int32_t ms5611RawPressure(uint8_t osr)
-{
-  uint32_t now = xTaskGetTickCount();
-  if (lastPresConv != 0 && (now - lastPresConv) >= CONVERSION_TIME_MS)
-  {
-    lastPresConv = 0;
-    return ms5611GetConversion(MS5611_D1 + osr);
-  }
-  else
-  {
-    if (lastPresConv == 0 && lastTempConv == 0)
-    {
-      ms5611StartConversion(MS5611_D1 + osr);
-      lastPresConv = now;
-    }
-    return 0;
-  }
-}
+	finished_conversion = l_conversion;
+	l_conversion = drvMS5611_CT_None;
 
-int32_t ms5611RawTemperature(uint8_t osr)
-{
-  uint32_t now = xTaskGetTickCount();
-  if (lastTempConv != 0 && (now - lastTempConv) >= CONVERSION_TIME_MS)
-  {
-    lastTempConv = 0;
-    tempCache = ms5611GetConversion(MS5611_D2 + osr);
-    return tempCache;
-  }
-  else
-  {
-    if (lastTempConv == 0 && lastPresConv == 0)
-    {
-      ms5611StartConversion(MS5611_D2 + osr);
-      lastTempConv = now;
-    }
-    return tempCache;
-  }
-}
+	// process result of the previous conversion
+	if (l_adc_read_submitted)
+	{
+		l_statistics.TransactionCount++;
 
-// see page 11 of the datasheet
-void ms5611StartConversion(uint8_t command)
-{
-  // initialize pressure conversion
-  i2cdevWriteByte(I2Cx, devAddr, I2CDEV_NO_MEM_ADDR, command);
-}
+		if (l_adc_read_transaction.Status == imuTS_Success)
+			drvMS5611ProcessResult(finished_conversion, l_conversion_timestamp, in_interrupt_param);
+		else
+			l_statistics.ErrorCount++;
+	}
 
-int32_t ms5611GetConversion(uint8_t command)
-{
-  int32_t conversion = 0;
-  uint8_t buffer[MS5611_D1D2_SIZE];
+	// store state of the new conversion
+	if (in_transaction->Status != imuTS_Aborted)
+		l_statistics.TransactionCount++;
 
-  // start read sequence
-  i2cdevWriteByte(I2Cx, devAddr, I2CDEV_NO_MEM_ADDR, 0);
-  // Read conversion
-  i2cdevRead(I2Cx, devAddr, I2CDEV_NO_MEM_ADDR, MS5611_D1D2_SIZE, buffer);
-  conversion = ((int32_t)buffer[0] << 16) |
-               ((int32_t)buffer[1] << 8) | buffer[2];
+	if (in_transaction->Status == imuTS_Success)
+	{
+		l_conversion = l_next_conversion;
+		l_conversion_timestamp = timestamp;
 
-  return conversion;
-}
+		if (l_conversion == drvMS5611_CT_Pressure)
+			l_pressure_conversion_count++;
+		else
+			l_pressure_conversion_count = 0;
 
-/**
- * Reads factory calibration and store it into object variables.
- */
-bool ms5611ReadPROM()
-{
-  uint8_t buffer[MS5611_PROM_REG_SIZE];
-  uint16_t* pCalRegU16 = (uint16_t*)&calReg;
-  int32_t i = 0;
-  bool status = FALSE;
-
-  for (i = 0; i < MS5611_PROM_REG_COUNT; i++)
-  {
-    // start read sequence
-    status = i2cdevWriteByte(I2Cx, devAddr, I2CDEV_NO_MEM_ADDR,
-                             MS5611_PROM_BASE_ADDR + (i * MS5611_PROM_REG_SIZE));
-    // Read conversion
-    if (status)
-    {
-      status = i2cdevRead(I2Cx, devAddr, I2CDEV_NO_MEM_ADDR, MS5611_PROM_REG_SIZE, buffer);
-      pCalRegU16[i] = ((uint16_t)buffer[0] << 8) | buffer[1];
-    }
-  }
-
-  return status;
+		// result is read when the conversion is finished
+		sysHighresTimerStartCallback(timestamp + l_oversampling->ConversionTime, drvMS5611ConversionFinished);
+	}
+	else
+	{
+		if (in_transaction->Status == imuTS_Failed)
+			l_statistics.ErrorCount++;
+
+		// conversions are restarted by the next read
+		l_transfer_in_progress = false;
+	}
 }
 
-/**
- * Send a reset command to the device. With the reset command the device
- * populates its internal registers with the values read from the PROM.
- */
-void ms5611Reset()
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Processes ADC result. Temperature is stored, pressure is compensated and delivered.
+/// @param in_conversion Type of the finished conversion
+/// @param in_conversion_timestamp Start time of the finished conversion
+/// @param in_interrupt_param Interrupt parameter
+static void drvMS5611ProcessResult(drvMS5611ConversionType in_conversion, sysHighresTimestamp in_conversion_timestamp, void* in_interrupt_param)
 {
-  i2cdevWriteByte(I2Cx, devAddr, I2CDEV_NO_MEM_ADDR, MS5611_RESET);
-}
+	uint32_t raw_value;
+	drvIMUBarometerSample sample;
 
+	raw_value = ((uint32_t)l_adc_buffer[0] << 16) | ((uint32_t)l_adc_buffer[1] << 8) | l_adc_buffer[2];
 
+	// zero result is returned when the conversion is not finished (or disturbed)
+	if (raw_value == 0)
+	{
+		l_statistics.ErrorCount++;
+		l_statistics.LostSampleCount++;
+		return;
+	}
 
+	if (in_conversion == drvMS5611_CT_Temperature)
+	{
+		l_raw_temperature = raw_value;
+	}
+	else
+	{
+		drvMS5611Compensate(raw_value, l_raw_temperature, &sample);
+		sample.Timestamp = in_conversion_timestamp + l_oversampling->ConversionTime / 2;
 
-/**
- * Gets pressure, temperature and above sea level altitude estimate (asl).
- * Best called at 100hz. For every PRESSURE_PER_TEMP-1 pressure readings temp is read once.
- * Effective 50-90hz baro update and 50-10hz temperature update if called at 100hz.
- */
-void ms5611GetData(float* pressure, float* temperature, float* asl)
-{
-    int32_t tempPressureRaw, tempTemperatureRaw;
-
-    // Dont reader faster than we can
-    uint32_t now = xTaskGetTickCount();
-    if ((now - lastConv) < CONVERSION_TIME_MS)
-    {
-        return;
-    }
-    lastConv = now;
-
-    if (readState == 0)
-    {
-        // read temp
-        ++readState;
-        tempTemperatureRaw = ms5611GetConversion(MS5611_D2 + MS5611_OSR_DEFAULT);
-        tempDeltaT = ms5611CalcDeltaTemp(tempTemperatureRaw);
-        *temperature = ms5611CalcTemp(tempDeltaT);
-        // cmd to read pressure
-        ms5611StartConversion(MS5611_D1 + MS5611_OSR_DEFAULT);
-    }
-    else
-    {
-        // read pressure
-        ++readState;
-        tempPressureRaw = ms5611GetConversion(MS5611_D1 + MS5611_OSR_DEFAULT);
-        *pressure = ms5611CalcPressure(tempPressureRaw, tempDeltaT);
-        *asl = ms5611PressureToAltitude(pressure);
-        if (readState == PRESSURE_PER_TEMP){
-            // cmd to read temp
-            ms5611StartConversion(MS5611_D2 + MS5611_OSR_DEFAULT);
-            readState = 0;
-        }
-        else
-        {
-            // cmd to read pressure
-            ms5611StartConversion(MS5611_D1 + MS5611_OSR_DEFAULT);
-        }
-    }
-}
+		if (l_sample_callback != sysNULL)
+			l_sample_callback(l_sensor_index, &sample, in_interrupt_param);
 
-//TODO: pretty expensive function. Rather smooth the pressure estimates and only call this when needed
+		l_statistics.SampleCount++;
+	}
+}
 
-/**
- * Converts pressure to altitude above sea level (ASL) in meters
- */
-float ms5611PressureToAltitude(float* pressure/*, float* ground_pressure, float* ground_temp*/)
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Calculates temperature compensated pressure (integer calculation with second order
+/// compensation according to the datasheet). Divisions are used instead of shifts because the
+/// rounding of negative values affects the second order terms.
+/// @param in_raw_pressure Digital pressure value (D1)
+/// @param in_raw_temperature Digital temperature value (D2)
+/// @param out_sample Compensated pressure [Pa] and temperature [0.01 degC]
+static void drvMS5611Compensate(uint32_t in_raw_pressure, uint32_t in_raw_temperature, drvIMUBarometerSample* out_sample)
 {
-    if (*pressure > 0)
-    {
-        //return (1.f - pow(*pressure / CONST_SEA_PRESSURE, CONST_PF)) * CONST_PF2;
-        //return ((pow((1015.7 / *pressure), CONST_PF) - 1.0) * (25. + 273.15)) / 0.0065;
-        return ((pow((1015.7 / *pressure), CONST_PF) - 1.0) * (FIX_TEMP + 273.15)) / 0.0065;
-    }
-    else
-    {
-        return 0;
-    }
-}
+	int32_t dt;
+	int32_t temperature;
+	int64_t offset;
+	int64_t sensitivity;
+	int64_t delta;
+
+	// first order compensation
+	dt = (int32_t)in_raw_temperature - ((int32_t)l_prom[5] << 8);
+	temperature = 2000 + (int32_t)((int64_t)dt * l_prom[6] / (1 << 23));
+	offset = ((int64_t)l_prom[2] << 16) + (int64_t)l_prom[4] * dt / (1 << 7);
+	sensitivity = ((int64_t)l_prom[1] << 15) + (int64_t)l_prom[3] * dt / (1 << 8);
+
+	// second order compensation at low temperature
+	if (temperature < 2000)
+	{
+		delta = (int64_t)(temperature - 2000) * (temperature - 2000);
+		offset -= 5 * delta / 2;
+		sensitivity -= 5 * delta / 4;
+
+		if (temperature < -1500)
+		{
+			delta = (int64_t)(temperature + 1500) * (temperature + 1500);
+			offset -= 7 * delta;
+			sensitivity -= 11 * delta / 2;
+		}
+
+		temperature -= (int32_t)((int64_t)dt * dt / (1ll << 31));
+	}
 
-#endif
+	out_sample->Temperature = temperature;
+	out_sample->Pressure = (int32_t)(((int64_t)in_raw_pressure * sensitivity / (1 << 21) - offset) / (1 << 15));
+}
@@ -28,6 +28,9 @@
 
 #define halUART_MAX_COUNT 4
 
+// number of UDP packets can be queued for transmission (ESP8266)
+#define drvUDP_TRANSMITTER_SLOT_COUNT 2
+
 // pin definitions
 #define SPI_CS_Pin GPIO_PIN_13
 #define SPI_CS_GPIO_Port GPIOC
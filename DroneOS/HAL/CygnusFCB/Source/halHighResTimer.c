@@ -14,6 +14,7 @@
 #include <halIODefinitions.h>
 #include <stm32f4xx_hal.h>
 #include <halHelpers.h>
+#include <sysRTOS.h>
 #include <sysHighresTimer.h>
 
 /*****************************************************************************/
@@ -26,6 +27,8 @@
 /*****************************************************************************/
 static TIM_HandleTypeDef l_high_res_timer;
 static volatile uint16_t l_timer_high = 0;
+static volatile sysHighresTimerCallbackFunction l_callback = sysNULL;
+static volatile sysHighresTimestamp l_expiration_time;
 
 /*****************************************************************************/
 /* Function implementation                                                   */
@@ -73,11 +76,46 @@ sysHighresTimestamp sysHighresTimerGetTimestamp(void)
 
   return (((uint32_t)upper_word)<<16) | timestamp;
 }
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Starts one shot timer (channel 1 compare interrupt). Only one callback can be pending, the previous one is replaced.
+/// @param in_expiration_time Timestamp when the callback is called (it must be less than 2^31us ahead)
+/// @param in_callback Callback function
+void sysHighresTimerStartCallback(sysHighresTimestamp in_expiration_time, sysHighresTimerCallbackFunction in_callback)
+{
+	sysCriticalSectionBeginFromISR();
+
+	l_expiration_time = in_expiration_time;
+	l_callback = in_callback;
+
+	// compare matches at the lower 16 bits, the upper bits are checked in the interrupt
+	__HAL_TIM_SET_COMPARE(&l_high_res_timer, TIM_CHANNEL_1, (uint16_t)in_expiration_time);
+	__HAL_TIM_CLEAR_FLAG(&l_high_res_timer, TIM_FLAG_CC1);
+	__HAL_TIM_ENABLE_IT(&l_high_res_timer, TIM_IT_CC1);
+
+	// expiration time can pass before the compare register is set -> generate compare event
+	if ((int32_t)(sysHighresTimerGetTimestamp() - in_expiration_time) >= 0)
+		l_high_res_timer.Instance->EGR = TIM_EGR_CC1G;
+
+	sysCriticalSectionEndFromISR();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Cancels pending timer callback
+void sysHighresTimerStopCallback(void)
+{
+	__HAL_TIM_DISABLE_IT(&l_high_res_timer, TIM_IT_CC1);
+	l_callback = sysNULL;
+}
 /*****************************************************************************/
 /* Interrupt handler                                                         */
 /*****************************************************************************/
 void TIM1_BRK_TIM9_IRQHandler(void)
 {
+	sysHighresTimerCallbackFunction callback;
+
+	sysBeginInterruptRoutine();
+
   if (__HAL_TIM_GET_FLAG(&l_high_res_timer, TIM_FLAG_UPDATE) != RESET)      //In case other interrupts are also running
   {
   	if (__HAL_TIM_GET_ITSTATUS(&l_high_res_timer, TIM_IT_UPDATE) != RESET)
@@ -86,5 +124,23 @@ void TIM1_BRK_TIM9_IRQHandler(void)
   		__HAL_TIM_CLEAR_FLAG(&l_high_res_timer, TIM_FLAG_UPDATE);
   	}
   }
+
+	// one shot timer (the compare matches once in every 65536us, the callback is called when the whole timestamp is expired)
+	if (__HAL_TIM_GET_FLAG(&l_high_res_timer, TIM_FLAG_CC1) != RESET && __HAL_TIM_GET_ITSTATUS(&l_high_res_timer, TIM_IT_CC1) != RESET)
+	{
+		__HAL_TIM_CLEAR_FLAG(&l_high_res_timer, TIM_FLAG_CC1);
+
+		if (l_callback != sysNULL && (int32_t)(sysHighresTimerGetTimestamp() - l_expiration_time) >= 0)
+		{
+			__HAL_TIM_DISABLE_IT(&l_high_res_timer, TIM_IT_CC1);
+
+			// the callback is cleared before the call (it can restart the timer)
+			callback = l_callback;
+			l_callback = sysNULL;
+			callback(sysInterruptParam());
+		}
+	}
+
+	sysEndInterruptRoutine();
 }
 
@@ -35,6 +35,13 @@
 /* Module global variables                                                   */
 /*****************************************************************************/
 static drvI2CMasterModule l_imu_i2c;
+static drvIMUCallbackFunction l_callback_function;
+static uint32_t l_callback_param;
+
+/*****************************************************************************/
+/* Local functions                                                           */
+/*****************************************************************************/
+static void drvIMUTransferFinished(bool in_success, void* in_interrupt_param);
 
 /*****************************************************************************/
 /* Function implementation                                                   */
@@ -96,17 +103,28 @@ void I2C2_ER_IRQHandler(void)
 	drvI2CMasterErrorInterruptHandler(&l_imu_i2c);
 }
 
-void drvIMUStartWriteAndReadBlock(uint8_t in_address, uint8_t* in_write_buffer, uint8_t in_write_buffer_length, uint8_t* in_read_buffer, uint8_t in_read_buffer_length, drvIMUCallbackFunction in_callback_function)
+void drvIMUStartWriteAndReadBlock(uint8_t in_address, uint8_t* in_write_buffer, uint8_t in_write_buffer_length, uint8_t* in_read_buffer, uint8_t in_read_buffer_length, drvIMUCallbackFunction in_callback_function, uint32_t in_callback_param)
 {
-	l_imu_i2c.CallbackFunction = in_callback_function;
+	l_callback_function = in_callback_function;
+	l_callback_param = in_callback_param;
+	l_imu_i2c.CallbackFunction = drvIMUTransferFinished;
 
 	drvI2CMasterStartWriteAndReadBlock(&l_imu_i2c, in_address, in_write_buffer, in_write_buffer_length, in_read_buffer, in_read_buffer_length);
 }
 
-void drvIMUStartWriteAndWriteBlock(uint8_t in_address, uint8_t* in_buffer1, uint8_t in_buffer1_length, uint8_t* in_buffer2, uint8_t in_buffer2_length, drvIMUCallbackFunction in_callback_function)
+void drvIMUStartWriteAndWriteBlock(uint8_t in_address, uint8_t* in_buffer1, uint8_t in_buffer1_length, uint8_t* in_buffer2, uint8_t in_buffer2_length, drvIMUCallbackFunction in_callback_function, uint32_t in_callback_param)
 {
-	l_imu_i2c.CallbackFunction = in_callback_function;
+	l_callback_function = in_callback_function;
+	l_callback_param = in_callback_param;
+	l_imu_i2c.CallbackFunction = drvIMUTransferFinished;
 
 	drvI2CMasterStartWriteAndWriteBlock(&l_imu_i2c, in_address, in_buffer1, in_buffer1_length, in_buffer2, in_buffer2_length);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+/// @brief I2C transfer finished interrupt handler, passes the parameter of the transfer to the callback
+static void drvIMUTransferFinished(bool in_success, void* in_interrupt_param)
+{
+	if (l_callback_function != sysNULL)
+		l_callback_function(in_success, l_callback_param, in_interrupt_param);
+}
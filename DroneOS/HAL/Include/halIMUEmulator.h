@@ -0,0 +1,60 @@
+/*****************************************************************************/
+/* Emulated IMU sensor bus                                                   */
+/*                                                                           */
+/* Copyright (C) 2017 Laszlo Arvai                                           */
+/* All rights reserved.                                                      */
+/*                                                                           */
+/* This software may be modified and distributed under the terms             */
+/* of the GNU General Public License.  See the LICENSE file for details.     */
+/*****************************************************************************/
+
+#ifndef __halIMUEmulator_h
+#define __halIMUEmulator_h
+
+/*****************************************************************************/
+/* Includes                                                                  */
+/*****************************************************************************/
+#include <sysTypes.h>
+#include <halIODefinitions.h>
+
+/*****************************************************************************/
+/* Constants                                                                 */
+/*****************************************************************************/
+
+// emulated barometer (both sensors use the same address): 0 - MS5611, 1 - BMP085
+#ifndef halIMUEmulator_BMP085
+#define halIMUEmulator_BMP085 0
+#endif
+
+/*****************************************************************************/
+/* Types                                                                     */
+/*****************************************************************************/
+
+/// Emulated bus and sensor statistics
+typedef struct
+{
+	uint32_t TransactionCount;					// number of bus transactions
+	uint32_t ByteCount;									// number of transferred bytes (including address bytes)
+	uint32_t NackCount;									// number of transactions addressing non-existing devices
+	uint32_t CollisionCount;						// number of transactions started while the bus was busy
+	uint32_t BusyTime;									// total bus busy time [us]
+	uint32_t ElapsedTime;								// time since the start of the emulation [us]
+	uint32_t MPU6050SampleCount;				// number of samples generated by the emulated MPU6050
+	uint32_t MPU6050FIFOOverflowCount;	// number of samples written into the full FIFO of the emulated MPU6050
+	uint32_t MS5611PressureConversionCount;			// number of pressure conversions of the emulated MS5611
+	uint32_t MS5611TemperatureConversionCount;	// number of temperature conversions of the emulated MS5611
+	uint32_t MS5611InvalidReadCount;						// number of ADC reads returning zero (conversion not finished or not started)
+	uint32_t MS5611CommandErrorCount;						// number of commands ignored because of a running conversion
+	uint32_t BMP085PressureConversionCount;			// number of pressure conversions of the emulated BMP085
+	uint32_t BMP085TemperatureConversionCount;	// number of temperature conversions of the emulated BMP085
+	uint32_t BMP085InvalidReadCount;						// number of output register reads during conversion
+	uint32_t BMP085CommandErrorCount;						// number of invalid or ignored (because of a running conversion) commands
+} halIMUEmulatorStatistics;
+
+/*****************************************************************************/
+/* Function prototypes                                                       */
+/*****************************************************************************/
+void halIMUEmulatorTaskStop(void);
+void halIMUEmulatorGetStatistics(halIMUEmulatorStatistics* out_statistics);
+
+#endif
@@ -14,16 +14,19 @@
 /* Includes                                                                  */
 /*****************************************************************************/
 #include <sysTypes.h>
+#include <sysHighresTimer.h>
 
 /*****************************************************************************/
 /* Types                                                                     */
 /*****************************************************************************/
 typedef void(*drvUARTRxReceivedCallback)(uint8_t in_byte, void* in_interrupt_param);
+typedef void(*drvUARTRxBlockReceivedCallback)(uint8_t* in_buffer, uint16_t in_buffer_length, sysHighresTimestamp in_timestamp, void* in_interrupt_param);
 typedef void(*drvUARTTxEmptyCallback)(void* in_interrupt_param);
 
 typedef struct
 {
 	drvUARTRxReceivedCallback RxReceivedCallback;
+	drvUARTRxBlockReceivedCallback RxBlockReceivedCallback; // optional, used instead of RxReceivedCallback by the HALs supporting block reception
 	drvUARTTxEmptyCallback TxEmptyCallback;
 
 } halUARTConfigInfo;
@@ -38,4 +41,7 @@ void halUARTConfigInfoInit(halUARTConfigInfo* in_config_info);
 bool halUARTSetBaudRate(uint8_t in_uart_index, uint32_t in_baud_rate);
 bool halUARTSendBlock(uint8_t in_uart_index, uint8_t* in_buffer, uint16_t in_buffer_length);
 
+// Linux HAL only
+void halUARTSetDeviceName(uint8_t in_uart_index, char* in_device_name);
+
 #endif
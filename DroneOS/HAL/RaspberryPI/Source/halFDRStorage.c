@@ -0,0 +1,65 @@
+/*****************************************************************************/
+/* Flight data recorder log storage (Linux implementation using file)        */
+/*                                                                           */
+/* Copyright (C) 2017 Laszlo Arvai                                           */
+/* All rights reserved.                                                      */
+/*                                                                           */
+/* This software may be modified and distributed under the terms             */
+/* of the GNU General Public License.  See the LICENSE file for details.     */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/* Includes                                                                  */
+/*****************************************************************************/
+#include <drvFDRStorage.h>
+#include <stdio.h>
+
+/*****************************************************************************/
+/* Module global variable                                                    */
+/*****************************************************************************/
+static FILE* l_log_file = NULL;
+
+/*****************************************************************************/
+/* Function implementation                                                   */
+/*****************************************************************************/
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Creates new log file (existing file is overwritten)
+/// @param in_name Name of the log file
+/// @return True if log file is created
+bool drvFDRStorageOpen(const char* in_name)
+{
+	l_log_file = fopen(in_name, "wb");
+
+	return l_log_file != NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Appends block to the log file
+/// @param in_buffer Buffer containing data to write
+/// @param in_length Number of bytes to write
+/// @return True if block was written
+bool drvFDRStorageWrite(uint8_t* in_buffer, uint16_t in_length)
+{
+	if (l_log_file == NULL)
+		return false;
+
+	if (fwrite(in_buffer, sizeof(uint8_t), in_length, l_log_file) != in_length)
+		return false;
+
+	// keep the file up to date in case of crash
+	fflush(l_log_file);
+
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Closes log file
+void drvFDRStorageClose(void)
+{
+	if (l_log_file != NULL)
+	{
+		fclose(l_log_file);
+		l_log_file = NULL;
+	}
+}
@@ -12,19 +12,65 @@
 /* Includes                                                                  */
 /*****************************************************************************/
 #include <sysRTOS.h>
+#include <halIODefinitions.h>
 #include <sys/time.h>
+#include <time.h>
 #include <signal.h>
 #include <pthread.h>
+#include <sched.h>
 #include <unistd.h>
 #include <stdio.h>
 #include <stdarg.h>
+#include <string.h>
 #include <errno.h>
+#include <limits.h>
 #include <sys/resource.h> 
+#include <sys/syscall.h>
 
 /*****************************************************************************/
 /* Constants                                                                 */
 /*****************************************************************************/
 #define sysTASK_STOP_FUNCTION_COUNT 128
+#define sysTASK_MAX_COUNT 32
+
+// task scheduling (real-time priority = base + sysRTOS priority, nice value = -sysRTOS priority when real-time is not permitted)
+#ifndef halTASK_SCHEDULING_POLICY
+#define halTASK_SCHEDULING_POLICY SCHED_RR
+#endif
+
+#ifndef halTASK_REALTIME_PRIORITY_BASE
+#define halTASK_REALTIME_PRIORITY_BASE 10
+#endif
+
+// task stack size in bytes (stack size of the task create function is in words, reserve is added for the C library)
+#ifndef halTASK_DEFAULT_STACK_SIZE
+#define halTASK_DEFAULT_STACK_SIZE (256 * 1024)
+#endif
+
+#ifndef halTASK_STACK_RESERVE
+#define halTASK_STACK_RESERVE (64 * 1024)
+#endif
+
+/*****************************************************************************/
+/* Types                                                                     */
+/*****************************************************************************/
+
+/// Task start information
+typedef struct
+{
+	sysTaskFunction TaskFunction;
+	void* Parameters;
+	const char* Name;
+	uint8_t Priority;
+	size_t StackSize;
+} sysLinuxTaskInfo;
+
+/// CPU affinity configuration of a task
+typedef struct
+{
+	const char* Name;
+	uint32_t CPUMask;
+} sysLinuxTaskAffinity;
 
 /*****************************************************************************/
 /* Module global variables                                                   */
@@ -34,12 +80,22 @@ static sysTaskStopFunction l_task_stop_functions[sysTASK_STOP_FUNCTION_COUNT];
 static uint8_t l_task_stop_function_count = 0;
 static struct timeval l_prev_user_time;
 static struct timeval l_prev_system_time;
+static sysLinuxTaskInfo l_task_info[sysTASK_MAX_COUNT];
+static uint8_t l_task_info_count = 0;
+static bool l_priority_fallback_reported = false;
+
+#ifdef halTASK_CPU_AFFINITY_INIT
+static const sysLinuxTaskAffinity l_task_affinity[] = halTASK_CPU_AFFINITY_INIT;
+#endif
 
 
 /*****************************************************************************/
 /* Local function declaration                                                */
 /*****************************************************************************/
 static void halUser1SignalHandler(int in_signum);
+static void sysMillisecToTimespec(clockid_t in_clock, uint32_t in_ms, struct timespec *out_ts);
+static void* sysLinuxTaskStart(void* in_task_info);
+static void sysLinuxTaskSetScheduling(sysLinuxTaskInfo* in_task_info);
 
 
 /*****************************************************************************/
@@ -80,17 +136,67 @@ void sysCriticalSectionEnd(void)
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-/// @brief Creates task under Win32
+/// @brief Creates task under Linux
+/// @param in_task_code Task function
+/// @param in_task_name Name of the task
+/// @param in_stack_size Stack size in words (sysDEFAULT_STACK_SIZE for the default size)
+/// @param in_parameters Task function parameter
+/// @param in_priority Task priority (higher value means higher priority)
+/// @param out_thread_handle Receives handle of the created thread
+/// @param in_stop_function Function called at system shutdown to stop the task
+/// @return Zero when task was created or error code
 uint32_t sysLinuxTaskCreate(sysTaskFunction in_task_code, const char* const in_task_name, uint16_t in_stack_size, void *in_parameters, uint8_t in_priority, sysTask* out_thread_handle, sysTaskStopFunction in_stop_function)
 {
-	sysUNUSED(in_task_name);
-	sysUNUSED(in_priority); // TODO: implement priority
+	pthread_attr_t attributes;
+	sysLinuxTaskInfo* task_info = sysNULL;
+	size_t stack_size;
+	size_t page_size;
+	long sysconf_value;
+	int retval;
+
+	// allocate task info
+	sysCriticalSectionBegin();
+	if (l_task_info_count < sysTASK_MAX_COUNT)
+		task_info = &l_task_info[l_task_info_count++];
+	sysCriticalSectionEnd();
+
+	if (task_info == sysNULL)
+		return EAGAIN;
+
+	// determine stack size
+	if (in_stack_size == sysDEFAULT_STACK_SIZE)
+		stack_size = halTASK_DEFAULT_STACK_SIZE;
+	else
+		stack_size = in_stack_size * sizeof(uint32_t) + halTASK_STACK_RESERVE;
+
+	if (stack_size < (size_t)PTHREAD_STACK_MIN)
+		stack_size = (size_t)PTHREAD_STACK_MIN;
+
+	// round up to page size
+	sysconf_value = sysconf(_SC_PAGESIZE);
+	if (sysconf_value > 0)
+	{
+		page_size = (size_t)sysconf_value;
+		stack_size = (stack_size + page_size - 1) / page_size * page_size;
+	}
+
+	task_info->TaskFunction = in_task_code;
+	task_info->Parameters = in_parameters;
+	task_info->Name = in_task_name;
+	task_info->Priority = in_priority;
+	task_info->StackSize = stack_size;
 
 	sysAddThreadStopFunction(in_stop_function);
-	
-	pthread_create(out_thread_handle, NULL, in_task_code, in_parameters);
 
-	return 0;
+	// create thread
+	pthread_attr_init(&attributes);
+	pthread_attr_setstacksize(&attributes, stack_size);
+
+	retval = pthread_create(out_thread_handle, &attributes, sysLinuxTaskStart, task_info);
+
+	pthread_attr_destroy(&attributes);
+
+	return retval;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -165,15 +271,16 @@ uint8_t sysGetCPUUsage(void)
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-/// @brief Gets system timer current value in ms (current timestamp)
+/// @brief Gets system timer current value in ms (current timestamp). Timer is based on the monotonic clock,
+/// it is not affected by wall clock (NTP, RTC) adjustments.
 /// @return System timer value in ms
 sysTick sysGetSystemTick(void)
 {
-	struct timeval te; 
+	struct timespec ts;
 	sysTick milliseconds;
 	
-	gettimeofday(&te, NULL); // get current time
-	milliseconds = te.tv_sec * 1000LL + te.tv_usec / 1000; // caculate milliseconds
+	clock_gettime(CLOCK_MONOTONIC, &ts); // get current time
+	milliseconds = (sysTick)(ts.tv_sec * 1000LL + ts.tv_nsec / 1000000); // caculate milliseconds
 
 	return milliseconds;
 }	
@@ -187,13 +294,22 @@ void sysDelay(uint32_t in_delay_in_ms)
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-/// @brief Converts millisec to timespec struct
+/// @brief Converts timeout in millisec to absolute timespec (deadline) of the given clock
+/// @param in_clock Clock used for the deadline calculation
 /// @param in_ms time in millisec to convert
 /// @param out_ts timespec to receive the converted time
-static void sysMillisecToTimespec(unsigned long in_ms, struct timespec *out_ts)
+static void sysMillisecToTimespec(clockid_t in_clock, uint32_t in_ms, struct timespec *out_ts)
 {
-	out_ts->tv_sec = in_ms / 1000;
-	out_ts->tv_nsec = (in_ms % 1000) * 1000000;
+	clock_gettime(in_clock, out_ts);
+
+	out_ts->tv_sec += in_ms / 1000;
+	out_ts->tv_nsec += (in_ms % 1000) * 1000000;
+
+	if (out_ts->tv_nsec >= 1000000000)
+	{
+		out_ts->tv_sec++;
+		out_ts->tv_nsec -= 1000000000;
+	}
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -205,14 +321,18 @@ bool pthread_mutex_take(pthread_mutex_t* in_mutex, uint32_t in_timeout)
 {
 	struct timespec tv;
 	
-	// convert itmeout from ms to timespec
-	sysMillisecToTimespec(in_timeout, &tv);
-	
 	// lock mutex
 	if (in_timeout == sysINFINITE_TIMEOUT)
-		return pthread_mutex_lock(in_mutex);
+	{
+		return pthread_mutex_lock(in_mutex) == 0;
+	}
 	else
+	{
+		// convert itmeout from ms to timespec (mutex timeout is always based on the realtime clock)
+		sysMillisecToTimespec(CLOCK_REALTIME, in_timeout, &tv);
+
 		return pthread_mutex_timedlock(in_mutex, &tv) == 0;
+	}
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -221,8 +341,16 @@ bool pthread_mutex_take(pthread_mutex_t* in_mutex, uint32_t in_timeout)
 /// @param in_init_value Init value (0 or 1)
 void pthread_binsem_init(pthread_binsem_t* in_binary_semaphore, int in_init_value)
 {
+	pthread_condattr_t cond_attributes;
+
+	// use monotonic clock for timeouts
+	pthread_condattr_init(&cond_attributes);
+	pthread_condattr_setclock(&cond_attributes, CLOCK_MONOTONIC);
+
 	pthread_mutex_init(&in_binary_semaphore->mutex, NULL);
-	pthread_cond_init(&in_binary_semaphore->cvar, NULL);
+	pthread_cond_init(&in_binary_semaphore->cvar, &cond_attributes);
+
+	pthread_condattr_destroy(&cond_attributes);
 	
 	in_binary_semaphore->v = in_init_value;
 }
@@ -240,40 +368,35 @@ void pthread_binsem_destroy(pthread_binsem_t* in_binary_semaphore)
 /// @brief Acquires lock on the given binary semaphore
 /// @param in_binary_semapahore Semaphore to lock
 /// @param in_timeout TImeout until the lockmust be acquired otherwise timeout will be occured
-void pthread_binsem_lock(pthread_binsem_t* in_binary_semaphore, uint32_t in_timeout)
+/// @return True if semaphore was acquired, false when timeout occured
+bool pthread_binsem_lock(pthread_binsem_t* in_binary_semaphore, uint32_t in_timeout)
 {
 	struct timespec tv;
 	int retval = 0;
+	bool success;
 	
 	// convert itmeout from ms to timespec
-	sysMillisecToTimespec(in_timeout, &tv);
+	if (in_timeout != sysINFINITE_TIMEOUT)
+		sysMillisecToTimespec(CLOCK_MONOTONIC, in_timeout, &tv);
 
 	pthread_mutex_lock(&in_binary_semaphore->mutex);
 	
+	// wait for the semaphore (handles spurious wakeups)
 	while (in_binary_semaphore->v == 0 && retval == 0)
 	{
 		if (in_timeout == sysINFINITE_TIMEOUT)
-		{
-			pthread_cond_wait(&in_binary_semaphore->cvar, &in_binary_semaphore->mutex);
-			in_binary_semaphore->v = 0;
-		}
+			retval = pthread_cond_wait(&in_binary_semaphore->cvar, &in_binary_semaphore->mutex);
 		else
-		{
 			retval = pthread_cond_timedwait(&in_binary_semaphore->cvar, &in_binary_semaphore->mutex, &tv);
-			switch (retval)
-			{
-				case ETIMEDOUT:
-					break;
-					
-				default:
-					in_binary_semaphore->v = 0;
-					break;
-			}
-				break;
-		}
 	}
+
+	// take semaphore
+	success = (in_binary_semaphore->v != 0);
+	in_binary_semaphore->v = 0;
 	
 	pthread_mutex_unlock(&in_binary_semaphore->mutex);
+
+	return success;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -303,6 +426,108 @@ void sysDebugPrint(const char *fmt, ...)
 	fprintf(stderr, "%s", str);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Thread entry function, sets up scheduling of the task and executes task function
+/// @param in_task_info Pointer to the task information struct
+static void* sysLinuxTaskStart(void* in_task_info)
+{
+	sysLinuxTaskInfo* task_info = (sysLinuxTaskInfo*)in_task_info;
+	char thread_name[16];
+
+	// set thread name (max. 15 characters)
+	if (task_info->Name != sysNULL)
+	{
+		snprintf(thread_name, sizeof(thread_name), "%s", task_info->Name);
+		pthread_setname_np(pthread_self(), thread_name);
+	}
+
+	sysLinuxTaskSetScheduling(task_info);
+
+	return task_info->TaskFunction(task_info->Parameters);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Sets scheduling policy, priority and CPU affinity of the calling thread and reports the effective settings
+/// @param in_task_info Pointer to the task information struct
+static void sysLinuxTaskSetScheduling(sysLinuxTaskInfo* in_task_info)
+{
+	struct sched_param param;
+	int policy;
+	int priority;
+	int nice_value;
+	pid_t thread_id = (pid_t)syscall(SYS_gettid);
+	uint32_t cpu_mask = 0;
+	cpu_set_t cpu_set;
+	uint8_t i;
+
+	// try to set real-time priority
+	priority = sched_get_priority_min(halTASK_SCHEDULING_POLICY) + halTASK_REALTIME_PRIORITY_BASE + in_task_info->Priority;
+	if (priority > sched_get_priority_max(halTASK_SCHEDULING_POLICY))
+		priority = sched_get_priority_max(halTASK_SCHEDULING_POLICY);
+
+	param.sched_priority = priority;
+	if (pthread_setschedparam(pthread_self(), halTASK_SCHEDULING_POLICY, &param) != 0)
+	{
+		// real-time scheduling is not permitted -> fallback to nice value (when negative nice values are not permitted either, the default nice value is used)
+		if (setpriority(PRIO_PROCESS, thread_id, -(int)in_task_info->Priority) != 0)
+		{
+			setpriority(PRIO_PROCESS, thread_id, 0);
+
+			// report only once (all tasks fail the same way)
+			sysCriticalSectionBegin();
+			if (!l_priority_fallback_reported)
+			{
+				l_priority_fallback_reported = true;
+				sysDebugPrint("Real-time scheduling and negative nice values are not permitted, tasks run with nice 0\n");
+			}
+			sysCriticalSectionEnd();
+		}
+	}
+
+#ifdef halTASK_CPU_AFFINITY_INIT
+	// set CPU affinity
+	for (i = 0; i < sizeof(l_task_affinity) / sizeof(l_task_affinity[0]); i++)
+	{
+		if (in_task_info->Name != sysNULL && strcmp(l_task_affinity[i].Name, in_task_info->Name) == 0)
+		{
+			cpu_mask = l_task_affinity[i].CPUMask;
+			break;
+		}
+	}
+
+	if (cpu_mask != 0)
+	{
+		CPU_ZERO(&cpu_set);
+		for (i = 0; i < 32; i++)
+		{
+			if ((cpu_mask & (1ul << i)) != 0)
+				CPU_SET(i, &cpu_set);
+		}
+
+		if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) != 0)
+			cpu_mask = 0;
+	}
+#else
+	sysUNUSED(cpu_set);
+	sysUNUSED(i);
+#endif
+
+	// report effective settings
+	pthread_getschedparam(pthread_self(), &policy, &param);
+	errno = 0;
+	nice_value = getpriority(PRIO_PROCESS, thread_id);
+	if (errno != 0)
+		nice_value = 0;
+
+	sysDebugPrint("Task '%s': policy %s, priority %d, nice %d, stack %u bytes, CPU mask 0x%x\n",
+		(in_task_info->Name != sysNULL) ? in_task_info->Name : "",
+		(policy == SCHED_FIFO) ? "SCHED_FIFO" : ((policy == SCHED_RR) ? "SCHED_RR" : "SCHED_OTHER"),
+		param.sched_priority,
+		nice_value,
+		(unsigned int)in_task_info->StackSize,
+		(unsigned int)cpu_mask);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 /// @brief Empty signal handler
 static void halUser1SignalHandler(int in_signum)
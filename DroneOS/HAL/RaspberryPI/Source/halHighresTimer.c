@@ -0,0 +1,138 @@
+/*****************************************************************************/
+/* High resolution (1us resolution) timer driver (Linux)                     */
+/*                                                                           */
+/* Copyright (C) 2016 Laszlo Arvai                                           */
+/* All rights reserved.                                                      */
+/*                                                                           */
+/* This software may be modified and distributed under the terms             */
+/* of the GNU General Public License.  See the LICENSE file for details.     */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/* Includes                                                                  */
+/*****************************************************************************/
+#include <time.h>
+#include <sysRTOS.h>
+#include <sysHighresTimer.h>
+
+/*****************************************************************************/
+/* Constants                                                                 */
+/*****************************************************************************/
+
+// timer task emulates the timer interrupt, it preempts all other tasks
+#define halHIGHRES_TIMER_TASK_PRIORITY 6
+
+/*****************************************************************************/
+/* Module global variables                                                   */
+/*****************************************************************************/
+static volatile sysHighresTimerCallbackFunction l_callback = sysNULL;
+static volatile sysHighresTimestamp l_expiration_time;
+static volatile bool l_task_running = false;
+static bool l_stop_task;
+static sysTaskNotify l_task_event;
+
+/*****************************************************************************/
+/* Local function prototypes                                                 */
+/*****************************************************************************/
+static sysTaskRetval halHighresTimerTask(sysTaskParam in_param);
+static void halHighresTimerTaskStop(void);
+
+/*****************************************************************************/
+/* Function implementation                                                   */
+/*****************************************************************************/
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Initializes high resolution timer
+void halHighresTimerInit(void)
+{
+	sysTask task_handle;
+
+	// monotonic clock doesn't require initialization, only the timer task is started (once)
+	if (l_task_running)
+		return;
+
+	l_callback = sysNULL;
+	l_stop_task = false;
+	l_task_running = true;
+
+	sysTaskNotifyCreate(l_task_event);
+	sysTaskCreate(halHighresTimerTask, "halHighresTimer", sysDEFAULT_STACK_SIZE, sysNULL, halHIGHRES_TIMER_TASK_PRIORITY, &task_handle, halHighresTimerTaskStop);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Gets high resolution time timestamp (based on the monotonic clock)
+sysHighresTimestamp sysHighresTimerGetTimestamp(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (sysHighresTimestamp)(ts.tv_sec * 1000000LL + ts.tv_nsec / 1000);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Starts one shot timer. Only one callback can be pending, the previous one is replaced.
+/// @param in_expiration_time Timestamp when the callback is called (it must be less than 2^31us ahead)
+/// @param in_callback Callback function
+void sysHighresTimerStartCallback(sysHighresTimestamp in_expiration_time, sysHighresTimerCallbackFunction in_callback)
+{
+	l_expiration_time = in_expiration_time;
+	sysMemoryBarrier();
+	l_callback = in_callback;
+
+	sysTaskNotifyGive(l_task_event);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Cancels pending timer callback
+void sysHighresTimerStopCallback(void)
+{
+	l_callback = sysNULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Stops timer task
+static void halHighresTimerTaskStop(void)
+{
+	l_stop_task = true;
+	sysTaskNotifyGive(l_task_event);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Timer task: sleeps until the expiration time and calls the callback function
+static sysTaskRetval halHighresTimerTask(sysTaskParam in_param)
+{
+	sysHighresTimerCallbackFunction callback;
+	int32_t remaining_time;
+	struct timespec sleep_time;
+
+	sysUNUSED(in_param);
+
+	while (!l_stop_task)
+	{
+		sysTaskNotifyTake(l_task_event, sysINFINITE_TIMEOUT);
+
+		while (!l_stop_task && l_callback != sysNULL)
+		{
+			remaining_time = (int32_t)(l_expiration_time - sysHighresTimerGetTimestamp());
+			if (remaining_time > 0)
+			{
+				sleep_time.tv_sec = remaining_time / 1000000;
+				sleep_time.tv_nsec = (remaining_time % 1000000) * 1000;
+				clock_nanosleep(CLOCK_MONOTONIC, 0, &sleep_time, NULL);
+				continue;
+			}
+
+			// the callback is cleared before the call (it can restart the timer)
+			callback = l_callback;
+			l_callback = sysNULL;
+
+			if (callback != sysNULL)
+				callback(sysNULL);
+		}
+	}
+
+	l_task_running = false;
+
+	return (sysTaskRetval)0;
+}
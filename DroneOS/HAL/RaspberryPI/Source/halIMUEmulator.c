@@ -0,0 +1,988 @@
+/*****************************************************************************/
+/* Emulated IMU sensor bus (Linux)                                           */
+/*                                                                           */
+/* Copyright (C) 2017 Laszlo Arvai                                           */
+/* All rights reserved.                                                      */
+/*                                                                           */
+/* This software may be modified and distributed under the terms             */
+/* of the GNU General Public License.  See the LICENSE file for details.     */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/* Includes                                                                  */
+/*****************************************************************************/
+#include <sysRTOS.h>
+#include <sysHighresTimer.h>
+#include <halIODefinitions.h>
+#include <halIMUEmulator.h>
+#include <drvIMU.h>
+
+/*****************************************************************************/
+/* Constants                                                                 */
+/*****************************************************************************/
+#define halIMUEmulator_TASK_PRIORITY 5
+
+// emulated I2C bus clock frequency [Hz]
+#ifndef halIMUEmulator_I2C_CLOCK_FREQUENCY
+#define halIMUEmulator_I2C_CLOCK_FREQUENCY 400000
+#endif
+
+// sample clock error of the emulated MPU6050 [ppm]
+#ifndef halIMUEmulator_MPU6050_CLOCK_ERROR
+#define halIMUEmulator_MPU6050_CLOCK_ERROR 2000
+#endif
+
+#define halIMUEmulator_I2C_BITS_PER_BYTE 9	// 8 data bits + ACK
+#define halIMUEmulator_MAX_WRITE_LENGTH 512
+
+// emulated MPU6050
+#define halMPU6050_I2C_ADDRESS 0x68
+#define halMPU6050_REGISTER_COUNT 128
+#define halMPU6050_FIFO_SIZE 1024
+#define halMPU6050_MAX_SAMPLE_BACKLOG 1000000000ull	// samples older than this are not generated [ns]
+
+#define halMPU6050_RA_YA_OFFS_L_TC	0x09
+#define halMPU6050_RA_SELF_TEST_X		0x0D
+#define halMPU6050_RA_SMPLRT_DIV		0x19
+#define halMPU6050_RA_CONFIG				0x1A
+#define halMPU6050_RA_GYRO_CONFIG		0x1B
+#define halMPU6050_RA_ACCEL_CONFIG	0x1C
+#define halMPU6050_RA_FIFO_EN				0x23
+#define halMPU6050_RA_INT_STATUS		0x3A
+#define halMPU6050_RA_ACCEL_XOUT_H	0x3B
+#define halMPU6050_RA_TEMP_OUT_H		0x41
+#define halMPU6050_RA_GYRO_XOUT_H		0x43
+#define halMPU6050_RA_GYRO_YOUT_H		0x45
+#define halMPU6050_RA_GYRO_ZOUT_H		0x47
+#define halMPU6050_RA_USER_CTRL			0x6A
+#define halMPU6050_RA_PWR_MGMT_1		0x6B
+#define halMPU6050_RA_FIFO_COUNTH		0x72
+#define halMPU6050_RA_FIFO_COUNTL		0x73
+#define halMPU6050_RA_FIFO_R_W			0x74
+#define halMPU6050_RA_WHO_AM_I			0x75
+
+#define halMPU6050_DATA_RDY_INT		(1<<0)
+#define halMPU6050_FIFO_OFLOW_INT	(1<<4)
+#define halMPU6050_UC_FIFO_RESET	(1<<2)
+#define halMPU6050_UC_FIFO_EN			(1<<6)
+#define halMPU6050_PM1_SLEEP			(1<<6)
+#define halMPU6050_PM1_RESET			(1<<7)
+#define halMPU6050_ACCEL_FIFO_EN	(1<<3)
+#define halMPU6050_ZG_FIFO_EN			(1<<4)
+#define halMPU6050_YG_FIFO_EN			(1<<5)
+#define halMPU6050_XG_FIFO_EN			(1<<6)
+#define halMPU6050_TEMP_FIFO_EN		(1<<7)
+#define halMPU6050_ST_X						(1<<7)	// self test bits of the accelerometer and gyro configuration
+#define halMPU6050_ST_Y						(1<<6)
+#define halMPU6050_ST_Z						(1<<5)
+
+// factory trim code 16 for all axes (XA_TEST[4:2] and XG_TEST fields, XA_TEST[1:0] is zero) and the belonging self test responses
+#define halMPU6050_SELF_TEST_TRIM				0x90
+#define halMPU6050_ACCEL_SELF_TEST_RESPONSE	559		// [mg]
+#define halMPU6050_GYRO_SELF_TEST_RESPONSE	6430	// at +-250 deg/s range [LSB], negative on the Y axis
+
+// emulated MS5611
+#define halMS5611_I2C_ADDRESS 0x77
+#define halMS5611_PROM_WORD_COUNT 8
+#define halMS5611_RESET_TIME 2800				// PROM reload time after reset [us]
+
+#define halMS5611_CMD_ADC_READ		0x00
+#define halMS5611_CMD_RESET				0x1E
+#define halMS5611_CMD_CONVERT_D1	0x40
+#define halMS5611_CMD_CONVERT_D2	0x50
+#define halMS5611_CMD_PROM_READ		0xA0
+
+#define halMS5611_CMD_TYPE_MASK		0xF0
+#define halMS5611_CMD_OSR_MASK		0x0F
+
+// digital pressure and temperature values of the datasheet example (2007 = 20.07 degC, 100009 Pa)
+#define halMS5611_D1 9085466ul
+#define halMS5611_D2 8569150ul
+
+// emulated BMP085
+#define halBMP085_I2C_ADDRESS 0x77
+#define halBMP085_CALIBRATION_WORD_COUNT 11
+#define halBMP085_TEMPERATURE_CONVERSION_TIME 3000	// typical temperature conversion time [us]
+
+#define halBMP085_RA_CALIBRATION	0xAA
+#define halBMP085_RA_CHIP_ID			0xD0
+#define halBMP085_RA_VERSION			0xD1
+#define halBMP085_RA_SOFT_RESET		0xE0
+#define halBMP085_RA_CTRL_MEAS		0xF4
+#define halBMP085_RA_OUT_MSB			0xF6
+#define halBMP085_RA_OUT_LSB			0xF7
+#define halBMP085_RA_OUT_XLSB			0xF8
+
+#define halBMP085_CHIP_ID					0x55
+#define halBMP085_VERSION					0x02
+#define halBMP085_SOFT_RESET			0xB6
+#define halBMP085_CMD_TEMPERATURE	0x2E
+#define halBMP085_CMD_PRESSURE		0x34
+#define halBMP085_CTRL_SCO				(1<<5)
+#define halBMP085_CTRL_OSS_SHIFT	6
+
+// uncompensated temperature and pressure (oss=0) of the datasheet example (150 = 15.0 degC, 69964 Pa)
+#define halBMP085_UT 27898ul
+#define halBMP085_UP 23843ul
+
+/*****************************************************************************/
+/* Types                                                                     */
+/*****************************************************************************/
+
+typedef void (*halIMUEmulatorDeviceWrite)(uint8_t* in_buffer, uint16_t in_length);
+typedef void (*halIMUEmulatorDeviceRead)(uint8_t* out_buffer, uint16_t in_length);
+
+/// Emulated device description
+typedef struct
+{
+	uint8_t Address;
+	halIMUEmulatorDeviceWrite Write;
+	halIMUEmulatorDeviceRead Read;
+} halIMUEmulatorDeviceInfo;
+
+/*****************************************************************************/
+/* Local function prototypes                                                 */
+/*****************************************************************************/
+static sysTaskRetval halIMUEmulatorTask(sysTaskParam in_param);
+static void halIMUEmulatorStartTransaction(uint8_t in_address, uint8_t* in_write_buffer1, uint8_t in_write_buffer1_length, uint8_t* in_write_buffer2, uint8_t in_write_buffer2_length, uint8_t* in_read_buffer, uint8_t in_read_buffer_length, drvIMUCallbackFunction in_callback_function, uint32_t in_callback_param);
+static void halMPU6050Reset(void);
+static void halMPU6050Update(void);
+static void halMPU6050GenerateSample(void);
+static void halMPU6050AddToRegister(uint8_t in_register_address, int16_t in_value);
+static void halMPU6050WriteFIFO(uint8_t in_register_address, uint8_t in_length);
+static void halMPU6050Write(uint8_t* in_buffer, uint16_t in_length);
+static void halMPU6050Read(uint8_t* out_buffer, uint16_t in_length);
+#if !halIMUEmulator_BMP085
+static void halMS5611Reset(void);
+static void halMS5611Write(uint8_t* in_buffer, uint16_t in_length);
+static void halMS5611Read(uint8_t* out_buffer, uint16_t in_length);
+#else
+static void halBMP085Reset(void);
+static void halBMP085Update(void);
+static void halBMP085Write(uint8_t* in_buffer, uint16_t in_length);
+static void halBMP085Read(uint8_t* out_buffer, uint16_t in_length);
+#endif
+
+/*****************************************************************************/
+/* Module global variables                                                   */
+/*****************************************************************************/
+static bool l_stop_task = false;
+static sysTaskNotify l_task_event;
+static sysHighresTimestamp l_start_timestamp;
+static halIMUEmulatorStatistics l_statistics;
+
+// emulated devices
+static halIMUEmulatorDeviceInfo l_devices[] =
+{
+	{ halMPU6050_I2C_ADDRESS, halMPU6050Write, halMPU6050Read },
+#if halIMUEmulator_BMP085
+	{ halBMP085_I2C_ADDRESS, halBMP085Write, halBMP085Read },
+#else
+	{ halMS5611_I2C_ADDRESS, halMS5611Write, halMS5611Read },
+#endif
+
+	{ 0, sysNULL, sysNULL }
+};
+
+// pending transaction
+static volatile bool l_bus_busy = false;
+static uint8_t l_address;
+static uint8_t* l_write_buffer1;
+static uint8_t l_write_buffer1_length;
+static uint8_t* l_write_buffer2;
+static uint8_t l_write_buffer2_length;
+static uint8_t* l_read_buffer;
+static uint8_t l_read_buffer_length;
+static drvIMUCallbackFunction l_callback_function;
+static uint32_t l_callback_param;
+static uint8_t l_write_buffer[halIMUEmulator_MAX_WRITE_LENGTH];
+
+// emulated MPU6050
+static uint8_t l_mpu6050_registers[halMPU6050_REGISTER_COUNT];
+static uint8_t l_mpu6050_register_pointer;
+static uint8_t l_mpu6050_fifo[halMPU6050_FIFO_SIZE];
+static uint16_t l_mpu6050_fifo_read_pos;
+static uint16_t l_mpu6050_fifo_count;
+static sysHighresTimestamp l_mpu6050_update_timestamp;
+static uint64_t l_mpu6050_time;							// emulated time [ns]
+static uint64_t l_mpu6050_next_sample_time;	// time of the next sample [ns]
+static uint16_t l_mpu6050_sample_index;
+
+#if !halIMUEmulator_BMP085
+// emulated MS5611 (calibration coefficients of the datasheet example, CRC is in the lowest 4 bits of the last word)
+static const uint16_t l_ms5611_prom[halMS5611_PROM_WORD_COUNT] = { 0x1234, 40127, 36924, 23317, 23282, 33464, 28312, 0x0006 };
+static const uint16_t l_ms5611_conversion_time[] = { 540, 1060, 2080, 4130, 8220 };	// typical conversion time for OSR 256..4096 [us]
+static uint8_t l_ms5611_command;
+static bool l_ms5611_converting;
+static sysHighresTimestamp l_ms5611_conversion_timestamp;	// start of the conversion or reset
+static uint32_t l_ms5611_conversion_time_us;
+static uint32_t l_ms5611_conversion_value;
+static uint32_t l_ms5611_adc_value;												// result of the last conversion (0 - no result)
+#else
+// emulated BMP085 (calibration coefficients of the datasheet example)
+static const uint16_t l_bmp085_calibration[halBMP085_CALIBRATION_WORD_COUNT] = { 408, (uint16_t)-72, (uint16_t)-14383, 32741, 32757, 23153, 6190, 4, (uint16_t)-32768, (uint16_t)-8711, 2868 };
+static const uint16_t l_bmp085_conversion_time[] = { 3000, 5000, 9000, 17000 };	// typical pressure conversion time for oss 0..3 [us]
+static uint8_t l_bmp085_register_pointer;
+static uint8_t l_bmp085_ctrl_meas;
+static bool l_bmp085_converting;
+static sysHighresTimestamp l_bmp085_conversion_timestamp;
+static uint32_t l_bmp085_conversion_time_us;
+static uint32_t l_bmp085_conversion_value;
+static uint32_t l_bmp085_out_value;													// content of the output registers (MSB, LSB, XLSB)
+#endif
+
+/*****************************************************************************/
+/* Function implementation                                                   */
+/*****************************************************************************/
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Initializes emulated IMU bus and sensors
+void drvIMUInit(void)
+{
+	sysTask task_handle;
+
+	sysMemZero(&l_statistics, sizeof(l_statistics));
+	l_start_timestamp = sysHighresTimerGetTimestamp();
+
+	halMPU6050Reset();
+#if !halIMUEmulator_BMP085
+	halMS5611Reset();
+#else
+	halBMP085Reset();
+#endif
+
+	sysTaskNotifyCreate(l_task_event);
+	sysTaskCreate(halIMUEmulatorTask, "halIMUEmulator", sysDEFAULT_STACK_SIZE, sysNULL, halIMUEmulator_TASK_PRIORITY, &task_handle, halIMUEmulatorTaskStop);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Stops emulator task
+void halIMUEmulatorTaskStop(void)
+{
+	l_stop_task = true;
+	sysTaskNotifyGive(l_task_event);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Gets bus and sensor statistics
+/// @param out_statistics Statistics
+void halIMUEmulatorGetStatistics(halIMUEmulatorStatistics* out_statistics)
+{
+	*out_statistics = l_statistics;
+	out_statistics->ElapsedTime = sysHighresTimerGetTimeSince(l_start_timestamp);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Starts write and read transaction (register address write and register data read)
+/// @param in_address Device address
+/// @param in_write_buffer Data to write
+/// @param in_write_buffer_length Number of bytes to write
+/// @param in_read_buffer Buffer for the read data
+/// @param in_read_buffer_length Number of bytes to read
+/// @param in_callback_function Function to call when transaction finished
+/// @param in_callback_param Parameter passed to the callback function
+void drvIMUStartWriteAndReadBlock(uint8_t in_address, uint8_t* in_write_buffer, uint8_t in_write_buffer_length, uint8_t* in_read_buffer, uint8_t in_read_buffer_length, drvIMUCallbackFunction in_callback_function, uint32_t in_callback_param)
+{
+	halIMUEmulatorStartTransaction(in_address, in_write_buffer, in_write_buffer_length, sysNULL, 0, in_read_buffer, in_read_buffer_length, in_callback_function, in_callback_param);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Starts write transaction of two buffers (register address and register data)
+/// @param in_address Device address
+/// @param in_buffer1 First buffer to write
+/// @param in_buffer1_length Number of bytes in the first buffer
+/// @param in_buffer2 Second buffer to write
+/// @param in_buffer2_length Number of bytes in the second buffer
+/// @param in_callback_function Function to call when transaction finished
+/// @param in_callback_param Parameter passed to the callback function
+void drvIMUStartWriteAndWriteBlock(uint8_t in_address, uint8_t* in_buffer1, uint8_t in_buffer1_length, uint8_t* in_buffer2, uint8_t in_buffer2_length, drvIMUCallbackFunction in_callback_function, uint32_t in_callback_param)
+{
+	halIMUEmulatorStartTransaction(in_address, in_buffer1, in_buffer1_length, in_buffer2, in_buffer2_length, sysNULL, 0, in_callback_function, in_callback_param);
+}
+
+/*****************************************************************************/
+/* Emulated bus                                                              */
+/*****************************************************************************/
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Stores transaction and wakes up the bus task
+static void halIMUEmulatorStartTransaction(uint8_t in_address, uint8_t* in_write_buffer1, uint8_t in_write_buffer1_length, uint8_t* in_write_buffer2, uint8_t in_write_buffer2_length, uint8_t* in_read_buffer, uint8_t in_read_buffer_length, drvIMUCallbackFunction in_callback_function, uint32_t in_callback_param)
+{
+	// only one transaction can be active
+	if (l_bus_busy)
+	{
+		l_statistics.CollisionCount++;
+		in_callback_function(false, in_callback_param, sysNULL);
+		return;
+	}
+
+	l_address = in_address;
+	l_write_buffer1 = in_write_buffer1;
+	l_write_buffer1_length = in_write_buffer1_length;
+	l_write_buffer2 = in_write_buffer2;
+	l_write_buffer2_length = in_write_buffer2_length;
+	l_read_buffer = in_read_buffer;
+	l_read_buffer_length = in_read_buffer_length;
+	l_callback_function = in_callback_function;
+	l_callback_param = in_callback_param;
+
+	sysMemoryBarrier();
+	l_bus_busy = true;
+
+	sysTaskNotifyGive(l_task_event);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Bus task: executes transactions with the timing of the I2C bus
+static sysTaskRetval halIMUEmulatorTask(sysTaskParam in_param)
+{
+	uint8_t device_index;
+	uint16_t byte_count;
+	uint32_t transfer_time;
+	bool success;
+	drvIMUCallbackFunction callback_function;
+	uint32_t callback_param;
+
+	sysUNUSED(in_param);
+
+	while (!l_stop_task)
+	{
+		sysTaskNotifyTake(l_task_event, sysINFINITE_TIMEOUT);
+
+		if (!l_bus_busy)
+			continue;
+
+		// find device
+		device_index = 0;
+		while (l_devices[device_index].Write != sysNULL && l_devices[device_index].Address != l_address)
+			device_index++;
+
+		success = (l_devices[device_index].Write != sysNULL);
+
+		// calculate transferred bytes (the transaction ends at the address byte when it is not acknowledged)
+		if (success)
+		{
+			byte_count = 1 + l_write_buffer1_length + l_write_buffer2_length;
+			if (l_read_buffer_length > 0)
+				byte_count += 1 + l_read_buffer_length;
+		}
+		else
+		{
+			byte_count = 1;
+			l_statistics.NackCount++;
+		}
+
+		// wait for the transfer time (data bytes + start, (repeated start) and stop conditions)
+		transfer_time = (uint32_t)(((uint64_t)(byte_count * halIMUEmulator_I2C_BITS_PER_BYTE + 3) * 1000000ul) / halIMUEmulator_I2C_CLOCK_FREQUENCY);
+		sysHighresTimerDelay(transfer_time);
+
+		// execute transaction
+		if (success)
+		{
+			if (l_write_buffer2_length > 0 && l_write_buffer1_length + l_write_buffer2_length <= halIMUEmulator_MAX_WRITE_LENGTH)
+			{
+				sysMemCopy(l_write_buffer, l_write_buffer1, l_write_buffer1_length);
+				sysMemCopy(&l_write_buffer[l_write_buffer1_length], l_write_buffer2, l_write_buffer2_length);
+				l_devices[device_index].Write(l_write_buffer, l_write_buffer1_length + l_write_buffer2_length);
+			}
+			else
+			{
+				l_devices[device_index].Write(l_write_buffer1, l_write_buffer1_length);
+			}
+
+			if (l_read_buffer_length > 0)
+				l_devices[device_index].Read(l_read_buffer, l_read_buffer_length);
+		}
+
+		// update statistics
+		l_statistics.TransactionCount++;
+		l_statistics.ByteCount += byte_count;
+		l_statistics.BusyTime += transfer_time;
+
+		// finish transaction
+		callback_function = l_callback_function;
+		callback_param = l_callback_param;
+		sysMemoryBarrier();
+		l_bus_busy = false;
+
+		callback_function(success, callback_param, sysNULL);
+	}
+
+	return (sysTaskRetval)0;
+}
+
+/*****************************************************************************/
+/* Emulated MPU6050                                                          */
+/*****************************************************************************/
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Resets emulated MPU6050 registers
+static void halMPU6050Reset(void)
+{
+	sysMemZero(l_mpu6050_registers, sizeof(l_mpu6050_registers));
+
+	l_mpu6050_registers[halMPU6050_RA_WHO_AM_I] = halMPU6050_I2C_ADDRESS;
+	l_mpu6050_registers[halMPU6050_RA_YA_OFFS_L_TC] = 0x01; // revision 2 (full resolution accelerometer)
+	l_mpu6050_registers[halMPU6050_RA_PWR_MGMT_1] = halMPU6050_PM1_SLEEP;
+	l_mpu6050_registers[halMPU6050_RA_SELF_TEST_X] = halMPU6050_SELF_TEST_TRIM;
+	l_mpu6050_registers[halMPU6050_RA_SELF_TEST_X + 1] = halMPU6050_SELF_TEST_TRIM;
+	l_mpu6050_registers[halMPU6050_RA_SELF_TEST_X + 2] = halMPU6050_SELF_TEST_TRIM;
+
+	l_mpu6050_register_pointer = 0;
+	l_mpu6050_fifo_read_pos = 0;
+	l_mpu6050_fifo_count = 0;
+	l_mpu6050_update_timestamp = sysHighresTimerGetTimestamp();
+	l_mpu6050_time = 0;
+	l_mpu6050_next_sample_time = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Generates samples according to the time ellapsed since the last update
+static void halMPU6050Update(void)
+{
+	sysHighresTimestamp timestamp;
+	uint32_t gyro_rate;
+	uint64_t sample_period;
+
+	// update emulated time
+	timestamp = sysHighresTimerGetTimestamp();
+	l_mpu6050_time += (uint64_t)(timestamp - l_mpu6050_update_timestamp) * 1000;
+	l_mpu6050_update_timestamp = timestamp;
+
+	// no sampling in sleep mode
+	if ((l_mpu6050_registers[halMPU6050_RA_PWR_MGMT_1] & halMPU6050_PM1_SLEEP) != 0)
+	{
+		l_mpu6050_next_sample_time = l_mpu6050_time;
+		return;
+	}
+
+	// sample period (gyro output rate is 8kHz when the digital low pass filter is disabled)
+	gyro_rate = ((l_mpu6050_registers[halMPU6050_RA_CONFIG] & 0x07) == 0 || (l_mpu6050_registers[halMPU6050_RA_CONFIG] & 0x07) == 7) ? 8000 : 1000;
+	sample_period = 1000000000ull * (l_mpu6050_registers[halMPU6050_RA_SMPLRT_DIV] + 1) / gyro_rate;
+	sample_period = sample_period * (1000000 + halIMUEmulator_MPU6050_CLOCK_ERROR) / 1000000;
+
+	// skip samples when the emulation was not updated for a long time
+	if (l_mpu6050_time > l_mpu6050_next_sample_time + halMPU6050_MAX_SAMPLE_BACKLOG)
+		l_mpu6050_next_sample_time = l_mpu6050_time - halMPU6050_MAX_SAMPLE_BACKLOG;
+
+	// generate samples
+	while (l_mpu6050_next_sample_time <= l_mpu6050_time)
+	{
+		halMPU6050GenerateSample();
+		l_mpu6050_next_sample_time += sample_period;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Generates one sample. The device is at rest (1g on the Z axis), gyro X contains the
+/// sample counter in order to make lost or duplicated samples detectable.
+static void halMPU6050GenerateSample(void)
+{
+	uint16_t acceleration_1g;
+	uint8_t accel_config;
+	uint8_t gyro_config;
+	int16_t self_test_response;
+
+	acceleration_1g = 16384 >> ((l_mpu6050_registers[halMPU6050_RA_ACCEL_CONFIG] >> 3) & 0x03);
+
+	sysMemZero(&l_mpu6050_registers[halMPU6050_RA_ACCEL_XOUT_H], halMPU6050_RA_GYRO_ZOUT_H + 2 - halMPU6050_RA_ACCEL_XOUT_H);
+	l_mpu6050_registers[halMPU6050_RA_ACCEL_XOUT_H + 4] = (uint8_t)(acceleration_1g >> 8);
+	l_mpu6050_registers[halMPU6050_RA_ACCEL_XOUT_H + 5] = (uint8_t)acceleration_1g;
+	l_mpu6050_registers[halMPU6050_RA_GYRO_XOUT_H] = (uint8_t)(l_mpu6050_sample_index >> 8);
+	l_mpu6050_registers[halMPU6050_RA_GYRO_XOUT_H + 1] = (uint8_t)l_mpu6050_sample_index;
+
+	// self test response
+	accel_config = l_mpu6050_registers[halMPU6050_RA_ACCEL_CONFIG];
+	self_test_response = (int16_t)((int32_t)acceleration_1g * halMPU6050_ACCEL_SELF_TEST_RESPONSE / 1000);
+	if ((accel_config & halMPU6050_ST_X) != 0)
+		halMPU6050AddToRegister(halMPU6050_RA_ACCEL_XOUT_H, self_test_response);
+	if ((accel_config & halMPU6050_ST_Y) != 0)
+		halMPU6050AddToRegister(halMPU6050_RA_ACCEL_XOUT_H + 2, self_test_response);
+	if ((accel_config & halMPU6050_ST_Z) != 0)
+		halMPU6050AddToRegister(halMPU6050_RA_ACCEL_XOUT_H + 4, self_test_response);
+
+	gyro_config = l_mpu6050_registers[halMPU6050_RA_GYRO_CONFIG];
+	self_test_response = halMPU6050_GYRO_SELF_TEST_RESPONSE >> ((gyro_config >> 3) & 0x03);
+	if ((gyro_config & halMPU6050_ST_X) != 0)
+		halMPU6050AddToRegister(halMPU6050_RA_GYRO_XOUT_H, self_test_response);
+	if ((gyro_config & halMPU6050_ST_Y) != 0)
+		halMPU6050AddToRegister(halMPU6050_RA_GYRO_YOUT_H, -self_test_response);
+	if ((gyro_config & halMPU6050_ST_Z) != 0)
+		halMPU6050AddToRegister(halMPU6050_RA_GYRO_ZOUT_H, self_test_response);
+
+	l_mpu6050_registers[halMPU6050_RA_INT_STATUS] |= halMPU6050_DATA_RDY_INT;
+
+	// store sample in the FIFO (in register order)
+	if ((l_mpu6050_registers[halMPU6050_RA_USER_CTRL] & halMPU6050_UC_FIFO_EN) != 0)
+	{
+		if ((l_mpu6050_registers[halMPU6050_RA_FIFO_EN] & halMPU6050_ACCEL_FIFO_EN) != 0)
+			halMPU6050WriteFIFO(halMPU6050_RA_ACCEL_XOUT_H, 6);
+
+		if ((l_mpu6050_registers[halMPU6050_RA_FIFO_EN] & halMPU6050_TEMP_FIFO_EN) != 0)
+			halMPU6050WriteFIFO(halMPU6050_RA_TEMP_OUT_H, 2);
+
+		if ((l_mpu6050_registers[halMPU6050_RA_FIFO_EN] & halMPU6050_XG_FIFO_EN) != 0)
+			halMPU6050WriteFIFO(halMPU6050_RA_GYRO_XOUT_H, 2);
+
+		if ((l_mpu6050_registers[halMPU6050_RA_FIFO_EN] & halMPU6050_YG_FIFO_EN) != 0)
+			halMPU6050WriteFIFO(halMPU6050_RA_GYRO_YOUT_H, 2);
+
+		if ((l_mpu6050_registers[halMPU6050_RA_FIFO_EN] & halMPU6050_ZG_FIFO_EN) != 0)
+			halMPU6050WriteFIFO(halMPU6050_RA_GYRO_ZOUT_H, 2);
+	}
+
+	l_mpu6050_sample_index++;
+	l_statistics.MPU6050SampleCount++;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Adds value to a 16 bit (big endian) sensor output register
+/// @param in_register_address Address of the high byte
+/// @param in_value Value to add
+static void halMPU6050AddToRegister(uint8_t in_register_address, int16_t in_value)
+{
+	uint16_t value;
+
+	value = ((uint16_t)l_mpu6050_registers[in_register_address] << 8) | l_mpu6050_registers[in_register_address + 1];
+	value += (uint16_t)in_value;
+
+	l_mpu6050_registers[in_register_address] = (uint8_t)(value >> 8);
+	l_mpu6050_registers[in_register_address + 1] = (uint8_t)value;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Stores register content in the FIFO (oldest data is overwritten when the FIFO is full)
+/// @param in_register_address First register to store
+/// @param in_length Number of registers to store
+static void halMPU6050WriteFIFO(uint8_t in_register_address, uint8_t in_length)
+{
+	bool overflow = false;
+
+	while (in_length > 0)
+	{
+		if (l_mpu6050_fifo_count >= halMPU6050_FIFO_SIZE)
+		{
+			l_mpu6050_fifo_read_pos = (l_mpu6050_fifo_read_pos + 1) % halMPU6050_FIFO_SIZE;
+			l_mpu6050_fifo_count--;
+			overflow = true;
+		}
+
+		l_mpu6050_fifo[(l_mpu6050_fifo_read_pos + l_mpu6050_fifo_count) % halMPU6050_FIFO_SIZE] = l_mpu6050_registers[in_register_address++];
+		l_mpu6050_fifo_count++;
+		in_length--;
+	}
+
+	if (overflow)
+	{
+		l_mpu6050_registers[halMPU6050_RA_INT_STATUS] |= halMPU6050_FIFO_OFLOW_INT;
+		l_statistics.MPU6050FIFOOverflowCount++;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Handles I2C write (first byte is the register address, the rest is written into the registers)
+static void halMPU6050Write(uint8_t* in_buffer, uint16_t in_length)
+{
+	uint8_t value;
+
+	if (in_length == 0)
+		return;
+
+	halMPU6050Update();
+
+	l_mpu6050_register_pointer = in_buffer[0] % halMPU6050_REGISTER_COUNT;
+	in_buffer++;
+	in_length--;
+
+	while (in_length > 0)
+	{
+		value = *in_buffer;
+
+		switch (l_mpu6050_register_pointer)
+		{
+			case halMPU6050_RA_PWR_MGMT_1:
+				if ((value & halMPU6050_PM1_RESET) != 0)
+					halMPU6050Reset();
+				else
+					l_mpu6050_registers[halMPU6050_RA_PWR_MGMT_1] = value;
+				break;
+
+			case halMPU6050_RA_USER_CTRL:
+				if ((value & halMPU6050_UC_FIFO_RESET) != 0)
+				{
+					l_mpu6050_fifo_read_pos = 0;
+					l_mpu6050_fifo_count = 0;
+				}
+				l_mpu6050_registers[halMPU6050_RA_USER_CTRL] = value & ~halMPU6050_UC_FIFO_RESET;
+				break;
+
+			case halMPU6050_RA_WHO_AM_I:
+			case halMPU6050_RA_INT_STATUS:
+			case halMPU6050_RA_FIFO_COUNTH:
+			case halMPU6050_RA_FIFO_COUNTL:
+			case halMPU6050_RA_FIFO_R_W:
+				// read only or not emulated
+				break;
+
+			default:
+				l_mpu6050_registers[l_mpu6050_register_pointer] = value;
+				break;
+		}
+
+		if (l_mpu6050_register_pointer != halMPU6050_RA_FIFO_R_W)
+			l_mpu6050_register_pointer = (l_mpu6050_register_pointer + 1) % halMPU6050_REGISTER_COUNT;
+
+		in_buffer++;
+		in_length--;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Handles I2C read (reads registers from the current register address)
+static void halMPU6050Read(uint8_t* out_buffer, uint16_t in_length)
+{
+	uint16_t fifo_count;
+
+	halMPU6050Update();
+
+	// FIFO count is latched at the beginning of the read
+	fifo_count = l_mpu6050_fifo_count;
+
+	while (in_length > 0)
+	{
+		switch (l_mpu6050_register_pointer)
+		{
+			case halMPU6050_RA_FIFO_COUNTH:
+				*out_buffer = (uint8_t)(fifo_count >> 8);
+				break;
+
+			case halMPU6050_RA_FIFO_COUNTL:
+				*out_buffer = (uint8_t)fifo_count;
+				break;
+
+			case halMPU6050_RA_FIFO_R_W:
+				if (l_mpu6050_fifo_count > 0)
+				{
+					*out_buffer = l_mpu6050_fifo[l_mpu6050_fifo_read_pos];
+					l_mpu6050_fifo_read_pos = (l_mpu6050_fifo_read_pos + 1) % halMPU6050_FIFO_SIZE;
+					l_mpu6050_fifo_count--;
+				}
+				else
+				{
+					*out_buffer = 0;
+				}
+				break;
+
+			case halMPU6050_RA_INT_STATUS:
+				// interrupt status is cleared on read
+				*out_buffer = l_mpu6050_registers[halMPU6050_RA_INT_STATUS];
+				l_mpu6050_registers[halMPU6050_RA_INT_STATUS] = 0;
+				break;
+
+			default:
+				*out_buffer = l_mpu6050_registers[l_mpu6050_register_pointer];
+				break;
+		}
+
+		if (l_mpu6050_register_pointer != halMPU6050_RA_FIFO_R_W)
+			l_mpu6050_register_pointer = (l_mpu6050_register_pointer + 1) % halMPU6050_REGISTER_COUNT;
+
+		out_buffer++;
+		in_length--;
+	}
+}
+
+#if !halIMUEmulator_BMP085
+
+/*****************************************************************************/
+/* Emulated MS5611                                                           */
+/*****************************************************************************/
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Resets emulated MS5611 (PROM is reloaded, it behaves as a running conversion)
+static void halMS5611Reset(void)
+{
+	l_ms5611_command = halMS5611_CMD_RESET;
+	l_ms5611_converting = true;
+	l_ms5611_conversion_timestamp = sysHighresTimerGetTimestamp();
+	l_ms5611_conversion_time_us = halMS5611_RESET_TIME;
+	l_ms5611_conversion_value = 0;
+	l_ms5611_adc_value = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Handles I2C write (the first byte is the command, the rest is ignored)
+static void halMS5611Write(uint8_t* in_buffer, uint16_t in_length)
+{
+	uint8_t command;
+	uint8_t osr_index;
+
+	if (in_length == 0)
+		return;
+
+	command = in_buffer[0];
+
+	// conversion is finished
+	if (l_ms5611_converting && sysHighresTimerGetTimeSince(l_ms5611_conversion_timestamp) >= l_ms5611_conversion_time_us)
+	{
+		l_ms5611_converting = false;
+		l_ms5611_adc_value = l_ms5611_conversion_value;
+	}
+
+	switch (command & halMS5611_CMD_TYPE_MASK)
+	{
+		case halMS5611_CMD_CONVERT_D1:
+		case halMS5611_CMD_CONVERT_D2:
+			osr_index = (command & halMS5611_CMD_OSR_MASK) >> 1;
+
+			// command is ignored during conversion or with invalid oversampling ratio
+			if (l_ms5611_converting || (command & 1) != 0 || osr_index >= sizeof(l_ms5611_conversion_time) / sizeof(l_ms5611_conversion_time[0]))
+			{
+				l_statistics.MS5611CommandErrorCount++;
+				return;
+			}
+
+			l_ms5611_converting = true;
+			l_ms5611_conversion_timestamp = sysHighresTimerGetTimestamp();
+			l_ms5611_conversion_time_us = l_ms5611_conversion_time[osr_index];
+			l_ms5611_conversion_value = ((command & halMS5611_CMD_TYPE_MASK) == halMS5611_CMD_CONVERT_D1) ? halMS5611_D1 : halMS5611_D2;
+			l_ms5611_adc_value = 0;
+
+			if ((command & halMS5611_CMD_TYPE_MASK) == halMS5611_CMD_CONVERT_D1)
+				l_statistics.MS5611PressureConversionCount++;
+			else
+				l_statistics.MS5611TemperatureConversionCount++;
+			break;
+
+		default:
+			if (command == halMS5611_CMD_RESET)
+				halMS5611Reset();
+			else
+				l_ms5611_command = command;
+			break;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Handles I2C read (ADC result or PROM word selected by the last command)
+static void halMS5611Read(uint8_t* out_buffer, uint16_t in_length)
+{
+	uint32_t value = 0;
+	uint16_t length;
+
+	if (l_ms5611_command == halMS5611_CMD_ADC_READ)
+	{
+		// reading during the conversion returns zero and corrupts the result
+		if (l_ms5611_converting && sysHighresTimerGetTimeSince(l_ms5611_conversion_timestamp) < l_ms5611_conversion_time_us)
+		{
+			l_ms5611_conversion_value = 0;
+		}
+		else
+		{
+			if (l_ms5611_converting)
+			{
+				l_ms5611_converting = false;
+				l_ms5611_adc_value = l_ms5611_conversion_value;
+			}
+
+			// result can be read only once
+			value = l_ms5611_adc_value;
+			l_ms5611_adc_value = 0;
+		}
+
+		if (value == 0)
+			l_statistics.MS5611InvalidReadCount++;
+
+		length = 3;
+	}
+	else
+	{
+		if ((l_ms5611_command & halMS5611_CMD_TYPE_MASK) == halMS5611_CMD_PROM_READ)
+			value = l_ms5611_prom[(l_ms5611_command >> 1) & (halMS5611_PROM_WORD_COUNT - 1)];
+
+		length = 2;
+	}
+
+	// big endian, bytes after the value are read as zero
+	while (in_length > 0)
+	{
+		if (length > 0)
+		{
+			length--;
+			*out_buffer = (uint8_t)(value >> (8 * length));
+		}
+		else
+		{
+			*out_buffer = 0;
+		}
+
+		out_buffer++;
+		in_length--;
+	}
+}
+
+#else
+
+/*****************************************************************************/
+/* Emulated BMP085                                                           */
+/*****************************************************************************/
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Resets emulated BMP085
+static void halBMP085Reset(void)
+{
+	l_bmp085_register_pointer = 0;
+	l_bmp085_ctrl_meas = 0;
+	l_bmp085_converting = false;
+	l_bmp085_conversion_value = 0;
+	l_bmp085_out_value = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Updates output registers when the running conversion is finished
+static void halBMP085Update(void)
+{
+	if (l_bmp085_converting && sysHighresTimerGetTimeSince(l_bmp085_conversion_timestamp) >= l_bmp085_conversion_time_us)
+	{
+		l_bmp085_converting = false;
+		l_bmp085_ctrl_meas &= ~halBMP085_CTRL_SCO;
+		l_bmp085_out_value = l_bmp085_conversion_value;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Handles I2C write (the first byte is the register address, only the control register is writable)
+static void halBMP085Write(uint8_t* in_buffer, uint16_t in_length)
+{
+	uint8_t oss;
+
+	if (in_length == 0)
+		return;
+
+	halBMP085Update();
+
+	l_bmp085_register_pointer = in_buffer[0];
+	in_buffer++;
+	in_length--;
+
+	while (in_length > 0)
+	{
+		switch (l_bmp085_register_pointer)
+		{
+			case halBMP085_RA_SOFT_RESET:
+				if (*in_buffer == halBMP085_SOFT_RESET)
+					halBMP085Reset();
+				break;
+
+			case halBMP085_RA_CTRL_MEAS:
+				// command is ignored during conversion
+				if (l_bmp085_converting)
+				{
+					l_statistics.BMP085CommandErrorCount++;
+					break;
+				}
+
+				l_bmp085_ctrl_meas = *in_buffer | halBMP085_CTRL_SCO;
+				oss = *in_buffer >> halBMP085_CTRL_OSS_SHIFT;
+
+				if (*in_buffer == halBMP085_CMD_TEMPERATURE)
+				{
+					// 16 bit temperature result in the MSB and LSB registers
+					l_bmp085_converting = true;
+					l_bmp085_conversion_time_us = halBMP085_TEMPERATURE_CONVERSION_TIME;
+					l_bmp085_conversion_value = halBMP085_UT << 8;
+					l_statistics.BMP085TemperatureConversionCount++;
+				}
+				else
+				{
+					if ((*in_buffer & ~(3 << halBMP085_CTRL_OSS_SHIFT)) == halBMP085_CMD_PRESSURE)
+					{
+						// the same pressure at every oversampling setting: (UP << oss) is left aligned to 19 bits
+						l_bmp085_converting = true;
+						l_bmp085_conversion_time_us = l_bmp085_conversion_time[oss];
+						l_bmp085_conversion_value = halBMP085_UP << 8;
+						l_statistics.BMP085PressureConversionCount++;
+					}
+					else
+					{
+						l_bmp085_ctrl_meas = *in_buffer;
+						l_statistics.BMP085CommandErrorCount++;
+					}
+				}
+
+				l_bmp085_conversion_timestamp = sysHighresTimerGetTimestamp();
+				break;
+		}
+
+		l_bmp085_register_pointer++;
+		in_buffer++;
+		in_length--;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Handles I2C read (registers are read from the register pointer with auto increment)
+static void halBMP085Read(uint8_t* out_buffer, uint16_t in_length)
+{
+	uint8_t address;
+	uint8_t value;
+
+	halBMP085Update();
+
+	// output registers keep the previous result during the conversion
+	address = l_bmp085_register_pointer;
+	if (l_bmp085_converting && address <= halBMP085_RA_OUT_XLSB && address + in_length > halBMP085_RA_OUT_MSB)
+		l_statistics.BMP085InvalidReadCount++;
+
+	while (in_length > 0)
+	{
+		if (address >= halBMP085_RA_CALIBRATION && address < halBMP085_RA_CALIBRATION + 2 * halBMP085_CALIBRATION_WORD_COUNT)
+		{
+			// big endian words
+			value = (uint8_t)(l_bmp085_calibration[(address - halBMP085_RA_CALIBRATION) / 2] >> (((address - halBMP085_RA_CALIBRATION) & 1) ? 0 : 8));
+		}
+		else
+		{
+			switch (address)
+			{
+				case halBMP085_RA_CHIP_ID:
+					value = halBMP085_CHIP_ID;
+					break;
+
+				case halBMP085_RA_VERSION:
+					value = halBMP085_VERSION;
+					break;
+
+				case halBMP085_RA_CTRL_MEAS:
+					value = l_bmp085_ctrl_meas;
+					break;
+
+				case halBMP085_RA_OUT_MSB:
+					value = (uint8_t)(l_bmp085_out_value >> 16);
+					break;
+
+				case halBMP085_RA_OUT_LSB:
+					value = (uint8_t)(l_bmp085_out_value >> 8);
+					break;
+
+				case halBMP085_RA_OUT_XLSB:
+					value = (uint8_t)l_bmp085_out_value;
+					break;
+
+				default:
+					value = 0;
+					break;
+			}
+		}
+
+		*out_buffer = value;
+
+		address++;
+		out_buffer++;
+		in_length--;
+	}
+
+	l_bmp085_register_pointer = address;
+}
+
+#endif
@@ -13,9 +13,13 @@
 #include <stdio.h>
 #include <unistd.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <termios.h>
 #include <unistd.h>
+#include <poll.h>
 #include <sysRTOS.h>
+#include <fdrReplay.h>
 #include <sysInitialize.h>
 #include <halHelpers.h>
 
@@ -48,27 +52,124 @@ int mygetch(void)
 
 ///////////////////////////////////////////////////////////////////////////////
 /// @brief Linux console emulation main entry function
+/// Flight data is recorded (the log size is limited) using the following argument:
+///   -record <log file>
+/// Flight data log can be replayed using the following arguments:
+///   -replay <log file> [-speed <speed factor, 0 - maximum>] [-start <start time in sec>]
+/// Statistics are printed at exit and periodically using the following argument:
+///   -stats <print period in sec, 0 - only at exit>
+/// Checks and benchmarks are run (instead of starting the whole system) using the following arguments:
+///   -check <check name> (-mathcheck is the same as -check math)
 int main(int argc, char* argv[])
 {
+	int i;
+	char* replay_file = NULL;
+	char* record_file = NULL;
+	char* check_name = NULL;
+	bool check_passed;
+	uint16_t replay_speed = 1;
+	uint64_t replay_start_time = 0;
+	bool print_statistics = false;
+	int statistics_period = 0;
+	struct pollfd key_poll;
+
 	g_argc = argc;
 	g_argv = argv;
 
+	// process arguments
+	for (i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "-mathcheck") == 0)
+			check_name = "math";
+
+		// the rest of the arguments have a value
+		if (i >= argc - 1)
+			break;
+
+		if (strcmp(argv[i], "-replay") == 0)
+			replay_file = argv[++i];
+		else if (strcmp(argv[i], "-record") == 0)
+			record_file = argv[++i];
+		else if (strcmp(argv[i], "-check") == 0)
+			check_name = argv[++i];
+		else if (strcmp(argv[i], "-speed") == 0)
+			replay_speed = (uint16_t)atoi(argv[++i]);
+		else if (strcmp(argv[i], "-start") == 0)
+			replay_start_time = (uint64_t)(atof(argv[++i]) * 1000000.0);
+		else if (strcmp(argv[i], "-stats") == 0)
+		{
+			print_statistics = true;
+			statistics_period = atoi(argv[++i]);
+		}
+	}
+
+	// run check
+	if (check_name != NULL)
+	{
+		halInitialize();
+
+		check_passed = sysRunCheck(check_name);
+
+		sysShutdown();
+		halDeinitialize();
+
+		return (check_passed) ? 0 : 1;
+	}
+
 	// initialize system
 	halInitialize();
 	sysInitialize();
 	//sysCreateTasks();
 
 	printf("Cygnus system is initialized.\n");
+
+	// start recording
+	if (record_file != NULL)
+	{
+#ifdef fdrRECORDER_ENABLED
+		if (fdrRecorderStart(record_file))
+			printf("Recording flight data log: %s\n", record_file);
+		else
+			printf("Can't create flight data log: %s\n", record_file);
+#else
+		printf("Flight data recorder is not enabled\n");
+#endif
+	}
+
+	// start replay
+	if (replay_file != NULL)
+	{
+		if (fdrReplayStart(replay_file, replay_start_time, replay_speed))
+			printf("Replaying flight data log: %s\n", replay_file);
+		else
+			printf("Can't open flight data log: %s\n", replay_file);
+	}
+
 	printf("  (Press ESC to exit)\n");
 
 	//while (mygetch() != 27)
 	//{
 	//	
 	//}
+
+	// print statistics periodically until a key is pressed
+	if (statistics_period > 0)
+	{
+		key_poll.fd = STDIN_FILENO;
+		key_poll.events = POLLIN;
+
+		while (poll(&key_poll, 1, statistics_period * 1000) == 0)
+			sysPrintStatistics();
+	}
+
 	getchar();
 	
 	// shutdown system
 	sysShutdown();
+
+	if (print_statistics)
+		sysPrintStatistics();
+
 	halDeinitialize();
 
 	return 0;
@@ -13,10 +13,12 @@
 /*****************************************************************************/
 #include <stdio.h>
 #include <fcntl.h>
-#include <signal.h>
+#include <errno.h>
+#include <poll.h>
 #include <pthread.h>
 #include <termios.h>
 #include <unistd.h>
+#include <sys/eventfd.h>
 #include <sysRTOS.h>
 #include <halUART.h>
 #include <halIODefinitions.h>
@@ -25,7 +27,7 @@
 /* Constants                                                                 */
 /*****************************************************************************/
 #define drvUART_RECEIVER_BUFFER_LENGTH 512
-
+#define drvUART_ERROR_RETRY_DELAY 100
 
 /*****************************************************************************/
 /* Types                                                                     */
@@ -39,6 +41,7 @@ typedef struct
 	pthread_t TransmitterThread;
 	halUARTConfigInfo Config;
 	sysTaskNotify TransmitNotification;
+	int StopEvent;
 } halUARTDriverInfo;
 
 /*****************************************************************************/
@@ -55,7 +58,7 @@ static void halUARTShutdown(void);
 static sysTaskRetval halReceiverThread(sysTaskParam in_param);
 static sysTaskRetval halTransmitterThread(sysTaskParam in_param);
 static bool halUARTInitOneUART(uint8_t in_uart_index);
-static void halUARTSignalHandler(int in_signum);
+static void halUARTProcessReceivedBlock(halUARTDriverInfo* in_uart_info, uint8_t* in_buffer, uint16_t in_buffer_length, sysHighresTimestamp in_timestamp);
 
 /*****************************************************************************/
 /* UART Functions                                                            */
@@ -104,7 +107,8 @@ static bool halUARTInitOneUART(uint8_t in_uart_index)
 	port_settings.c_cflag |= (CLOCAL | CREAD);				// enable the receiver and set local mode
 	port_settings.c_cflag &= ~(PARENB | CSTOPB);			// set no parity, stop bits, data bits
 	port_settings.c_cflag = (port_settings.c_cflag & ~CSIZE) | CS8; // set data length
-	port_settings.c_lflag &= ~(ICANON | ECHO | ISIG); // Raw input mode
+	port_settings.c_iflag &= ~(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL | IXON | IXOFF | IXANY); // no character translation and software flow control
+	port_settings.c_lflag &= ~(ICANON | ECHO | ISIG | IEXTEN); // Raw input mode
 	port_settings.c_oflag = ~OPOST;
 	
 	port_settings.c_cc[VMIN] = 1;											// read minimum one character
@@ -116,6 +120,10 @@ static bool halUARTInitOneUART(uint8_t in_uart_index)
 	if (success)
 	{
 		sysTaskNotifyCreate(uart_info->TransmitNotification);
+
+		uart_info->StopEvent = eventfd(0, EFD_NONBLOCK);
+		if (uart_info->StopEvent == -1)
+			success = false;
 	}
 
 	// create receiver  thread
@@ -132,13 +140,23 @@ static bool halUARTInitOneUART(uint8_t in_uart_index)
 	{
 		sysTaskCreate(halTransmitterThread, "halUARTTransmitterThread", sysDEFAULT_STACK_SIZE, uart_info, 2, &uart_info->TransmitterThread, halUARTShutdown);
 
-		if (uart_info->ReceiverThread == sysNULL)
+		if (uart_info->TransmitterThread == sysNULL)
 			success = false;
 	}
 
 	return success;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Changes the device name of the UART (must be called before halUARTInit)
+/// @param in_uart_index Index of the UART
+/// @param in_device_name Device name (e.g. USB serial adapter or pseudo terminal), must be valid until the UART is opened
+void halUARTSetDeviceName(uint8_t in_uart_index, char* in_device_name)
+{
+	if (in_uart_index < halUART_MAX_COUNT)
+		l_uart_names[in_uart_index] = in_device_name;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 /// @brief Changes UART configuration
 void halUARTConfig(uint8_t in_uart_index, halUARTConfigInfo* in_config_info)
@@ -346,119 +364,81 @@ bool halUARTSetBaudRate(uint8_t in_uart_index, uint32_t in_baud_rate)
 // UART Receiver Thread function
 static sysTaskRetval halReceiverThread(sysTaskParam in_param)
 {
-	fd_set read_set;
-	struct timeval timeout;
-	int select_result;
-	int recvpos;
-	int recvbytes;
+	struct pollfd poll_descriptors[2];
+	sysHighresTimestamp timestamp;
+	int poll_result;
+	int received_bytes;
+	int cancel_state;
 	uint8_t receiver_buffer[drvUART_RECEIVER_BUFFER_LENGTH];
 	halUARTDriverInfo* uart_info = (halUARTDriverInfo*)in_param;
 
-	FD_ZERO(&read_set);
-	FD_SET(uart_info->FileDescriptor, &read_set);
-	
+	// UART and stop event descriptors (returned events are cleared by every poll call)
+	poll_descriptors[0].fd = uart_info->FileDescriptor;
+	poll_descriptors[0].events = POLLIN;
+	poll_descriptors[1].fd = uart_info->StopEvent;
+	poll_descriptors[1].events = POLLIN;
+
+	// the thread can be cancelled only while it is waiting for data (see halUARTShutdown)
+	pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &cancel_state);
+
 	while (!l_task_stop)
 	{
-		// Wait up to five seconds
-		timeout.tv_sec = 20;
-		timeout.tv_usec = 0;
-		
-		// wait for character received
-		select_result = select(uart_info->FileDescriptor + 1, &read_set, NULL, NULL, &timeout);
-		if ( select_result > 0)
-		{
-			if (FD_ISSET(uart_info->FileDescriptor, &read_set))
-			{
-				recvbytes = read(uart_info->FileDescriptor, receiver_buffer, sizeof(receiver_buffer));
-				recvpos = 0;
-				if (uart_info->Config.RxReceivedCallback != sysNULL)
-				{
-					while (recvpos < recvbytes)
-					{
-						uart_info->Config.RxReceivedCallback(receiver_buffer[recvpos++], sysNULL);
-					}
-				}
-				FD_CLR(uart_info->FileDescriptor, &read_set);
-			}
-		}
-		else
+		// wait for character received or stop request
+		pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, &cancel_state);
+		poll_result = poll(poll_descriptors, 2, -1);
+		pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &cancel_state);
+
+		if (l_task_stop)
+			break;
+
+		if (poll_result <= 0)
+			continue;
+
+		if ((poll_descriptors[0].revents & (POLLIN | POLLERR | POLLHUP | POLLNVAL)) != 0)
 		{
-			if (select_result == 0)
+			timestamp = sysHighresTimerGetTimestamp();
+
+			// read all available data
+			do
 			{
-				
-				
-			}
-		}
-	}
-	
-#if 0
-  HANDLE handles[2];
-  DWORD event_mask = 0;
-  DWORD wait_res;
-  DWORD bytes_read;
-	BYTE buffer;
-	BOOL result;
-	
-	// registersignal handler
-	signal(SIGTERM, halUARTSignalHandler);
+				received_bytes = read(uart_info->FileDescriptor, receiver_buffer, sizeof(receiver_buffer));
 
-	while(!l_task_stop)
-	{
-    // start overlapped comm event watching
-		result = WaitCommEvent( uart_info->UARTHandle, &event_mask, &uart_info->Overlapped);
+				if (received_bytes > 0)
+					halUARTProcessReceivedBlock(uart_info, receiver_buffer, (uint16_t)received_bytes, timestamp);
 
-    // wait for eighter thread stop or communication event
-    wait_res = WaitForMultipleObjects(2, handles, FALSE, INFINITE);
+			} while (received_bytes == sizeof(receiver_buffer));
 
-		switch(wait_res)
-		{
-			// thread exit event
-			case WAIT_OBJECT_0:
-				// do nothing
-				break;
-
-			// character received event
-			case WAIT_OBJECT_0+1:
-				if (GetCommMask(uart_info->UARTHandle, &event_mask))
-				{
-					if ((event_mask & EV_RXCHAR) != 0)
-					{
-						// process received characters
-						do
-						{
-							// read pending character
-							ReadFile(uart_info->UARTHandle, &buffer, sizeof(buffer), &bytes_read, &uart_info->Overlapped);
-
-							// process character
-							if (bytes_read > 0 && uart_info->Config.RxReceivedCallback != sysNULL)
-								uart_info->Config.RxReceivedCallback(buffer, sysNULL);
-						} while (bytes_read > 0);
-					}
-
-					if ((event_mask & EV_TXEMPTY) != 0)
-					{
-						if (uart_info->Config.TxEmptyCallback != sysNULL)
-						{
-							uart_info->Config.TxEmptyCallback(sysNULL);
-						}
-					}
-				}
-				break;
+			// device error (e.g. disconnected), wait before the next try
+			if (received_bytes == 0 || (received_bytes < 0 && errno != EAGAIN && errno != EINTR))
+				poll(&poll_descriptors[1], 1, drvUART_ERROR_RETRY_DELAY);
 		}
-  }
-
-	// cleanup
-	uart_info->UARTThread = NULL;
+	}
 
-	CloseHandle(uart_info->UARTEvent);
-	uart_info->UARTEvent = NULL;
+	return 0;
+}
 
-	CloseHandle(uart_info->UARTHandle);
-	uart_info->UARTHandle = NULL;
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Passes received data to the configured callback function
+/// @param in_uart_info UART driver info
+/// @param in_buffer Received data
+/// @param in_buffer_length Number of bytes received
+/// @param in_timestamp Time when the data is received
+static void halUARTProcessReceivedBlock(halUARTDriverInfo* in_uart_info, uint8_t* in_buffer, uint16_t in_buffer_length, sysHighresTimestamp in_timestamp)
+{
+	uint16_t pos;
 
-  // exit thread
-  ExitThread( 0 );
-#endif
+	if (in_uart_info->Config.RxBlockReceivedCallback != sysNULL)
+	{
+		in_uart_info->Config.RxBlockReceivedCallback(in_buffer, in_buffer_length, in_timestamp, sysNULL);
+	}
+	else
+	{
+		if (in_uart_info->Config.RxReceivedCallback != sysNULL)
+		{
+			for (pos = 0; pos < in_buffer_length; pos++)
+				in_uart_info->Config.RxReceivedCallback(in_buffer[pos], sysNULL);
+		}
+	}
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -466,8 +446,9 @@ static sysTaskRetval halReceiverThread(sysTaskParam in_param)
 static void halUARTShutdown(void)
 {
 	int uart_index;
-	int thread_index;
 	void* retval;
+	uint64_t event_value = 1;
+	ssize_t write_result;
 	
 	l_task_stop = true;
 
@@ -477,8 +458,16 @@ static void halUARTShutdown(void)
 		if (l_uart_info[uart_index].ReceiverThread != sysNULL)
 		{
 			sysTaskNotifyGive(l_uart_info[uart_index].TransmitNotification);
-			pthread_kill(l_uart_info[uart_index].ReceiverThread, SIGUSR1);
-			pthread_kill(l_uart_info[uart_index].TransmitterThread, SIGUSR1);
+
+			// wake up receiver thread (EAGAIN means that the event counter is already set)
+			do
+			{
+				write_result = write(l_uart_info[uart_index].StopEvent, &event_value, sizeof(event_value));
+			} while (write_result < 0 && errno == EINTR);
+
+			// the receiver thread never wakes up without the stop event, cancel it in poll() to avoid blocking on join
+			if (write_result < 0 && errno != EAGAIN)
+				pthread_cancel(l_uart_info[uart_index].ReceiverThread);
 		}
 	}
 
@@ -492,7 +481,7 @@ static void halUARTShutdown(void)
 		
 		if (l_uart_info[uart_index].TransmitterThread != sysNULL)
 		{
-			pthread_join(l_uart_info[uart_index].ReceiverThread, &retval);			
+			pthread_join(l_uart_info[uart_index].TransmitterThread, &retval);			
 		}
 
 		l_uart_info[uart_index].ReceiverThread = sysNULL;
@@ -507,5 +496,11 @@ static void halUARTShutdown(void)
 			close(l_uart_info[uart_index].FileDescriptor);
 			l_uart_info[uart_index].FileDescriptor =  -1;
 		}
+
+		if (l_uart_info[uart_index].StopEvent > 0)
+		{
+			close(l_uart_info[uart_index].StopEvent);
+			l_uart_info[uart_index].StopEvent = -1;
+		}
 	}
 }
@@ -24,8 +24,13 @@
 #include <crcCITT16.h>
 #include <comUDP.h>
 #include <cfgStorage.h>
-#include <signal.h>
+#include <drvUDP.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
 #include "cfgConstants.h"
+#include "cfgValueLayout.h"
 //#include <string.h>
 //#include <arpa/inet.h>
 #if 0
@@ -40,6 +45,7 @@
 #include <comUDP.h>
 #include <cfgStorage.h>
 #include "cfgConstants.h"
+#include "cfgValueLayout.h"
 #endif
 
 /*****************************************************************************/
@@ -49,10 +55,25 @@
 #define drvUDP_RECEIVER_BUFFER_LENGTH 256
 #define drvUDP_TASK_MAX_CYCLE_TIME 50
 
-#define drvUDP_TRANSMITTER_BUFFER_RESEVED 0xffff
+#define drvUDP_RECEIVER_BATCH_COUNT 8
+
+#define drvUDP_EPOLL_EVENT_COUNT 2
 
 #define drvUDP_TASK_PRIORITY 2
 
+/*****************************************************************************/
+/* Types                                                                     */
+/*****************************************************************************/
+
+/// Transmitter slot (one datagram waiting for transmission)
+typedef struct
+{
+	uint8_t Buffer[drvUDP_TRANSMITTER_BUFFER_LENGTH];
+	uint16_t Length;
+	uint32_t DestinationAddress;
+	volatile drvUDPTransmitterSlotState State;
+} drvUDPTransmitterSlot;
+
 /*****************************************************************************/
 /* Module local variables                                                    */
 /*****************************************************************************/
@@ -61,47 +82,63 @@ static pthread_t l_udp_task;
 static volatile bool l_stop_task = false;
 static sysTick l_periodic_timestamp;
 static int l_socket = -1;
+static int l_epoll = -1;
+static int l_event = -1;
+static bool l_wait_for_writable = false;
+static volatile uint16_t l_remote_port; // remote port in network byte order (refreshed when configuration is changed)
 struct sockaddr_in l_socket_address;
 
 // receiver variables
-static uint8_t l_receive_buffer[drvUDP_RECEIVER_BUFFER_LENGTH];
-static uint16_t l_receive_buffer_length;
+static uint8_t l_receive_buffers[drvUDP_RECEIVER_BATCH_COUNT][drvUDP_RECEIVER_BUFFER_LENGTH];
+static struct iovec l_receive_iovecs[drvUDP_RECEIVER_BATCH_COUNT];
+static struct mmsghdr l_receive_messages[drvUDP_RECEIVER_BATCH_COUNT];
 
 // transmitter variables
-static uint8_t l_transmitter_buffer[drvUDP_RECEIVER_BUFFER_LENGTH];
-static volatile uint16_t l_transmitter_buffer_length;
-static uint32_t l_transmitter_destination_address;
-
-
-#if 0
-static WSAEVENT l_task_events[2];
-static WSANETWORKEVENTS l_events;
-static WSADATA l_wsa;
-static SOCKET l_socket = INVALID_SOCKET;
-struct sockaddr_in l_socket_address;
-
-
+static drvUDPTransmitterSlot l_transmitter_slots[drvUDP_TRANSMITTER_SLOT_COUNT];
+static uint8_t l_transmitter_push_index;
+static uint8_t l_transmitter_pop_index;
+static struct sockaddr_in l_transmit_addresses[drvUDP_TRANSMITTER_SLOT_COUNT];
+static struct iovec l_transmit_iovecs[drvUDP_TRANSMITTER_SLOT_COUNT];
+static struct mmsghdr l_transmit_messages[drvUDP_TRANSMITTER_SLOT_COUNT];
 
-#endif
 /*****************************************************************************/
 /* Local functions                                                           */
 /*****************************************************************************/
 static sysTaskRetval drvUDPTask(sysTaskParam in_param);
 static void drvUDPDeinit(void);
 static void drvUDPNotifyTask(void);
+static void drvUDPReceivePackets(void);
+static void drvUDPTransmitPackets(void);
+static void drvUDPSetWaitForWritable(bool in_wait);
+static void drvUDPReleaseTransmitterSlots(uint8_t in_slot_count);
+static void drvUDPConfigurationChanged(void);
 
 /*****************************************************************************/
 /* Functions implementation                                                  */
 /*****************************************************************************/
 
 ///////////////////////////////////////////////////////////////////////////////
-// @brief Initializes ethernet communication service on WIN32
+// @brief Initializes ethernet communication service on Linux
 void drvUDPInit(void)
 {
+	// notification event of the task
+	l_event = eventfd(0, EFD_NONBLOCK);
+
+	// cache configuration values
+	drvUDPConfigurationChanged();
+	cfgRegisterChangedCallback(drvUDPConfigurationChanged);
+
 	// initialize communication tasks
 	sysTaskCreate(drvUDPTask, "halUDP", sysDEFAULT_STACK_SIZE, sysNULL, drvUDP_TASK_PRIORITY, &l_udp_task, drvUDPDeinit);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Refreshes cached configuration values
+static void drvUDPConfigurationChanged(void)
+{
+	l_remote_port = htons((uint16_t)cfgGetValue(WIFI_REMOTE));
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // @brief Shots down ethernet communication service
 static void drvUDPDeinit(void)
@@ -111,18 +148,23 @@ static void drvUDPDeinit(void)
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-/// @brief Allocates and reserves transmitter buffer
+/// @brief Allocates and reserves transmitter buffer. Buffers are allocated from the transmitter slots in the
+/// order of the transmission, so more than one packet can be waiting for transmission.
 /// @return Transmitter data buffer address or sysNULL if transmitter is not available
 uint8_t* drvUDPAllocTransmitBuffer(void)
 {
+	drvUDPTransmitterSlot* slot;
 	uint8_t* buffer;
 
 	sysCriticalSectionBegin();
 
-	if (l_transmitter_buffer_length == 0)
+	slot = &l_transmitter_slots[l_transmitter_push_index];
+	if (slot->State == drvUDP_TSS_Free)
 	{
-		l_transmitter_buffer_length = drvUDP_TRANSMITTER_BUFFER_RESEVED;
-		buffer = l_transmitter_buffer;
+		slot->State = drvUDP_TSS_Reserved;
+		buffer = slot->Buffer;
+
+		l_transmitter_push_index = (l_transmitter_push_index + 1) % drvUDP_TRANSMITTER_SLOT_COUNT;
 	}
 	else
 	{
@@ -136,18 +178,41 @@ uint8_t* drvUDPAllocTransmitBuffer(void)
 
 ///////////////////////////////////////////////////////////////////////////////
 /// @brief Transmits data which is already placed in the transmitter buffer
+/// @param in_buffer Transmitter buffer returned by drvUDPAllocTransmitBuffer
 /// @param in_data_length Number of bytes to send
 /// @param in_destination_address IP address of the destination
-void drvUDPTransmitData(uint16_t in_data_length, uint32_t in_destination_address)
+void drvUDPTransmitData(uint8_t* in_buffer, uint16_t in_data_length, uint32_t in_destination_address)
 {
+	drvUDPTransmitterSlot* slot;
+	uint8_t slot_index;
+
+	// find slot of the buffer
+	slot_index = 0;
+	while (slot_index < drvUDP_TRANSMITTER_SLOT_COUNT && l_transmitter_slots[slot_index].Buffer != in_buffer)
+		slot_index++;
+
 	// sanity check
-	if (l_transmitter_buffer_length != drvUDP_TRANSMITTER_BUFFER_RESEVED)
+	if (slot_index >= drvUDP_TRANSMITTER_SLOT_COUNT)
 		return;
 
-	// notify thread about the transmission request
-	l_transmitter_destination_address = in_destination_address;
-	l_transmitter_buffer_length = in_data_length;
+	slot = &l_transmitter_slots[slot_index];
 
+	if (slot->State != drvUDP_TSS_Reserved)
+		return;
+
+	// invalid packets are released by the task without sending (zero length)
+	if (in_data_length > drvUDP_TRANSMITTER_BUFFER_LENGTH)
+		in_data_length = 0;
+
+	// queue slot for transmission
+	slot->Length = in_data_length;
+	slot->DestinationAddress = in_destination_address;
+
+	sysCriticalSectionBegin();
+	slot->State = drvUDP_TSS_ReadyToSend;
+	sysCriticalSectionEnd();
+
+	// notify thread about the transmission request
 	drvUDPNotifyTask();
 }
 
@@ -197,13 +262,14 @@ uint32_t drvUDPGetLocalIPAddress(void)
 static sysTaskRetval drvUDPTask(sysTaskParam in_param)
 {
 	sysTick ellapsed_time;
-	fd_set read_set, write_set;
-	struct timeval timeout;
-	int select_result;
+	struct epoll_event event;
+	struct epoll_event events[drvUDP_EPOLL_EVENT_COUNT];
+	int event_count;
+	int timeout;
+	int i;
 	int one = 1;
+	uint64_t event_value;
 	
-	//DWORD wait_result;
-
 	sysUNUSED(in_param);
 
 	l_socket = socket(AF_INET, SOCK_DGRAM, 0);
@@ -232,77 +298,76 @@ static sysTaskRetval drvUDPTask(sysTaskParam in_param)
 	// set socket options
 	fcntl(l_socket, F_SETFL, O_NONBLOCK);
 	setsockopt(l_socket, SOL_SOCKET, SO_BROADCAST, &one, sizeof(one));
+
+	// prepare receiver message headers
+	for (i = 0; i < drvUDP_RECEIVER_BATCH_COUNT; i++)
+	{
+		l_receive_iovecs[i].iov_base = l_receive_buffers[i];
+		l_receive_iovecs[i].iov_len = drvUDP_RECEIVER_BUFFER_LENGTH;
+
+		bzero(&l_receive_messages[i], sizeof(l_receive_messages[i]));
+		l_receive_messages[i].msg_hdr.msg_iov = &l_receive_iovecs[i];
+		l_receive_messages[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	// register socket and notification event
+	l_epoll = epoll_create1(0);
+	if (l_epoll < 0 || l_event < 0)
+	{
+		fprintf(stderr, "Communication: Error creating event handlers\n");
+		exit(-1);
+	}
+
+	bzero(&event, sizeof(event));
+	event.events = EPOLLIN;
+	event.data.fd = l_socket;
+	epoll_ctl(l_epoll, EPOLL_CTL_ADD, l_socket, &event);
+
+	event.events = EPOLLIN;
+	event.data.fd = l_event;
+	epoll_ctl(l_epoll, EPOLL_CTL_ADD, l_event, &event);
 	
 	// init
-	l_transmitter_buffer_length = 0;
 	l_periodic_timestamp = sysGetSystemTick();
-	
-	FD_ZERO(&read_set);
-	FD_SET(l_socket, &read_set);
-	
-	FD_ZERO(&write_set);
-	FD_CLR(l_socket, &write_set);
 
 	// task loop
 	while (!l_stop_task)
 	{
-		// Wait up to five seconds
-		timeout.tv_sec = 20;
-		timeout.tv_usec = 0;//10000;
-		
-		// wait for character received
-		select_result = select(l_socket + 1, &read_set, &write_set, NULL, &timeout);
-		if (select_result > 0)
-		{
-			if (FD_ISSET(l_socket, &read_set))
-			{
-				FD_CLR(l_socket, &read_set);
-
-				l_receive_buffer_length = recv(l_socket, l_receive_buffer, drvUDP_RECEIVER_BUFFER_LENGTH, 0);
-				if (l_receive_buffer_length)
-				{
-					comUDPProcessReceivedPacket(l_receive_buffer, (uint8_t)l_receive_buffer_length);
-				}	
-				
-			}
-			if (FD_ISSET(l_socket, &write_set))
-			{
-				FD_CLR(l_socket, &write_set);
-			}
-		}
+		// wait until the next periodic callback
+		ellapsed_time = sysGetSystemTickSince(l_periodic_timestamp);
+		if (ellapsed_time < comUDP_PERIODIC_CALLBACK_TIME)
+			timeout = comUDP_PERIODIC_CALLBACK_TIME - ellapsed_time + 1;
 		else
+			timeout = 0;
+
+		if (timeout > drvUDP_TASK_MAX_CYCLE_TIME)
+			timeout = drvUDP_TASK_MAX_CYCLE_TIME;
+
+		// wait for socket or notification events
+		event_count = epoll_wait(l_epoll, events, drvUDP_EPOLL_EVENT_COUNT, timeout);
+
+		for (i = 0; i < event_count; i++)
 		{
-			if (select_result == 0)
+			if (events[i].data.fd == l_event)
 			{
+				// clear notification
+				if (read(l_event, &event_value, sizeof(event_value)) < 0)
+					event_value = 0;
 			}
 			else
 			{
-				switch (errno)
-				{
-					case EINTR:
-						break;
-				}
-			}	
-		}
-	
-		// handle transmission request
-		if (l_transmitter_buffer_length > 0 && l_transmitter_buffer_length < drvUDP_TRANSMITTER_BUFFER_LENGTH)
-		{
-			struct sockaddr_in dest;
-
-			// send packet
-			dest.sin_family = AF_INET;
-			dest.sin_addr.s_addr = ntohl(l_transmitter_destination_address);
-			dest.sin_port = htons(cfgGetUInt16Value(cfgVAL_WIFI_REMOTE));
+				if ((events[i].events & EPOLLIN) != 0)
+					drvUDPReceivePackets();
 
-			int a =sendto(l_socket, (const char*)l_transmitter_buffer, l_transmitter_buffer_length, 0, (const struct sockaddr*)&dest, sizeof(dest));
-
-			l_transmitter_buffer_length = 0;
-
-			// Notify communication task about the available send buffer
-			comManagerGenerateEvent();
+				if ((events[i].events & EPOLLOUT) != 0)
+					drvUDPSetWaitForWritable(false);
+			}
 		}
 
+		// handle transmission requests
+		if (!l_wait_for_writable)
+			drvUDPTransmitPackets();
+
 		// handle periodic callback
 		ellapsed_time = sysGetSystemTickSince(l_periodic_timestamp);
 		if ( ellapsed_time > comUDP_PERIODIC_CALLBACK_TIME)
@@ -313,15 +378,159 @@ static sysTaskRetval drvUDPTask(sysTaskParam in_param)
 	}
 
 	// close socket
+	close(l_epoll);
 	close(l_socket);
+	close(l_event);
 	
+	l_epoll = -1;
 	l_socket = -1;
+	l_event = -1;
+
+	return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Receives all pending datagrams (in batches) and passes them to the UDP communication layer
+static void drvUDPReceivePackets(void)
+{
+	int received_count;
+	int i;
+
+	do
+	{
+		received_count = recvmmsg(l_socket, l_receive_messages, drvUDP_RECEIVER_BATCH_COUNT, MSG_DONTWAIT, NULL);
+
+		for (i = 0; i < received_count; i++)
+		{
+			if (l_receive_messages[i].msg_len > 0 && l_receive_messages[i].msg_len <= comMAX_PACKET_SIZE)
+				comUDPProcessReceivedPacket(l_receive_buffers[i], (uint8_t)l_receive_messages[i].msg_len);
+		}
+	} while (received_count == drvUDP_RECEIVER_BATCH_COUNT);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Sends all packets ready for transmission with one system call
+static void drvUDPTransmitPackets(void)
+{
+	uint8_t message_count;
+	uint8_t slot_index;
+	drvUDPTransmitterSlot* slot;
+	int sent_count;
+
+	// collect slots ready to send (in the order of the allocation)
+	message_count = 0;
+	slot_index = l_transmitter_pop_index;
+	while (message_count < drvUDP_TRANSMITTER_SLOT_COUNT)
+	{
+		slot = &l_transmitter_slots[slot_index];
+
+		if (slot->State != drvUDP_TSS_ReadyToSend)
+			break;
+
+		// drop invalid packet from the head of the queue, stop collecting at invalid packet otherwise
+		if (slot->Length == 0)
+		{
+			if (message_count > 0)
+				break;
+
+			drvUDPReleaseTransmitterSlots(1);
+			slot_index = l_transmitter_pop_index;
+			continue;
+		}
+
+		bzero(&l_transmit_addresses[message_count], sizeof(l_transmit_addresses[message_count]));
+		l_transmit_addresses[message_count].sin_family = AF_INET;
+		l_transmit_addresses[message_count].sin_addr.s_addr = ntohl(slot->DestinationAddress);
+		l_transmit_addresses[message_count].sin_port = l_remote_port;
+
+		l_transmit_iovecs[message_count].iov_base = slot->Buffer;
+		l_transmit_iovecs[message_count].iov_len = slot->Length;
+
+		bzero(&l_transmit_messages[message_count], sizeof(l_transmit_messages[message_count]));
+		l_transmit_messages[message_count].msg_hdr.msg_name = &l_transmit_addresses[message_count];
+		l_transmit_messages[message_count].msg_hdr.msg_namelen = sizeof(l_transmit_addresses[message_count]);
+		l_transmit_messages[message_count].msg_hdr.msg_iov = &l_transmit_iovecs[message_count];
+		l_transmit_messages[message_count].msg_hdr.msg_iovlen = 1;
+
+		message_count++;
+		slot_index = (slot_index + 1) % drvUDP_TRANSMITTER_SLOT_COUNT;
+	}
+
+	if (message_count == 0)
+		return;
+
+	// send packets
+	sent_count = sendmmsg(l_socket, l_transmit_messages, message_count, MSG_DONTWAIT);
+
+	if (sent_count < 0)
+	{
+		if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS)
+		{
+			// socket buffer is full -> wait until socket is writable
+			drvUDPSetWaitForWritable(true);
+			return;
+		}
+		else
+		{
+			// drop first packet on other errors (e.g. unreachable destination)
+			sent_count = 1;
+		}
+	}
+
+	// release sent slots
+	drvUDPReleaseTransmitterSlots((uint8_t)sent_count);
+
+	// wait for writable socket when not all packets were sent
+	if (sent_count < message_count)
+		drvUDPSetWaitForWritable(true);
+
+	// Notify communication task about the available send buffer
+	comManagerGenerateEvent();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Releases transmitter slots from the head of the transmission queue
+/// @param in_slot_count Number of slots to release
+static void drvUDPReleaseTransmitterSlots(uint8_t in_slot_count)
+{
+	sysCriticalSectionBegin();
+
+	while (in_slot_count > 0)
+	{
+		l_transmitter_slots[l_transmitter_pop_index].State = drvUDP_TSS_Free;
+		l_transmitter_pop_index = (l_transmitter_pop_index + 1) % drvUDP_TRANSMITTER_SLOT_COUNT;
+		in_slot_count--;
+	}
+
+	sysCriticalSectionEnd();
 }
 
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Enables or disables socket writable event
+/// @param in_wait True to wait for the socket writable event
+static void drvUDPSetWaitForWritable(bool in_wait)
+{
+	struct epoll_event event;
 
+	if (l_wait_for_writable == in_wait)
+		return;
+
+	bzero(&event, sizeof(event));
+	event.events = (in_wait) ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+	event.data.fd = l_socket;
+	epoll_ctl(l_epoll, EPOLL_CTL_MOD, l_socket, &event);
+
+	l_wait_for_writable = in_wait;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Wakes up the UDP task
 static void drvUDPNotifyTask(void)
 {
-	pthread_kill(l_udp_task, SIGUSR1);
+	uint64_t event_value = 1;
+
+	if (write(l_event, &event_value, sizeof(event_value)) < 0)
+		event_value = 0;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,45 @@
+/*****************************************************************************/
+/* High resolution (1us resolution) timer driver (Win32)                     */
+/*                                                                           */
+/* Copyright (C) 2016 Laszlo Arvai                                           */
+/* All rights reserved.                                                      */
+/*                                                                           */
+/* This software may be modified and distributed under the terms             */
+/* of the GNU General Public License.  See the LICENSE file for details.     */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/* Includes                                                                  */
+/*****************************************************************************/
+#include <Windows.h>
+#include <sysHighresTimer.h>
+
+/*****************************************************************************/
+/* Module global variables                                                   */
+/*****************************************************************************/
+static LARGE_INTEGER l_performance_frequency = { 0 };
+
+/*****************************************************************************/
+/* Function implementation                                                   */
+/*****************************************************************************/
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Initializes high resolution timer
+void halHighresTimerInit(void)
+{
+	QueryPerformanceFrequency(&l_performance_frequency);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Gets high resolution time timestamp (based on the performance counter)
+sysHighresTimestamp sysHighresTimerGetTimestamp(void)
+{
+	LARGE_INTEGER counter;
+
+	if (l_performance_frequency.QuadPart == 0)
+		halHighresTimerInit();
+
+	QueryPerformanceCounter(&counter);
+
+	return (sysHighresTimestamp)((counter.QuadPart / l_performance_frequency.QuadPart) * 1000000 + (counter.QuadPart % l_performance_frequency.QuadPart) * 1000000 / l_performance_frequency.QuadPart);
+}
@@ -22,7 +22,9 @@
 #include <crcCITT16.h>
 #include <comUDP.h>
 #include <cfgStorage.h>
+#include <drvUDP.h>
 #include "cfgConstants.h"
+#include "cfgValueLayout.h"
 
 #pragma comment(lib,"ws2_32.lib") //Winsock Library
 
@@ -33,10 +35,21 @@
 #define drvUDP_RECEIVER_BUFFER_LENGTH 256
 #define drvUDP_TASK_MAX_CYCLE_TIME 50
 
-#define drvUDP_TRANSMITTER_BUFFER_RESEVED 0xffff
-
 #define drvUDP_TASK_PRIORITY 2
 
+/*****************************************************************************/
+/* Types                                                                     */
+/*****************************************************************************/
+
+/// Transmitter slot (one datagram waiting for transmission)
+typedef struct
+{
+	uint8_t Buffer[drvUDP_TRANSMITTER_BUFFER_LENGTH];
+	uint16_t Length;
+	uint32_t DestinationAddress;
+	volatile drvUDPTransmitterSlotState State;
+} drvUDPTransmitterSlot;
+
 /*****************************************************************************/
 /* Module local variables                                                    */
 /*****************************************************************************/
@@ -50,21 +63,24 @@ static SOCKET l_socket = INVALID_SOCKET;
 struct sockaddr_in l_socket_address;
 
 static sysTick l_periodic_timestamp;
+static volatile uint16_t l_remote_port; // remote port in network byte order (refreshed when configuration is changed)
 
 // receiver variables
 static uint8_t l_receive_buffer[drvUDP_RECEIVER_BUFFER_LENGTH];
 static uint16_t l_receive_buffer_length;
 
 // transmitter variables
-static uint8_t l_transmitter_buffer[drvUDP_RECEIVER_BUFFER_LENGTH];
-static volatile uint16_t l_transmitter_buffer_length;
-static uint32_t l_transmitter_destination_address;
+static drvUDPTransmitterSlot l_transmitter_slots[drvUDP_TRANSMITTER_SLOT_COUNT];
+static uint8_t l_transmitter_push_index;
+static uint8_t l_transmitter_pop_index;
 
 /*****************************************************************************/
 /* Local functions                                                           */
 /*****************************************************************************/
 static sysTaskRetval drvUDPTask(sysTaskParam in_param);
 static void drvUDPDeinit(void);
+static void drvUDPTransmitPackets(void);
+static void drvUDPConfigurationChanged(void);
 
 /*****************************************************************************/
 /* Functions implementation                                                  */
@@ -79,10 +95,21 @@ void drvUDPInit(void)
 	// create notofication
 	sysTaskNotifyCreate(l_task_events[0]);
 
+	// cache configuration values
+	drvUDPConfigurationChanged();
+	cfgRegisterChangedCallback(drvUDPConfigurationChanged);
+
 	// initialize communication tasks
 	sysTaskCreate(drvUDPTask, "halUDP", sysDEFAULT_STACK_SIZE, sysNULL, drvUDP_TASK_PRIORITY, &task_handle, drvUDPDeinit);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Refreshes cached configuration values
+static void drvUDPConfigurationChanged(void)
+{
+	l_remote_port = htons((uint16_t)cfgGetValue(WIFI_REMOTE));
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // @brief Shots down ethernet communication service
 static void drvUDPDeinit(void)
@@ -92,18 +119,23 @@ static void drvUDPDeinit(void)
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-/// @brief Allocates and reserves transmitter buffer
+/// @brief Allocates and reserves transmitter buffer. Buffers are allocated from the transmitter slots in the
+/// order of the transmission, so more than one packet can be waiting for transmission.
 /// @return Transmitter data buffer address or sysNULL if transmitter is not available
 uint8_t* drvUDPAllocTransmitBuffer(void)
 {
+	drvUDPTransmitterSlot* slot;
 	uint8_t* buffer;
 
 	sysCriticalSectionBegin();
 
-	if (l_transmitter_buffer_length == 0)
+	slot = &l_transmitter_slots[l_transmitter_push_index];
+	if (slot->State == drvUDP_TSS_Free)
 	{
-		l_transmitter_buffer_length = drvUDP_TRANSMITTER_BUFFER_RESEVED;
-		buffer = l_transmitter_buffer;
+		slot->State = drvUDP_TSS_Reserved;
+		buffer = slot->Buffer;
+
+		l_transmitter_push_index = (l_transmitter_push_index + 1) % drvUDP_TRANSMITTER_SLOT_COUNT;
 	}
 	else
 	{
@@ -117,18 +149,41 @@ uint8_t* drvUDPAllocTransmitBuffer(void)
 
 ///////////////////////////////////////////////////////////////////////////////
 /// @brief Transmits data which is already placed in the transmitter buffer
+/// @param in_buffer Transmitter buffer returned by drvUDPAllocTransmitBuffer
 /// @param in_data_length Number of bytes to send
 /// @param in_destination_address IP address of the destination
-void drvUDPTransmitData(uint16_t in_data_length, uint32_t in_destination_address)
+void drvUDPTransmitData(uint8_t* in_buffer, uint16_t in_data_length, uint32_t in_destination_address)
 {
+	drvUDPTransmitterSlot* slot;
+	uint8_t slot_index;
+
+	// find slot of the buffer
+	slot_index = 0;
+	while (slot_index < drvUDP_TRANSMITTER_SLOT_COUNT && l_transmitter_slots[slot_index].Buffer != in_buffer)
+		slot_index++;
+
 	// sanity check
-	if (l_transmitter_buffer_length != drvUDP_TRANSMITTER_BUFFER_RESEVED)
+	if (slot_index >= drvUDP_TRANSMITTER_SLOT_COUNT)
 		return;
 
-	// notify thread about the transmission request
-	l_transmitter_destination_address = in_destination_address;
-	l_transmitter_buffer_length = in_data_length;
+	slot = &l_transmitter_slots[slot_index];
+
+	if (slot->State != drvUDP_TSS_Reserved)
+		return;
+
+	// invalid packets are released by the task without sending (zero length)
+	if (in_data_length > drvUDP_TRANSMITTER_BUFFER_LENGTH)
+		in_data_length = 0;
+
+	// queue slot for transmission
+	slot->Length = in_data_length;
+	slot->DestinationAddress = in_destination_address;
+
+	sysCriticalSectionBegin();
+	slot->State = drvUDP_TSS_ReadyToSend;
+	sysCriticalSectionEnd();
 
+	// notify thread about the transmission request
 	sysTaskNotifyGive(l_task_events[0]);
 }
 
@@ -215,7 +270,6 @@ static sysTaskRetval drvUDPTask(sysTaskParam in_param)
 	WSAEventSelect(l_socket, l_task_events[1], FD_READ);
 
 	// init
-	l_transmitter_buffer_length = 0;
 	l_periodic_timestamp = sysGetSystemTick();
 
 	// task loop
@@ -254,23 +308,8 @@ static sysTaskRetval drvUDPTask(sysTaskParam in_param)
 				break;
 		}
 
-		// handle transmission request
-		if (l_transmitter_buffer_length > 0 && l_transmitter_buffer_length < drvUDP_TRANSMITTER_BUFFER_LENGTH)
-		{
-			struct sockaddr_in dest;
-
-			// send packet
-			dest.sin_family = AF_INET;
-			dest.sin_addr.s_addr = ntohl(l_transmitter_destination_address);
-			dest.sin_port = htons(cfgGetUInt16Value(cfgVAL_WIFI_REMOTE));
-
-			sendto(l_socket, (const char*)l_transmitter_buffer, l_transmitter_buffer_length, 0, (const struct sockaddr*)&dest, sizeof(dest));
-
-			l_transmitter_buffer_length = 0;
-
-			// Notify communication task about the available send buffer
-			comManagerGenerateEvent();
-		}
+		// handle transmission requests
+		drvUDPTransmitPackets();
 
 		// handle periodic callback
 		ellapsed_time = sysGetSystemTickSince(l_periodic_timestamp);
@@ -296,6 +335,43 @@ static sysTaskRetval drvUDPTask(sysTaskParam in_param)
 	ExitThread(0);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Sends all packets ready for transmission
+static void drvUDPTransmitPackets(void)
+{
+	drvUDPTransmitterSlot* slot;
+	struct sockaddr_in dest;
+	bool packet_sent = false;
+
+	dest.sin_family = AF_INET;
+	dest.sin_port = l_remote_port;
+
+	// send packets in the order of the allocation
+	slot = &l_transmitter_slots[l_transmitter_pop_index];
+	while (slot->State == drvUDP_TSS_ReadyToSend)
+	{
+		if (slot->Length > 0)
+		{
+			dest.sin_addr.s_addr = ntohl(slot->DestinationAddress);
+
+			sendto(l_socket, (const char*)slot->Buffer, slot->Length, 0, (const struct sockaddr*)&dest, sizeof(dest));
+		}
+
+		// release slot
+		sysCriticalSectionBegin();
+		slot->State = drvUDP_TSS_Free;
+		l_transmitter_pop_index = (l_transmitter_pop_index + 1) % drvUDP_TRANSMITTER_SLOT_COUNT;
+		sysCriticalSectionEnd();
+
+		packet_sent = true;
+		slot = &l_transmitter_slots[l_transmitter_pop_index];
+	}
+
+	// Notify communication task about the available send buffer
+	if (packet_sent)
+		comManagerGenerateEvent();
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 /// @brief Returns true when connected to the network media
 bool drvUDPIsConnected(void)
@@ -15,13 +15,45 @@
 /* Includes                                                                  */
 /*****************************************************************************/
 #include <sysTypes.h>
+#include <sysRTOS.h>
 #include <fileSystemFiles.h>
 #include "cfgConstants.h"
 
+/*****************************************************************************/
+/* Constants                                                                 */
+/*****************************************************************************/
+
+// number of value data buffers (value data is double buffered)
+#define cfg_STORAGE_COUNT 2
+
+// maximum number of configuration change callbacks
+#ifndef cfg_CHANGED_CALLBACK_COUNT
+#define cfg_CHANGED_CALLBACK_COUNT 4
+#endif
+
+/*****************************************************************************/
+/* Types                                                                     */
+/*****************************************************************************/
+
+/// Configuration storage (EEPROM) statistics
+typedef struct
+{
+	uint32_t SaveCount;					// number of performed configuration saves
+	uint32_t PageWriteCount;		// number of written EEPROM pages
+	uint32_t PageWriteErrorCount;	// number of failed EEPROM page writes
+	uint32_t PageSkipCount;			// number of unchanged (not written) EEPROM pages
+	uint32_t LastSaveTime;			// duration of the last configuration save in us
+	uint32_t LastLoadTime;			// duration of the last configuration load in us
+} cfgStorageStatistics;
+
+/// Configuration change callback function
+typedef void(*cfgChangedCallback)(void);
+
 /*****************************************************************************/
 /* Module global variables                                                   */
 /*****************************************************************************/
-extern uint8_t g_configuration_data[];
+extern uint8_t g_cfg_value_data[cfg_STORAGE_COUNT][cfg_VALUE_DATA_FILE_LENGTH];
+extern uint8_t g_cfg_value_storage_index[cfg_VALUE_COUNT];
 
 /*****************************************************************************/
 /* Function prototypes                                                       */
@@ -30,7 +62,9 @@ void cfgStorageInit(void);
 void cfgLoadDefaultConfiguration(void);
 void cfgLoadConfiguration(void);
 void cfgSaveConfiguration(void);
-bool cfgValueDataFileHandler(fileCallbackRequest in_request, void* in_buffer, uint16_t in_buffer_length, uint16_t in_start_pos);
+void cfgGetStorageStatistics(cfgStorageStatistics* out_statistics);
+bool cfgRegisterChangedCallback(cfgChangedCallback in_callback);
+bool cfgValueDataFileHandler(fileCallbackRequest in_request, void* in_buffer, uint16_t in_buffer_length, uint32_t in_start_pos);
 
 
 sysString cfgGetStringValue(uint16_t in_value_index);
@@ -39,6 +73,70 @@ uint32_t cfgGetUInt32Value(uint16_t in_value_index);
 uint8_t cfgGetEnumValue(uint16_t in_value_index);
 float cfgGetFloatValue(uint16_t in_value_index);
 
+/*****************************************************************************/
+/* Typed value access                                                        */
+/*****************************************************************************/
+
+// Gets configuration value by name (e.g. cfgGetValue(WIFI_REMOTE)). Value offset and type are resolved at compile time
+// using cfgOFS_xxx and cfgTYP_xxx definitions of the project's cfgValueLayout.h (it must be included by the caller).
+#define cfgGetValue(name) cfgGetValueByType(cfgTYP_##name, cfgVAL_##name, cfgOFS_##name)
+#define cfgGetValueByType(type, index, offset) cfgGetValueByTypeName(type, index, offset)
+#define cfgGetValueByTypeName(type, index, offset) cfgRead##type##Value(index, offset)
+
+// Gets address of the value in the active value data buffer
+#define cfgGetValueAddress(index, offset) (&g_cfg_value_data[g_cfg_value_storage_index[index]][offset])
+
+// Value readers (value data is packed therefore multi-byte values are copied to avoid unaligned access)
+sysINLINE uint8_t cfgReadUInt8Value(uint16_t in_value_index, uint16_t in_offset)
+{
+	return *cfgGetValueAddress(in_value_index, in_offset);
+}
+
+sysINLINE int8_t cfgReadInt8Value(uint16_t in_value_index, uint16_t in_offset)
+{
+	return (int8_t)*cfgGetValueAddress(in_value_index, in_offset);
+}
+
+sysINLINE uint16_t cfgReadUInt16Value(uint16_t in_value_index, uint16_t in_offset)
+{
+	uint16_t value;
+	sysMemCopy(&value, cfgGetValueAddress(in_value_index, in_offset), sizeof(value));
+	return value;
+}
+
+sysINLINE int16_t cfgReadInt16Value(uint16_t in_value_index, uint16_t in_offset)
+{
+	int16_t value;
+	sysMemCopy(&value, cfgGetValueAddress(in_value_index, in_offset), sizeof(value));
+	return value;
+}
+
+sysINLINE uint32_t cfgReadUInt32Value(uint16_t in_value_index, uint16_t in_offset)
+{
+	uint32_t value;
+	sysMemCopy(&value, cfgGetValueAddress(in_value_index, in_offset), sizeof(value));
+	return value;
+}
+
+sysINLINE int32_t cfgReadInt32Value(uint16_t in_value_index, uint16_t in_offset)
+{
+	int32_t value;
+	sysMemCopy(&value, cfgGetValueAddress(in_value_index, in_offset), sizeof(value));
+	return value;
+}
+
+sysINLINE float cfgReadFloatValue(uint16_t in_value_index, uint16_t in_offset)
+{
+	float value;
+	sysMemCopy(&value, cfgGetValueAddress(in_value_index, in_offset), sizeof(value));
+	return value;
+}
+
+sysINLINE sysString cfgReadStringValue(uint16_t in_value_index, uint16_t in_offset)
+{
+	return (sysString)cfgGetValueAddress(in_value_index, in_offset);
+}
+
 
 
 #endif
@@ -27,6 +27,24 @@
 #define comMAX_PACKET_SIZE 255
 #define comINVALID_INTERFACE_INDEX 0xff
 
+/*****************************************************************************/
+/* Types                                                                     */
+/*****************************************************************************/
+
+/// Transmitter statistics of the communication manager
+typedef struct
+{
+	uint16_t TransmitQueueDepth;						// Number of bytes currently used in the transmitter queue
+	uint16_t TransmitQueueMaxDepth;					// Highest number of used bytes in the transmitter queue
+	uint32_t TransmitWakeupCount;						// Number of transmitter processing cycles
+	uint32_t TransmittedPacketCount;				// Total number of packets passed to at least one interface
+	uint32_t ExpiredPacketCount;						// Number of packets dropped because of expiration
+	uint32_t RetryCount;										// Number of transmitter cycles stopped by a packet not accepted by the interfaces (retried in the next cycle)
+	uint16_t LastWakeupPacketCount;					// Number of packets sent in the last transmitter cycle
+	uint16_t MaxWakeupPacketCount;					// Highest number of packets sent in one transmitter cycle
+	uint32_t StalledCycleCount;							// Number of transmitter cycles blocked by a packet reserved but never finished or cancelled
+} comManagerStatistics;
+
 /*****************************************************************************/
 /* Function prototypes                                                       */
 /*****************************************************************************/
@@ -47,4 +65,7 @@ uint8_t* comManagerGetTransmitPacketGetBuffer(uint16_t in_packet_index);
 
 void comManagerGenerateEvent(void);
 
+void comManagerGetStatistics(comManagerStatistics* out_statistics);
+void comManagerResetStatistics(void);
+
 #endif
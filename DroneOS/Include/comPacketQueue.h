@@ -64,9 +64,10 @@ typedef struct
 	uint16_t BufferSize;
 
 	sysMutex PushLock;
+	bool SingleProducer;
 
-	uint16_t PushIndex;
-	uint16_t PopIndex;
+	volatile uint16_t PushIndex;
+	volatile uint16_t PopIndex;
 
 	comQueueNotificationFunction Callback;
 
@@ -76,6 +77,7 @@ typedef struct
 ///////////////////////////////////////////////////////////////////////////////
 // Function prototypes
 void comPacketQueueInitialize(comPacketQueue* in_queue, uint8_t* in_packet_buffer, uint16_t in_buffer_size);
+void comPacketQueueInitializeSingleProducer(comPacketQueue* in_queue, uint8_t* in_packet_buffer, uint16_t in_buffer_size);
 
 uint16_t comPacketQueuePushBegin(comPacketQueue* in_queue, uint8_t in_size, uint8_t in_source_interface);
 void comPacketQueuePushEnd(comPacketQueue* in_queue, uint16_t in_packet_index);
@@ -88,5 +90,8 @@ void comPacketQueuePopEnd(comPacketQueue* in_queue);
 comPacketInfo* comPacketQueueGetPacketInfo(comPacketQueue* in_queue, uint16_t in_packet_index);
 uint8_t* comPacketQueueGetPacketBuffer(comPacketQueue* in_queue, uint16_t in_packet_index);
 
+uint16_t comPacketQueueGetUsedSize(comPacketQueue* in_queue);
+uint32_t comPacketQueueGetHeadReservationTime(comPacketQueue* in_queue);
+
 
 #endif
\ No newline at end of file
@@ -63,6 +63,7 @@ bool slipEncodeBlock(slipEncoderState* in_state, uint8_t* in_buffer, uint8_t in_
 
 void slipDecodeInitialize(slipDecoderState* in_state);
 bool slipDecodeByte(slipDecoderState* in_state, uint8_t in_byte);
+bool slipDecodeBlock(slipDecoderState* in_state, uint8_t* in_buffer, uint16_t in_length, uint16_t* out_processed_length);
 
 
 #endif
@@ -74,6 +74,16 @@
 #define comPT_FILE_OPERATION_FINISHED_REQUEST		(comPT_FILE_OPERATION_FINISHED | comPT_REQUEST_FLAG)
 #define comPT_FILE_OPERATION_FINISHED_RESPONSE	(comPT_FILE_OPERATION_FINISHED)
 
+#define comPT_FILE_DATA_WINDOW_READ							(comPT_SYSTEM_FLAG | comPT_CLASS_FILE | 5)
+#define comPT_FILE_DATA_WINDOW_READ_REQUEST			(comPT_FILE_DATA_WINDOW_READ | comPT_REQUEST_FLAG) // response: comPT_FILE_DATA_READ_RESPONSE for every requested block
+
+#define comPT_FILE_DATA_WINDOW_WRITE						(comPT_SYSTEM_FLAG | comPT_CLASS_FILE | 6)
+#define comPT_FILE_DATA_WINDOW_WRITE_REQUEST		(comPT_FILE_DATA_WINDOW_WRITE | comPT_REQUEST_FLAG)
+#define comPT_FILE_DATA_WINDOW_WRITE_RESPONSE		(comPT_FILE_DATA_WINDOW_WRITE)
+
+// Telemetry packet types (system flag is not set)
+#define comPT_TELEMETRY_OBJECT			1
+
 // File result codes
 #define comFRC_OK					0
 #define comFRC_NOT_FOUND	1
@@ -85,6 +95,9 @@
 #define comFOFM_SUCCESS 1
 #define comFOFM_CANCEL	2
 
+// Maximum number of blocks in one window of the windowed file transfer
+#define comFILE_TRANSFER_MAX_WINDOW_SIZE 32
+
 // packet definitions
 
 /////////////////////
@@ -269,6 +282,34 @@ typedef struct
 
 } comPacketFileOperationFinishedResponse;
 
+////////////////////////////////
+// File data window read request
+typedef struct
+{
+	comPacketFileHeader Header;
+
+	uint32_t Pos;					// position of the first block of the window
+	uint8_t BlockLength;	// length of the blocks in bytes
+	uint32_t BlockMask;		// requested blocks (bit n: block at Pos + n * BlockLength)
+
+} comPacketFileDataWindowReadRequest;
+
+/////////////////////////////////////////////////////////
+// File data window write request (header only, same as comPacketFileDataWriteRequestHeader)
+typedef comPacketFileDataWriteRequestHeader comPacketFileDataWindowWriteRequestHeader;
+
+//////////////////////////////////////////////
+// File data window write response (block acknowledge)
+typedef struct
+{
+	comPacketFileHeader Header;
+
+	uint32_t Pos;
+	uint16_t Length;
+	uint8_t Error;
+
+} comPacketFileDataWindowWriteResponse;
+
 
 ////////////////////////////////////
 // File operation: Get changes request
@@ -294,6 +335,20 @@ typedef struct
 
 } comPacketFileOperationGetChangesResponse;
 
+/*****************************************************************************/
+/* Telemetry packets                                                         */
+/*****************************************************************************/
+
+///////////////////////////////////
+// Telemetry object (header only, followed by the object data)
+typedef struct
+{
+	comPacketHeader Header;
+
+	uint16_t ObjectIndex;
+
+} comPacketTelemetryObjectHeader;
+
 // Ends packed struct
 #include <sysPackedStructEnd.h>
 
@@ -8,7 +8,7 @@
 /* of the GNU General Public License.  See the LICENSE file for details.     */
 /*****************************************************************************/
 #ifndef __crcCITT16_h
-#define __sysCITT16_h
+#define __crcCITT16_h
 
 /*****************************************************************************/
 /* Includes                                                                  */
@@ -0,0 +1,104 @@
+/*****************************************************************************/
+/* Flight data recorder                                                      */
+/*                                                                           */
+/* Copyright (C) 2017 Laszlo Arvai                                           */
+/* All rights reserved.                                                      */
+/*                                                                           */
+/* This software may be modified and distributed under the terms             */
+/* of the GNU General Public License.  See the LICENSE file for details.     */
+/*****************************************************************************/
+
+#ifndef __fdrRecorder_h
+#define __fdrRecorder_h
+
+/*****************************************************************************/
+/* Includes                                                                  */
+/*****************************************************************************/
+#include <sysTypes.h>
+#include <halIODefinitions.h>
+
+/*****************************************************************************/
+/* Constants                                                                 */
+/*****************************************************************************/
+
+// Log file format: sequence of fixed size blocks. Every block starts with a block header followed by
+// complete records (records never cross block boundary). Blocks can be located by offset and the block header
+// contains the time range of its records, so the log can be searched by time without a separate index.
+#define fdrBLOCK_SIZE 4096
+#define fdrBLOCK_MAGIC 0x42524446ul		// 'FDRB'
+#define fdrFORMAT_VERSION 1
+
+// Record types
+#define fdrRT_PADDING							0		// unused space (only in the ring buffer)
+#define fdrRT_OBJECT							1		// realtime object snapshot (channel: object index)
+#define fdrRT_PACKET_RECEIVED			2		// received packet (channel: interface index)
+#define fdrRT_PACKET_TRANSMITTED	3		// transmitted packet (channel: interface index, 0xff: all interfaces)
+#define fdrRT_SENSOR							4		// raw sensor data (channel: sensor index)
+
+// Maximum data length of one record
+#define fdrMAX_RECORD_DATA_LENGTH 256
+
+/*****************************************************************************/
+/* Types                                                                     */
+/*****************************************************************************/
+
+// Starts packed struct
+#include <sysPackedStructStart.h>
+
+/// Header of the log blocks
+typedef struct
+{
+	uint32_t Magic;				// fdrBLOCK_MAGIC
+	uint16_t Version;			// fdrFORMAT_VERSION
+	uint16_t DataLength;	// number of record bytes after the header
+	uint32_t Sequence;		// block sequence number
+	uint64_t StartTime;		// timestamp of the first record [us since recording start]
+	uint64_t EndTime;			// timestamp of the last record [us since recording start]
+	uint16_t CRC;					// CRC of the record data
+	uint16_t Reserved;
+} fdrBlockHeader;
+
+/// Header of the records stored in the log blocks (followed by the record data)
+typedef struct
+{
+	uint32_t TimeOffset;	// record timestamp relative to the block start time [us]
+	uint16_t Length;			// number of data bytes
+	uint8_t Type;					// record type (fdrRT_xxx)
+	uint8_t Channel;			// object, interface or sensor index
+} fdrRecordHeader;
+
+// Ends packed struct
+#include <sysPackedStructEnd.h>
+
+/// Recorder statistics
+typedef struct
+{
+	uint32_t RecordCount;					// number of records written into the log
+	uint32_t DroppedRecordCount;	// number of records dropped because the ring buffer was full
+	uint32_t BlockCount;					// number of blocks written into the log
+	uint32_t WriteErrorCount;			// number of failed block writes
+	uint32_t MaxRingUsage;				// highest number of bytes used in the ring buffer
+	bool LogFull;									// recording is stopped because the log reached its maximum size
+} fdrRecorderStatistics;
+
+/*****************************************************************************/
+/* Function prototypes                                                       */
+/*****************************************************************************/
+void fdrRecorderInitialize(void);
+bool fdrRecorderStart(const char* in_log_name);
+void fdrRecorderTaskStop(void);
+bool fdrRecordData(uint8_t in_type, uint8_t in_channel, const void* in_data, uint16_t in_length);
+void fdrRecorderGetStatistics(fdrRecorderStatistics* out_statistics);
+
+/*****************************************************************************/
+/* Recorder hooks                                                            */
+/*****************************************************************************/
+
+// Recording points in the system modules are compiled only when fdrRECORDER_ENABLED is defined in halIODefinitions.h
+#ifdef fdrRECORDER_ENABLED
+#define fdrRECORD(type, channel, data, length) fdrRecordData(type, channel, data, length)
+#else
+#define fdrRECORD(type, channel, data, length)
+#endif
+
+#endif
@@ -0,0 +1,61 @@
+/*****************************************************************************/
+/* Flight data recorder log replay                                           */
+/*                                                                           */
+/* Copyright (C) 2017 Laszlo Arvai                                           */
+/* All rights reserved.                                                      */
+/*                                                                           */
+/* This software may be modified and distributed under the terms             */
+/* of the GNU General Public License.  See the LICENSE file for details.     */
+/*****************************************************************************/
+
+#ifndef __fdrReplay_h
+#define __fdrReplay_h
+
+/*****************************************************************************/
+/* Includes                                                                  */
+/*****************************************************************************/
+#include <sysTypes.h>
+#include <fdrRecorder.h>
+#include <roxStorage.h>
+
+/*****************************************************************************/
+/* Constants                                                                 */
+/*****************************************************************************/
+#define fdrREPLAY_MAXIMUM_SPEED 0
+
+/*****************************************************************************/
+/* Types                                                                     */
+/*****************************************************************************/
+
+/// Record read from the log
+typedef struct
+{
+	uint64_t Time;				// record timestamp [us since recording start]
+	uint8_t Type;					// record type (fdrRT_xxx)
+	uint8_t Channel;			// object, interface or sensor index
+	uint16_t Length;			// number of data bytes
+	uint8_t* Data;				// record data (valid until the next record is read)
+} fdrReplayRecord;
+
+/// Callback for replaying raw sensor data
+typedef void (*fdrReplaySensorCallback)(uint8_t in_sensor_index, uint8_t* in_data, uint16_t in_length);
+
+/*****************************************************************************/
+/* Function prototypes                                                       */
+/*****************************************************************************/
+
+// log reader functions
+bool fdrReplayOpen(const char* in_file_name);
+void fdrReplayClose(void);
+bool fdrReplaySeek(uint64_t in_time);
+bool fdrReplayReadRecord(fdrReplayRecord* out_record);
+uint32_t fdrReplayGetInvalidBlockCount(void);
+
+// replay task functions
+bool fdrReplayStart(const char* in_file_name, uint64_t in_start_time, uint16_t in_speed);
+void fdrReplayTaskStop(void);
+bool fdrReplayIsRunning(void);
+void fdrReplaySetSensorCallback(fdrReplaySensorCallback in_callback);
+void fdrReplaySetRepublishedObject(roxObjectIndex in_object_index);
+
+#endif
@@ -14,6 +14,7 @@
 /* Includes                                                                  */
 /*****************************************************************************/
 #include <sysTypes.h>
+#include <crcMD5.h>
 
 /*****************************************************************************/
 /* Constants                                                                 */
@@ -33,15 +34,23 @@ typedef enum
 	fileCF_GetLength,						// gets length of the file
 	fileCF_GetMD5,							// gets MD5 checksum of the file
 	fileCF_GetContent,					// gets pointer to the file content
-	fileCF_IsChangedSince,			// check if the given portion of the file was changed
+	fileCF_IsChangedSince,			// check if the file was changed since the previous check (buffer: fileChangeInfo)
 	fileCF_ReadBlock,						// reads block from the file
 	fileCF_WriteBlock,					// writes block to the file
 	fileCF_FinishSuccess,				// finishes file block operation (read/write) with success status
 	fileCF_FinishCancel					// finishes file block operation (read/write) with failed status
 } fileCallbackRequest;
 
+/// Change information of the file (used by fileCF_IsChangedSince request)
+typedef struct
+{
+	uint32_t ChangeCounter;		// [in] change counter returned by the previous check, [out] current change counter
+	uint32_t FirstChangedPos;	// [out] position of the first changed byte since the previous check
+	bool Changed;							// [out] true if file content was changed since the previous check
+} fileChangeInfo;
+
 /// File request callback function
-typedef bool(*fileSystemFileHandlerCallback)(fileCallbackRequest in_function, void* in_buffer, uint16_t in_buffer_length, uint16_t in_start_pos);
+typedef bool(*fileSystemFileHandlerCallback)(fileCallbackRequest in_function, void* in_buffer, uint16_t in_buffer_length, uint32_t in_start_pos);
 
 /// Entry (file information) for internal file table
 typedef struct
@@ -61,10 +70,13 @@ extern fileInternalFileTableEntry g_system_files_info_table[];
 /*****************************************************************************/
 /* Function prototypes                                                       */
 /*****************************************************************************/
+void fileSystemFileInit(void);
+void fileSystemFileSetTable(fileInternalFileTableEntry* in_file_table);
 uint8_t fileSystemFileGetIndex(sysString in_file_name);
 uint8_t fileSystemFileGetCount(void);
 uint32_t fileSystemFileGetLength(uint8_t in_file_index);
 const uint8_t* fileSystemFileGetContent(uint8_t in_file_index);
 uint8_t fileSystemFileGetFlag(uint8_t in_file_index);
+bool fileSystemFileGetHash(uint8_t in_file_index, crcMD5Hash* out_hash);
 
 #endif
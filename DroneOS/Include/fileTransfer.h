@@ -21,6 +21,7 @@
 /* Function prototypes                                                       */
 /*****************************************************************************/
 void fileProcessFileTransfer(comPacketInfo* in_packet_info, uint8_t* in_packet);
+void fileProcessPendingTransfers(void);
 
 
 #endif
\ No newline at end of file
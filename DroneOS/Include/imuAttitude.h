@@ -0,0 +1,41 @@
+/*****************************************************************************/
+/* Attitude estimation (Mahony complementary filter)                         */
+/*                                                                           */
+/* Copyright (C) 2016 Laszlo Arvai                                           */
+/* All rights reserved.                                                      */
+/*                                                                           */
+/* This software may be modified and distributed under the terms             */
+/* of the GNU General Public License.  See the LICENSE file for details.     */
+/*****************************************************************************/
+
+#ifndef __imuAttitude_h
+#define __imuAttitude_h
+
+/*****************************************************************************/
+/* Includes                                                                  */
+/*****************************************************************************/
+#include <sysTypes.h>
+#include <mathVector.h>
+
+/*****************************************************************************/
+/* Types                                                                     */
+/*****************************************************************************/
+
+/// Attitude estimator state
+typedef struct
+{
+	mathQuaternionf Quaternion;	// attitude quaternion, rotates from body to earth frame
+	mathVector3f IntegralError;	// integrated attitude error (estimated gyro bias) [rad/s]
+	float Kp;									// proportional gain of the accelerometer correction
+	float Ki;									// integral gain of the accelerometer correction
+} imuAttitudeState;
+
+/*****************************************************************************/
+/* Function prototypes                                                       */
+/*****************************************************************************/
+void imuAttitudeInit(imuAttitudeState* out_state, float in_kp, float in_ki);
+void imuAttitudeAlign(imuAttitudeState* inout_state, const mathVector3f* in_acceleration);
+void imuAttitudeUpdate(imuAttitudeState* inout_state, const mathVector3f* in_angular_rate, const mathVector3f* in_acceleration, float in_dt);
+void imuAttitudeGetEulerAngles(const imuAttitudeState* in_state, float* out_roll, float* out_pitch, float* out_yaw);
+
+#endif
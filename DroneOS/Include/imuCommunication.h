@@ -21,10 +21,72 @@
 /*****************************************************************************/
 
 
+/*****************************************************************************/
+/* Types                                                                     */
+/*****************************************************************************/
+
+/// Transaction type
+typedef enum
+{
+	imuTT_Read,		/// reads register block
+	imuTT_Write		/// writes register block
+} imuTransactionType;
+
+/// Transaction status
+typedef enum
+{
+	imuTS_Idle,			/// not submitted
+	imuTS_Pending,	/// waiting in the queue
+	imuTS_Active,		/// transfer is in progress
+	imuTS_Success,	/// finished successfully
+	imuTS_Failed,		/// transfer failed
+	imuTS_Aborted		/// not executed because a previous transaction of the chain failed
+} imuTransactionStatus;
+
+struct _imuTransaction;
+
+/// Transaction finished callback (called from the bus interrupt)
+typedef void (*imuTransactionCallbackFunction)(struct _imuTransaction* in_transaction, void* in_interrupt_param);
+
+/// Bus transaction (storage is provided by the caller and must be valid until the transaction is finished)
+typedef struct _imuTransaction
+{
+	imuTransactionType Type;
+	uint8_t I2CAddress;
+	uint8_t RegisterAddress;
+	uint8_t* Buffer;												// data to write or buffer for the read data
+	uint8_t Length;													// number of bytes to read or write
+	imuTransactionCallbackFunction Callback;	// called when the transaction is finished (can be sysNULL)
+	void* CallbackParameter;								// not used by the queue
+	struct _imuTransaction* Next;						// next transaction of the chain (sysNULL at the end of the chain)
+	volatile imuTransactionStatus Status;
+	struct _imuTransaction* NextInQueue;		// used by the queue
+} imuTransaction;
+
+/// Transaction queue statistics
+typedef struct
+{
+	uint32_t TransactionCount;				// number of finished transactions
+	uint32_t FailedTransactionCount;	// number of failed transactions
+	uint32_t AbortedTransactionCount;	// number of transactions aborted because of a failure in the chain
+	uint32_t TimeoutCount;						// number of transactions failed because the bus transfer was not finished in time
+	uint32_t LateCompletionCount;			// number of ignored bus transfer completions (transfer was already timed out)
+	uint16_t MaxQueueLength;					// maximum number of waiting transactions
+} imuCommunicationStatistics;
+
 /*****************************************************************************/
 /* Function prototypes                                                       */
 /*****************************************************************************/
 void imuCommunicationInit(void);
+
+// asynchronous transactions
+void imuTransactionInitRead(imuTransaction* in_transaction, uint8_t in_i2c_address, uint8_t in_register_address, uint8_t* out_buffer, uint8_t in_length, imuTransactionCallbackFunction in_callback);
+void imuTransactionInitWrite(imuTransaction* in_transaction, uint8_t in_i2c_address, uint8_t in_register_address, uint8_t* in_buffer, uint8_t in_length, imuTransactionCallbackFunction in_callback);
+bool imuTransactionSubmit(imuTransaction* in_transaction);
+void imuCommunicationGetStatistics(imuCommunicationStatistics* out_statistics);
+void imuCommunicationCheckTimeout(void);
+
+// blocking functions (can be used only from the task which called imuCommunicationInit)
 void imuReadByteRegister(uint8_t in_i2caddress, uint8_t in_register_address, uint8_t* out_register_value, bool* inout_success);
 void imuWriteByteRegister(uint8_t in_i2c_address, uint8_t in_register_address, uint8_t in_register_value, bool* inout_success);
 void imuReadRegisterBlock(uint8_t in_i2c_address, uint8_t in_register_address, uint8_t* out_register_block, uint8_t in_register_block_length, bool* inout_success);
@@ -16,11 +16,61 @@
 /*****************************************************************************/
 #include <sysTypes.h>
 #include <sysRTOS.h>
+#include <drvIMU.h>
 
 /*****************************************************************************/
 /* Constants                                                                 */
 /*****************************************************************************/
-#define drvIMU_MaxSensorCount 4
+
+// realtime object used to publish the estimated attitude
+#ifndef imuATTITUDE_OBJECT_INDEX
+#define imuATTITUDE_OBJECT_INDEX 0
+#endif
+
+// attitude object member addresses
+#define imuAOM_TIMESTAMP				0		// uint32_t: sampling time of the newest processed sample [us]
+#define imuAOM_QUATERNION_W			4		// float: attitude quaternion (body to earth frame)
+#define imuAOM_QUATERNION_X			8
+#define imuAOM_QUATERNION_Y			12
+#define imuAOM_QUATERNION_Z			16
+#define imuAOM_ROLL							20	// float: Euler angles [rad]
+#define imuAOM_PITCH						24
+#define imuAOM_YAW							28
+#define imuAOM_RATE_X						32	// float: angular rate [rad/s]
+#define imuAOM_RATE_Y						36
+#define imuAOM_RATE_Z						40
+#define imuAOM_ACCELERATION_X		44	// float: acceleration [g]
+#define imuAOM_ACCELERATION_Y		48
+#define imuAOM_ACCELERATION_Z		52
+#define imuAOM_SIZE							56
+
+// realtime object used to publish the barometric pressure and altitude
+#ifndef imuBAROMETER_OBJECT_INDEX
+#define imuBAROMETER_OBJECT_INDEX 1
+#endif
+
+// barometer object member addresses
+#define imuBOM_TIMESTAMP				0		// uint32_t: sampling time of the pressure [us]
+#define imuBOM_PRESSURE					4		// float: pressure [Pa]
+#define imuBOM_TEMPERATURE			8		// float: sensor temperature [degC]
+#define imuBOM_ALTITUDE					12	// float: pressure altitude (standard atmosphere) [m]
+#define imuBOM_SIZE							16
+
+/*****************************************************************************/
+/* Types                                                                     */
+/*****************************************************************************/
+
+/// Attitude estimation statistics
+typedef struct
+{
+	uint32_t UpdateCount;						// number of processed samples
+	uint32_t PublishCount;					// number of attitude object updates
+	uint32_t DroppedSampleCount;		// number of samples lost because the sample buffer was full
+	uint32_t MaxProcessingTime;			// maximum processing time of one publish cycle [us]
+	uint32_t TotalProcessingTime;		// total processing time [us]
+	uint32_t MaxLatency;						// maximum time between sampling and publishing [us]
+	uint32_t TotalLatency;					// sum of the publishing latency of the newest samples [us]
+} imuAttitudeStatistics;
 
 /*****************************************************************************/
 /* Global variables                                                          */
@@ -30,5 +80,11 @@
 /* Function prototypes                                                       */
 /*****************************************************************************/
 void imuInitialize(void);
+void imuSetBarometerOversampling(uint16_t in_oversampling);
+void imuTaskStop(void);
+bool imuGetStatistics(uint8_t in_sensor_index, drvIMUStatisticsParameter* out_statistics);
+bool imuIsSelfTestPassed(uint8_t in_sensor_index);
+void imuGetAttitudeStatistics(imuAttitudeStatistics* out_statistics);
+void imuReplaySample(uint8_t in_sensor_index, uint8_t* in_data, uint16_t in_length);
 
 #endif
@@ -0,0 +1,150 @@
+/*****************************************************************************/
+/* Fixed point (Q format) vector and quaternion math                         */
+/*                                                                           */
+/* Copyright (C) 2016 Laszlo Arvai                                           */
+/* All rights reserved.                                                      */
+/*                                                                           */
+/* This software may be modified and distributed under the terms             */
+/* of the GNU General Public License.  See the LICENSE file for details.     */
+/*****************************************************************************/
+
+#ifndef __mathFixed_h
+#define __mathFixed_h
+
+/*****************************************************************************/
+/* Includes                                                                  */
+/*****************************************************************************/
+#include <sysTypes.h>
+
+/*****************************************************************************/
+/* Constants                                                                 */
+/*****************************************************************************/
+
+/// Enables the dual 16-bit multiply-accumulate instructions of the Cortex-M4 (CMSIS intrinsics)
+#ifndef mathUSE_CMSIS
+#if defined(STM32F4XX) && defined(__ARM_FEATURE_DSP)
+#define mathUSE_CMSIS 1
+#else
+#define mathUSE_CMSIS 0
+#endif
+#endif
+
+#define mathQ15_ONE 0x7fff
+#define mathQ16_ONE 0x00010000
+#define mathQ30_ONE 0x40000000
+
+/*
+ * Error bounds (LSB of the result format, inputs are exact):
+ *  - mathQ15Multiply, mathQ16Multiply, mathQ30Multiply: 0.5 LSB (rounded)
+ *  - mathQuaternionQ30Multiply: 0.5 LSB per component (products are summed before rounding)
+ *  - mathQuaternionQ30Normalize: 4 LSB when the squared norm is in 0.99..1.01 range
+ *  - mathQuaternionQ30Integrate: 2 LSB per step (the angular rate is quantized to Q16 by the caller)
+ */
+
+/*****************************************************************************/
+/* Types                                                                     */
+/*****************************************************************************/
+
+/// Signed 1.15 fixed point number (-1..1)
+typedef int16_t mathQ15;
+
+/// Signed 16.16 fixed point number (-32768..32768)
+typedef int32_t mathQ16;
+
+/// Signed 2.30 fixed point number (-2..2)
+typedef int32_t mathQ30;
+
+/// Three dimensional vector in 16.16 format
+typedef struct
+{
+	mathQ16 X;
+	mathQ16 Y;
+	mathQ16 Z;
+} mathVector3Q16;
+
+/// Quaternion in 2.30 format (W is the scalar part)
+typedef struct
+{
+	mathQ30 W;
+	mathQ30 X;
+	mathQ30 Y;
+	mathQ30 Z;
+} mathQuaternionQ30;
+
+/*****************************************************************************/
+/* Inline functions                                                          */
+/*****************************************************************************/
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Converts floating point value to Q16 (rounded to the nearest)
+sysINLINE mathQ16 mathQ16FromFloat(float in_value)
+{
+	return (mathQ16)(in_value * 65536.0f + ((in_value >= 0) ? 0.5f : -0.5f));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Converts Q16 value to floating point
+sysINLINE float mathQ16ToFloat(mathQ16 in_value)
+{
+	return in_value * (1.0f / 65536.0f);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Converts floating point value to Q30 (rounded to the nearest)
+sysINLINE mathQ30 mathQ30FromFloat(float in_value)
+{
+	return (mathQ30)(in_value * 1073741824.0f + ((in_value >= 0) ? 0.5f : -0.5f));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Converts Q30 value to floating point
+sysINLINE float mathQ30ToFloat(mathQ30 in_value)
+{
+	return in_value * (1.0f / 1073741824.0f);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Multiplies Q15 values (rounded, saturated)
+sysINLINE mathQ15 mathQ15Multiply(mathQ15 in_a, mathQ15 in_b)
+{
+	int32_t result = ((int32_t)in_a * in_b + 0x4000) >> 15;
+
+	// -1 * -1 is the only overflow
+	if (result > 0x7fff)
+		result = 0x7fff;
+
+	return (mathQ15)result;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Multiplies Q16 values (rounded, not saturated)
+sysINLINE mathQ16 mathQ16Multiply(mathQ16 in_a, mathQ16 in_b)
+{
+	return (mathQ16)(((int64_t)in_a * in_b + 0x8000) >> 16);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Multiplies Q30 values (rounded, not saturated)
+sysINLINE mathQ30 mathQ30Multiply(mathQ30 in_a, mathQ30 in_b)
+{
+	return (mathQ30)(((int64_t)in_a * in_b + 0x20000000) >> 30);
+}
+
+/*****************************************************************************/
+/* Function prototypes                                                       */
+/*****************************************************************************/
+
+// array functions
+int64_t mathQ15DotProduct(const mathQ15* in_a, const mathQ15* in_b, uint16_t in_count);
+
+// vector functions
+void mathVector3Q16FromInt16(mathVector3Q16* out_vector, const int16_t in_raw[3], mathQ30 in_scale);
+
+// quaternion functions
+void mathQuaternionQ30SetIdentity(mathQuaternionQ30* out_quaternion);
+void mathQuaternionQ30FromFloat(mathQuaternionQ30* out_quaternion, float in_w, float in_x, float in_y, float in_z);
+void mathQuaternionQ30Multiply(mathQuaternionQ30* out_quaternion, const mathQuaternionQ30* in_a, const mathQuaternionQ30* in_b);
+void mathQuaternionQ30Normalize(mathQuaternionQ30* inout_quaternion);
+void mathQuaternionQ30Integrate(mathQuaternionQ30* inout_quaternion, const mathVector3Q16* in_angular_rate, uint32_t in_dt_us);
+
+#endif
@@ -0,0 +1,248 @@
+/*****************************************************************************/
+/* Vector, quaternion and matrix math (single precision floating point)      */
+/*                                                                           */
+/* Copyright (C) 2016 Laszlo Arvai                                           */
+/* All rights reserved.                                                      */
+/*                                                                           */
+/* This software may be modified and distributed under the terms             */
+/* of the GNU General Public License.  See the LICENSE file for details.     */
+/*****************************************************************************/
+
+#ifndef __mathVector_h
+#define __mathVector_h
+
+/*****************************************************************************/
+/* Includes                                                                  */
+/*****************************************************************************/
+#include <sysTypes.h>
+#include <math.h>
+
+/*****************************************************************************/
+/* Constants                                                                 */
+/*****************************************************************************/
+
+/// Enables the SIMD implementation of the array conversion and quaternion multiplication. It uses the vector
+/// extension of GCC which is compiled to NEON instructions on ARM and SSE instructions on x86.
+#ifndef mathUSE_SIMD
+#if defined(__GNUC__) && !defined(__clang__) && (defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(__SSE2__))
+#define mathUSE_SIMD 1
+#else
+#define mathUSE_SIMD 0
+#endif
+#endif
+
+/// Absolute error bound of mathQuaternionMultiply for unit quaternions
+#define mathQUATERNION_MULTIPLY_ERROR 2.5e-7f
+
+/// Relative error bound of mathFastInverseSquareRoot
+#define mathFAST_INVERSE_SQUARE_ROOT_ERROR 5e-6f
+
+/// Relative error bound of mathPower when the absolute value of exponent * log2(base) is less than mathPOWER_RANGE
+/// (the error grows with the rounding error of exponent * log2(base) above this range)
+#define mathPOWER_ERROR 1e-6f
+#define mathPOWER_RANGE 8
+
+/*****************************************************************************/
+/* Types                                                                     */
+/*****************************************************************************/
+
+/// Three dimensional vector
+typedef struct
+{
+	float X;
+	float Y;
+	float Z;
+} mathVector3f;
+
+/// Quaternion (W is the scalar part)
+typedef struct
+{
+	float W;
+	float X;
+	float Y;
+	float Z;
+} mathQuaternionf;
+
+/// 3x3 matrix (row major order)
+typedef struct
+{
+	float M[3][3];
+} mathMatrix3f;
+
+/*****************************************************************************/
+/* Inline functions                                                          */
+/*****************************************************************************/
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Calculates 1/sqrt(x)
+/// @param in_value Input value (must be positive)
+/// @return Inverse square root
+sysINLINE float mathInverseSquareRoot(float in_value)
+{
+	return 1.0f / sqrtf(in_value);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Sets vector elements
+sysINLINE void mathVector3Set(mathVector3f* out_vector, float in_x, float in_y, float in_z)
+{
+	out_vector->X = in_x;
+	out_vector->Y = in_y;
+	out_vector->Z = in_z;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Calculates out = a + b
+sysINLINE void mathVector3Add(mathVector3f* out_vector, const mathVector3f* in_a, const mathVector3f* in_b)
+{
+	out_vector->X = in_a->X + in_b->X;
+	out_vector->Y = in_a->Y + in_b->Y;
+	out_vector->Z = in_a->Z + in_b->Z;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Calculates out = a - b
+sysINLINE void mathVector3Subtract(mathVector3f* out_vector, const mathVector3f* in_a, const mathVector3f* in_b)
+{
+	out_vector->X = in_a->X - in_b->X;
+	out_vector->Y = in_a->Y - in_b->Y;
+	out_vector->Z = in_a->Z - in_b->Z;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Calculates out = a * scale
+sysINLINE void mathVector3Scale(mathVector3f* out_vector, const mathVector3f* in_a, float in_scale)
+{
+	out_vector->X = in_a->X * in_scale;
+	out_vector->Y = in_a->Y * in_scale;
+	out_vector->Z = in_a->Z * in_scale;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Calculates out = out + a * scale
+sysINLINE void mathVector3AddScaled(mathVector3f* inout_vector, const mathVector3f* in_a, float in_scale)
+{
+	inout_vector->X += in_a->X * in_scale;
+	inout_vector->Y += in_a->Y * in_scale;
+	inout_vector->Z += in_a->Z * in_scale;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Returns the dot product of two vectors
+sysINLINE float mathVector3Dot(const mathVector3f* in_a, const mathVector3f* in_b)
+{
+	return in_a->X * in_b->X + in_a->Y * in_b->Y + in_a->Z * in_b->Z;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Calculates out = a x b (out must not be the same as any of the inputs)
+sysINLINE void mathVector3Cross(mathVector3f* out_vector, const mathVector3f* in_a, const mathVector3f* in_b)
+{
+	out_vector->X = in_a->Y * in_b->Z - in_a->Z * in_b->Y;
+	out_vector->Y = in_a->Z * in_b->X - in_a->X * in_b->Z;
+	out_vector->Z = in_a->X * in_b->Y - in_a->Y * in_b->X;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Converts raw sensor reading to physical units
+/// @param out_vector Converted vector
+/// @param in_raw Raw X, Y, Z values
+/// @param in_scale Resolution of the raw values
+sysINLINE void mathVector3FromInt16(mathVector3f* out_vector, const int16_t in_raw[3], float in_scale)
+{
+	out_vector->X = in_raw[0] * in_scale;
+	out_vector->Y = in_raw[1] * in_scale;
+	out_vector->Z = in_raw[2] * in_scale;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Sets quaternion to identity (no rotation)
+sysINLINE void mathQuaternionSetIdentity(mathQuaternionf* out_quaternion)
+{
+	out_quaternion->W = 1.0f;
+	out_quaternion->X = 0.0f;
+	out_quaternion->Y = 0.0f;
+	out_quaternion->Z = 0.0f;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Calculates conjugate (inverse rotation of a unit quaternion)
+sysINLINE void mathQuaternionConjugate(mathQuaternionf* out_quaternion, const mathQuaternionf* in_quaternion)
+{
+	out_quaternion->W = in_quaternion->W;
+	out_quaternion->X = -in_quaternion->X;
+	out_quaternion->Y = -in_quaternion->Y;
+	out_quaternion->Z = -in_quaternion->Z;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Calculates the direction of the earth Z axis (gravity) in body frame
+/// @param out_gravity Unit gravity vector in body frame
+/// @param in_quaternion Attitude (body to earth frame)
+sysINLINE void mathQuaternionGetGravity(mathVector3f* out_gravity, const mathQuaternionf* in_quaternion)
+{
+	out_gravity->X = 2.0f * (in_quaternion->X * in_quaternion->Z - in_quaternion->W * in_quaternion->Y);
+	out_gravity->Y = 2.0f * (in_quaternion->W * in_quaternion->X + in_quaternion->Y * in_quaternion->Z);
+	out_gravity->Z = in_quaternion->W * in_quaternion->W - in_quaternion->X * in_quaternion->X - in_quaternion->Y * in_quaternion->Y + in_quaternion->Z * in_quaternion->Z;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Integrates angular rate (first order) and normalizes the result. It is inline and scalar
+/// because it is on the critical path of the attitude update: passing the values through memory to a
+/// function or a SIMD register costs more than the calculation itself.
+/// @param inout_quaternion Attitude (body to earth frame)
+/// @param in_angular_rate Angular rate in body frame [rad/s]
+/// @param in_dt Integration time [s]
+sysINLINE void mathQuaternionIntegrate(mathQuaternionf* inout_quaternion, const mathVector3f* in_angular_rate, float in_dt)
+{
+	float half_dt = 0.5f * in_dt;
+	float gx, gy, gz;
+	float w, x, y, z;
+	float norm;
+
+	// rotation during the half time step
+	gx = in_angular_rate->X * half_dt;
+	gy = in_angular_rate->Y * half_dt;
+	gz = in_angular_rate->Z * half_dt;
+
+	// the new values are kept in registers until the normalization is done
+	w = inout_quaternion->W - inout_quaternion->X * gx - inout_quaternion->Y * gy - inout_quaternion->Z * gz;
+	x = inout_quaternion->X + inout_quaternion->W * gx + inout_quaternion->Y * gz - inout_quaternion->Z * gy;
+	y = inout_quaternion->Y + inout_quaternion->W * gy - inout_quaternion->X * gz + inout_quaternion->Z * gx;
+	z = inout_quaternion->Z + inout_quaternion->W * gz + inout_quaternion->X * gy - inout_quaternion->Y * gx;
+
+	norm = mathInverseSquareRoot(w * w + x * x + y * y + z * z);
+
+	inout_quaternion->W = w * norm;
+	inout_quaternion->X = x * norm;
+	inout_quaternion->Y = y * norm;
+	inout_quaternion->Z = z * norm;
+}
+
+/*****************************************************************************/
+/* Function prototypes                                                       */
+/*****************************************************************************/
+
+// scalar functions
+float mathFastInverseSquareRoot(float in_value);
+float mathPower(float in_base, float in_exponent);
+
+// vector functions
+float mathVector3Length(const mathVector3f* in_vector);
+bool mathVector3Normalize(mathVector3f* inout_vector);
+void mathConvertInt16Array(float* out_values, const int16_t* in_raw, uint16_t in_count, float in_scale);
+
+// quaternion functions
+void mathQuaternionMultiply(mathQuaternionf* out_quaternion, const mathQuaternionf* in_a, const mathQuaternionf* in_b);
+void mathQuaternionNormalize(mathQuaternionf* inout_quaternion);
+void mathQuaternionRotate(mathVector3f* out_vector, const mathQuaternionf* in_quaternion, const mathVector3f* in_vector);
+void mathQuaternionFromEulerAngles(mathQuaternionf* out_quaternion, float in_roll, float in_pitch, float in_yaw);
+void mathQuaternionToEulerAngles(const mathQuaternionf* in_quaternion, float* out_roll, float* out_pitch, float* out_yaw);
+void mathQuaternionToMatrix(mathMatrix3f* out_matrix, const mathQuaternionf* in_quaternion);
+
+// matrix functions
+void mathMatrix3MultiplyVector(mathVector3f* out_vector, const mathMatrix3f* in_matrix, const mathVector3f* in_vector);
+void mathMatrix3Multiply(mathMatrix3f* out_matrix, const mathMatrix3f* in_a, const mathMatrix3f* in_b);
+void mathMatrix3Transpose(mathMatrix3f* out_matrix, const mathMatrix3f* in_matrix);
+
+#endif
@@ -15,34 +15,83 @@
 /* Includes                                                                  */
 /*****************************************************************************/
 #include <sysTypes.h>
+#include <comSystemPacketDefinitions.h>
 
 /*****************************************************************************/
 /* Constants                                                                 */
 /*****************************************************************************/
 #define roxSTORAGE_INVALID_OBJECT_INDEX 0xffff
+#define roxTOTAL_STORAGE_SIZE 1024
+
+// storage size reserved for one object (roxTOTAL_OBJECT_COUNT is defined in comSystemPacketDefinitions.h)
+#define roxOBJECT_SIZE (roxTOTAL_STORAGE_SIZE / roxTOTAL_OBJECT_COUNT)
 
 /*****************************************************************************/
 /* Types                                                                     */
 /*****************************************************************************/
 typedef uint16_t roxObjectIndex;
 typedef uint16_t roxMemberAddress; 
+typedef uint32_t roxObjectVersion;
 typedef void(*roxObjectChangedCallbackFunction)(roxObjectIndex in_object_index);
 
+/// Object change callback subscription (storage is provided by the subscriber)
+typedef struct _roxCallbackSubscription
+{
+	roxObjectChangedCallbackFunction Callback;
+	struct _roxCallbackSubscription* Next;
+} roxCallbackSubscription;
+
+/// Change notification statistics
+typedef struct
+{
+	uint32_t NotificationCount;						// number of dispatched change notifications
+	uint32_t CoalescedNotificationCount;	// number of changes merged into an already pending notification
+	uint16_t MaxQueueLength;							// maximum number of objects waiting for notification
+} roxStorageStatistics;
+
 /*****************************************************************************/
 /* Function prototypes                                                       */
 /*****************************************************************************/
 void roxStorageInitialize(void);
+void roxStorageTaskStop(void);
+void roxGetStorageStatistics(roxStorageStatistics* out_statistics);
+
+void roxCallbackSubscribe(roxObjectIndex in_object_index, roxCallbackSubscription* in_subscription, roxObjectChangedCallbackFunction in_callback_function);
+void roxCallbackUnsubscribe(roxObjectIndex in_object_index, roxCallbackSubscription* in_subscription);
 void roxCallbackFunctionAdd(roxObjectIndex in_object_index, roxObjectChangedCallbackFunction in_callback_function);
 void roxCallbackFunctionDelete(roxObjectChangedCallbackFunction in_callback_function, roxObjectIndex in_object_index);
 
-void roxObjectReadBegin(roxObjectIndex in_object_index);
-void roxObjectReadEnd(roxObjectIndex in_object_index);
+roxObjectVersion roxObjectReadBegin(roxObjectIndex in_object_index);
+bool roxObjectReadEnd(roxObjectIndex in_object_index, roxObjectVersion in_version);
+
+uint16_t roxGetObjectSize(roxObjectIndex in_object_index);
+void roxObjectCopy(roxObjectIndex in_object_index, uint8_t* out_buffer);
 
 bool roxObjectWriteBegin(roxObjectIndex in_object_index);
 void roxObjectWriteEnd(roxObjectIndex in_object_index);
+bool roxObjectWrite(roxObjectIndex in_object_index, const uint8_t* in_buffer);
 
+uint8_t roxGetUInt8(roxObjectIndex in_object_index, roxMemberAddress in_member_address);
+int8_t roxGetInt8(roxObjectIndex in_object_index, roxMemberAddress in_member_address);
+uint16_t roxGetUInt16(roxObjectIndex in_object_index, roxMemberAddress in_member_address);
+int16_t roxGetInt16(roxObjectIndex in_object_index, roxMemberAddress in_member_address);
+uint32_t roxGetUInt32(roxObjectIndex in_object_index, roxMemberAddress in_member_address);
+int32_t roxGetInt32(roxObjectIndex in_object_index, roxMemberAddress in_member_address);
+uint64_t roxGetUInt64(roxObjectIndex in_object_index, roxMemberAddress in_member_address);
+int64_t roxGetInt64(roxObjectIndex in_object_index, roxMemberAddress in_member_address);
 float roxGetFloat(roxObjectIndex in_object_index, roxMemberAddress in_member_address);
-bool roxSetFloat(roxObjectIndex in_object_address, roxMemberAddress in_member_address, float in_value);
+double roxGetDouble(roxObjectIndex in_object_index, roxMemberAddress in_member_address);
+
+bool roxSetUInt8(roxObjectIndex in_object_index, roxMemberAddress in_member_address, uint8_t in_value);
+bool roxSetInt8(roxObjectIndex in_object_index, roxMemberAddress in_member_address, int8_t in_value);
+bool roxSetUInt16(roxObjectIndex in_object_index, roxMemberAddress in_member_address, uint16_t in_value);
+bool roxSetInt16(roxObjectIndex in_object_index, roxMemberAddress in_member_address, int16_t in_value);
+bool roxSetUInt32(roxObjectIndex in_object_index, roxMemberAddress in_member_address, uint32_t in_value);
+bool roxSetInt32(roxObjectIndex in_object_index, roxMemberAddress in_member_address, int32_t in_value);
+bool roxSetUInt64(roxObjectIndex in_object_index, roxMemberAddress in_member_address, uint64_t in_value);
+bool roxSetInt64(roxObjectIndex in_object_index, roxMemberAddress in_member_address, int64_t in_value);
+bool roxSetFloat(roxObjectIndex in_object_index, roxMemberAddress in_member_address, float in_value);
+bool roxSetDouble(roxObjectIndex in_object_index, roxMemberAddress in_member_address, double in_value);
 
 
 
@@ -17,11 +17,41 @@
 #include <sysTypes.h>
 #include <roxStorage.h>
 
+/*****************************************************************************/
+/* Constants                                                                 */
+/*****************************************************************************/
+
+// bandwidth available for the telemetry on every link [byte/s]
+#ifndef roxTELEMETRY_LINK_BANDWIDTH
+#define roxTELEMETRY_LINK_BANDWIDTH 4096
+#endif
+
+// maximum number of bytes can be sent in one burst
+#ifndef roxTELEMETRY_LINK_BURST_SIZE
+#define roxTELEMETRY_LINK_BURST_SIZE 512
+#endif
+
+/*****************************************************************************/
+/* Types                                                                     */
+/*****************************************************************************/
+
+/// Telemetry transmission statistics
+typedef struct
+{
+	uint32_t TransmittedObjectCount;		// number of transmitted object packets
+	uint32_t TransmittedByteCount;			// number of transmitted bytes (including packet header and CRC)
+	uint32_t CoalescedChangeCount;			// number of changes merged into an already scheduled transmission
+	uint32_t BandwidthLimitedCount;			// number of times the transmission was delayed by the bandwidth limit
+	uint32_t QueueFullCount;						// number of times the transmitter queue was full
+} roxTelemetryStatistics;
+
 /*****************************************************************************/
 /* Function prototypes                                                       */
 /*****************************************************************************/
 void roxTelemetryInitialize(void);
 void roxTelemetryTaskStop(void);
+void roxTelemetrySetObjectParameters(roxObjectIndex in_object_index, uint16_t in_minimum_period, uint8_t in_priority);
 void roxTelemetrySetObjectChanged(roxObjectIndex in_object_index);
+void roxTelemetryGetStatistics(roxTelemetryStatistics* out_statistics);
 
 #endif
\ No newline at end of file
@@ -21,6 +21,9 @@
 /*****************************************************************************/
 typedef uint32_t sysHighresTimestamp;
 
+/// One shot timer callback (called from interrupt)
+typedef void (*sysHighresTimerCallbackFunction)(void* in_interrupt_param);
+
 /*****************************************************************************/
 /* Function prototypes                                                       */
 /*****************************************************************************/
@@ -29,4 +32,8 @@ sysHighresTimestamp sysHighresTimerGetTimestamp(void);
 void sysHighresTimerDelay(uint32_t in_delay_us);
 sysHighresTimestamp sysHighresTimerGetTimeSince(sysHighresTimestamp in_start_time);
 
+// one shot timer callback (implemented in the HAL)
+void sysHighresTimerStartCallback(sysHighresTimestamp in_expiration_time, sysHighresTimerCallbackFunction in_callback);
+void sysHighresTimerStopCallback(void);
+
 #endif
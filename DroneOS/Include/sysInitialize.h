@@ -29,5 +29,7 @@ extern HANDLE g_system_is_running_event;
 void sysCreateTasks(void);
 void sysInitialize(void);
 void sysShutdown(void);
+void sysPrintStatistics(void);
+bool sysRunCheck(const char* in_name);
 
 #endif
@@ -31,6 +31,7 @@ void sysDelay(uint32_t in_delay_in_ms);
 
 #define sysMemZero(dst, siz)  memset(dst, 0, siz)
 #define sysMemCopy(dst, src, siz) memcpy(dst, src, siz)
+#define sysMemCompare(buf1, buf2, siz) memcmp(buf1, buf2, siz)
 
 /*****************************************************************************/
 /* RTOS dependent function prototypes                                        */
@@ -33,6 +33,10 @@ uint32_t sysGetSystemTick(void);
 #define sysCriticalSectionBegin() vPortEnterCritical()
 #define sysCriticalSectionEnd() vPortExitCritical()
 
+// critical section which can be used from both interrupt and task context (only once per block)
+#define sysCriticalSectionBeginFromISR() UBaseType_t sysCriticalSectionSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR()
+#define sysCriticalSectionEndFromISR() taskEXIT_CRITICAL_FROM_ISR(sysCriticalSectionSavedInterruptStatus)
+
 #define sysASSERT(x) configASSERT(x)
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -79,5 +83,7 @@ typedef TaskHandle_t sysTaskNotify;
 
 
 #define sysNOP() asm("nop")
+#define sysMemoryBarrier() asm volatile ("dmb" ::: "memory")
+#define sysAtomicCompareAndSwap(ptr, old_value, new_value) __sync_bool_compare_and_swap(ptr, old_value, new_value)
 
 
@@ -37,7 +37,6 @@ typedef sysTaskRetval (*sysTaskFunction)(sysTaskParam);
 //CreateThread(0, stacksize, (LPTHREAD_START_ROUTINE)taskfunc, param, 0, handle, stopfunction)
 uint32_t sysLinuxTaskCreate(sysTaskFunction in_task_code, const char* const in_task_name, uint16_t in_stack_size, void *in_parameters, uint8_t in_priority, sysTask* out_thread_handle, sysTaskStopFunction in_stop_function);
 void sysAddThreadStopFunction(sysTaskStopFunction in_stop_function);
-static void sysMillisecToTimespec(unsigned long in_ms, struct timespec *out_ts);
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -51,6 +50,10 @@ static void sysMillisecToTimespec(unsigned long in_ms, struct timespec *out_ts);
 void sysCriticalSectionBegin(void);
 void sysCriticalSectionEnd(void);
 
+// critical section which can be used from both interrupt and task context
+#define sysCriticalSectionBeginFromISR() sysCriticalSectionBegin()
+#define sysCriticalSectionEndFromISR() sysCriticalSectionEnd()
+
 #define sysASSERT(x) assert(x)
 
 void sysDebugPrint(const char *fmt, ...);
@@ -80,7 +83,7 @@ bool pthread_mutex_take(sysMutex* in_mutex, uint32_t in_timeout);
 typedef pthread_binsem_t sysBinarySemaphore;
 void pthread_binsem_init(pthread_binsem_t* in_binary_semaphore, int in_init_value);
 void pthread_binsem_destroy(pthread_binsem_t* in_binary_semaphore);
-void pthread_binsem_lock(pthread_binsem_t* in_binary_semaphore, uint32_t in_timeout);
+bool pthread_binsem_lock(pthread_binsem_t* in_binary_semaphore, uint32_t in_timeout);
 void pthread_binsem_unlock(pthread_binsem_t* in_binary_semaphore);
 
 
@@ -97,11 +100,13 @@ typedef pthread_binsem_t sysTaskNotify;
 #define sysTaskNotifyDelete(x) pthread_binsem_destroy(&x)
 #define sysTaskNotifyTake(x,t) pthread_binsem_lock(&x ,t)
 #define sysTaskNotifyGive(x) pthread_binsem_unlock(&x)
-#define sysTaskNotifyGiveFromISR(x, interrupt_param) { pthread_binsem_unlock(&x); (void*)(interrupt_param); }
+#define sysTaskNotifyGiveFromISR(x, interrupt_param) { pthread_binsem_unlock(&x); (void)(interrupt_param); }
 
 #define sysBeginInterruptRoutine() 
 #define sysEndInterruptRoutine() 
 #define sysInterruptParam() sysNULL
 
 #define sysNOP() asm("nop")
+#define sysMemoryBarrier() __sync_synchronize()
+#define sysAtomicCompareAndSwap(ptr, old_value, new_value) __sync_bool_compare_and_swap(ptr, old_value, new_value)
 
@@ -42,6 +42,10 @@ void sysAddThreadStopFunction(sysTaskStopFunction in_stop_function);
 void sysCriticalSectionBegin(void);
 void sysCriticalSectionEnd(void);
 
+// critical section which can be used from both interrupt and task context
+#define sysCriticalSectionBeginFromISR() sysCriticalSectionBegin()
+#define sysCriticalSectionEndFromISR() sysCriticalSectionEnd()
+
 #define sysASSERT(x) assert(x)
 
 void sysDebugPrint(const char *fmt, ...);
@@ -82,5 +86,7 @@ typedef HANDLE sysTaskNotify;
 
 
 #define sysNOP() asm("nop")
+#define sysMemoryBarrier() MemoryBarrier()
+#define sysAtomicCompareAndSwap(ptr, old_value, new_value) (InterlockedCompareExchange((volatile LONG*)(ptr), (LONG)(new_value), (LONG)(old_value)) == (LONG)(old_value))
 
 
@@ -46,4 +46,15 @@ typedef uint32_t sysSize;
 
 #define sysUNUSED(x) (void)(x)
 
+// compile time assertion (expression must be constant, can be used only once per line)
+#define sysSTATIC_ASSERT(x) typedef char ___sysSTATIC_ASSERT_NAME(__LINE__)[(x) ? 1 : -1]
+#define ___sysSTATIC_ASSERT_NAME(line) ___sysSTATIC_ASSERT_NAME2(line)
+#define ___sysSTATIC_ASSERT_NAME2(line) sysStaticAssert_##line
+
+#ifdef _MSC_VER
+#define sysINLINE static __inline
+#else
+#define sysINLINE static inline
+#endif
+
 #endif
@@ -13,16 +13,35 @@
 /*****************************************************************************/
 #include <sysRTOS.h>
 #include <crcMD5.h>
+#include <crcCITT16.h>
 #include <drvEEPROM.h>
+#include <sysHighresTimer.h>
 #include <fileSystemFiles.h>
 #include <cfgStorage.h>
 #include <comSystemPacketDefinitions.h>
 #include "cfgConstants.h"
+#include "cfgValueLayout.h"
 
 /*****************************************************************************/
 /* Const                                                                     */
 /*****************************************************************************/
-#define cfg_STORAGE_COUNT 2
+// number of configuration slots in the EEPROM (configuration is saved into the slots in rotating order)
+#ifndef cfg_STORAGE_SLOT_COUNT
+#define cfg_STORAGE_SLOT_COUNT 2
+#endif
+
+// EEPROM page size (slots are page aligned, only changed pages are written)
+#ifndef cfg_STORAGE_PAGE_SIZE
+#define cfg_STORAGE_PAGE_SIZE 32
+#endif
+
+// size of the EEPROM
+#ifndef cfg_STORAGE_EEPROM_SIZE
+#define cfg_STORAGE_EEPROM_SIZE 2048
+#endif
+
+#define cfg_STORAGE_SLOT_LENGTH (sizeof(cfgConfigurationDataHeader) + cfg_VALUE_DATA_FILE_LENGTH)
+#define cfg_STORAGE_SLOT_SIZE (((cfg_STORAGE_SLOT_LENGTH + cfg_STORAGE_PAGE_SIZE - 1) / cfg_STORAGE_PAGE_SIZE) * cfg_STORAGE_PAGE_SIZE)
 
 // configuration value types
 #define cfg_VT_UINT8 1
@@ -43,14 +62,39 @@
 
 #define cfg_VT_STRING 13
 
+// value sizes of the typed readers (length of the strings is not checked)
+#define cfg_LAYOUT_SIZE_UInt8 1
+#define cfg_LAYOUT_SIZE_Int8 1
+#define cfg_LAYOUT_SIZE_UInt16 2
+#define cfg_LAYOUT_SIZE_Int16 2
+#define cfg_LAYOUT_SIZE_UInt32 4
+#define cfg_LAYOUT_SIZE_Int32 4
+#define cfg_LAYOUT_SIZE_Float 4
+#define cfg_LAYOUT_SIZE_String 0
+
+#define cfg_LAYOUT_SIZE(type) cfg_LAYOUT_SIZE_BY_NAME(type)
+#define cfg_LAYOUT_SIZE_BY_NAME(type) cfg_LAYOUT_SIZE_##type
+#define cfg_LAYOUT_ENTRY(name) { cfgVAL_##name, cfgOFS_##name, cfg_LAYOUT_SIZE(cfgTYP_##name) },
+
 /*****************************************************************************/
 /* Types                                                                     */
 /*****************************************************************************/
+
+// Value layout entry (cfgValueLayout.h)
+typedef struct
+{
+	uint16_t Index;		// value index
+	uint16_t Offset;	// value position in the value data file
+	uint8_t Size;			// size of the value read by the typed accessor (0 for strings)
+} cfgValueLayoutEntry;
+
 #include <sysPackedStructStart.h>
 typedef struct
 {
-	uint16_t Length;
-	uint8_t Hash[crcMD5_HASH_SIZE];
+	uint16_t Length;									// length of the value data
+	uint8_t Hash[crcMD5_HASH_SIZE];		// MD5 hash of the configuration XML file
+	uint32_t Sequence;								// save sequence number (the slot with the highest number is the latest)
+	uint16_t DataCRC;									// CRC of the value data
 } cfgConfigurationDataHeader;
 
 // Value information struct. Used in 'ConfigurationValueInfo' file.
@@ -63,19 +107,45 @@ typedef struct
 
 #include <sysPackedStructEnd.h>
 
+// all configuration slots must fit into the EEPROM
+sysSTATIC_ASSERT(cfg_STORAGE_SLOT_COUNT * cfg_STORAGE_SLOT_SIZE <= cfg_STORAGE_EEPROM_SIZE);
+
+/*****************************************************************************/
+/* Global variables                                                          */
+/*****************************************************************************/
+uint8_t g_cfg_value_data[cfg_STORAGE_COUNT][cfg_VALUE_DATA_FILE_LENGTH]; // value data buffers (primary and secondary)
+uint8_t g_cfg_value_storage_index[cfg_VALUE_COUNT]; // index of the buffer containing the actual value
+
+// hand-written value layout of the typed accessors, it must follow the generated configuration constants
+static const cfgValueLayoutEntry l_value_layout[] = { cfgVALUE_LAYOUT(cfg_LAYOUT_ENTRY) };
+
+sysSTATIC_ASSERT(sizeof(l_value_layout) / sizeof(cfgValueLayoutEntry) == cfg_VALUE_COUNT);
+sysSTATIC_ASSERT(cfgVALUE_LAYOUT_DATA_FILE_LENGTH == cfg_VALUE_DATA_FILE_LENGTH);
+
 /*****************************************************************************/
 /* Module local variables                                                    */
 /*****************************************************************************/
-static uint8_t l_configuration_data_primary[cfg_VALUE_DATA_FILE_LENGTH];
-static uint8_t l_configuration_data_secondary[cfg_VALUE_DATA_FILE_LENGTH];
-static uint8_t l_config_storage_index[cfg_VALUE_COUNT];
+static cfgChangedCallback l_changed_callbacks[cfg_CHANGED_CALLBACK_COUNT];
 static cfgConfigurationValueInfo* l_configuration_value_info;
+static uint32_t l_value_data_change_counter = 0;
+static uint16_t l_value_data_first_changed_pos = 0;
+static uint8_t l_storage_image[cfg_STORAGE_SLOT_LENGTH];
+static uint8_t l_storage_page_buffer[cfg_STORAGE_PAGE_SIZE];
+static uint8_t l_storage_slot = 0;
+static uint32_t l_storage_sequence = 0;
+static bool l_storage_slot_valid = false;
+static cfgStorageStatistics l_storage_statistics;
 
 /*****************************************************************************/
 /* Module local functions                                                    */
 /*****************************************************************************/
 static void cfgActualizePrimaryBuffer(void);
 static uint16_t cfgGetValueIndexFromPos(uint16_t in_pos);
+static void cfgValueDataChanged(uint16_t in_pos);
+static void cfgGetXMLHash(crcMD5Hash* out_hash);
+static bool cfgIsSlotEqual(uint8_t in_slot);
+static bool cfgWriteSlot(uint8_t in_slot);
+static bool cfgWriteChangedPage(uint16_t in_address, uint8_t* in_buffer, uint16_t in_length);
 
 /*****************************************************************************/
 /* Function implementation                                                   */
@@ -89,41 +159,66 @@ void cfgStorageInit(void)
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-/// @brief Loads configration from external storage (EEPROM)
+/// @brief Loads configration from external storage (EEPROM). The latest valid configuration slot is loaded.
 void cfgLoadConfiguration(void)
 {
 	cfgConfigurationDataHeader settings_header;
-	uint8_t xml_file_id;
-	uint32_t xml_file_length;
 	crcMD5Hash xml_file_hash;
-	crcMD5State md5_state;
+	sysHighresTimestamp start_time;
 	uint16_t value_index;
+	uint8_t slot;
+	bool found;
+
+	start_time = sysHighresTimerGetTimestamp();
 
 	// move config settings to the primary buffer
 	cfgActualizePrimaryBuffer();
 		
 	// get xml file information
-	xml_file_id = fileSystemFileGetIndex("ConfigurationXML");
-	xml_file_length = fileSystemFileGetLength(xml_file_id);
-	crcMD5Open(&md5_state);
-	crcMD5Update(&md5_state, fileSystemFileGetContent(xml_file_id), xml_file_length);
-	crcMD5Close(&md5_state, &xml_file_hash);
+	cfgGetXMLHash(&xml_file_hash);
 
-	// load settings header
-	drvEEPROMReadBlock(0, (uint8_t*)&settings_header, sizeof(cfgConfigurationDataHeader));
+	// find the latest valid slot
+	found = false;
+	for (slot = 0; slot < cfg_STORAGE_SLOT_COUNT; slot++)
+	{
+		// load settings header
+		drvEEPROMReadBlock(slot * cfg_STORAGE_SLOT_SIZE, (uint8_t*)&settings_header, sizeof(cfgConfigurationDataHeader));
+
+		// check settings validity
+		if (settings_header.Length != cfg_VALUE_DATA_FILE_LENGTH || !crcMD5IsEqual(&xml_file_hash, (crcMD5Hash*)&settings_header.Hash))
+			continue;
+
+		if (found && (int32_t)(settings_header.Sequence - l_storage_sequence) <= 0)
+			continue;
+
+		// check data validity (slot write might be interrupted)
+		drvEEPROMReadBlock(slot * cfg_STORAGE_SLOT_SIZE + sizeof(cfgConfigurationDataHeader), g_cfg_value_data[1], cfg_VALUE_DATA_FILE_LENGTH);
+
+		if (crc16CalculateForBlock(crc16_INIT_VALUE, g_cfg_value_data[1], cfg_VALUE_DATA_FILE_LENGTH) != settings_header.DataCRC)
+			continue;
+
+		found = true;
+		l_storage_slot = slot;
+		l_storage_sequence = settings_header.Sequence;
+	}
+
+	l_storage_slot_valid = found;
 
-	// check settings validity
-	if (settings_header.Length == cfg_VALUE_DATA_FILE_LENGTH && crcMD5IsEqual(&xml_file_hash, (crcMD5Hash*)&settings_header.Hash))
+	if (found)
 	{
 		// settings seems to be ok -> load settings
-		drvEEPROMReadBlock(sizeof(cfgConfigurationDataHeader), (uint8_t*)&l_configuration_data_secondary, cfg_VALUE_DATA_FILE_LENGTH);
+		drvEEPROMReadBlock(l_storage_slot * cfg_STORAGE_SLOT_SIZE + sizeof(cfgConfigurationDataHeader), g_cfg_value_data[1], cfg_VALUE_DATA_FILE_LENGTH);
 
 		// actualize secondary buffer
 		for (value_index = 0; value_index < cfg_VALUE_COUNT; value_index++)
 		{
-			l_config_storage_index[value_index] = 1;
+			g_cfg_value_storage_index[value_index] = 1;
 		}
+
+		cfgValueDataChanged(0);
 	}
+
+	l_storage_statistics.LastLoadTime = sysHighresTimerGetTimeSince(start_time);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -131,15 +226,25 @@ void cfgLoadConfiguration(void)
 void cfgLoadDefaultConfiguration(void)
 {
 	uint8_t file_id;
+	uint16_t i;
 
 	// get default settings file
 	file_id = fileSystemFileGetIndex("DefaultConfigurationData");
-	sysMemCopy(l_configuration_data_primary, fileSystemFileGetContent(file_id), cfg_VALUE_DATA_FILE_LENGTH);
-	sysMemZero(l_config_storage_index, sizeof(l_config_storage_index));
+	sysMemCopy(g_cfg_value_data[0], fileSystemFileGetContent(file_id), cfg_VALUE_DATA_FILE_LENGTH);
+	sysMemZero(g_cfg_value_storage_index, sizeof(g_cfg_value_storage_index));
 
 	// get value info file
 	file_id = fileSystemFileGetIndex("ConfigurationValueInfo");
 	l_configuration_value_info = (cfgConfigurationValueInfo*)fileSystemFileGetContent(file_id);
+
+	// offsets and sizes of the typed accessors must match the value info file
+	for (i = 0; i < sizeof(l_value_layout) / sizeof(cfgValueLayoutEntry); i++)
+	{
+		sysASSERT(l_configuration_value_info[l_value_layout[i].Index].Offset == l_value_layout[i].Offset);
+		sysASSERT(l_value_layout[i].Size == 0 || l_configuration_value_info[l_value_layout[i].Index].Size == l_value_layout[i].Size);
+	}
+
+	cfgValueDataChanged(0);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -150,41 +255,182 @@ static void cfgActualizePrimaryBuffer(void)
 
 	for (value_index = 0; value_index < cfg_VALUE_COUNT; value_index++)
 	{
-		if (l_config_storage_index[value_index] != 0)
+		if (g_cfg_value_storage_index[value_index] != 0)
 		{
 			// copy config value from the secondary buffer to the primary
-			sysMemCopy(&l_configuration_data_primary[l_configuration_value_info[value_index].Offset], &l_configuration_data_secondary[l_configuration_value_info[value_index].Offset], l_configuration_value_info[value_index].Size);
-			l_config_storage_index[value_index] = 0; // actualize primary buffer
+			sysMemCopy(&g_cfg_value_data[0][l_configuration_value_info[value_index].Offset], &g_cfg_value_data[1][l_configuration_value_info[value_index].Offset], l_configuration_value_info[value_index].Size);
+			g_cfg_value_storage_index[value_index] = 0; // actualize primary buffer
 		}
 	}
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-/// @brief Saves current configuration into external storage (EEPROM)
+/// @brief Saves current configuration into external storage (EEPROM). Configuration is written into the next slot
+/// (header page is written last) therefore the previous configuration remains valid when the write is interrupted.
+/// Only pages which differ from the current slot content are written.
 void cfgSaveConfiguration(void)
 {
-	cfgConfigurationDataHeader settings_header;
-	uint8_t xml_file_id;
-	uint32_t xml_file_length;
-	crcMD5State md5_state;
+	cfgConfigurationDataHeader* settings_header = (cfgConfigurationDataHeader*)l_storage_image;
+	sysHighresTimestamp start_time;
+	uint8_t slot;
+
+	start_time = sysHighresTimerGetTimestamp();
 
 	// move config data to the primary buffer
 	cfgActualizePrimaryBuffer();
 
-	// prepare configuration header
-	xml_file_id = fileSystemFileGetIndex("ConfigurationXML");
-	xml_file_length = fileSystemFileGetLength(xml_file_id);
-	crcMD5Open(&md5_state);
-	crcMD5Update(&md5_state, fileSystemFileGetContent(xml_file_id), xml_file_length);
-	crcMD5Close(&md5_state,(crcMD5Hash*)&settings_header.Hash);
+	// prepare configuration header and data
+	cfgGetXMLHash((crcMD5Hash*)&settings_header->Hash);
+	settings_header->Length = cfg_VALUE_DATA_FILE_LENGTH;
+	settings_header->Sequence = l_storage_sequence;
+	settings_header->DataCRC = crc16CalculateForBlock(crc16_INIT_VALUE, g_cfg_value_data[0], cfg_VALUE_DATA_FILE_LENGTH);
+	sysMemCopy(&l_storage_image[sizeof(cfgConfigurationDataHeader)], g_cfg_value_data[0], cfg_VALUE_DATA_FILE_LENGTH);
 
-	settings_header.Length = cfg_VALUE_DATA_FILE_LENGTH;
+	// nothing to write if the configuration is already stored
+	if (!l_storage_slot_valid || !cfgIsSlotEqual(l_storage_slot))
+	{
+		// write configuration into the next slot
+		if (l_storage_slot_valid)
+		{
+			slot = (l_storage_slot + 1) % cfg_STORAGE_SLOT_COUNT;
+			settings_header->Sequence = l_storage_sequence + 1;
+		}
+		else
+		{
+			slot = 0;
+		}
 
-	// write header
-	drvEEPROMWriteBlock(0, (uint8_t*)&settings_header, sizeof(cfgConfigurationDataHeader));
+		// the current slot remains the latest one if the write fails
+		if (cfgWriteSlot(slot))
+		{
+			l_storage_slot = slot;
+			l_storage_sequence = settings_header->Sequence;
+			l_storage_slot_valid = true;
+		}
+	}
 
-	// write data
-	drvEEPROMWriteBlock(sizeof(cfgConfigurationDataHeader), l_configuration_data_primary, cfg_VALUE_DATA_FILE_LENGTH);
+	// update statistics
+	l_storage_statistics.SaveCount++;
+	l_storage_statistics.LastSaveTime = sysHighresTimerGetTimeSince(start_time);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Registers callback function which is called when configuration values are changed (loaded or written).
+/// Callback is called from the context of the modifying task therefore it must be short (e.g. refreshing cached values).
+/// @param in_callback Callback function to register
+/// @return True if callback was registered, false when there is no free callback slot
+bool cfgRegisterChangedCallback(cfgChangedCallback in_callback)
+{
+	uint8_t index;
+
+	for (index = 0; index < cfg_CHANGED_CALLBACK_COUNT; index++)
+	{
+		if (l_changed_callbacks[index] == sysNULL)
+		{
+			l_changed_callbacks[index] = in_callback;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Gets configuration storage statistics
+/// @param out_statistics Statistics structure will receive the current statistics
+void cfgGetStorageStatistics(cfgStorageStatistics* out_statistics)
+{
+	*out_statistics = l_storage_statistics;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Gets MD5 hash of the configuration XML file. The hash generated into cfgConstants.h is used when
+/// available, otherwise the hash is calculated by the file system (only once).
+/// @param out_hash Hash of the configuration XML
+static void cfgGetXMLHash(crcMD5Hash* out_hash)
+{
+#ifdef cfg_XML_DATA_FILE_HASH
+	static const crcMD5Hash xml_file_hash = { { cfg_XML_DATA_FILE_HASH } };
+
+	*out_hash = xml_file_hash;
+#else
+	fileSystemFileGetHash(fileSystemFileGetIndex("ConfigurationXML"), out_hash);
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Compares the content of the given slot with the storage image
+/// @param in_slot Slot index
+/// @return True if the slot content is the same as the storage image
+static bool cfgIsSlotEqual(uint8_t in_slot)
+{
+	uint16_t pos;
+	uint16_t length;
+
+	for (pos = 0; pos < cfg_STORAGE_SLOT_LENGTH; pos += cfg_STORAGE_PAGE_SIZE)
+	{
+		length = cfg_STORAGE_SLOT_LENGTH - pos;
+		if (length > cfg_STORAGE_PAGE_SIZE)
+			length = cfg_STORAGE_PAGE_SIZE;
+
+		drvEEPROMReadBlock(in_slot * cfg_STORAGE_SLOT_SIZE + pos, l_storage_page_buffer, length);
+
+		if (sysMemCompare(l_storage_page_buffer, &l_storage_image[pos], length) != 0)
+			return false;
+	}
+
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Writes storage image into the given slot. The first page (which contains the header) is written last.
+/// @param in_slot Slot index
+/// @return True if all pages were written successfully
+static bool cfgWriteSlot(uint8_t in_slot)
+{
+	uint16_t pos;
+	uint16_t length;
+
+	for (pos = cfg_STORAGE_PAGE_SIZE; pos < cfg_STORAGE_SLOT_LENGTH; pos += cfg_STORAGE_PAGE_SIZE)
+	{
+		length = cfg_STORAGE_SLOT_LENGTH - pos;
+		if (length > cfg_STORAGE_PAGE_SIZE)
+			length = cfg_STORAGE_PAGE_SIZE;
+
+		if (!cfgWriteChangedPage(in_slot * cfg_STORAGE_SLOT_SIZE + pos, &l_storage_image[pos], length))
+			return false;
+	}
+
+	// write header page
+	length = (cfg_STORAGE_SLOT_LENGTH < cfg_STORAGE_PAGE_SIZE) ? cfg_STORAGE_SLOT_LENGTH : cfg_STORAGE_PAGE_SIZE;
+	return cfgWriteChangedPage(in_slot * cfg_STORAGE_SLOT_SIZE, l_storage_image, length);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Writes one EEPROM page if its content differs from the given buffer
+/// @param in_address Page address
+/// @param in_buffer New page content
+/// @param in_length Number of bytes to write
+/// @return True if page was written successfully (or it was not changed)
+static bool cfgWriteChangedPage(uint16_t in_address, uint8_t* in_buffer, uint16_t in_length)
+{
+	drvEEPROMReadBlock(in_address, l_storage_page_buffer, in_length);
+
+	if (sysMemCompare(l_storage_page_buffer, in_buffer, in_length) == 0)
+	{
+		l_storage_statistics.PageSkipCount++;
+		return true;
+	}
+
+	if (!drvEEPROMWriteBlock(in_address, in_buffer, in_length))
+	{
+		l_storage_statistics.PageWriteErrorCount++;
+		return false;
+	}
+
+	l_storage_statistics.PageWriteCount++;
+
+	return true;
 }
 
 /*****************************************************************************/
@@ -198,7 +444,7 @@ void cfgSaveConfiguration(void)
 /// @param in_buffer_length Length of the buffer in bytes used for data transfer
 /// @param in_start_position The position within the file where operation must be started
 /// @return True if file operation was success
-bool cfgValueDataFileHandler(fileCallbackRequest in_request, void* in_buffer, uint16_t in_buffer_length, uint16_t in_start_pos)
+bool cfgValueDataFileHandler(fileCallbackRequest in_request, void* in_buffer, uint16_t in_buffer_length, uint32_t in_start_pos)
 {
 	switch (in_request)
 	{
@@ -215,7 +461,7 @@ bool cfgValueDataFileHandler(fileCallbackRequest in_request, void* in_buffer, ui
 			cfgActualizePrimaryBuffer();
 
 			crcMD5Open(&md5_state);
-			crcMD5Update(&md5_state, l_configuration_data_primary, cfg_VALUE_DATA_FILE_LENGTH);
+			crcMD5Update(&md5_state, g_cfg_value_data[0], cfg_VALUE_DATA_FILE_LENGTH);
 			crcMD5Close(&md5_state, (crcMD5Hash*)in_buffer);
 		}
 		return true;
@@ -224,7 +470,7 @@ bool cfgValueDataFileHandler(fileCallbackRequest in_request, void* in_buffer, ui
 		case fileCF_GetContent:
 			cfgActualizePrimaryBuffer();
 
-			*((uint8_t**)in_buffer) = l_configuration_data_primary;
+			*((uint8_t**)in_buffer) = g_cfg_value_data[0];
 
 			return true;
 
@@ -237,13 +483,16 @@ bool cfgValueDataFileHandler(fileCallbackRequest in_request, void* in_buffer, ui
 			uint8_t* source_data;
 			uint8_t* destination_data;
 
+			if (in_start_pos + in_buffer_length > cfg_VALUE_DATA_FILE_LENGTH)
+				return false;
+
 			destination_data = (uint8_t*)in_buffer;
-			value_index = cfgGetValueIndexFromPos(in_start_pos);
-			source_pos = in_start_pos;
-			if (l_config_storage_index[value_index] == 0)
-				source_data = &l_configuration_data_primary[source_pos];
+			value_index = cfgGetValueIndexFromPos((uint16_t)in_start_pos);
+			source_pos = (uint16_t)in_start_pos;
+			if (g_cfg_value_storage_index[value_index] == 0)
+				source_data = &g_cfg_value_data[0][source_pos];
 			else
-				source_data = &l_configuration_data_secondary[source_pos];
+				source_data = &g_cfg_value_data[1][source_pos];
 
 			for (length = 0; length < in_buffer_length; length++)
 			{
@@ -251,14 +500,17 @@ bool cfgValueDataFileHandler(fileCallbackRequest in_request, void* in_buffer, ui
 				source_pos++;
 
 				// switch to the next value when end of the current value of reached
-				if (l_configuration_value_info[value_index].Offset + l_configuration_value_info[value_index].Size < source_pos)
+				if (l_configuration_value_info[value_index].Offset + l_configuration_value_info[value_index].Size <= source_pos)
 				{
 					value_index++;
 
-					if (l_config_storage_index[value_index] == 0)
-						source_data = &l_configuration_data_primary[source_pos];
+					if (value_index >= cfg_VALUE_COUNT)
+						break;
+
+					if (g_cfg_value_storage_index[value_index] == 0)
+						source_data = &g_cfg_value_data[0][source_pos];
 					else
-						source_data = &l_configuration_data_secondary[source_pos];
+						source_data = &g_cfg_value_data[1][source_pos];
 				}
 			}
 		}
@@ -273,14 +525,17 @@ bool cfgValueDataFileHandler(fileCallbackRequest in_request, void* in_buffer, ui
 			uint8_t* source_data;
 			uint8_t* destination_data;
 
+			if (in_start_pos + in_buffer_length > cfg_VALUE_DATA_FILE_LENGTH)
+				return false;
+
 			source_data = (uint8_t*)in_buffer;
-			value_index = cfgGetValueIndexFromPos(in_start_pos);
-			destination_pos = in_start_pos;
+			value_index = cfgGetValueIndexFromPos((uint16_t)in_start_pos);
+			destination_pos = (uint16_t)in_start_pos;
 
-			if (l_config_storage_index[value_index] == 0)
-				destination_data = &l_configuration_data_secondary[destination_pos];
+			if (g_cfg_value_storage_index[value_index] == 0)
+				destination_data = &g_cfg_value_data[1][destination_pos];
 			else
-				destination_data = &l_configuration_data_primary[destination_pos];
+				destination_data = &g_cfg_value_data[0][destination_pos];
 
 			for (length = 0; length < in_buffer_length; length++)
 			{
@@ -291,16 +546,35 @@ bool cfgValueDataFileHandler(fileCallbackRequest in_request, void* in_buffer, ui
 				if (l_configuration_value_info[value_index].Offset + l_configuration_value_info[value_index].Size <= destination_pos)
 				{
 					// switch to the newly written storage
-					l_config_storage_index[value_index] = 1 - l_config_storage_index[value_index];
+					g_cfg_value_storage_index[value_index] = 1 - g_cfg_value_storage_index[value_index];
 
 					value_index++;
 
-					if (l_config_storage_index[value_index] == 0)
-						destination_data = &l_configuration_data_secondary[destination_pos];
+					if (value_index >= cfg_VALUE_COUNT)
+						break;
+
+					if (g_cfg_value_storage_index[value_index] == 0)
+						destination_data = &g_cfg_value_data[1][destination_pos];
 					else
-						destination_data = &l_configuration_data_primary[destination_pos];
+						destination_data = &g_cfg_value_data[0][destination_pos];
 				}
 			}
+
+			cfgValueDataChanged((uint16_t)in_start_pos);
+		}
+		return true;
+
+		// checks if the content was changed since the previous check
+		case fileCF_IsChangedSince:
+		{
+			fileChangeInfo* change_info = (fileChangeInfo*)in_buffer;
+
+			change_info->Changed = (change_info->ChangeCounter != l_value_data_change_counter);
+			change_info->ChangeCounter = l_value_data_change_counter;
+			change_info->FirstChangedPos = l_value_data_first_changed_pos;
+
+			// start collecting changes for the next check
+			l_value_data_first_changed_pos = cfg_VALUE_DATA_FILE_LENGTH;
 		}
 		return true;
 
@@ -319,6 +593,23 @@ bool cfgValueDataFileHandler(fileCallbackRequest in_request, void* in_buffer, ui
 	} 
 }
 
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Registers value data file content change (used by fileCF_IsChangedSince request)
+/// @param in_pos Position of the first changed byte
+static void cfgValueDataChanged(uint16_t in_pos)
+{
+	uint8_t index;
+
+	l_value_data_change_counter++;
+
+	if (in_pos < l_value_data_first_changed_pos)
+		l_value_data_first_changed_pos = in_pos;
+
+	// notify registered consumers
+	for (index = 0; index < cfg_CHANGED_CALLBACK_COUNT && l_changed_callbacks[index] != sysNULL; index++)
+		l_changed_callbacks[index]();
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 /// @brief Gets value index from value data file position
 /// @param in_pos value data file position
@@ -369,10 +660,7 @@ sysString cfgGetStringValue(uint16_t in_value_index)
 	sysASSERT(in_value_index < cfg_VALUE_COUNT);
 	sysASSERT(l_configuration_value_info[in_value_index].Type == cfg_VT_STRING);
 
-	if(l_config_storage_index[in_value_index] == 0)
-		return (sysString)&l_configuration_data_primary[l_configuration_value_info[in_value_index].Offset];
-	else
-		return (sysString)&l_configuration_data_secondary[l_configuration_value_info[in_value_index].Offset];
+	return cfgReadStringValue(in_value_index, l_configuration_value_info[in_value_index].Offset);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -381,28 +669,44 @@ sysString cfgGetStringValue(uint16_t in_value_index)
 /// @return Configuration value
 uint16_t cfgGetUInt16Value(uint16_t in_value_index)
 {
-	sysASSERT(in_value_index < cfg_VALUE_COUNT);
-	sysASSERT(l_configuration_value_info[in_value_index].Type == cfg_VT_INT32);
-
-	if (l_config_storage_index[in_value_index] == 0)
-		return *(uint16_t*)&l_configuration_data_primary[l_configuration_value_info[in_value_index].Offset];
-	else
-		return *(uint16_t*)&l_configuration_data_secondary[l_configuration_value_info[in_value_index].Offset];
+	return (uint16_t)cfgGetUInt32Value(in_value_index);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-/// @brief Gets configuration uint32 value
+/// @brief Gets configuration uint32 value (integer values stored on less bytes are converted)
 /// @param in_value_index Index of the value to get
 /// @return Configuration value
 uint32_t cfgGetUInt32Value(uint16_t in_value_index)
 {
+	uint16_t offset;
+
 	sysASSERT(in_value_index < cfg_VALUE_COUNT);
-	sysASSERT(l_configuration_value_info[in_value_index].Type == cfg_VT_INT32);
 
-	if (l_config_storage_index[in_value_index] == 0)
-		return *(uint32_t*)&l_configuration_data_primary[l_configuration_value_info[in_value_index].Offset];
-	else
-		return *(uint32_t*)&l_configuration_data_secondary[l_configuration_value_info[in_value_index].Offset];
+	offset = l_configuration_value_info[in_value_index].Offset;
+
+	switch (l_configuration_value_info[in_value_index].Type)
+	{
+		case cfg_VT_UINT8:
+		case cfg_VT_ENUM:
+			return cfgReadUInt8Value(in_value_index, offset);
+
+		case cfg_VT_INT8:
+			return (uint32_t)cfgReadInt8Value(in_value_index, offset);
+
+		case cfg_VT_UINT16:
+			return cfgReadUInt16Value(in_value_index, offset);
+
+		case cfg_VT_INT16:
+			return (uint32_t)cfgReadInt16Value(in_value_index, offset);
+
+		case cfg_VT_UINT32:
+		case cfg_VT_INT32:
+			return cfgReadUInt32Value(in_value_index, offset);
+
+		default:
+			sysASSERT(false);
+			return 0;
+	}
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -414,10 +718,7 @@ uint8_t cfgGetEnumValue(uint16_t in_value_index)
 	sysASSERT(in_value_index < cfg_VALUE_COUNT);
 	sysASSERT(l_configuration_value_info[in_value_index].Type == cfg_VT_ENUM);
 
-	if (l_config_storage_index[in_value_index] == 0)
-		return l_configuration_data_primary[l_configuration_value_info[in_value_index].Offset];
-	else
-		return l_configuration_data_secondary[l_configuration_value_info[in_value_index].Offset];
+	return cfgReadUInt8Value(in_value_index, l_configuration_value_info[in_value_index].Offset);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -427,10 +728,7 @@ uint8_t cfgGetEnumValue(uint16_t in_value_index)
 float cfgGetFloatValue(uint16_t in_value_index)
 {
 	sysASSERT(in_value_index < cfg_VALUE_COUNT);
-	sysASSERT(l_configuration_value_info[in_value_index].Type == cfg_VT_INT32);
+	sysASSERT(l_configuration_value_info[in_value_index].Type == cfg_VT_FLOAT);
 
-	if (l_config_storage_index[in_value_index] == 0)
-		return *(float*)&l_configuration_data_primary[l_configuration_value_info[in_value_index].Offset];
-	else
-		return *(float*)&l_configuration_data_secondary[l_configuration_value_info[in_value_index].Offset];
+	return cfgReadFloatValue(in_value_index, l_configuration_value_info[in_value_index].Offset);
 }
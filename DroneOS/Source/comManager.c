@@ -20,6 +20,7 @@
 #include <crcCITT16.h>
 #include <sysDateTime.h>
 #include <cfgStorage.h>
+#include <fdrRecorder.h>
 
 /*****************************************************************************/
 /* Constants                                                                 */
@@ -30,7 +31,20 @@
 #define comManager_TASK_MAX_CYCLE_TIME 100
 #define comManager_TRANSMIT_PACKET_EXPIRE_INTERVAL 100
 
-#define comManager_RECEIVER_PACKET_QUEUE_LENGTH 4096
+// transmit budget of one task cycle (maximum time in ms and maximum number of bytes sent)
+#ifndef comManager_TRANSMIT_TIME_BUDGET
+#define comManager_TRANSMIT_TIME_BUDGET 10
+#endif
+
+#ifndef comManager_TRANSMIT_BYTE_BUDGET
+#define comManager_TRANSMIT_BYTE_BUDGET 4096
+#endif
+
+// receiver queue length of one interface (every interface has its own queue)
+#ifndef comManager_RECEIVER_PACKET_QUEUE_LENGTH
+#define comManager_RECEIVER_PACKET_QUEUE_LENGTH 2048
+#endif
+
 #define comManager_TRANSMITTER_PACKET_QUEUE_LENGTH 1024
 
 #define comManager_HEARTBEAT_INTERVAL 1000
@@ -64,9 +78,9 @@ static uint8_t l_transmitter_packet_counter;
 static bool l_stop_task = false;
 static sysTaskNotify l_task_event;
 
-// packet receiver buffers
-static comPacketQueue l_receiver_queue;
-static uint8_t l_receiver_packet_buffer[comManager_RECEIVER_PACKET_QUEUE_LENGTH];
+// packet receiver buffers (the receiver of the interface is the only producer of the queue of the interface)
+static comPacketQueue l_receiver_queues[comManager_MAX_INTERFACE_NUMBER];
+static uint8_t l_receiver_packet_buffers[comManager_MAX_INTERFACE_NUMBER][comManager_RECEIVER_PACKET_QUEUE_LENGTH];
 
 // packet transmitter buffers
 static comPacketQueue l_transmitter_queue;
@@ -75,12 +89,16 @@ static uint8_t l_transmitter_packet_buffer[comManager_TRANSMITTER_PACKET_QUEUE_L
 // heartbeat timestamp
 static sysTick l_last_heartbeat_timestamp;
 
+// transmitter statistics
+static comManagerStatistics l_statistics;
+
 /*****************************************************************************/
 /* Local function prototypes                                                 */
 /*****************************************************************************/
 static sysTaskRetval comManagerTask(sysTaskParam in_param);
 static bool comManagerSendDeviceHeartbeat(void);
-static void comManagerTransmitPacket(void);
+static void comManagerTransmitPackets(void);
+static bool comManagerTransmitPacket(uint16_t in_packet_index);
 static void comManagerProcessReceivedPackets(void);
 static void comProcessCommunicationPacket(comPacketInfo* in_packet_info, uint8_t* in_packet);
 static void comManagerGenerateQueueEvent(comQueueEvent in_event);
@@ -94,8 +112,21 @@ static void comManagerGenerateQueueEvent(comQueueEvent in_event);
 void comManagerInit(void)
 {
 	sysTask task_handle;
+	uint8_t i;
 	
 	sysMemZero(g_com_interfaces, sizeof(g_com_interfaces));
+	sysMemZero(&l_statistics, sizeof(l_statistics));
+
+	// receiver queues are initialized before any interface is added
+	for (i = 0; i < comManager_MAX_INTERFACE_NUMBER; i++)
+	{
+		comPacketQueueInitializeSingleProducer(&l_receiver_queues[i], l_receiver_packet_buffers[i], comManager_RECEIVER_PACKET_QUEUE_LENGTH);
+		l_receiver_queues[i].Callback = comManagerGenerateQueueEvent;
+	}
+
+	// transmitter queue is initialized before the task is started, packets can be pushed right after the initialization
+	comPacketQueueInitialize(&l_transmitter_queue, l_transmitter_packet_buffer, comManager_TRANSMITTER_PACKET_QUEUE_LENGTH);
+	l_transmitter_queue.Callback = comManagerGenerateQueueEvent;
 
 	sysTaskNotifyCreate(l_task_event);
 
@@ -145,11 +176,6 @@ static sysTaskRetval comManagerTask(sysTaskParam in_param)
 	sysTick difference;
 
 	// initialize
-	comPacketQueueInitialize(&l_receiver_queue, l_receiver_packet_buffer, comManager_RECEIVER_PACKET_QUEUE_LENGTH);
-	l_receiver_queue.Callback = comManagerGenerateQueueEvent;
-	comPacketQueueInitialize(&l_transmitter_queue, l_transmitter_packet_buffer, comManager_TRANSMITTER_PACKET_QUEUE_LENGTH);
-	l_transmitter_queue.Callback = comManagerGenerateQueueEvent;
-
 	l_last_received_packet_counter = 0;
 	l_transmitter_packet_counter = 0;
 
@@ -176,8 +202,11 @@ static sysTaskRetval comManagerTask(sysTaskParam in_param)
 		// process received packets
 		comManagerProcessReceivedPackets();
 
+		// continue pending file transfer
+		fileProcessPendingTransfers();
+
 		// handle pending transmitter messages
-		comManagerTransmitPacket();
+		comManagerTransmitPackets();
 	}
 }
 
@@ -198,7 +227,8 @@ uint8_t comIncrementAndGetTransmittedPacketCounter(void)
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-/// @brief Stored received packet of any interface
+/// @brief Stored received packet of any interface. Must be called only from the receiver of the interface
+/// (the receiver queue of the interface has only one producer).
 /// @param in_interface_index Interface index wich is received the packet
 /// @param in_packet Pointer to the received packet
 /// @param in_packet_size Length of the received packet
@@ -212,6 +242,9 @@ void comManagerStoreReceivedPacket(uint8_t in_interface_index, uint8_t* in_packe
 	if (in_packet_size == 0 || in_interface_index >= comManager_MAX_INTERFACE_NUMBER)
 		return;
 
+	// record all received packets (including the dropped ones)
+	fdrRECORD(fdrRT_PACKET_RECEIVED, in_interface_index, in_packet, in_packet_size);
+
 	// check packet counter
 	packet_header = (comPacketHeader*)in_packet;
 
@@ -220,17 +253,17 @@ void comManagerStoreReceivedPacket(uint8_t in_interface_index, uint8_t* in_packe
 		return;
 
 	// store packet
-	push_index = comPacketQueuePushBegin(&l_receiver_queue, in_packet_size, in_interface_index);
+	push_index = comPacketQueuePushBegin(&l_receiver_queues[in_interface_index], in_packet_size, in_interface_index);
 	if (push_index != comINVALID_PACKET_INDEX)
 	{
 		// get pointer to packet data
-		packet_pointer = comPacketQueueGetPacketBuffer(&l_receiver_queue, push_index);
+		packet_pointer = comPacketQueueGetPacketBuffer(&l_receiver_queues[in_interface_index], push_index);
 
 		// copy packet content
 		sysMemCopy(packet_pointer, in_packet, in_packet_size);
 
 		// fill out header
-		comPacketQueuePushEnd(&l_receiver_queue, push_index);
+		comPacketQueuePushEnd(&l_receiver_queues[in_interface_index], push_index);
 	}
 }
 
@@ -322,6 +355,8 @@ void comManagerTransmitPacketPushEnd(uint16_t in_packet_index)
 	packet_data_buffer[packet_size - comCRC_BYTE_COUNT] = sysLOW(crc);
 	packet_data_buffer[packet_size - comCRC_BYTE_COUNT + 1] = sysHIGH(crc);
 
+	fdrRECORD(fdrRT_PACKET_TRANSMITTED, packet_info->Interface, packet_data_buffer, packet_size);
+
 	// finish packet preparation
 	comPacketQueuePushEnd(&l_transmitter_queue, in_packet_index);
 }
@@ -350,26 +385,117 @@ void comManagerGenerateEvent(void)
 	sysTaskNotifyGive(l_task_event);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Gets a copy of the transmitter statistics
+/// @param out_statistics Struct to receive the statistics
+void comManagerGetStatistics(comManagerStatistics* out_statistics)
+{
+	sysCriticalSectionBegin();
+
+	*out_statistics = l_statistics;
+
+	sysCriticalSectionEnd();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Clears transmitter statistics
+void comManagerResetStatistics(void)
+{
+	sysCriticalSectionBegin();
+
+	sysMemZero(&l_statistics, sizeof(l_statistics));
+
+	sysCriticalSectionEnd();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Sends pending packets from the transmitter queue until the queue is empty, the interfaces
+/// don't accept more packets or the time or byte budget of the cycle is exhausted
+static void comManagerTransmitPackets(void)
+{
+	uint16_t packet_index = comINVALID_PACKET_INDEX;
+	comPacketInfo* packet_info;
+	sysTick start_timestamp;
+	uint32_t byte_count = 0;
+	uint16_t packet_count = 0;
+	uint32_t expired_count = 0;
+	uint16_t queue_depth;
+	bool retry = false;
+	bool stalled;
+
+	start_timestamp = sysGetSystemTick();
+	queue_depth = comPacketQueueGetUsedSize(&l_transmitter_queue);
+
+	while (byte_count < comManager_TRANSMIT_BYTE_BUDGET && sysGetSystemTickSince(start_timestamp) <= comManager_TRANSMIT_TIME_BUDGET)
+	{
+		// pop next packet from the transmitter queue, stop when there no packet in the queue
+		packet_index = comPacketQueuePopBegin(&l_transmitter_queue);
+		if (packet_index == comINVALID_PACKET_INDEX)
+			break;
+
+		packet_info = comPacketQueueGetPacketInfo(&l_transmitter_queue, packet_index);
+
+		if (comManagerTransmitPacket(packet_index))
+		{
+			byte_count += packet_info->Size;
+			packet_count++;
+		}
+		else
+		{
+			// packet was not accepted by the interfaces, drop it when expired otherwise retry at the next cycle
+			if (sysGetSystemTickSince(packet_info->Timestamp) > comManager_TRANSMIT_PACKET_EXPIRE_INTERVAL)
+			{
+				expired_count++;
+			}
+			else
+			{
+				retry = true;
+				break;
+			}
+		}
+
+		// remove packet from the queue if it was sent or expired
+		comPacketQueuePopEnd(&l_transmitter_queue);
+	}
+
+	// every reserved packet must be finished or cancelled, a packet which is reserved for too long blocks the queue
+	stalled = (packet_index == comINVALID_PACKET_INDEX && comPacketQueueGetHeadReservationTime(&l_transmitter_queue) > comManager_TRANSMIT_PACKET_EXPIRE_INTERVAL);
+
+	// update statistics
+	sysCriticalSectionBegin();
+
+	l_statistics.TransmitQueueDepth = queue_depth;
+	if (queue_depth > l_statistics.TransmitQueueMaxDepth)
+		l_statistics.TransmitQueueMaxDepth = queue_depth;
+
+	l_statistics.TransmitWakeupCount++;
+	l_statistics.TransmittedPacketCount += packet_count;
+	l_statistics.ExpiredPacketCount += expired_count;
+	if (retry)
+		l_statistics.RetryCount++;
+	l_statistics.LastWakeupPacketCount = packet_count;
+	if (packet_count > l_statistics.MaxWakeupPacketCount)
+		l_statistics.MaxWakeupPacketCount = packet_count;
+	if (stalled)
+		l_statistics.StalledCycleCount++;
+
+	sysCriticalSectionEnd();
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 /// @brief Sends packet
-/// @param in_queue Queue description
-/// @param in_packet_index Packet index to finish
-static void comManagerTransmitPacket(void)
+/// @param in_packet_index Index of the packet (in the transmitter queue) to send
+/// @return True if packet was accepted by at least one interface
+static bool comManagerTransmitPacket(uint16_t in_packet_index)
 {
-	uint16_t packet_index;
 	comPacketInfo* packet_info;
 	uint8_t* packet_data_buffer;
 	uint8_t i;
 	bool packet_sent = false;
 
-	// pop next packet from the transmitter queue, return where there no packet in the queue
-	packet_index = comPacketQueuePopBegin(&l_transmitter_queue);
-	if (packet_index == comINVALID_PACKET_INDEX)
-		return;
-
-	// get further packet information
-	packet_info = comPacketQueueGetPacketInfo(&l_transmitter_queue, packet_index);
-	packet_data_buffer = comPacketQueueGetPacketBuffer(&l_transmitter_queue, packet_index);
+	// get packet information
+	packet_info = comPacketQueueGetPacketInfo(&l_transmitter_queue, in_packet_index);
+	packet_data_buffer = comPacketQueueGetPacketBuffer(&l_transmitter_queue, in_packet_index);
 
 	if (packet_info->Interface < comManager_MAX_INTERFACE_NUMBER)
 	{
@@ -393,50 +519,55 @@ static void comManagerTransmitPacket(void)
 		}
 	}
 
-	// remove packet from the queue if it was sent or expired
-	if(packet_sent || sysGetSystemTickSince(packet_info->Timestamp) > comManager_TRANSMIT_PACKET_EXPIRE_INTERVAL)
-		comPacketQueuePopEnd(&l_transmitter_queue);
+	return packet_sent;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-/// @brief Processes received (incoming) packets
+/// @brief Processes received (incoming) packets of all interfaces
 static void comManagerProcessReceivedPackets(void)
 {
 	uint16_t packet_index;
 	comPacketInfo* packet_info;
 	comPacketHeader* packet_header;
+	comPacketQueue* queue;
+	uint8_t interface_index;
 
-	// process all pending packets
-	do
+	for (interface_index = 0; interface_index < comManager_MAX_INTERFACE_NUMBER; interface_index++)
 	{
-		// get next pending packet
-		packet_index = comPacketQueuePopBegin(&l_receiver_queue);
-		if (packet_index != comINVALID_PACKET_INDEX)
+		queue = &l_receiver_queues[interface_index];
+
+		// process all pending packets
+		do
 		{
-			// process packet
-			packet_info = comPacketQueueGetPacketInfo(&l_receiver_queue, packet_index);
-			packet_header = (comPacketHeader*)comPacketQueueGetPacketBuffer(&l_receiver_queue, packet_index);
+			// get next pending packet
+			packet_index = comPacketQueuePopBegin(queue);
+			if (packet_index != comINVALID_PACKET_INDEX)
+			{
+				// process packet
+				packet_info = comPacketQueueGetPacketInfo(queue, packet_index);
+				packet_header = (comPacketHeader*)comPacketQueueGetPacketBuffer(queue, packet_index);
 
-			l_last_received_packet_counter = packet_header->PacketCounter;
+				l_last_received_packet_counter = packet_header->PacketCounter;
 
-			switch (comPT_GET_CLASS(packet_header->PacketType))
-			{
-				case comPT_CLASS_FILE:
-					fileProcessFileTransfer(packet_info, (uint8_t*)packet_header);
-					break;
+				switch (comPT_GET_CLASS(packet_header->PacketType))
+				{
+					case comPT_CLASS_FILE:
+						fileProcessFileTransfer(packet_info, (uint8_t*)packet_header);
+						break;
 
-				case comPT_CLASS_COMM:
-					comProcessCommunicationPacket(packet_info, (uint8_t*)packet_header);
-					break;
+					case comPT_CLASS_COMM:
+						comProcessCommunicationPacket(packet_info, (uint8_t*)packet_header);
+						break;
 
-				case comPT_CLASS_CONFIG:
-					break;
-			}
+					case comPT_CLASS_CONFIG:
+						break;
+				}
 
-			// remove packet from the queue
-			comPacketQueuePopEnd(&l_receiver_queue);
-		}
-	} while (packet_index != comINVALID_PACKET_INDEX);
+				// remove packet from the queue
+				comPacketQueuePopEnd(queue);
+			}
+		} while (packet_index != comINVALID_PACKET_INDEX);
+	}
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -16,11 +16,13 @@
 /*****************************************************************************/
 /* Constants                                                                 */
 /*****************************************************************************/
+#define comPacketQueue_ALIGNMENT 4
 
 /*****************************************************************************/
 /* Module local functions                                                    */
 /*****************************************************************************/
 static void comPacketQueueCallbackExecute(comPacketQueue* in_queue, comQueueEvent in_event);
+static uint16_t comPacketQueueGetTotalSize(uint8_t in_size);
 
 /*****************************************************************************/
 /* Public functions                                                          */
@@ -36,6 +38,7 @@ void comPacketQueueInitialize(comPacketQueue* in_queue, uint8_t* in_packet_buffe
 	in_queue->Buffer = in_packet_buffer;
 	in_queue->BufferSize = in_buffer_size;
 	sysMutexCreate(in_queue->PushLock);
+	in_queue->SingleProducer = false;
 	
 	in_queue->PushIndex = 0;
 	in_queue->PopIndex = 0;
@@ -43,6 +46,19 @@ void comPacketQueueInitialize(comPacketQueue* in_queue, uint8_t* in_packet_buffe
 	in_queue->Callback = sysNULL;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Initialize packet queue for single producer/single consumer use. Push functions don't lock the queue
+/// therefore only one task (or interrupt) is allowed to push packets and only one is allowed to pop packets.
+/// @param in_queue Packet queue description
+/// @param in_packet_buffer Packet data buffer
+/// @param in_buffer_size Packet data buffer size in bytes
+void comPacketQueueInitializeSingleProducer(comPacketQueue* in_queue, uint8_t* in_packet_buffer, uint16_t in_buffer_size)
+{
+	comPacketQueueInitialize(in_queue, in_packet_buffer, in_buffer_size);
+
+	in_queue->SingleProducer = true;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 /// @brief Gets pointer to the packet info header in the packet queue
 /// @param in_queue Queue description
@@ -61,81 +77,100 @@ uint8_t* comPacketQueueGetPacketBuffer(comPacketQueue* in_queue, uint16_t in_pac
 	return ((uint8_t*)&(in_queue->Buffer[in_packet_index])) + sizeof(comPacketInfo);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Gets number of bytes currently occupied in the queue (including packet info headers)
+/// @param in_queue Queue description
+/// @return Number of used bytes (approximate value when the queue is accessed concurrently)
+uint16_t comPacketQueueGetUsedSize(comPacketQueue* in_queue)
+{
+	uint16_t push_index;
+	uint16_t pop_index;
+
+	sysASSERT(in_queue != sysNULL);
+
+	push_index = in_queue->PushIndex;
+	pop_index = in_queue->PopIndex;
+
+	if (push_index >= pop_index)
+		return push_index - pop_index;
+	else
+		return in_queue->BufferSize - pop_index + push_index;
+}
+
 /*****************************************************************************/
 /* Queue PUSH functions                                                      */
 /*****************************************************************************/
 
 ///////////////////////////////////////////////////////////////////////////////
-/// @brief Allocated space for a packet in the queue. Handles multiple thread access.
+/// @brief Allocated space for a packet in the queue. Handles multiple thread access (except in single producer mode).
 /// @param in_queue Queue descriptor
 /// @param in_size Size of the packet to allocate
 /// @param in_source_interface Source Interface number (where the packet comes)
 uint16_t comPacketQueuePushBegin(comPacketQueue* in_queue, uint8_t in_size, uint8_t in_source_interface)
 {
 	uint16_t total_size;
+	uint16_t push_index;
+	uint16_t pop_index;
 	comPacketInfo* packet_info = sysNULL;
 	uint16_t packet_index = comINVALID_PACKET_INDEX;
 
 	sysASSERT(in_queue != sysNULL);
 
 	// reserve storage from the queue
-	total_size = sizeof(comPacketInfo) + in_size;
+	total_size = comPacketQueueGetTotalSize(in_size);
 
 	// reserve storage in a critical section
-	sysMutexTake(in_queue->PushLock, sysINFINITE_TIMEOUT);
+	if (!in_queue->SingleProducer)
+		sysMutexTake(in_queue->PushLock, sysINFINITE_TIMEOUT);
 
-	// reserve space from the end of the buffer
-	if (in_queue->PopIndex <= in_queue->PushIndex && in_queue->PushIndex + total_size < in_queue->BufferSize)
-	{
-		// there is enough space at the end of the buffer
-		packet_index = in_queue->PushIndex;
-		packet_info = (comPacketInfo*)&(in_queue->Buffer[packet_index]);
-		in_queue->PushIndex += total_size;
-		packet_info->Status = comPQS_Reserved;
+	// pop index can only be increased by the consumer which means more free space therefore it is safe to use a copy of it
+	push_index = in_queue->PushIndex;
+	pop_index = in_queue->PopIndex;
 
-		// wrap around push index
-		if (in_queue->PushIndex >= in_queue->BufferSize)
-		{
-			// there is no space beind this packet -> wrap push pointer
-			in_queue->PushIndex = 0;
-		}
-	}
-	else
+	if (pop_index <= push_index)
 	{
-		// handle push pointer wrap around condition -> terminate queue
-		if (in_queue->PopIndex <= in_queue->PushIndex)
-		{
-			// terminate end of the queue
-			((comPacketInfo*)&in_queue->Buffer[in_queue->PushIndex])->Status = comPQS_EndOfQueue;
-			in_queue->PushIndex = 0;
-		}
-
-		// reserve space from the beginning of the buffer
-		if (in_queue->PushIndex + total_size + 1 < in_queue->PopIndex)	// +1 to never have the same value of the push and pop index except when queue is empty
+		// reserve space from the end of the buffer (keep space for the end of queue marker)
+		if (push_index + total_size + sizeof(comPacketInfo) <= in_queue->BufferSize)
 		{
-			packet_index = in_queue->PushIndex;
-			packet_info = (comPacketInfo*)&(in_queue->Buffer[packet_index]);
-			in_queue->PushIndex += total_size;
-			packet_info->Status = comPQS_Reserved;
+			packet_index = push_index;
 		}
 		else
 		{
-			// no free space in the buffer
-			packet_index = comINVALID_PACKET_INDEX;
+			// reserve space from the beginning of the buffer
+			if (total_size + 1 < pop_index)	// +1 to never have the same value of the push and pop index except when queue is empty
+			{
+				// terminate end of the queue
+				((comPacketInfo*)&in_queue->Buffer[push_index])->Status = comPQS_EndOfQueue;
+				packet_index = 0;
+			}
 		}
 	}
+	else
+	{
+		// reserve space between the push and pop index
+		if (push_index + total_size + 1 < pop_index)	// +1 to never have the same value of the push and pop index except when queue is empty
+			packet_index = push_index;
+	}
 
-	// release lock
-	sysMutexGive(in_queue->PushLock);
-
-	// initialize packet info
-	if (packet_info != sysNULL)
+	if (packet_index != comINVALID_PACKET_INDEX)
 	{
+		// initialize packet info
+		packet_info = (comPacketInfo*)&(in_queue->Buffer[packet_index]);
+		packet_info->Status = comPQS_Reserved;
 		packet_info->Size = in_size;
 		packet_info->Interface = in_source_interface;
 		packet_info->Timestamp = sysGetSystemTick();
+
+		// packet info must be visible before the packet is published for the consumer
+		sysMemoryBarrier();
+
+		in_queue->PushIndex = packet_index + total_size;
 	}
 
+	// release lock
+	if (!in_queue->SingleProducer)
+		sysMutexGive(in_queue->PushLock);
+
 	return packet_index;
 }
 
@@ -154,6 +189,10 @@ void comPacketQueuePushEnd(comPacketQueue* in_queue, uint16_t in_packet_index)
 	// mark packet as 'ready'
 	packet_info = (comPacketInfo*)&(in_queue->Buffer[in_packet_index]);
 	sysASSERT(packet_info->Status == comPQS_Reserved);
+
+	// packet content must be visible before the packet is marked as ready
+	sysMemoryBarrier();
+
 	packet_info->Status = comPQS_Ready;
 
 	// execute callback
@@ -174,6 +213,9 @@ void comPacketQueuePushCancel(comPacketQueue* in_queue, uint16_t in_packet_index
 	// mark packet as 'deleted'
 	packet_info = (comPacketInfo*)&in_queue->Buffer[in_packet_index];
 	sysASSERT(packet_info->Status == comPQS_Reserved);
+
+	sysMemoryBarrier();
+
 	packet_info->Status = comPQS_Deleted;
 
 	// execute callback
@@ -228,6 +270,9 @@ uint16_t comPacketQueuePopBegin(comPacketQueue* in_queue)
 		}
 		else
 		{
+			// packet header must be read after the push index
+			sysMemoryBarrier();
+
 			// check packet header
 			packet_info = (comPacketInfo*)&in_queue->Buffer[in_queue->PopIndex];
 			pop_index = in_queue->PopIndex;
@@ -245,7 +290,7 @@ uint16_t comPacketQueuePopBegin(comPacketQueue* in_queue)
 				// deleted packet was found
 				case comPQS_Deleted:
 					// increment pop index
-					total_size = sizeof(comPacketInfo) + packet_info->Size;
+					total_size = comPacketQueueGetTotalSize(packet_info->Size);
 
 					if (in_queue->PopIndex + total_size < in_queue->BufferSize)
 					{
@@ -259,6 +304,12 @@ uint16_t comPacketQueuePopBegin(comPacketQueue* in_queue)
 					next_packet = true;
 					break;
 
+				// packet is still being filled by the producer
+				case comPQS_Reserved:
+					pop_index = comINVALID_PACKET_INDEX;
+					next_packet = false;
+					break;
+
 				default:
 					next_packet = false;
 					break;
@@ -280,7 +331,10 @@ void comPacketQueuePopEnd(comPacketQueue* in_queue)
 	packet_info = (comPacketInfo*)&in_queue->Buffer[in_queue->PopIndex];
 
 	// increment pop index
-	total_size = sizeof(comPacketInfo) + packet_info->Size;
+	total_size = comPacketQueueGetTotalSize(packet_info->Size);
+
+	// packet content must be completely read before the storage is released
+	sysMemoryBarrier();
 
 	if (in_queue->PopIndex + total_size < in_queue->BufferSize)
 	{
@@ -295,6 +349,30 @@ void comPacketQueuePopEnd(comPacketQueue* in_queue)
 	comPacketQueueCallbackExecute(in_queue, comQE_PacketPushed);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Gets the time since the packet at the head of the queue is reserved. The head packet blocks the
+/// queue until its push operation is finished or cancelled, a long reservation indicates a missing push end or cancel.
+/// @param in_queue Queue description
+/// @return Reservation time of the head packet [ms] or zero when the head packet is not in reserved state
+uint32_t comPacketQueueGetHeadReservationTime(comPacketQueue* in_queue)
+{
+	comPacketInfo* packet_info;
+
+	sysASSERT(in_queue != sysNULL);
+
+	if (in_queue->PopIndex == in_queue->PushIndex)
+		return 0;
+
+	// packet header must be read after the push index
+	sysMemoryBarrier();
+
+	packet_info = (comPacketInfo*)&in_queue->Buffer[in_queue->PopIndex];
+	if (packet_info->Status != comPQS_Reserved)
+		return 0;
+
+	return sysGetSystemTickSince(packet_info->Timestamp);
+}
+
 /*****************************************************************************/
 /* Module local functions                                                    */
 /*****************************************************************************/
@@ -308,3 +386,12 @@ static void comPacketQueueCallbackExecute(comPacketQueue* in_queue, comQueueEven
 	if (in_queue->Callback != sysNULL)
 		in_queue->Callback(in_event);
 }
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Gets storage size of a packet (packet info header and data rounded up to the queue alignment)
+/// @param in_size Size of the packet data in bytes
+/// @return Number of bytes occupied by the packet in the queue
+static uint16_t comPacketQueueGetTotalSize(uint8_t in_size)
+{
+	return (sizeof(comPacketInfo) + in_size + comPacketQueue_ALIGNMENT - 1) & ~(comPacketQueue_ALIGNMENT - 1);
+}
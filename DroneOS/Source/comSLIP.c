@@ -13,6 +13,7 @@
 /*****************************************************************************/
 #include <comSLIP.h>
 #include <crcCITT16.h>
+#include <sysRTOS.h>
 
 /*****************************************************************************/
 /* Functions implementation                                                  */
@@ -44,39 +45,58 @@ void slipEncodeByte(slipEncoderState* in_state, uint8_t in_byte)
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-/// @brief Stores block of data in the packet buffer using SLIP encoding and updates CRC
+/// @brief Stores block of data in the packet buffer using SLIP encoding. Runs of bytes without special
+/// characters are copied at once, only END and ESC characters are escaped one by one.
 /// @param in_state Pointer to the decoder state structure
 /// @param in_buffer Pointer to the buffer
 /// @param in_length Number of bytes to store
 /// @return True if if was success, False when buffer is too small
 bool slipEncodeBlock(slipEncoderState* in_state, uint8_t* in_buffer, uint8_t in_length)
 {
-	uint8_t data;
-	bool success = true;
+	uint16_t run_length;
 
 	// slip packet start
+	if (in_state->TargetBufferPos >= in_state->TargetBufferSize)
+		return false;
+
 	in_state->TargetBuffer[in_state->TargetBufferPos++] = slip_END;
 	
-	while(in_length > 0 && in_state->TargetBufferPos < in_state->TargetBufferSize)
+	while (in_length > 0)
 	{
-		data = *in_buffer;
-		slipEncodeByte(in_state, data);
+		// find the next special character
+		run_length = 0;
+		while (run_length < in_length && in_buffer[run_length] != slip_END && in_buffer[run_length] != slip_ESC)
+			run_length++;
+
+		if (run_length > 0)
+		{
+			// copy data (keep one byte for the SLIP END)
+			if (in_state->TargetBufferPos + run_length >= in_state->TargetBufferSize)
+				return false;
+
+			sysMemCopy(&in_state->TargetBuffer[in_state->TargetBufferPos], in_buffer, run_length);
 
-		in_buffer++;
-		in_length--;
+			in_state->TargetBufferPos += run_length;
+			in_buffer += run_length;
+			in_length -= (uint8_t)run_length;
+		}
+		else
+		{
+			// escape special character (keep one byte for the SLIP END)
+			if (in_state->TargetBufferPos + 2 >= in_state->TargetBufferSize)
+				return false;
+
+			slipEncodeByte(in_state, *in_buffer);
+
+			in_buffer++;
+			in_length--;
+		}
 	}
 
 	// store SLIP END
-	if (in_state->TargetBufferPos < in_state->TargetBufferSize - 1)
-	{
-		in_state->TargetBuffer[in_state->TargetBufferPos++] = slip_END;
-	}
-	else
-	{
-		success = false;
-	}
+	in_state->TargetBuffer[in_state->TargetBufferPos++] = slip_END;
 
-	return success;
+	return true;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -171,3 +191,113 @@ bool slipDecodeByte(slipDecoderState* in_state, uint8_t in_byte)
 
 	return retval;
 }
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief SLIP decodes block of bytes. Decoding stops after the first complete packet, the remaining bytes must
+/// be passed again after the packet is processed. Runs of bytes without special characters are copied at once.
+/// @param in_state SLIP decoder state
+/// @param in_buffer Bytes to decode
+/// @param in_length Number of bytes to decode
+/// @param out_processed_length Number of bytes processed from the buffer
+/// @return True if block end was found
+bool slipDecodeBlock(slipDecoderState* in_state, uint8_t* in_buffer, uint16_t in_length, uint16_t* out_processed_length)
+{
+	bool retval = false;
+	uint16_t pos = 0;
+	uint16_t run_length;
+	uint16_t free_space;
+	uint8_t data;
+
+	while (pos < in_length && !retval)
+	{
+		// buffer is full, there is no full packet in the buffer ->clear buffer content
+		if (in_state->TargetBufferPos == in_state->TargetBufferSize)
+		{
+			in_state->Status = slip_ES_Idle;
+			in_state->TargetBufferPos = 0;
+		}
+
+		switch (in_state->Status)
+		{
+			// waiting for packet start
+			case slip_ES_Idle:
+				// skip bytes until packet start
+				while (pos < in_length && in_buffer[pos] != slip_END)
+					pos++;
+
+				if (pos < in_length)
+				{
+					pos++;
+					in_state->Status = slip_ES_Data;
+
+					// report only packet with non-zero length
+					if (in_state->TargetBufferPos != 0)
+					{
+						retval = true;
+						in_state->LastPacketLength = in_state->TargetBufferPos;
+					}
+
+					// prepare to receive next packet
+					in_state->TargetBufferPos = 0;
+				}
+				break;
+
+			// processing packet data
+			case slip_ES_Data:
+				// find the next special character
+				free_space = in_state->TargetBufferSize - in_state->TargetBufferPos;
+				run_length = 0;
+				while (pos + run_length < in_length && run_length < free_space && in_buffer[pos + run_length] != slip_END && in_buffer[pos + run_length] != slip_ESC)
+					run_length++;
+
+				if (run_length > 0)
+				{
+					// copy normal data
+					sysMemCopy(&in_state->TargetBuffer[in_state->TargetBufferPos], &in_buffer[pos], run_length);
+					in_state->TargetBufferPos += run_length;
+					pos += run_length;
+				}
+				else
+				{
+					if (in_buffer[pos++] == slip_ESC)
+					{
+						// escape code
+						in_state->Status = slip_ES_Escape;
+					}
+					else
+					{
+						// packet end, report only packet with non-zero length
+						if (in_state->TargetBufferPos != 0)
+						{
+							retval = true;
+							in_state->LastPacketLength = in_state->TargetBufferPos;
+						}
+
+						// prepare to receive next packet
+						in_state->TargetBufferPos = 0;
+					}
+				}
+				break;
+
+			// processing escape characters
+			case slip_ES_Escape:
+				data = in_buffer[pos++];
+				switch (data)
+				{
+					case slip_ESC_ESC:
+						in_state->TargetBuffer[in_state->TargetBufferPos++] = slip_ESC;
+						break;
+
+					case slip_ESC_END:
+						in_state->TargetBuffer[in_state->TargetBufferPos++] = slip_END;
+						break;
+				}
+				in_state->Status = slip_ES_Data;
+				break;
+		}
+	}
+
+	*out_processed_length = pos;
+
+	return retval;
+}
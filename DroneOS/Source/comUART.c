@@ -39,6 +39,8 @@
 static sysTaskRetval comUARTThread(sysTaskParam in_param);
 
 static void comUARTRxCallback(uint8_t in_char, void* in_interrupt_param);
+static void comUARTRxBlockCallback(uint8_t* in_buffer, uint16_t in_buffer_length, sysHighresTimestamp in_timestamp, void* in_interrupt_param);
+static void comUARTProcessReceivedPacket(uint8_t* in_packet, uint16_t in_packet_length);
 static void comUARTTxEmptyCallback(void* in_interrupt_param);
 static uint8_t* comUARTAllocTransmitBuffer(void);
 
@@ -158,6 +160,9 @@ bool comUARTSendPacket(uint8_t* in_packet, uint16_t in_packet_length)
 	}
 	else
 	{
+		// release transmitter buffer
+		l_transmitter_buffer_length = 0;
+
 		return false;
 	}
 }
@@ -174,9 +179,6 @@ bool comUARTSendPacket(uint8_t* in_packet, uint16_t in_packet_length)
 static sysTaskRetval comUARTThread(sysTaskParam in_param)
 {
 	halUARTConfigInfo uart_config;
-	uint8_t packet_length;
-	comPacketHeader* packet_header;
-	uint16_t crc;
 
 	sysUNUSED(in_param);
 
@@ -185,6 +187,7 @@ static sysTaskRetval comUARTThread(sysTaskParam in_param)
 
 	halUARTConfigInfoInit(&uart_config);
 	uart_config.RxReceivedCallback = comUARTRxCallback;
+	uart_config.RxBlockReceivedCallback = comUARTRxBlockCallback;
 	uart_config.TxEmptyCallback = comUARTTxEmptyCallback;
 	halUARTConfig(l_uart_index, &uart_config);
 	halUARTSetBaudRate(l_uart_index, 115200);
@@ -210,22 +213,7 @@ static sysTaskRetval comUARTThread(sysTaskParam in_param)
 		// process received packets
 		if (l_packet_received)
 		{
-			packet_header = (comPacketHeader*)l_receive_buffer;
-			packet_length = packet_header->PacketLength;
-
-			// check packet length
-			if (packet_length == l_received_packet_length)
-			{
-				// check CRC
-				crc = crc16_INIT_VALUE;
-				crc = crc16CalculateForBlock(crc, l_receive_buffer, packet_length - comCRC_BYTE_COUNT);
-
-				if (sysLOW(crc) == l_receive_buffer[packet_length - 2] && sysHIGH(crc) == l_receive_buffer[packet_length - 1])
-				{
-					// further process other packets
-					comManagerStoreReceivedPacket(l_interface_index, l_receive_buffer, packet_length);
-				}
-			}
+			comUARTProcessReceivedPacket(l_receive_buffer, l_received_packet_length);
 
 			l_packet_received = false;
 		}
@@ -245,6 +233,37 @@ static sysTaskRetval comUARTThread(sysTaskParam in_param)
 	return 0;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Checks received packet and passes it to the communication manager
+/// @param in_packet Received packet (SLIP decoded)
+/// @param in_packet_length Length of the received packet
+static void comUARTProcessReceivedPacket(uint8_t* in_packet, uint16_t in_packet_length)
+{
+	comPacketHeader* packet_header;
+	uint8_t packet_length;
+	uint16_t crc;
+
+	if (in_packet_length <= comCRC_BYTE_COUNT)
+		return;
+
+	packet_header = (comPacketHeader*)in_packet;
+	packet_length = packet_header->PacketLength;
+
+	// check packet length
+	if (packet_length != in_packet_length)
+		return;
+
+	// check CRC
+	crc = crc16_INIT_VALUE;
+	crc = crc16CalculateForBlock(crc, in_packet, packet_length - comCRC_BYTE_COUNT);
+
+	if (sysLOW(crc) == in_packet[packet_length - 2] && sysHIGH(crc) == in_packet[packet_length - 1])
+	{
+		// further process other packets
+		comManagerStoreReceivedPacket(l_interface_index, in_packet, packet_length);
+	}
+}
+
 /*****************************************************************************/
 /* UART Callback functions                                                   */
 /*****************************************************************************/
@@ -271,6 +290,26 @@ void comUARTRxCallback(uint8_t in_char, void* in_interrupt_param)
 	}
 }
 
+///////////////////////////////////////////////////////////////////////////////
+/// @brief UART Block Received Callback. It is called from the receiver thread of the HAL (not from interrupt)
+/// therefore the received packets are processed immediately.
+void comUARTRxBlockCallback(uint8_t* in_buffer, uint16_t in_buffer_length, sysHighresTimestamp in_timestamp, void* in_interrupt_param)
+{
+	uint16_t processed_length;
+
+	sysUNUSED(in_timestamp);
+	sysUNUSED(in_interrupt_param);
+
+	while (in_buffer_length > 0)
+	{
+		if (slipDecodeBlock(&l_slip_decoder_state, in_buffer, in_buffer_length, &processed_length))
+			comUARTProcessReceivedPacket(l_receive_buffer, l_slip_decoder_state.LastPacketLength);
+
+		in_buffer += processed_length;
+		in_buffer_length -= processed_length;
+	}
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 /// @brief ESP8266 UART Transmitter Empty Callback
 void comUARTTxEmptyCallback(void* in_interrupt_param)
@@ -134,7 +134,7 @@ bool comUDPSendPacket(uint8_t* in_packet, uint16_t in_packet_length)
 	sysMemCopy(transmit_buffer, in_packet, in_packet_length);
 
 	// send packet
-	drvUDPTransmitData(in_packet_length, l_host_address);
+	drvUDPTransmitData(transmit_buffer, in_packet_length, l_host_address);
 
 	return true;
 }
@@ -207,7 +207,7 @@ static void comUDPSendDeviceAnounce(uint8_t* in_transmit_buffer)
 	in_transmit_buffer[sizeof(comPacketDeviceAnnounce) + 1] = sysHIGH(crc);
 
 	// send packet (Broadcast)
-	drvUDPTransmitData(sizeof(comPacketDeviceAnnounce) + comCRC_BYTE_COUNT, comUDP_MAKE_BROADCAST_ADDRESS(ip_address));
+	drvUDPTransmitData(in_transmit_buffer, sizeof(comPacketDeviceAnnounce) + comCRC_BYTE_COUNT, comUDP_MAKE_BROADCAST_ADDRESS(ip_address));
 }
 
 ///////////////////////////////////////////////////////////////////////////////
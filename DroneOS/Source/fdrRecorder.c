@@ -0,0 +1,414 @@
+/*****************************************************************************/
+/* Flight data recorder                                                      */
+/*                                                                           */
+/* Copyright (C) 2017 Laszlo Arvai                                           */
+/* All rights reserved.                                                      */
+/*                                                                           */
+/* This software may be modified and distributed under the terms             */
+/* of the GNU General Public License.  See the LICENSE file for details.     */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/* Includes                                                                  */
+/*****************************************************************************/
+#include <sysRTOS.h>
+#include <sysHighresTimer.h>
+#include <crcCITT16.h>
+#include <fdrRecorder.h>
+#include <drvFDRStorage.h>
+
+/*****************************************************************************/
+/* Constants                                                                 */
+/*****************************************************************************/
+
+// size of the ring buffer between the recording tasks and the recorder task (must be power of two)
+#ifndef fdrRING_BUFFER_SIZE
+#define fdrRING_BUFFER_SIZE 16384
+#endif
+
+// maximum number of blocks in the log (recording stops when the log is full, default: 64MB)
+#ifndef fdrMAXIMUM_BLOCK_COUNT
+#define fdrMAXIMUM_BLOCK_COUNT 16384
+#endif
+
+#define fdrRING_BUFFER_MASK (fdrRING_BUFFER_SIZE - 1)
+#define fdrRING_ALIGNMENT 4
+#define fdrRING_RECORD_COMMITTED 0x5a5a5a5aul
+
+#define fdrRECORDER_TASK_PRIORITY 1
+#define fdrRECORDER_TASK_CYCLE_TIME 10
+#define fdrRECORDER_STOP_TIMEOUT 1000
+
+#define fdrBLOCK_DATA_SIZE (fdrBLOCK_SIZE - sizeof(fdrBlockHeader))
+
+/*****************************************************************************/
+/* Types                                                                     */
+/*****************************************************************************/
+
+// record header in the ring buffer (followed by the record data)
+typedef struct
+{
+	volatile uint32_t State;					// fdrRING_RECORD_COMMITTED when the record is complete
+	sysHighresTimestamp Timestamp;
+	uint16_t Length;
+	uint8_t Type;
+	uint8_t Channel;
+} fdrRingRecordHeader;
+
+/*****************************************************************************/
+/* Local function prototypes                                                 */
+/*****************************************************************************/
+static sysTaskRetval fdrRecorderTask(sysTaskParam in_param);
+static void fdrRecorderProcessRingBuffer(void);
+static void fdrRecorderStoreRecord(fdrRingRecordHeader* in_record);
+static void fdrRecorderWriteBlock(void);
+static void fdrRecorderAtomicIncrement(volatile uint32_t* in_value);
+
+/*****************************************************************************/
+/* Module global variables                                                   */
+/*****************************************************************************/
+
+// ring buffer (positions are free running byte counters)
+static uint8_t l_ring_buffer[fdrRING_BUFFER_SIZE];
+static volatile uint32_t l_ring_reserve_pos;
+static volatile uint32_t l_ring_read_pos;
+
+// block assembly
+static uint8_t l_block_buffer[fdrBLOCK_SIZE];
+static uint16_t l_block_data_length;
+static uint32_t l_block_sequence;
+static uint64_t l_block_start_time;
+static uint64_t l_block_end_time;
+
+// recording time (unwrapped high resolution timestamp)
+static bool l_time_valid;
+static sysHighresTimestamp l_last_timestamp;
+static uint64_t l_time;
+
+static fdrRecorderStatistics l_recorder_statistics;
+static volatile uint32_t l_dropped_record_count;
+
+// task variables
+static volatile bool l_recorder_running = false;
+static bool l_stop_task = false;
+static sysTaskNotify l_task_event;
+static sysTaskNotify l_task_stopped_event;
+
+/*****************************************************************************/
+/* Function implementation                                                   */
+/*****************************************************************************/
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Initializes flight data recorder (recording is started by fdrRecorderStart)
+void fdrRecorderInitialize(void)
+{
+	l_ring_reserve_pos = 0;
+	l_ring_read_pos = 0;
+	sysMemZero(l_ring_buffer, sizeof(l_ring_buffer));
+
+	l_block_data_length = 0;
+	l_block_sequence = 0;
+	l_time_valid = false;
+	l_time = 0;
+
+	sysMemZero(&l_recorder_statistics, sizeof(l_recorder_statistics));
+	l_dropped_record_count = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Opens the log and starts recording. The log is limited to fdrMAXIMUM_BLOCK_COUNT blocks.
+/// @param in_log_name Name of the log in the log storage
+/// @return True if recording is started
+bool fdrRecorderStart(const char* in_log_name)
+{
+	sysTask task_handle;
+
+	if (l_recorder_running)
+		return false;
+
+	// open log storage
+	if (!drvFDRStorageOpen(in_log_name))
+		return false;
+
+	sysTaskNotifyCreate(l_task_event);
+
+	l_stop_task = false;
+	l_recorder_running = true;
+
+	sysTaskCreate(fdrRecorderTask, "fdrRecorder", sysDEFAULT_STACK_SIZE, sysNULL, fdrRECORDER_TASK_PRIORITY, &task_handle, fdrRecorderTaskStop);
+
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Stops recorder task, all recorded data is written into the log before the function returns
+void fdrRecorderTaskStop(void)
+{
+	if (!l_recorder_running)
+		return;
+
+	sysTaskNotifyCreate(l_task_stopped_event);
+
+	l_recorder_running = false;
+	l_stop_task = true;
+	sysTaskNotifyGive(l_task_event);
+
+	// wait for log flush
+	sysTaskNotifyTake(l_task_stopped_event, fdrRECORDER_STOP_TIMEOUT);
+	sysTaskNotifyDelete(l_task_stopped_event);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Appends record to the log. This function is lock free, it can be called from any task. When the ring
+/// buffer is full the record is dropped.
+/// @param in_type Record type (fdrRT_xxx)
+/// @param in_channel Object, interface or sensor index
+/// @param in_data Record data
+/// @param in_length Record data length
+/// @return True if record was stored, false when it was dropped
+bool fdrRecordData(uint8_t in_type, uint8_t in_channel, const void* in_data, uint16_t in_length)
+{
+	fdrRingRecordHeader* record;
+	sysHighresTimestamp timestamp;
+	uint32_t reserve_pos;
+	uint32_t record_pos;
+	uint32_t record_size;
+	uint32_t reserved_size;
+	uint32_t tail_size;
+
+	if (!l_recorder_running || l_recorder_statistics.LogFull)
+		return false;
+
+	sysASSERT(in_length <= fdrMAX_RECORD_DATA_LENGTH);
+
+	record_size = (sizeof(fdrRingRecordHeader) + in_length + fdrRING_ALIGNMENT - 1) & ~(fdrRING_ALIGNMENT - 1);
+
+	// reserve space in the ring buffer
+	do
+	{
+		timestamp = sysHighresTimerGetTimestamp();
+		reserve_pos = l_ring_reserve_pos;
+		record_pos = reserve_pos;
+		reserved_size = record_size;
+
+		// records are not wrapped around, the end of the buffer is skipped if the record doesn't fit
+		tail_size = fdrRING_BUFFER_SIZE - (reserve_pos & fdrRING_BUFFER_MASK);
+		if (tail_size < record_size)
+		{
+			record_pos += tail_size;
+			reserved_size += tail_size;
+		}
+
+		// check free space
+		if (reserve_pos + reserved_size - l_ring_read_pos > fdrRING_BUFFER_SIZE)
+		{
+			fdrRecorderAtomicIncrement(&l_dropped_record_count);
+			return false;
+		}
+	} while (!sysAtomicCompareAndSwap(&l_ring_reserve_pos, reserve_pos, reserve_pos + reserved_size));
+
+	// mark skipped space (there is no room for the header when the skipped space is smaller than a header)
+	if (record_pos != reserve_pos && tail_size >= sizeof(fdrRingRecordHeader))
+	{
+		record = (fdrRingRecordHeader*)&l_ring_buffer[reserve_pos & fdrRING_BUFFER_MASK];
+		record->Length = (uint16_t)(tail_size - sizeof(fdrRingRecordHeader));
+		record->Type = fdrRT_PADDING;
+		sysMemoryBarrier();
+		record->State = fdrRING_RECORD_COMMITTED;
+	}
+
+	// store record
+	record = (fdrRingRecordHeader*)&l_ring_buffer[record_pos & fdrRING_BUFFER_MASK];
+	record->Timestamp = timestamp;
+	record->Length = in_length;
+	record->Type = in_type;
+	record->Channel = in_channel;
+	sysMemCopy((uint8_t*)record + sizeof(fdrRingRecordHeader), in_data, in_length);
+
+	// record data must be complete before commit
+	sysMemoryBarrier();
+	record->State = fdrRING_RECORD_COMMITTED;
+
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Gets recorder statistics
+/// @param out_statistics Statistics structure to fill
+void fdrRecorderGetStatistics(fdrRecorderStatistics* out_statistics)
+{
+	sysCriticalSectionBegin();
+	*out_statistics = l_recorder_statistics;
+	out_statistics->DroppedRecordCount = l_dropped_record_count;
+	sysCriticalSectionEnd();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Recorder task function (moves records from the ring buffer to the log storage)
+static sysTaskRetval fdrRecorderTask(sysTaskParam in_param)
+{
+	sysUNUSED(in_param);
+
+	// task loop
+	while (!l_stop_task)
+	{
+		// wait for event
+		sysTaskNotifyTake(l_task_event, fdrRECORDER_TASK_CYCLE_TIME);
+
+		fdrRecorderProcessRingBuffer();
+	}
+
+	// write pending records (recording is stopped, no more records are reserved after the pending ones are committed)
+	fdrRecorderProcessRingBuffer();
+	if (l_block_data_length > 0)
+		fdrRecorderWriteBlock();
+
+	drvFDRStorageClose();
+
+	sysTaskNotifyGive(l_task_stopped_event);
+
+	return (sysTaskRetval)0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Moves all committed records from the ring buffer into the log blocks
+static void fdrRecorderProcessRingBuffer(void)
+{
+	fdrRingRecordHeader* record;
+	uint32_t read_pos;
+	uint32_t tail_size;
+	uint32_t record_size;
+	uint32_t ring_usage;
+
+	read_pos = l_ring_read_pos;
+
+	ring_usage = l_ring_reserve_pos - read_pos;
+	if (ring_usage > l_recorder_statistics.MaxRingUsage)
+		l_recorder_statistics.MaxRingUsage = ring_usage;
+
+	while (read_pos != l_ring_reserve_pos)
+	{
+		// skip the end of the buffer when it is smaller than a record header
+		tail_size = fdrRING_BUFFER_SIZE - (read_pos & fdrRING_BUFFER_MASK);
+		if (tail_size < sizeof(fdrRingRecordHeader))
+		{
+			read_pos += tail_size;
+			continue;
+		}
+
+		// stop at the first uncommitted record
+		record = (fdrRingRecordHeader*)&l_ring_buffer[read_pos & fdrRING_BUFFER_MASK];
+		if (record->State != fdrRING_RECORD_COMMITTED)
+			break;
+
+		// record content must be read after the state
+		sysMemoryBarrier();
+
+		record_size = (sizeof(fdrRingRecordHeader) + record->Length + fdrRING_ALIGNMENT - 1) & ~(fdrRING_ALIGNMENT - 1);
+
+		if (record->Type != fdrRT_PADDING)
+			fdrRecorderStoreRecord(record);
+
+		// release record (the whole record is cleared, its data must not look like a committed header later)
+		sysMemZero(record, record_size);
+		read_pos += record_size;
+
+		sysMemoryBarrier();
+		l_ring_read_pos = read_pos;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Stores one record in the current log block
+/// @param in_record Record to store
+static void fdrRecorderStoreRecord(fdrRingRecordHeader* in_record)
+{
+	fdrRecordHeader* header;
+	uint32_t elapsed_time;
+
+	// update recording time (timestamps of the concurrent records are not strictly ordered, time is not allowed to go backward)
+	if (l_time_valid)
+	{
+		elapsed_time = in_record->Timestamp - l_last_timestamp;
+		if ((int32_t)elapsed_time > 0)
+		{
+			l_time += elapsed_time;
+			l_last_timestamp = in_record->Timestamp;
+		}
+	}
+	else
+	{
+		l_last_timestamp = in_record->Timestamp;
+		l_time_valid = true;
+	}
+
+	// start new block if the record doesn't fit or its time offset can't be stored
+	if (l_block_data_length > 0 && (l_block_data_length + sizeof(fdrRecordHeader) + in_record->Length > fdrBLOCK_DATA_SIZE || l_time - l_block_start_time > 0xfffffffful))
+		fdrRecorderWriteBlock();
+
+	if (l_block_data_length == 0)
+		l_block_start_time = l_time;
+
+	// store record
+	header = (fdrRecordHeader*)&l_block_buffer[sizeof(fdrBlockHeader) + l_block_data_length];
+	header->TimeOffset = (uint32_t)(l_time - l_block_start_time);
+	header->Length = in_record->Length;
+	header->Type = in_record->Type;
+	header->Channel = in_record->Channel;
+	sysMemCopy((uint8_t*)header + sizeof(fdrRecordHeader), (uint8_t*)in_record + sizeof(fdrRingRecordHeader), in_record->Length);
+
+	l_block_data_length += sizeof(fdrRecordHeader) + in_record->Length;
+	l_block_end_time = l_time;
+
+	l_recorder_statistics.RecordCount++;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Writes current block into the log storage
+static void fdrRecorderWriteBlock(void)
+{
+	fdrBlockHeader* header = (fdrBlockHeader*)l_block_buffer;
+
+	// records are discarded when the log is full
+	if (l_recorder_statistics.LogFull)
+	{
+		l_block_data_length = 0;
+		return;
+	}
+
+	header->Magic = fdrBLOCK_MAGIC;
+	header->Version = fdrFORMAT_VERSION;
+	header->DataLength = l_block_data_length;
+	header->Sequence = l_block_sequence++;
+	header->StartTime = l_block_start_time;
+	header->EndTime = l_block_end_time;
+	header->CRC = crc16CalculateForBlock(crc16_INIT_VALUE, &l_block_buffer[sizeof(fdrBlockHeader)], l_block_data_length);
+	header->Reserved = 0;
+
+	// clear unused part of the block
+	sysMemZero(&l_block_buffer[sizeof(fdrBlockHeader) + l_block_data_length], fdrBLOCK_DATA_SIZE - l_block_data_length);
+
+	if (drvFDRStorageWrite(l_block_buffer, fdrBLOCK_SIZE))
+		l_recorder_statistics.BlockCount++;
+	else
+		l_recorder_statistics.WriteErrorCount++;
+
+	l_block_data_length = 0;
+
+	// stop recording at the maximum log size
+	if (l_recorder_statistics.BlockCount >= fdrMAXIMUM_BLOCK_COUNT)
+		l_recorder_statistics.LogFull = true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Increments value without locking
+/// @param in_value Pointer to the value to increment
+static void fdrRecorderAtomicIncrement(volatile uint32_t* in_value)
+{
+	uint32_t value;
+
+	do
+	{
+		value = *in_value;
+	} while (!sysAtomicCompareAndSwap(in_value, value, value + 1));
+}
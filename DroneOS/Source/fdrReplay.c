@@ -0,0 +1,401 @@
+/*****************************************************************************/
+/* Flight data recorder log replay (for host builds)                         */
+/*                                                                           */
+/* Copyright (C) 2017 Laszlo Arvai                                           */
+/* All rights reserved.                                                      */
+/*                                                                           */
+/* This software may be modified and distributed under the terms             */
+/* of the GNU General Public License.  See the LICENSE file for details.     */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/* Includes                                                                  */
+/*****************************************************************************/
+#include <stdio.h>
+#include <sysRTOS.h>
+#include <crcCITT16.h>
+#include <roxStorage.h>
+#include <comManager.h>
+#include <comSystemPacketDefinitions.h>
+#include <fdrReplay.h>
+
+/*****************************************************************************/
+/* Constants                                                                 */
+/*****************************************************************************/
+#define fdrREPLAY_TASK_PRIORITY 2
+#define fdrREPLAY_INVALID_BLOCK_INDEX 0xfffffffful
+
+/*****************************************************************************/
+/* Local function prototypes                                                 */
+/*****************************************************************************/
+static sysTaskRetval fdrReplayTask(sysTaskParam in_param);
+static bool fdrReplayReadBlock(uint32_t in_block_index, bool in_header_only);
+static uint32_t fdrReplayFindValidBlock(uint32_t in_first_block_index, uint32_t in_last_block_index, bool in_header_only);
+static void fdrReplayFeedRecord(fdrReplayRecord* in_record);
+static bool fdrReplayPacketSend(uint8_t* in_packet, uint16_t in_packet_length);
+
+/*****************************************************************************/
+/* Module global variables                                                   */
+/*****************************************************************************/
+
+// log reader variables
+static FILE* l_log_file = NULL;
+static uint32_t l_block_count;
+static uint32_t l_block_index = fdrREPLAY_INVALID_BLOCK_INDEX;
+static uint16_t l_block_pos;
+static uint8_t l_block_buffer[fdrBLOCK_SIZE];
+static uint32_t l_invalid_block_count;
+
+// replay task variables
+static uint16_t l_replay_speed;
+static fdrReplaySensorCallback l_sensor_callback = sysNULL;
+static bool l_republished_objects[roxTOTAL_OBJECT_COUNT];
+static volatile bool l_replay_running = false;
+static bool l_stop_task = false;
+static uint8_t l_interface_index = comINVALID_INTERFACE_INDEX;
+
+/*****************************************************************************/
+/* Log reader functions                                                      */
+/*****************************************************************************/
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Opens log file for reading and positions to the first record
+/// @param in_file_name Name of the log file
+/// @return True if file is opened
+bool fdrReplayOpen(const char* in_file_name)
+{
+	long file_length;
+
+	fdrReplayClose();
+
+	l_log_file = fopen(in_file_name, "rb");
+	if (l_log_file == NULL)
+		return false;
+
+	// get number of blocks (incomplete block at the end of the file is ignored)
+	fseek(l_log_file, 0, SEEK_END);
+	file_length = ftell(l_log_file);
+	l_block_count = (file_length > 0) ? (uint32_t)(file_length / fdrBLOCK_SIZE) : 0;
+
+	l_invalid_block_count = 0;
+
+	return fdrReplaySeek(0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Closes log file
+void fdrReplayClose(void)
+{
+	if (l_log_file != NULL)
+	{
+		fclose(l_log_file);
+		l_log_file = NULL;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Positions to the first record with timestamp equal or greater than the given time. The block is
+/// found by binary search using the time range stored in the block headers.
+/// @param in_time Time to seek to [us since recording start]
+/// @return True if success, false if there is no valid block in the log
+bool fdrReplaySeek(uint64_t in_time)
+{
+	fdrBlockHeader* header = (fdrBlockHeader*)l_block_buffer;
+	uint32_t first_block_index;
+	uint32_t last_block_index;
+	uint32_t middle_block_index;
+	uint32_t block_index;
+	fdrReplayRecord record;
+
+	if (l_log_file == NULL || l_block_count == 0)
+		return false;
+
+	// find the last block starting before the given time
+	first_block_index = fdrReplayFindValidBlock(0, l_block_count - 1, true);
+	if (first_block_index == fdrREPLAY_INVALID_BLOCK_INDEX)
+		return false;
+
+	last_block_index = l_block_count - 1;
+	while (first_block_index < last_block_index)
+	{
+		middle_block_index = first_block_index + (last_block_index - first_block_index + 1) / 2;
+
+		block_index = fdrReplayFindValidBlock(middle_block_index, last_block_index, true);
+		if (block_index != fdrREPLAY_INVALID_BLOCK_INDEX && header->StartTime <= in_time)
+			first_block_index = block_index;
+		else
+			last_block_index = middle_block_index - 1;
+	}
+
+	// load the block
+	l_block_index = fdrReplayFindValidBlock(first_block_index, l_block_count - 1, false);
+	l_block_pos = 0;
+
+	if (l_block_index == fdrREPLAY_INVALID_BLOCK_INDEX)
+		return false;
+
+	// skip earlier records
+	while (fdrReplayReadRecord(&record))
+	{
+		if (record.Time >= in_time)
+		{
+			// step back to the found record (it is always in the current block)
+			l_block_pos -= (uint16_t)(sizeof(fdrRecordHeader) + record.Length);
+			break;
+		}
+	}
+
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Reads the next record from the log. Invalid blocks are skipped.
+/// @param out_record Receives the record
+/// @return True if record was read, false at the end of the log
+bool fdrReplayReadRecord(fdrReplayRecord* out_record)
+{
+	fdrBlockHeader* header = (fdrBlockHeader*)l_block_buffer;
+	fdrRecordHeader record_header;
+
+	if (l_log_file == NULL || l_block_index == fdrREPLAY_INVALID_BLOCK_INDEX)
+		return false;
+
+	// step to the next block at the end of the current one
+	while (l_block_pos + sizeof(fdrRecordHeader) > header->DataLength)
+	{
+		if (l_block_index + 1 >= l_block_count)
+			return false;
+
+		l_block_index = fdrReplayFindValidBlock(l_block_index + 1, l_block_count - 1, false);
+		l_block_pos = 0;
+
+		if (l_block_index == fdrREPLAY_INVALID_BLOCK_INDEX)
+			return false;
+	}
+
+	sysMemCopy(&record_header, &l_block_buffer[sizeof(fdrBlockHeader) + l_block_pos], sizeof(fdrRecordHeader));
+
+	// sanity check
+	if (l_block_pos + sizeof(fdrRecordHeader) + record_header.Length > header->DataLength)
+		return false;
+
+	out_record->Time = header->StartTime + record_header.TimeOffset;
+	out_record->Type = record_header.Type;
+	out_record->Channel = record_header.Channel;
+	out_record->Length = record_header.Length;
+	out_record->Data = &l_block_buffer[sizeof(fdrBlockHeader) + l_block_pos + sizeof(fdrRecordHeader)];
+
+	l_block_pos += sizeof(fdrRecordHeader) + record_header.Length;
+
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Gets number of invalid (corrupted) blocks found in the log
+/// @return Number of invalid blocks
+uint32_t fdrReplayGetInvalidBlockCount(void)
+{
+	return l_invalid_block_count;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Reads and validates block
+/// @param in_block_index Index of the block to read
+/// @param in_header_only True if only the header must be read
+/// @return True if block is valid
+static bool fdrReplayReadBlock(uint32_t in_block_index, bool in_header_only)
+{
+	fdrBlockHeader* header = (fdrBlockHeader*)l_block_buffer;
+	size_t length;
+
+	length = in_header_only ? sizeof(fdrBlockHeader) : fdrBLOCK_SIZE;
+
+	if (fseek(l_log_file, (long)in_block_index * fdrBLOCK_SIZE, SEEK_SET) != 0 || fread(l_block_buffer, sizeof(uint8_t), length, l_log_file) != length)
+		return false;
+
+	if (header->Magic != fdrBLOCK_MAGIC || header->Version != fdrFORMAT_VERSION || header->DataLength > fdrBLOCK_SIZE - sizeof(fdrBlockHeader))
+		return false;
+
+	if (!in_header_only && header->CRC != crc16CalculateForBlock(crc16_INIT_VALUE, &l_block_buffer[sizeof(fdrBlockHeader)], header->DataLength))
+		return false;
+
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Finds and reads the first valid block in the given range
+/// @param in_first_block_index First block of the range
+/// @param in_last_block_index Last block of the range
+/// @param in_header_only True if only the header must be read
+/// @return Index of the valid block or fdrREPLAY_INVALID_BLOCK_INDEX when there is no valid block in the range
+static uint32_t fdrReplayFindValidBlock(uint32_t in_first_block_index, uint32_t in_last_block_index, bool in_header_only)
+{
+	uint32_t block_index;
+
+	for (block_index = in_first_block_index; block_index <= in_last_block_index; block_index++)
+	{
+		if (fdrReplayReadBlock(block_index, in_header_only))
+			return block_index;
+
+		if (!in_header_only)
+			l_invalid_block_count++;
+	}
+
+	return fdrREPLAY_INVALID_BLOCK_INDEX;
+}
+
+/*****************************************************************************/
+/* Replay task functions                                                     */
+/*****************************************************************************/
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Starts replaying log. Realtime objects are written into the object storage and received packets are
+/// passed to the communication manager with the original timing (divided by the speed factor).
+/// @param in_file_name Name of the log file
+/// @param in_start_time Replay starts from this time [us since recording start]
+/// @param in_speed Replay speed factor (1 - original speed, fdrREPLAY_MAXIMUM_SPEED - no delay between records)
+/// @return True if replay is started
+bool fdrReplayStart(const char* in_file_name, uint64_t in_start_time, uint16_t in_speed)
+{
+	sysTask task_handle;
+	comInterfaceDescription interface_description;
+
+	if (!fdrReplayOpen(in_file_name))
+		return false;
+
+	// replayed packets are received on a separate interface (the receiver queue of an interface can have only
+	// one producer), the responses generated by the replayed system are dropped
+	if (l_interface_index == comINVALID_INTERFACE_INDEX)
+	{
+		interface_description.PacketSendFunction = fdrReplayPacketSend;
+		l_interface_index = comAddInterface(&interface_description);
+	}
+
+	if (!fdrReplaySeek(in_start_time))
+		return false;
+
+	l_replay_speed = in_speed;
+	l_stop_task = false;
+	l_replay_running = true;
+
+	sysTaskCreate(fdrReplayTask, "fdrReplay", sysDEFAULT_STACK_SIZE, sysNULL, fdrREPLAY_TASK_PRIORITY, &task_handle, fdrReplayTaskStop);
+
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Stops replay task
+void fdrReplayTaskStop(void)
+{
+	l_stop_task = true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Checks if replay is in progress
+/// @return True while replay task is running
+bool fdrReplayIsRunning(void)
+{
+	return l_replay_running;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Sets callback function for replaying raw sensor records
+/// @param in_callback Callback function
+void fdrReplaySetSensorCallback(fdrReplaySensorCallback in_callback)
+{
+	l_sensor_callback = in_callback;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Marks object as published by a module fed from the replayed sensor records. The recorded object
+/// records are skipped, the object is generated again by the replayed module.
+/// @param in_object_index Index of the republished object
+void fdrReplaySetRepublishedObject(roxObjectIndex in_object_index)
+{
+	if (in_object_index < roxTOTAL_OBJECT_COUNT)
+		l_republished_objects[in_object_index] = true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Replay task function
+static sysTaskRetval fdrReplayTask(sysTaskParam in_param)
+{
+	fdrReplayRecord record;
+	sysTick start_tick;
+	uint64_t start_time;
+	uint32_t record_tick;
+	uint32_t elapsed_tick;
+	bool first_record = true;
+
+	sysUNUSED(in_param);
+
+	start_tick = sysGetSystemTick();
+	start_time = 0;
+
+	while (!l_stop_task && fdrReplayReadRecord(&record))
+	{
+		if (first_record)
+		{
+			start_time = record.Time;
+			first_record = false;
+		}
+
+		// wait for the record time
+		if (l_replay_speed != fdrREPLAY_MAXIMUM_SPEED)
+		{
+			record_tick = (uint32_t)((record.Time - start_time) / 1000 / l_replay_speed);
+			elapsed_tick = sysGetSystemTickSince(start_tick);
+
+			if (record_tick > elapsed_tick)
+				sysDelay(record_tick - elapsed_tick);
+		}
+
+		fdrReplayFeedRecord(&record);
+	}
+
+	fdrReplayClose();
+
+	l_replay_running = false;
+
+	return (sysTaskRetval)0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Passes record to the system module which originally generated it
+/// @param in_record Record to replay
+static void fdrReplayFeedRecord(fdrReplayRecord* in_record)
+{
+	switch (in_record->Type)
+	{
+		case fdrRT_OBJECT:
+			if (in_record->Channel < roxTOTAL_OBJECT_COUNT && !l_republished_objects[in_record->Channel] && in_record->Length == roxGetObjectSize(in_record->Channel))
+				roxObjectWrite(in_record->Channel, in_record->Data);
+			break;
+
+		case fdrRT_PACKET_RECEIVED:
+			comManagerStoreReceivedPacket(l_interface_index, in_record->Data, (uint8_t)in_record->Length);
+			break;
+
+		case fdrRT_SENSOR:
+			if (l_sensor_callback != sysNULL)
+				l_sensor_callback(in_record->Channel, in_record->Data, in_record->Length);
+			break;
+
+		default:
+			// transmitted packets are generated again by the replayed system
+			break;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Packet send function of the replay interface (packets are dropped)
+/// @param in_packet Packet to send
+/// @param in_packet_length Length of the packet
+/// @return Always true (packet is accepted)
+static bool fdrReplayPacketSend(uint8_t* in_packet, uint16_t in_packet_length)
+{
+	sysUNUSED(in_packet);
+	sysUNUSED(in_packet_length);
+
+	return true;
+}
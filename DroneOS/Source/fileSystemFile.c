@@ -14,10 +14,97 @@
 #include <fileSystemFiles.h>
 #include <sysString.h>
 
+/*****************************************************************************/
+/* Constants                                                                 */
+/*****************************************************************************/
+
+// size of the file name hash index (must be power of two and greater than the number of files)
+#ifndef fileSystemFile_INDEX_SIZE
+#define fileSystemFile_INDEX_SIZE 32
+#endif
+
+#define fileSystemFile_INDEX_MASK (fileSystemFile_INDEX_SIZE - 1)
+
+// number of files (starting from file ID 0) whose MD5 hash is stored after the first calculation (read-only files only)
+#ifndef fileSystemFile_HASH_CACHE_SIZE
+#define fileSystemFile_HASH_CACHE_SIZE 4
+#endif
+
+// FNV-1a hash constants
+#define fileSystemFile_HASH_OFFSET 2166136261ul
+#define fileSystemFile_HASH_PRIME 16777619ul
+
+/*****************************************************************************/
+/* Module local variables                                                    */
+/*****************************************************************************/
+static fileInternalFileTableEntry* l_file_table = g_system_files_info_table;
+static uint8_t l_file_index[fileSystemFile_INDEX_SIZE];
+static uint8_t l_file_count = 0;
+static bool l_initialized = false;
+static bool l_index_valid = false;
+static crcMD5Hash l_file_hash[fileSystemFile_HASH_CACHE_SIZE];
+static bool l_file_hash_valid[fileSystemFile_HASH_CACHE_SIZE];
+
+/*****************************************************************************/
+/* Local function prototypes                                                 */
+/*****************************************************************************/
+static uint32_t fileSystemFileNameHash(sysConstString in_file_name);
+
 /*****************************************************************************/
 /* Function implementation                                                   */
 /*****************************************************************************/
 
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Initializes system file handler (builds file name index and caches file count). Other
+/// functions initialize the handler on first use when this function is not called.
+void fileSystemFileInit(void)
+{
+	uint8_t count;
+	uint8_t index;
+	uint32_t slot;
+
+	// count file entries
+	count = 0;
+	while (l_file_table[count].Name != sysNULL)
+		count++;
+
+	// build file name hash index (open addressing with linear probing)
+	for (slot = 0; slot < fileSystemFile_INDEX_SIZE; slot++)
+		l_file_index[slot] = fileINVALID_SYSTEM_FILE_ID;
+
+	l_index_valid = (count < fileSystemFile_INDEX_SIZE);
+
+	if (l_index_valid)
+	{
+		for (index = 0; index < count; index++)
+		{
+			slot = fileSystemFileNameHash(l_file_table[index].Name) & fileSystemFile_INDEX_MASK;
+
+			while (l_file_index[slot] != fileINVALID_SYSTEM_FILE_ID)
+				slot = (slot + 1) & fileSystemFile_INDEX_MASK;
+
+			l_file_index[slot] = index;
+		}
+	}
+
+	// stored hashes belong to the previous table
+	for (index = 0; index < fileSystemFile_HASH_CACHE_SIZE; index++)
+		l_file_hash_valid[index] = false;
+
+	l_file_count = count;
+	l_initialized = true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Replaces the system file table and rebuilds the file name index
+/// @param in_file_table New file table (terminated by an entry with sysNULL name)
+void fileSystemFileSetTable(fileInternalFileTableEntry* in_file_table)
+{
+	l_file_table = in_file_table;
+
+	fileSystemFileInit();
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 /// @brief Convert file name to file index
 /// @param in_file_name Filename to convert
@@ -25,17 +112,33 @@
 uint8_t fileSystemFileGetIndex(sysString in_file_name)
 {
 	uint8_t index;
+	uint32_t slot;
 
-	index = 0;
-	while (g_system_files_info_table[index].Name != sysNULL)
+	if (!l_initialized)
+		fileSystemFileInit();
+
+	if (l_index_valid)
 	{
-		if (sysCompareConstStringNoCase(in_file_name, g_system_files_info_table[index].Name) == 0)
+		// hash index lookup
+		slot = fileSystemFileNameHash(in_file_name) & fileSystemFile_INDEX_MASK;
+
+		while (l_file_index[slot] != fileINVALID_SYSTEM_FILE_ID)
 		{
-			return index;
+			index = l_file_index[slot];
+
+			if (sysCompareConstStringNoCase(in_file_name, l_file_table[index].Name) == 0)
+				return index;
+
+			slot = (slot + 1) & fileSystemFile_INDEX_MASK;
 		}
-		else
+	}
+	else
+	{
+		// index is too small for the file table, use linear search
+		for (index = 0; index < l_file_count; index++)
 		{
-			index++;
+			if (sysCompareConstStringNoCase(in_file_name, l_file_table[index].Name) == 0)
+				return index;
 		}
 	}
 
@@ -47,16 +150,10 @@ uint8_t fileSystemFileGetIndex(sysString in_file_name)
 /// @return Number of system files
 uint8_t fileSystemFileGetCount(void)
 {
-	uint8_t index;
-
-	// file entries
-	index = 0;
-	while (g_system_files_info_table[index].Name != sysNULL)
-	{
-		index++;
-	}
+	if (!l_initialized)
+		fileSystemFileInit();
 
-	return index;
+	return l_file_count;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -65,21 +162,17 @@ uint8_t fileSystemFileGetCount(void)
 /// @return Length of the file
 uint32_t fileSystemFileGetLength(uint8_t in_file_index)
 {
-	uint8_t file_count;
-
-	file_count = fileSystemFileGetCount();
-
-	if (in_file_index < file_count)
+	if (in_file_index < fileSystemFileGetCount())
 	{
-		if (g_system_files_info_table[in_file_index].Callback == sysNULL)
+		if (l_file_table[in_file_index].Callback == sysNULL)
 		{
-			return g_system_files_info_table[in_file_index].Length;
+			return l_file_table[in_file_index].Length;
 		}
 		else
 		{
 			uint32_t length;
 
-			if (g_system_files_info_table[in_file_index].Callback(fileCF_GetLength, &length, sizeof(length), 0))
+			if (l_file_table[in_file_index].Callback(fileCF_GetLength, &length, sizeof(length), 0))
 				return length;
 			else
 				return 0;
@@ -97,12 +190,8 @@ uint32_t fileSystemFileGetLength(uint8_t in_file_index)
 /// @return File flags (see fileSFF_ values for possible flag values)
 uint8_t fileSystemFileGetFlag(uint8_t in_file_index)
 {
-	uint8_t file_count;
-
-	file_count = fileSystemFileGetCount();
-
-	if (in_file_index < file_count)
-		return g_system_files_info_table[in_file_index].Flags;
+	if (in_file_index < fileSystemFileGetCount())
+		return l_file_table[in_file_index].Flags;
 	else
 		return 0;
 }
@@ -113,21 +202,17 @@ uint8_t fileSystemFileGetFlag(uint8_t in_file_index)
 /// @return Pointer to the binary buffer
 const uint8_t* fileSystemFileGetContent(uint8_t in_file_index)
 {
-	uint8_t file_count;
-
-	file_count = fileSystemFileGetCount();
-
-	if (in_file_index < file_count)
+	if (in_file_index < fileSystemFileGetCount())
 	{
-		if (g_system_files_info_table[in_file_index].Callback == sysNULL)
+		if (l_file_table[in_file_index].Callback == sysNULL)
 		{
-			return (uint8_t*)g_system_files_info_table[in_file_index].Content;
+			return (uint8_t*)l_file_table[in_file_index].Content;
 		}
 		else
 		{
 			uint8_t* content;
 
-			if (g_system_files_info_table[in_file_index].Callback(fileCF_GetContent, &content, sizeof(content), 0))
+			if (l_file_table[in_file_index].Callback(fileCF_GetContent, &content, sizeof(content), 0))
 				return content;
 			else
 				return sysNULL;
@@ -138,3 +223,67 @@ const uint8_t* fileSystemFileGetContent(uint8_t in_file_index)
 		return sysNULL;
 	}
 }
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Gets MD5 hash of a system file. Hash of the read-only files is calculated only at the first call.
+/// @param in_file_index System file index
+/// @param out_hash Hash of the file content
+/// @return True if hash is available
+bool fileSystemFileGetHash(uint8_t in_file_index, crcMD5Hash* out_hash)
+{
+	fileInternalFileTableEntry* file_info;
+	crcMD5State md5_state;
+	bool cacheable;
+
+	if (in_file_index >= fileSystemFileGetCount())
+		return false;
+
+	file_info = &l_file_table[in_file_index];
+
+	// file handler calculates the hash
+	if (file_info->Callback != sysNULL)
+		return file_info->Callback(fileCF_GetMD5, out_hash, sizeof(crcMD5Hash), 0);
+
+	// use stored hash
+	cacheable = (in_file_index < fileSystemFile_HASH_CACHE_SIZE) && ((file_info->Flags & fileSFF_READ_WRITE) == 0);
+	if (cacheable && l_file_hash_valid[in_file_index])
+	{
+		*out_hash = l_file_hash[in_file_index];
+		return true;
+	}
+
+	// calculate hash
+	crcMD5Open(&md5_state);
+	crcMD5Update(&md5_state, file_info->Content, file_info->Length);
+	crcMD5Close(&md5_state, out_hash);
+
+	if (cacheable)
+	{
+		l_file_hash[in_file_index] = *out_hash;
+		l_file_hash_valid[in_file_index] = true;
+	}
+
+	return true;
+}
+
+/*****************************************************************************/
+/* Local functions                                                           */
+/*****************************************************************************/
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Calculates case insensitive hash of the file name
+/// @param in_file_name File name
+/// @return Hash value
+static uint32_t fileSystemFileNameHash(sysConstString in_file_name)
+{
+	uint32_t hash = fileSystemFile_HASH_OFFSET;
+
+	while (*in_file_name != '\0')
+	{
+		hash ^= (uint8_t)sysCharToLower(*in_file_name);
+		hash *= fileSystemFile_HASH_PRIME;
+		in_file_name++;
+	}
+
+	return hash;
+}
@@ -16,12 +16,67 @@
 #include <comSystemPacketDefinitions.h>
 #include <crcMD5.h>
 
+///////////////////////////////////////////////////////////////////////////////
+// Constants
+
+// number of files (starting from file ID 0) with cached MD5 hash
+#ifndef fileTransfer_HASH_CACHE_SIZE
+#define fileTransfer_HASH_CACHE_SIZE 4
+#endif
+
+// number of stored intermediate MD5 states per file (for partial recalculation of the hash of the changed files)
+#ifndef fileTransfer_HASH_CHECKPOINT_COUNT
+#define fileTransfer_HASH_CHECKPOINT_COUNT 4
+#endif
+
+#define fileTransfer_HASH_BLOCK_SIZE 64
+
+// maximum data length of one read response packet
+#define fileTransfer_MAX_BLOCK_LENGTH (comMAX_PACKET_SIZE - sizeof(comFileDataReadResponseHeader) - comCRC_BYTE_COUNT)
+
+///////////////////////////////////////////////////////////////////////////////
+// Types
+
+/// Cached MD5 hash of a file
+typedef struct
+{
+	crcMD5State Checkpoints[fileTransfer_HASH_CHECKPOINT_COUNT]; // MD5 state after every 'CheckpointDistance' bytes
+	crcMD5Hash Hash;						// MD5 hash of the whole file
+	uint32_t Length;						// length of the file when the hash was calculated
+	uint32_t CheckpointDistance;	// number of bytes between checkpoints
+	uint32_t ValidLength;				// number of bytes not changed since the hash calculation
+	uint32_t ChangeCounter;			// change counter of the file handler callback
+	bool Valid;
+} fileHashCacheEntry;
+
+/// State of the windowed read operation
+typedef struct
+{
+	uint32_t Pos;					// position of the first block of the window
+	uint32_t BlockMask;		// blocks waiting for transmission (bit n: block at Pos + n * BlockLength)
+	uint8_t BlockLength;	// length of the blocks in bytes
+	uint8_t FileID;
+	uint8_t Interface;
+} fileWindowReadState;
+
+///////////////////////////////////////////////////////////////////////////////
+// Module local variables
+static fileHashCacheEntry l_hash_cache[fileTransfer_HASH_CACHE_SIZE];
+static fileWindowReadState l_window_read_state;
+
 ///////////////////////////////////////////////////////////////////////////////
 // Module local functions
 static void fileProcessFileInfoRequest(comPacketInfo* in_packet_info, comPacketFileInfoRequest* in_request);
 static void fileProcessFileDataReadRequest(comPacketInfo * in_packet_info, comPacketFileDataReadRequest * in_request_packet);
 static void fileProcessFileDataWriteRequest(comPacketInfo* in_packet_info, comPacketFileDataWriteRequestHeader* in_request_packet);
 static void fileProcessFileOperationFinishedRequest(comPacketInfo* in_packet_info, comPacketFileOperationFinishedRequest* in_request_packet);
+static void fileProcessFileDataWindowReadRequest(comPacketInfo* in_packet_info, comPacketFileDataWindowReadRequest* in_request_packet);
+static void fileProcessFileDataWindowWriteRequest(comPacketInfo* in_packet_info, comPacketFileDataWindowWriteRequestHeader* in_request_packet);
+static bool fileSendDataBlock(uint8_t in_interface, uint8_t in_file_id, uint32_t in_pos, uint16_t in_length);
+static uint8_t fileWriteDataBlock(comPacketFileDataWriteRequestHeader* in_request_packet);
+static void fileGetFileHash(uint8_t in_file_id, uint32_t in_file_length, crcMD5Hash* out_hash);
+static void fileHashCacheInvalidate(uint8_t in_file_id, uint32_t in_pos);
+static void fileHashCacheUpdate(fileHashCacheEntry* in_cache_entry, const uint8_t* in_content);
 
 ///////////////////////////////////////////////////////////////////////////////
 /// @brief Processes file request command
@@ -48,6 +103,36 @@ void fileProcessFileTransfer(comPacketInfo* in_packet_info, uint8_t* in_packet)
 		case comPT_FILE_OPERATION_FINISHED_REQUEST:
 			fileProcessFileOperationFinishedRequest(in_packet_info, (comPacketFileOperationFinishedRequest*)in_packet);
 			return;
+
+		case comPT_FILE_DATA_WINDOW_READ_REQUEST:
+			fileProcessFileDataWindowReadRequest(in_packet_info, (comPacketFileDataWindowReadRequest*)in_packet);
+			return;
+
+		case comPT_FILE_DATA_WINDOW_WRITE_REQUEST:
+			fileProcessFileDataWindowWriteRequest(in_packet_info, (comPacketFileDataWindowWriteRequestHeader*)in_packet);
+			return;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Sends pending blocks of the windowed read operation. Must be called periodically and when 
+/// transmitter queue has free space.
+void fileProcessPendingTransfers(void)
+{
+	uint8_t block_index;
+
+	while (l_window_read_state.BlockMask != 0)
+	{
+		// find the first pending block
+		block_index = 0;
+		while ((l_window_read_state.BlockMask & (1ul << block_index)) == 0)
+			block_index++;
+
+		// send block, stop when transmitter queue is full
+		if (!fileSendDataBlock(l_window_read_state.Interface, l_window_read_state.FileID, l_window_read_state.Pos + (uint32_t)block_index * l_window_read_state.BlockLength, l_window_read_state.BlockLength))
+			break;
+
+		l_window_read_state.BlockMask &= ~(1ul << block_index);
 	}
 }
 
@@ -61,7 +146,6 @@ void fileProcessFileTransfer(comPacketInfo* in_packet_info, uint8_t* in_packet)
 static void fileProcessFileInfoRequest(comPacketInfo* in_packet_info, comPacketFileInfoRequest* in_request_packet)
 {
 	comPacketFileInfoResponse* response_packet;
-	crcMD5State md5_state;
 	uint16_t packet_index;
 
 	response_packet = (comPacketFileInfoResponse*)comManagerTransmitPacketPushStart(sizeof(comPacketFileInfoResponse), in_packet_info->Interface, comPT_FILE_INFO_RESPONSE, &packet_index);
@@ -78,11 +162,6 @@ static void fileProcessFileInfoRequest(comPacketInfo* in_packet_info, comPacketF
 			{
 				// store length
 				response_packet->Length = g_system_files_info_table[response_packet->Header.ID].Length;
-
-				// calculate MD5 checksum
-				crcMD5Open(&md5_state);
-				crcMD5Update(&md5_state, g_system_files_info_table[response_packet->Header.ID].Content, g_system_files_info_table[response_packet->Header.ID].Length);
-				crcMD5Close(&md5_state, (crcMD5Hash*)&response_packet->Hash);
 			}
 			else
 			{
@@ -97,69 +176,109 @@ static void fileProcessFileInfoRequest(comPacketInfo* in_packet_info, comPacketF
 				{
 					response_packet->Length = 0;
 				}
-
-				// get MD5
-				g_system_files_info_table[response_packet->Header.ID].Callback(fileCF_GetMD5, response_packet->Hash, sizeof(crcMD5Hash), 0);
 			}
 
-			// start packet transmission
-			comManagerTransmitPacketPushEnd(packet_index);
+			// get MD5 checksum
+			fileGetFileHash(response_packet->Header.ID, response_packet->Length, (crcMD5Hash*)&response_packet->Hash);
 		}
+		else
+		{
+			// file not found (invalid ID is sent back)
+			response_packet->Length = 0;
+			sysMemZero(response_packet->Hash, sizeof(response_packet->Hash));
+		}
+
+		// start packet transmission (reserved packet must always be finished otherwise it blocks the transmitter queue)
+		comManagerTransmitPacketPushEnd(packet_index);
 	}
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 /// @brief Process file data request packet
 static void fileProcessFileDataReadRequest(comPacketInfo* in_packet_info, comPacketFileDataReadRequest* in_request_packet)
+{
+	fileSendDataBlock(in_packet_info->Interface, in_request_packet->Header.ID, in_request_packet->Pos, in_request_packet->Length);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Process windowed file data read request. Requested blocks are sent when there is free space in
+/// the transmitter queue. New request replaces the blocks of the previous window not sent yet, the missing
+/// blocks can be requested again by the next window.
+static void fileProcessFileDataWindowReadRequest(comPacketInfo* in_packet_info, comPacketFileDataWindowReadRequest* in_request_packet)
+{
+	l_window_read_state.Interface = in_packet_info->Interface;
+	l_window_read_state.FileID = in_request_packet->Header.ID;
+	l_window_read_state.Pos = in_request_packet->Pos;
+	l_window_read_state.BlockLength = in_request_packet->BlockLength;
+	l_window_read_state.BlockMask = in_request_packet->BlockMask;
+
+	if (l_window_read_state.BlockLength == 0 || l_window_read_state.BlockLength > fileTransfer_MAX_BLOCK_LENGTH)
+		l_window_read_state.BlockLength = fileTransfer_MAX_BLOCK_LENGTH;
+
+	fileProcessPendingTransfers();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Sends one block of file data (read response)
+/// @param in_interface Interface index where response is sent
+/// @param in_file_id File ID (index)
+/// @param in_pos Position of the block within the file
+/// @param in_length Length of the block (truncated to the packet and file size)
+/// @return False if transmitter queue is full, true if block was sent or it can't be sent (invalid request)
+static bool fileSendDataBlock(uint8_t in_interface, uint8_t in_file_id, uint32_t in_pos, uint16_t in_length)
 {
 	uint16_t packet_index;
 	comFileDataReadResponseHeader* response_packet;
-	uint16_t data_length = in_request_packet->Length;
-	uint8_t* source_data_pointer;
 	uint8_t* destination_data_pointer;
-	uint32_t file_data_length;
-	uint8_t system_file_count;
+	uint32_t file_length;
+	uint16_t data_length;
 
 	// check file id validity
-	system_file_count = fileSystemFileGetCount();
-	if (in_request_packet->Header.ID >= system_file_count)
-		return;
+	if (in_file_id >= fileSystemFileGetCount())
+		return true;
 
 	// check file length
-	if (in_request_packet->Pos >= g_system_files_info_table[in_request_packet->Header.ID].Length)
-		return;
+	file_length = fileSystemFileGetLength(in_file_id);
+	if (in_pos >= file_length)
+		return true;
 
-	file_data_length = in_request_packet->Length;
-	if (in_request_packet->Pos + in_request_packet->Length >= g_system_files_info_table[in_request_packet->Header.ID].Length)
-	{
-		file_data_length = g_system_files_info_table[in_request_packet->Header.ID].Length - in_request_packet->Pos;
-	}
+	data_length = in_length;
+	if (data_length > fileTransfer_MAX_BLOCK_LENGTH)
+		data_length = fileTransfer_MAX_BLOCK_LENGTH;
+
+	if (data_length > file_length - in_pos)
+		data_length = (uint16_t)(file_length - in_pos);
 
 	// reserve packet storage
-	response_packet = (comFileDataReadResponseHeader*)comManagerTransmitPacketPushStart(sizeof(comFileDataReadResponseHeader) + (uint8_t)data_length, in_packet_info->Interface, comPT_FILE_DATA_READ_RESPONSE, &packet_index);
-	if (response_packet != sysNULL)
-	{
-		// fill out response information
-		response_packet->Header.ID = in_request_packet->Header.ID;
-		response_packet->Pos = in_request_packet->Pos;
+	response_packet = (comFileDataReadResponseHeader*)comManagerTransmitPacketPushStart((uint8_t)(sizeof(comFileDataReadResponseHeader) + data_length), in_interface, comPT_FILE_DATA_READ_RESPONSE, &packet_index);
+	if (response_packet == sysNULL)
+		return false;
 
-		destination_data_pointer = (uint8_t*)(comManagerGetTransmitPacketGetBuffer(packet_index) + sizeof(comFileDataReadResponseHeader));
+	// fill out response information
+	response_packet->Header.ID = in_file_id;
+	response_packet->Pos = in_pos;
+	response_packet->Length = data_length;
 
-		if (g_system_files_info_table[response_packet->Header.ID].Callback == sysNULL)
-		{
-			// copy response file data
-			source_data_pointer = g_system_files_info_table[in_request_packet->Header.ID].Content + in_request_packet->Pos;
+	destination_data_pointer = (uint8_t*)(comManagerGetTransmitPacketGetBuffer(packet_index) + sizeof(comFileDataReadResponseHeader));
 
-			sysMemCopy(destination_data_pointer, source_data_pointer, file_data_length);
-		}
-		else
+	if (g_system_files_info_table[in_file_id].Callback == sysNULL)
+	{
+		// copy response file data
+		sysMemCopy(destination_data_pointer, g_system_files_info_table[in_file_id].Content + in_pos, data_length);
+	}
+	else
+	{
+		if (!g_system_files_info_table[in_file_id].Callback(fileCF_ReadBlock, destination_data_pointer, data_length, in_pos))
 		{
-			g_system_files_info_table[response_packet->Header.ID].Callback(fileCF_ReadBlock, destination_data_pointer, (uint16_t)file_data_length, (uint16_t)in_request_packet->Pos);
+			comManagerTransmitPacketPushCancel(packet_index);
+			return true;
 		}
-
-		// start packet transmission
-		comManagerTransmitPacketPushEnd(packet_index);
 	}
+
+	// start packet transmission
+	comManagerTransmitPacketPushEnd(packet_index);
+
+	return true;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -167,62 +286,91 @@ static void fileProcessFileDataReadRequest(comPacketInfo* in_packet_info, comPac
 static void fileProcessFileDataWriteRequest(comPacketInfo* in_packet_info, comPacketFileDataWriteRequestHeader* in_request_packet)
 {
 	uint16_t packet_index;
-	uint8_t system_file_count;
 	comPacketFileDataWriteResponse* response_packet;
-	uint8_t* source_data_pointer;
-	uint8_t* destination_data_pointer;
 
 	response_packet = (comPacketFileDataWriteResponse*)comManagerTransmitPacketPushStart(sizeof(comPacketFileDataWriteResponse), in_packet_info->Interface, comPT_FILE_DATA_WRITE_RESPONSE, &packet_index);
 	if (response_packet != sysNULL)
 	{
-		response_packet->Error = comFRC_OK;
 		response_packet->Header.ID = in_request_packet->Header.ID;
+		response_packet->Error = fileWriteDataBlock(in_request_packet);
 
-		// check file id validity
-		system_file_count = fileSystemFileGetCount();
-		if (response_packet->Header.ID >= system_file_count)
-		{
-			response_packet->Header.ID = fileINVALID_SYSTEM_FILE_ID;
-			response_packet->Error = comFRC_NOT_FOUND;
-		}
-		else
-		{
-			// check file length
-			if ((in_request_packet->Pos + in_request_packet->Length) > g_system_files_info_table[in_request_packet->Header.ID].Length)
-			{
-				response_packet->Error = comFRC_INVALID;
-			}
-			else
-			{
-				// check file RW flag
-				if ((g_system_files_info_table[in_request_packet->Header.ID].Flags & fileSFF_READ_WRITE) == 0)
-				{
-					response_packet->Error = comFRC_READ_ONLY;
-				}
-				else
-				{
-					source_data_pointer = ((uint8_t*)in_request_packet) + sizeof(comPacketFileDataWriteRequestHeader);
+		// start packet transmission
+		comManagerTransmitPacketPushEnd(packet_index);
+	}
+}
 
-					if (g_system_files_info_table[response_packet->Header.ID].Callback == sysNULL)
-					{
-						// copy data
-						destination_data_pointer = g_system_files_info_table[in_request_packet->Header.ID].Content + in_request_packet->Pos;
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Process windowed file data write request. Every block is acknowledged by a response containing
+/// the block position. Block write can be repeated therefore not acknowledged blocks can be resent.
+static void fileProcessFileDataWindowWriteRequest(comPacketInfo* in_packet_info, comPacketFileDataWindowWriteRequestHeader* in_request_packet)
+{
+	uint16_t packet_index;
+	comPacketFileDataWindowWriteResponse* response_packet;
+	uint8_t error;
 
-						sysMemCopy(destination_data_pointer, source_data_pointer, in_request_packet->Length);
-					}
-					else
-					{
-						g_system_files_info_table[response_packet->Header.ID].Callback(fileCF_WriteBlock, source_data_pointer, in_request_packet->Length, (uint16_t)in_request_packet->Pos);
-					}
-				}
-			}
-		}
+	// write block
+	error = fileWriteDataBlock(in_request_packet);
+
+	// acknowledge block
+	response_packet = (comPacketFileDataWindowWriteResponse*)comManagerTransmitPacketPushStart(sizeof(comPacketFileDataWindowWriteResponse), in_packet_info->Interface, comPT_FILE_DATA_WINDOW_WRITE_RESPONSE, &packet_index);
+	if (response_packet != sysNULL)
+	{
+		response_packet->Header.ID = in_request_packet->Header.ID;
+		response_packet->Pos = in_request_packet->Pos;
+		response_packet->Length = in_request_packet->Length;
+		response_packet->Error = error;
 
 		// start packet transmission
 		comManagerTransmitPacketPushEnd(packet_index);
 	}
 }
 
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Writes data block of the write request packet into the file
+/// @param in_request_packet Write request packet (header followed by the data)
+/// @return Result code (comFRC_xxx)
+static uint8_t fileWriteDataBlock(comPacketFileDataWriteRequestHeader* in_request_packet)
+{
+	uint8_t* source_data_pointer;
+	uint8_t* destination_data_pointer;
+
+	// check file id validity
+	if (in_request_packet->Header.ID >= fileSystemFileGetCount())
+		return comFRC_NOT_FOUND;
+
+	// check data length
+	if (sizeof(comPacketFileDataWriteRequestHeader) + in_request_packet->Length + comCRC_BYTE_COUNT > in_request_packet->Header.Header.PacketLength)
+		return comFRC_INVALID;
+
+	// check file length
+	if ((in_request_packet->Pos + in_request_packet->Length) > fileSystemFileGetLength(in_request_packet->Header.ID))
+		return comFRC_INVALID;
+
+	// check file RW flag
+	if ((g_system_files_info_table[in_request_packet->Header.ID].Flags & fileSFF_READ_WRITE) == 0)
+		return comFRC_READ_ONLY;
+
+	source_data_pointer = ((uint8_t*)in_request_packet) + sizeof(comPacketFileDataWriteRequestHeader);
+
+	if (g_system_files_info_table[in_request_packet->Header.ID].Callback == sysNULL)
+	{
+		// copy data
+		destination_data_pointer = g_system_files_info_table[in_request_packet->Header.ID].Content + in_request_packet->Pos;
+
+		sysMemCopy(destination_data_pointer, source_data_pointer, in_request_packet->Length);
+
+		// file content changed
+		fileHashCacheInvalidate(in_request_packet->Header.ID, in_request_packet->Pos);
+	}
+	else
+	{
+		if (!g_system_files_info_table[in_request_packet->Header.ID].Callback(fileCF_WriteBlock, source_data_pointer, in_request_packet->Length, in_request_packet->Pos))
+			return comFRC_FALED;
+	}
+
+	return comFRC_OK;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 /// @brief Process file operation finished request
 static void fileProcessFileOperationFinishedRequest(comPacketInfo* in_packet_info, comPacketFileOperationFinishedRequest* in_request_packet)
@@ -236,6 +384,7 @@ static void fileProcessFileOperationFinishedRequest(comPacketInfo* in_packet_inf
 	{
 		response_packet->Header.ID = in_request_packet->Header.ID;
 		response_packet->FinishMode = in_request_packet->FinishMode;
+		response_packet->Error = comFRC_OK;
 
 		// check file ID
 		system_file_count = fileSystemFileGetCount();
@@ -263,9 +412,177 @@ static void fileProcessFileOperationFinishedRequest(comPacketInfo* in_packet_inf
 					}
 					break;
 			}
+		}
+
+		// start packet transmission (reserved packet must always be finished otherwise it blocks the transmitter queue)
+		comManagerTransmitPacketPushEnd(packet_index);
+	}
+}
+
+/*****************************************************************************/
+/* MD5 hash cache functions                                                  */
+/*****************************************************************************/
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Gets MD5 hash of a file. Hash is cached and recalculated only when file content is changed. 
+/// Files with handler callback must support fileCF_IsChangedSince request for caching the hash.
+/// @param in_file_id File ID (index)
+/// @param in_file_length Current length of the file
+/// @param out_hash MD5 hash of the file
+static void fileGetFileHash(uint8_t in_file_id, uint32_t in_file_length, crcMD5Hash* out_hash)
+{
+	fileInternalFileTableEntry* file_info = &g_system_files_info_table[in_file_id];
+	fileHashCacheEntry* cache_entry;
+	fileChangeInfo change_info;
+	const uint8_t* content;
+	crcMD5State md5_state;
+
+	// hash of the read-only files is stored by the file system
+	if (file_info->Callback == sysNULL && (file_info->Flags & fileSFF_READ_WRITE) == 0)
+	{
+		fileSystemFileGetHash(in_file_id, out_hash);
+		return;
+	}
+
+	// check if file hash can be cached
+	if (in_file_id < fileTransfer_HASH_CACHE_SIZE)
+	{
+		cache_entry = &l_hash_cache[in_file_id];
+
+		if (file_info->Callback != sysNULL)
+		{
+			change_info.ChangeCounter = cache_entry->ChangeCounter;
+			change_info.FirstChangedPos = 0;
+			change_info.Changed = true;
+
+			if (!file_info->Callback(fileCF_IsChangedSince, &change_info, sizeof(change_info), 0))
+				cache_entry = sysNULL; // change tracking is not supported
+			else
+			{
+				cache_entry->ChangeCounter = change_info.ChangeCounter;
+
+				if (change_info.Changed)
+					fileHashCacheInvalidate(in_file_id, change_info.FirstChangedPos);
+			}
+		}
+	}
+	else
+	{
+		cache_entry = sysNULL;
+	}
 
-			// start packet transmission
-			comManagerTransmitPacketPushEnd(packet_index);
+	// no cache, calculate hash
+	if (cache_entry == sysNULL)
+	{
+		if (file_info->Callback == sysNULL)
+		{
+			crcMD5Open(&md5_state);
+			crcMD5Update(&md5_state, file_info->Content, in_file_length);
+			crcMD5Close(&md5_state, out_hash);
 		}
+		else
+		{
+			file_info->Callback(fileCF_GetMD5, out_hash, sizeof(crcMD5Hash), 0);
+		}
+
+		return;
+	}
+
+	// restart hash calculation when file length is changed
+	if (!cache_entry->Valid || cache_entry->Length != in_file_length)
+	{
+		cache_entry->Valid = false;
+		cache_entry->Length = in_file_length;
+		cache_entry->ValidLength = 0;
+
+		// distribute checkpoints evenly (aligned to MD5 block size)
+		cache_entry->CheckpointDistance = in_file_length / (fileTransfer_HASH_CHECKPOINT_COUNT + 1);
+		cache_entry->CheckpointDistance = (cache_entry->CheckpointDistance + fileTransfer_HASH_BLOCK_SIZE - 1) & ~(uint32_t)(fileTransfer_HASH_BLOCK_SIZE - 1);
+		if (cache_entry->CheckpointDistance == 0)
+			cache_entry->CheckpointDistance = fileTransfer_HASH_BLOCK_SIZE;
+	}
+
+	// recalculate hash of the changed part
+	if (!cache_entry->Valid || cache_entry->ValidLength < cache_entry->Length)
+	{
+		content = fileSystemFileGetContent(in_file_id);
+
+		if (content == sysNULL)
+		{
+			// content is not accessible
+			file_info->Callback(fileCF_GetMD5, out_hash, sizeof(crcMD5Hash), 0);
+			cache_entry->Valid = false;
+			return;
+		}
+
+		fileHashCacheUpdate(cache_entry, content);
+	}
+
+	*out_hash = cache_entry->Hash;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Invalidates cached hash of a file from the given position
+/// @param in_file_id File ID (index)
+/// @param in_pos Position of the first changed byte
+static void fileHashCacheInvalidate(uint8_t in_file_id, uint32_t in_pos)
+{
+	if (in_file_id >= fileTransfer_HASH_CACHE_SIZE)
+		return;
+
+	if (in_pos < l_hash_cache[in_file_id].ValidLength)
+		l_hash_cache[in_file_id].ValidLength = in_pos;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Recalculates hash of the file starting from the last checkpoint before the first changed byte
+/// @param in_cache_entry Hash cache entry of the file
+/// @param in_content File content
+static void fileHashCacheUpdate(fileHashCacheEntry* in_cache_entry, const uint8_t* in_content)
+{
+	crcMD5State md5_state;
+	uint32_t checkpoint_index;
+	uint32_t block_length;
+	uint32_t pos;
+
+	// find the last valid checkpoint
+	if (in_cache_entry->Valid)
+		checkpoint_index = in_cache_entry->ValidLength / in_cache_entry->CheckpointDistance;
+	else
+		checkpoint_index = 0;
+
+	if (checkpoint_index > fileTransfer_HASH_CHECKPOINT_COUNT)
+		checkpoint_index = fileTransfer_HASH_CHECKPOINT_COUNT;
+
+	// restore MD5 state
+	if (checkpoint_index == 0)
+	{
+		crcMD5Open(&md5_state);
+		pos = 0;
+	}
+	else
+	{
+		md5_state = in_cache_entry->Checkpoints[checkpoint_index - 1];
+		pos = checkpoint_index * in_cache_entry->CheckpointDistance;
+	}
+
+	// hash the rest of the file and store checkpoints
+	while (pos < in_cache_entry->Length)
+	{
+		block_length = in_cache_entry->Length - pos;
+
+		if (checkpoint_index < fileTransfer_HASH_CHECKPOINT_COUNT && block_length > in_cache_entry->CheckpointDistance)
+			block_length = in_cache_entry->CheckpointDistance;
+
+		crcMD5Update(&md5_state, &in_content[pos], block_length);
+		pos += block_length;
+
+		if (checkpoint_index < fileTransfer_HASH_CHECKPOINT_COUNT && block_length == in_cache_entry->CheckpointDistance)
+			in_cache_entry->Checkpoints[checkpoint_index++] = md5_state;
 	}
+
+	crcMD5Close(&md5_state, &in_cache_entry->Hash);
+
+	in_cache_entry->ValidLength = in_cache_entry->Length;
+	in_cache_entry->Valid = true;
 }
@@ -0,0 +1,107 @@
+/*****************************************************************************/
+/* Attitude estimation (Mahony complementary filter)                         */
+/*                                                                           */
+/* Copyright (C) 2016 Laszlo Arvai                                           */
+/* All rights reserved.                                                      */
+/*                                                                           */
+/* This software may be modified and distributed under the terms             */
+/* of the GNU General Public License.  See the LICENSE file for details.     */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/* Includes                                                                  */
+/*****************************************************************************/
+#include <imuAttitude.h>
+#include <math.h>
+
+/*****************************************************************************/
+/* Constants                                                                 */
+/*****************************************************************************/
+
+// accelerometer correction is used only when the measured acceleration is close to the gravity [g]
+#define imuATTITUDE_MIN_ACCELERATION_SQUARE (0.5f * 0.5f)
+#define imuATTITUDE_MAX_ACCELERATION_SQUARE (1.5f * 1.5f)
+
+/*****************************************************************************/
+/* Function implementation                                                   */
+/*****************************************************************************/
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Initializes attitude estimator to level attitude
+/// @param out_state Estimator state
+/// @param in_kp Proportional gain of the accelerometer correction
+/// @param in_ki Integral gain of the accelerometer correction (gyro bias estimation)
+void imuAttitudeInit(imuAttitudeState* out_state, float in_kp, float in_ki)
+{
+	mathQuaternionSetIdentity(&out_state->Quaternion);
+	mathVector3Set(&out_state->IntegralError, 0.0f, 0.0f, 0.0f);
+
+	out_state->Kp = in_kp;
+	out_state->Ki = in_ki;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Sets roll and pitch from the measured gravity vector (yaw is set to zero)
+/// @param inout_state Estimator state
+/// @param in_acceleration Measured acceleration [g]
+void imuAttitudeAlign(imuAttitudeState* inout_state, const mathVector3f* in_acceleration)
+{
+	float roll;
+	float pitch;
+
+	roll = atan2f(in_acceleration->Y, in_acceleration->Z);
+	pitch = atan2f(-in_acceleration->X, sqrtf(in_acceleration->Y * in_acceleration->Y + in_acceleration->Z * in_acceleration->Z));
+
+	mathQuaternionFromEulerAngles(&inout_state->Quaternion, roll, pitch, 0.0f);
+	mathVector3Set(&inout_state->IntegralError, 0.0f, 0.0f, 0.0f);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Updates attitude with one sensor sample. Angular rate is integrated and the attitude
+/// is corrected towards the measured gravity direction. It has no loops, the execution time is bounded.
+/// @param inout_state Estimator state
+/// @param in_angular_rate Measured angular rate [rad/s]
+/// @param in_acceleration Measured acceleration [g]
+/// @param in_dt Time since the previous sample [s]
+void imuAttitudeUpdate(imuAttitudeState* inout_state, const mathVector3f* in_angular_rate, const mathVector3f* in_acceleration, float in_dt)
+{
+	mathVector3f rate;
+	mathVector3f acceleration;
+	mathVector3f gravity;
+	mathVector3f error;
+	float norm;
+
+	rate = *in_angular_rate;
+
+	// correct with the measured gravity direction when the vehicle is not accelerating heavily
+	norm = mathVector3Dot(in_acceleration, in_acceleration);
+	if (norm > imuATTITUDE_MIN_ACCELERATION_SQUARE && norm < imuATTITUDE_MAX_ACCELERATION_SQUARE)
+	{
+		mathVector3Scale(&acceleration, in_acceleration, mathInverseSquareRoot(norm));
+
+		// error is the cross product between the measured and estimated gravity direction
+		mathQuaternionGetGravity(&gravity, &inout_state->Quaternion);
+		mathVector3Cross(&error, &acceleration, &gravity);
+
+		// integral feedback (gyro bias)
+		mathVector3AddScaled(&inout_state->IntegralError, &error, inout_state->Ki * in_dt);
+
+		// proportional feedback
+		mathVector3AddScaled(&rate, &error, inout_state->Kp);
+	}
+
+	mathVector3Add(&rate, &rate, &inout_state->IntegralError);
+
+	mathQuaternionIntegrate(&inout_state->Quaternion, &rate, in_dt);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Converts attitude to Euler angles (Z-Y-X order)
+/// @param in_state Estimator state
+/// @param out_roll Roll angle [rad]
+/// @param out_pitch Pitch angle [rad]
+/// @param out_yaw Yaw angle [rad] (not corrected, drifts with the gyro bias)
+void imuAttitudeGetEulerAngles(const imuAttitudeState* in_state, float* out_roll, float* out_pitch, float* out_yaw)
+{
+	mathQuaternionToEulerAngles(&in_state->Quaternion, out_roll, out_pitch, out_yaw);
+}
@@ -14,22 +14,43 @@
 #include <sysTypes.h>
 #include <drvIMU.h>
 #include <sysRTOS.h>
+#include <imuCommunication.h>
 
 /*****************************************************************************/
 /* Constants                                                                 */
 /*****************************************************************************/
-#define imuCommunication_Timeout 5 /// 5ms time should be enough for all imu communication
+#ifndef imuCommunication_Timeout
+#define imuCommunication_Timeout 10 /// 10ms time should be enough for all imu communication (including FIFO burst reads)
+#endif
+#define imuCommunication_BLOCKING_BUFFER_SIZE 255
 
 /*****************************************************************************/
 /* Module global variables                                                   */
 /*****************************************************************************/
 static sysTaskNotify l_task_notify;
-static volatile bool l_success;
+
+// transaction queue
+static imuTransaction* l_queue_head = sysNULL;
+static imuTransaction* l_queue_tail = sysNULL;
+static imuTransaction* volatile l_active_transaction = sysNULL;
+static sysTick l_active_transaction_tick;
+static volatile uint32_t l_transfer_sequence = 0;	// sequence number of the active bus transfer, completions of earlier (timed out) transfers are ignored
+static uint16_t l_queue_length = 0;
+static imuCommunicationStatistics l_statistics;
+
+// blocking transaction
+static imuTransaction l_blocking_transaction;
+static uint8_t l_blocking_buffer[imuCommunication_BLOCKING_BUFFER_SIZE];
 
 /*****************************************************************************/
 /* Local functions                                                           */
 /*****************************************************************************/
-static void imuCommunicationFinished(bool in_success, void* in_interrupt_param);
+static imuTransaction* imuTransactionQueuePop(void);
+static void imuTransactionStart(imuTransaction* in_transaction);
+static void imuTransactionTransferFinished(bool in_success, uint32_t in_sequence, void* in_interrupt_param);
+static void imuTransactionFinished(bool in_success, uint32_t in_sequence, bool in_timeout, void* in_interrupt_param);
+static void imuBlockingTransaction(imuTransactionType in_type, uint8_t in_i2c_address, uint8_t in_register_address, uint8_t* inout_buffer, uint8_t in_length, bool* inout_success);
+static void imuBlockingTransactionFinished(imuTransaction* in_transaction, void* in_interrupt_param);
 
 /*****************************************************************************/
 /* Function implementation                                                   */
@@ -40,105 +61,370 @@ static void imuCommunicationFinished(bool in_success, void* in_interrupt_param);
 void imuCommunicationInit(void)
 {
 	sysTaskNotifyCreate(l_task_notify);
+
+	l_blocking_transaction.Status = imuTS_Idle;
+	sysMemZero(&l_statistics, sizeof(l_statistics));
 }
 
+/*****************************************************************************/
+/* Asynchronous transactions                                                 */
+/*****************************************************************************/
+
 ///////////////////////////////////////////////////////////////////////////////
-/// @brief Reads one byte register from the IMU sensor
+/// @brief Initializes register block read transaction
+/// @param in_transaction Transaction to initialize
 /// @param in_i2c_address I2C bus address of the sensor
-/// @param in_register_address Register address to read
-/// @param out_register_value Pointer to store register value
-/// @param inout_success Operation result (true - success, false - failed) Must be true before calling the function, otherwise the function immediatelly returns.
-void imuReadByteRegister(uint8_t in_i2c_address, uint8_t in_register_address, uint8_t* out_register_value, bool* inout_success)
+/// @param in_register_address Address of the first register to read
+/// @param out_buffer Buffer for the register content
+/// @param in_length Number of registers to read
+/// @param in_callback Function to call when the transaction is finished (can be sysNULL)
+void imuTransactionInitRead(imuTransaction* in_transaction, uint8_t in_i2c_address, uint8_t in_register_address, uint8_t* out_buffer, uint8_t in_length, imuTransactionCallbackFunction in_callback)
 {
-	uint8_t register_address = in_register_address;
-	uint8_t register_value;
-
-	l_success = *inout_success;
+	in_transaction->Type = imuTT_Read;
+	in_transaction->I2CAddress = in_i2c_address;
+	in_transaction->RegisterAddress = in_register_address;
+	in_transaction->Buffer = out_buffer;
+	in_transaction->Length = in_length;
+	in_transaction->Callback = in_callback;
+	in_transaction->Next = sysNULL;
+	in_transaction->Status = imuTS_Idle;
+}
 
-	// return if previous operations were failed
-	if(!l_success)
-		return;
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Initializes register block write transaction
+/// @param in_transaction Transaction to initialize
+/// @param in_i2c_address I2C bus address of the sensor
+/// @param in_register_address Address of the first register to write
+/// @param in_buffer Register content to write (must be valid until the transaction is finished)
+/// @param in_length Number of registers to write
+/// @param in_callback Function to call when the transaction is finished (can be sysNULL)
+void imuTransactionInitWrite(imuTransaction* in_transaction, uint8_t in_i2c_address, uint8_t in_register_address, uint8_t* in_buffer, uint8_t in_length, imuTransactionCallbackFunction in_callback)
+{
+	imuTransactionInitRead(in_transaction, in_i2c_address, in_register_address, in_buffer, in_length, in_callback);
 
-	// start I2C communications
-	drvIMUStartWriteAndReadBlock(in_i2c_address, &register_address, 1, &register_value, 1, imuCommunicationFinished);
+	in_transaction->Type = imuTT_Write;
+}
 
-	// wait until communication finished
-	sysTaskNotifyTake(l_task_notify, imuCommunication_Timeout);
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Submits a transaction chain (transactions linked by the Next member). Transactions
+/// of the chain are executed after each other without other transactions between them. When
+/// a transaction fails the rest of the chain is aborted. Callbacks are called from the bus interrupt.
+/// Can be called from task or from interrupt (transaction callbacks).
+/// @param in_transaction First transaction of the chain
+/// @return True if chain was queued, false if a transaction of the chain is already queued
+bool imuTransactionSubmit(imuTransaction* in_transaction)
+{
+	imuTransaction* transaction;
+	imuTransaction* last_transaction;
+	imuTransaction* start_transaction = sysNULL;
+	uint16_t chain_length;
+
+	// check chain
+	transaction = in_transaction;
+	while (transaction != sysNULL)
+	{
+		if (transaction->Status == imuTS_Pending || transaction->Status == imuTS_Active)
+			return false;
+
+		transaction = transaction->Next;
+	}
+
+	sysCriticalSectionBeginFromISR();
+
+	// prepare transactions
+	chain_length = 0;
+	transaction = in_transaction;
+	do
+	{
+		transaction->Status = imuTS_Pending;
+		transaction->NextInQueue = transaction->Next;
+		last_transaction = transaction;
+		transaction = transaction->Next;
+		chain_length++;
+	} while (transaction != sysNULL);
+
+	// append chain to the queue
+	if (l_queue_tail == sysNULL)
+		l_queue_head = in_transaction;
+	else
+		l_queue_tail->NextInQueue = in_transaction;
+
+	l_queue_tail = last_transaction;
+
+	l_queue_length += chain_length;
+	if (l_queue_length > l_statistics.MaxQueueLength)
+		l_statistics.MaxQueueLength = l_queue_length;
+
+	// start transfer if bus is idle
+	if (l_active_transaction == sysNULL)
+		start_transaction = imuTransactionQueuePop();
+
+	sysCriticalSectionEndFromISR();
+
+	if (start_transaction != sysNULL)
+		imuTransactionStart(start_transaction);
+
+	return true;
+}
 
-	*out_register_value = register_value;
-	*inout_success = l_success;
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Gets transaction queue statistics
+/// @param out_statistics Statistics
+void imuCommunicationGetStatistics(imuCommunicationStatistics* out_statistics)
+{
+	sysCriticalSectionBegin();
+	*out_statistics = l_statistics;
+	sysCriticalSectionEnd();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-/// @brief Writes one byte register of the IMU sensor
-/// @param in_i2c_address I2C bus address of the sensor
-/// @param in_register_address Register address to read
-/// @param in_register_value Register value to write
-/// @param inout_success Operation result (true - success, false - failed) Must be true before calling the function, otherwise the function immediatelly returns.
-void imuWriteByteRegister(uint8_t in_i2c_address, uint8_t in_register_address, uint8_t in_register_value, bool* inout_success)
+/// @brief Removes the first transaction from the queue and makes it active (must be called from critical section)
+/// @return Active transaction
+static imuTransaction* imuTransactionQueuePop(void)
 {
-	uint8_t register_address = in_register_address;
-	uint8_t register_value = in_register_value;
+	imuTransaction* transaction = l_queue_head;
 
-	l_success = *inout_success;
+	if (transaction != sysNULL)
+	{
+		l_queue_head = transaction->NextInQueue;
+		if (l_queue_head == sysNULL)
+			l_queue_tail = sysNULL;
 
-	// return if previous operations were failed
-	if(!l_success)
-		return;
+		l_queue_length--;
 
-	// start I2C communications
-	drvIMUStartWriteAndWriteBlock(in_i2c_address, &register_address, 1, &register_value, 1, imuCommunicationFinished);
+		transaction->Status = imuTS_Active;
+		l_active_transaction = transaction;
+		l_active_transaction_tick = sysGetSystemTick();
+		l_transfer_sequence++;
+	}
 
-	// wait until communication finished
-	sysTaskNotifyTake(l_task_notify, imuCommunication_Timeout);
+	return transaction;
+}
 
-	*inout_success = l_success;
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Starts bus transfer of the transaction
+/// @param in_transaction Transaction to start
+static void imuTransactionStart(imuTransaction* in_transaction)
+{
+	uint32_t sequence = l_transfer_sequence;
+
+	// the callback parameter identifies the transfer
+	if (in_transaction->Type == imuTT_Read)
+		drvIMUStartWriteAndReadBlock(in_transaction->I2CAddress, &in_transaction->RegisterAddress, 1, in_transaction->Buffer, in_transaction->Length, imuTransactionTransferFinished, sequence);
+	else
+		drvIMUStartWriteAndWriteBlock(in_transaction->I2CAddress, &in_transaction->RegisterAddress, 1, in_transaction->Buffer, in_transaction->Length, imuTransactionTransferFinished, sequence);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Fails the active transaction when its bus transfer is not finished within the timeout
+/// (the rest of its chain is aborted and the next transaction is started). Must be called periodically
+/// from the task, because a lost bus completion would block the queue forever.
+void imuCommunicationCheckTimeout(void)
+{
+	imuTransactionFinished(false, l_transfer_sequence, true, sysNULL);
+}
 
-void imuReadRegisterBlock(uint8_t in_i2c_address, uint8_t in_register_address, uint8_t* out_register_block, uint8_t in_register_block_length, bool* inout_success)
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Bus transfer finished interrupt handler
+/// @param in_success True if the bus transfer was successful
+/// @param in_sequence Sequence number of the finished transfer
+/// @param in_interrupt_param Interrupt parameter passed to the callbacks
+static void imuTransactionTransferFinished(bool in_success, uint32_t in_sequence, void* in_interrupt_param)
 {
-	uint8_t register_address = in_register_address;
+	imuTransactionFinished(in_success, in_sequence, false, in_interrupt_param);
+}
 
-	l_success = *inout_success;
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Finishes the active transaction: starts the next transaction and calls the callbacks
+/// @param in_success True if the bus transfer was successful
+/// @param in_sequence Sequence number of the finished transfer
+/// @param in_timeout True when called by the timeout check (the transaction is finished only when the timeout is expired)
+/// @param in_interrupt_param Interrupt parameter passed to the callbacks
+static void imuTransactionFinished(bool in_success, uint32_t in_sequence, bool in_timeout, void* in_interrupt_param)
+{
+	imuTransaction* finished_transaction;
+	imuTransaction* aborted_transaction = sysNULL;
+	imuTransaction* next_transaction = sysNULL;
+	imuTransaction* transaction;
+	uint16_t aborted_count = 0;
 
-	// return if previous operations were failed
-	if(!l_success)
+	sysCriticalSectionBeginFromISR();
+
+	// ignore late completion of a timed out transfer (any earlier transfer, not only the previous one) and check timeout of the active transaction
+	if (in_sequence != l_transfer_sequence || l_active_transaction == sysNULL || (in_timeout && sysGetSystemTickSince(l_active_transaction_tick) < imuCommunication_Timeout))
+	{
+		if (!in_timeout)
+			l_statistics.LateCompletionCount++;
+
+		sysCriticalSectionEndFromISR();
 		return;
+	}
+
+	if (in_timeout)
+		l_statistics.TimeoutCount++;
+
+	finished_transaction = l_active_transaction;
+	l_active_transaction = sysNULL;
+
+	if (finished_transaction != sysNULL)
+	{
+		l_statistics.TransactionCount++;
+
+		// remove the rest of the chain on failure (they are at the head of the queue)
+		if (!in_success)
+		{
+			l_statistics.FailedTransactionCount++;
 
-	// start I2C communications
-	drvIMUStartWriteAndReadBlock(in_i2c_address, &register_address, 1, out_register_block, in_register_block_length, imuCommunicationFinished);
+			aborted_transaction = finished_transaction->Next;
+			transaction = aborted_transaction;
+			while (transaction != sysNULL && transaction == l_queue_head)
+			{
+				l_queue_head = transaction->NextInQueue;
+				if (l_queue_head == sysNULL)
+					l_queue_tail = sysNULL;
 
-	// wait until communication finished
-	sysTaskNotifyTake(l_task_notify, imuCommunication_Timeout);
+				l_queue_length--;
+				aborted_count++;
 
-	*inout_success = l_success;
+				transaction = transaction->Next;
+			}
+
+			l_statistics.AbortedTransactionCount += aborted_count;
+		}
+	}
+
+	// start next transaction
+	next_transaction = imuTransactionQueuePop();
+
+	sysCriticalSectionEndFromISR();
+
+	if (next_transaction != sysNULL)
+		imuTransactionStart(next_transaction);
+
+	if (finished_transaction == sysNULL)
+		return;
+
+	// notify transaction owners
+	finished_transaction->Status = (in_success) ? imuTS_Success : imuTS_Failed;
+	if (finished_transaction->Callback != sysNULL)
+		finished_transaction->Callback(finished_transaction, in_interrupt_param);
+
+	while (aborted_count > 0)
+	{
+		transaction = aborted_transaction;
+		aborted_transaction = transaction->Next;
+
+		transaction->Status = imuTS_Aborted;
+		if (transaction->Callback != sysNULL)
+			transaction->Callback(transaction, in_interrupt_param);
+
+		aborted_count--;
+	}
 }
 
-void imuWriteRegisterBlock(uint8_t in_i2c_address, uint8_t in_register_address, uint8_t* in_register_block, uint8_t in_register_block_length, bool* inout_success)
+/*****************************************************************************/
+/* Blocking functions                                                        */
+/*****************************************************************************/
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Reads one byte register from the IMU sensor
+/// @param in_i2c_address I2C bus address of the sensor
+/// @param in_register_address Register address to read
+/// @param out_register_value Pointer to store register value
+/// @param inout_success Operation result (true - success, false - failed) Must be true before calling the function, otherwise the function immediatelly returns.
+void imuReadByteRegister(uint8_t in_i2c_address, uint8_t in_register_address, uint8_t* out_register_value, bool* inout_success)
+{
+	imuBlockingTransaction(imuTT_Read, in_i2c_address, in_register_address, out_register_value, 1, inout_success);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Writes one byte register of the IMU sensor
+/// @param in_i2c_address I2C bus address of the sensor
+/// @param in_register_address Register address to read
+/// @param in_register_value Register value to write
+/// @param inout_success Operation result (true - success, false - failed) Must be true before calling the function, otherwise the function immediatelly returns.
+void imuWriteByteRegister(uint8_t in_i2c_address, uint8_t in_register_address, uint8_t in_register_value, bool* inout_success)
 {
-	uint8_t register_address = in_register_address;
+	imuBlockingTransaction(imuTT_Write, in_i2c_address, in_register_address, &in_register_value, 1, inout_success);
+}
 
-	l_success = *inout_success;
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Reads register block from the IMU sensor
+/// @param in_i2c_address I2C bus address of the sensor
+/// @param in_register_address Address of the first register to read
+/// @param out_register_block Buffer for the register content
+/// @param in_register_block_length Number of registers to read
+/// @param inout_success Operation result (true - success, false - failed) Must be true before calling the function, otherwise the function immediatelly returns.
+void imuReadRegisterBlock(uint8_t in_i2c_address, uint8_t in_register_address, uint8_t* out_register_block, uint8_t in_register_block_length, bool* inout_success)
+{
+	imuBlockingTransaction(imuTT_Read, in_i2c_address, in_register_address, out_register_block, in_register_block_length, inout_success);
+}
 
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Writes register block of the IMU sensor
+/// @param in_i2c_address I2C bus address of the sensor
+/// @param in_register_address Address of the first register to write
+/// @param in_register_block Register content to write
+/// @param in_register_block_length Number of registers to write
+/// @param inout_success Operation result (true - success, false - failed) Must be true before calling the function, otherwise the function immediatelly returns.
+void imuWriteRegisterBlock(uint8_t in_i2c_address, uint8_t in_register_address, uint8_t* in_register_block, uint8_t in_register_block_length, bool* inout_success)
+{
+	imuBlockingTransaction(imuTT_Write, in_i2c_address, in_register_address, in_register_block, in_register_block_length, inout_success);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Executes transaction and waits for the result. Data is copied through a module buffer,
+/// so a timed out transaction doesn't access caller's memory when it finishes later.
+static void imuBlockingTransaction(imuTransactionType in_type, uint8_t in_i2c_address, uint8_t in_register_address, uint8_t* inout_buffer, uint8_t in_length, bool* inout_success)
+{
 	// return if previous operations were failed
-	if(!l_success)
+	if (!*inout_success)
 		return;
 
-	// start I2C communications
-	drvIMUStartWriteAndWriteBlock(in_i2c_address, &register_address, 1, in_register_block, in_register_block_length, imuCommunicationFinished);
-
-	// wait until communication finished
-	sysTaskNotifyTake(l_task_notify, imuCommunication_Timeout);
-
-	*inout_success = l_success;
+	// previous timed out transaction is still in progress
+	if (l_blocking_transaction.Status == imuTS_Pending || l_blocking_transaction.Status == imuTS_Active)
+	{
+		*inout_success = false;
+		return;
+	}
+
+	// prepare transaction
+	if (in_type == imuTT_Read)
+	{
+		imuTransactionInitRead(&l_blocking_transaction, in_i2c_address, in_register_address, l_blocking_buffer, in_length, imuBlockingTransactionFinished);
+	}
+	else
+	{
+		sysMemCopy(l_blocking_buffer, inout_buffer, in_length);
+		imuTransactionInitWrite(&l_blocking_transaction, in_i2c_address, in_register_address, l_blocking_buffer, in_length, imuBlockingTransactionFinished);
+	}
+
+	imuTransactionSubmit(&l_blocking_transaction);
+
+	// wait until communication finished (notification of an earlier transaction is skipped), the transaction
+	// which doesn't finish within the timeout is failed in order to keep the queue running
+	while (l_blocking_transaction.Status == imuTS_Pending || l_blocking_transaction.Status == imuTS_Active)
+	{
+		if (!sysTaskNotifyTake(l_task_notify, imuCommunication_Timeout))
+			imuCommunicationCheckTimeout();
+	}
+
+	if (l_blocking_transaction.Status == imuTS_Success)
+	{
+		if (in_type == imuTT_Read)
+			sysMemCopy(inout_buffer, l_blocking_buffer, in_length);
+	}
+	else
+	{
+		*inout_success = false;
+	}
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-/// @brief Communication finished interrupt handler
-static void imuCommunicationFinished(bool in_success, void* in_interrupt_param)
+/// @brief Blocking transaction finished callback
+static void imuBlockingTransactionFinished(imuTransaction* in_transaction, void* in_interrupt_param)
 {
-	l_success = in_success;
+	sysUNUSED(in_transaction);
 
 	sysTaskNotifyGiveFromISR(l_task_notify, in_interrupt_param);
 }
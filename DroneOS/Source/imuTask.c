@@ -12,8 +12,70 @@
 /* Includes                                                                  */
 /*****************************************************************************/
 #include <drvIMU.h>
+#include <imuTask.h>
 #include <imuCommunication.h>
+#include <imuAttitude.h>
 #include <sysRTOS.h>
+#include <sysHighresTimer.h>
+#include <roxStorage.h>
+#include <fdrRecorder.h>
+
+/*****************************************************************************/
+/* Constants                                                                 */
+/*****************************************************************************/
+#define imuTASK_PRIORITY 4
+
+// sensor sampling settings
+#ifndef imuSAMPLE_RATE
+#define imuSAMPLE_RATE 1000
+#endif
+
+#ifndef imuFILTER_FREQUENCY
+#define imuFILTER_FREQUENCY 94
+#endif
+
+// number of samples collected in the sensor in one read cycle
+#ifndef imuSAMPLE_WATERMARK
+#define imuSAMPLE_WATERMARK 8
+#endif
+
+// sensor read cycle time [ms]
+#define imuTASK_CYCLE_TIME ((imuSAMPLE_WATERMARK * 1000 + imuSAMPLE_RATE - 1) / imuSAMPLE_RATE)
+
+// sensor FIFO level required for reading (reads are started at fixed rate, the level only filters out
+// the reads which would transfer too few samples because of the clock difference of the sensor)
+#define imuSENSOR_WATERMARK ((imuSAMPLE_WATERMARK + 1) / 2)
+
+// attitude estimator gains
+#ifndef imuATTITUDE_KP
+#define imuATTITUDE_KP 1.0f
+#endif
+
+#ifndef imuATTITUDE_KI
+#define imuATTITUDE_KI 0.05f
+#endif
+
+// number of samples buffered between the sensor read and the attitude estimation
+#define imuSAMPLE_BUFFER_LENGTH 128
+
+// sample time difference longer than this is replaced by the nominal sample period [us]
+#define imuMAX_SAMPLE_GAP 50000ul
+
+// sample scale used for replayed samples when no sensor was started (MPU6050: +-8g, +-2000deg/s)
+#define imuDEFAULT_ACCELERATION_SCALE (1.0f / 4096)
+#define imuDEFAULT_GYRO_SCALE (1.0f / 16.4f)
+
+#define imuDEG_TO_RAD (3.14159265358979f / 180.0f)
+
+// barometer oversampling ratio (conversions are running continuously, the rate depends on the oversampling)
+#ifndef imuBAROMETER_OVERSAMPLING
+#define imuBAROMETER_OVERSAMPLING 4096
+#endif
+
+// reference pressure of the altitude calculation [Pa]
+#ifndef imuSEA_LEVEL_PRESSURE
+#define imuSEA_LEVEL_PRESSURE 101325.0f
+#endif
 
 /*****************************************************************************/
 /* Types                                                                     */
@@ -23,8 +85,11 @@ typedef struct
 {
 	bool IsValid;
 	uint8_t Class;
+	bool SelfTestPassed;
 	drvIMUSensorControlFunction Control;
 	drvIMUSensorReadFunction Read;
+	uint32_t ReadDelay;											// time between the last read and the next read requested by the driver [us]
+	sysHighresTimestamp ReadTimestamp;			// time of the last read
 } tskIMUSensorInfo;
 
 
@@ -34,21 +99,58 @@ typedef struct
 extern void drvADXL345Control(drvIMUControlFunction in_function, void* in_function_parameter);
 extern void drvHMC5883Control(drvIMUControlFunction in_function, void* in_function_parameter);
 extern void drvMPU6050Control(drvIMUControlFunction in_function, void* in_function_parameter);
+extern void drvMS5611Control(drvIMUControlFunction in_function, void* in_function_parameter);
+extern void drvBMP085Control(drvIMUControlFunction in_function, void* in_function_parameter);
 
 /*****************************************************************************/
 /* Local functions                                                           */
 /*****************************************************************************/
-static void tskIMU(void* in_argument);
+static sysTaskRetval tskIMU(sysTaskParam in_argument);
+static void imuReadSensor(uint8_t in_sensor_index);
+static uint32_t imuGetReadWaitTime(uint32_t in_cycle_wait_time);
+static void imuSampleReceived(uint8_t in_sensor_index, drvIMUSample* in_sample, void* in_interrupt_param);
+static void imuBarometerSampleReceived(uint8_t in_sensor_index, drvIMUBarometerSample* in_sample, void* in_interrupt_param);
+static void imuProcessBarometerSample(void);
+static void imuStoreSample(drvIMUSample* in_sample);
+static void imuProcessSamples(void);
+static void imuPublishAttitude(uint32_t in_timestamp, const mathVector3f* in_rate, const mathVector3f* in_acceleration);
 
 /*****************************************************************************/
 /* Module global variables                                                   */
 /*****************************************************************************/
 sysTask l_imu_task;
 tskIMUSensorInfo l_sensor_info[drvIMU_MaxSensorCount];
+static bool l_stop_task = false;
+static sysTaskNotify l_task_event;
+
+// sample buffer (written by the sensor read callback, read by the IMU task)
+static drvIMUSample l_sample_buffer[imuSAMPLE_BUFFER_LENGTH];
+static volatile uint16_t l_sample_buffer_push_index = 0;
+static volatile uint16_t l_sample_buffer_pop_index = 0;
+static volatile bool l_replay_active = false;
+static volatile bool l_realign_requested = false;
+
+// attitude estimation
+static uint8_t l_attitude_sensor_index = 0;
+static float l_acceleration_scale = imuDEFAULT_ACCELERATION_SCALE;
+static float l_gyro_scale = imuDEFAULT_GYRO_SCALE * imuDEG_TO_RAD;
+static uint32_t l_nominal_sample_period = 1000000ul / imuSAMPLE_RATE;
+static imuAttitudeState l_attitude;
+static bool l_attitude_aligned = false;
+static uint32_t l_previous_sample_timestamp;
+static imuAttitudeStatistics l_attitude_statistics;
 
+// barometer (the newest sample is stored by the sensor callback)
+static uint16_t l_barometer_oversampling = imuBAROMETER_OVERSAMPLING;
+static drvIMUBarometerSample l_barometer_sample;
+static volatile bool l_barometer_sample_valid = false;
+
+// BMP085 is probed (by its chip ID) before MS5611 because both sensors can use address 0x77
 static drvIMUSensorControlFunction l_imu_sensor_config_functions[] =
 {
 	drvMPU6050Control,
+	drvBMP085Control,
+	drvMS5611Control,
 		//drvADXL345Control,
 	//drvHMC5883Control,
 
@@ -60,17 +162,74 @@ static drvIMUSensorControlFunction l_imu_sensor_config_functions[] =
 /// @brief Initializes IMU operation
 void imuInitialize(void)
 {
-  sysTaskCreate(tskIMU, "IMU", configMINIMAL_STACK_SIZE, NULL, 4, &l_imu_task );
+	sysASSERT(imuAOM_SIZE <= roxGetObjectSize(imuATTITUDE_OBJECT_INDEX));
+	sysASSERT(imuBOM_SIZE <= roxGetObjectSize(imuBAROMETER_OBJECT_INDEX));
+
+	sysMemZero(&l_attitude_statistics, sizeof(l_attitude_statistics));
+	imuAttitudeInit(&l_attitude, imuATTITUDE_KP, imuATTITUDE_KI);
+
+	sysTaskNotifyCreate(l_task_event);
+
+	sysTaskCreate(tskIMU, "IMU", sysDEFAULT_STACK_SIZE, sysNULL, imuTASK_PRIORITY, &l_imu_task, imuTaskStop);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Sets oversampling ratio of the barometric sensor (must be called before imuInitialize)
+/// @param in_oversampling Oversampling ratio (0 - highest)
+void imuSetBarometerOversampling(uint16_t in_oversampling)
+{
+	l_barometer_oversampling = in_oversampling;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Stops IMU task
+void imuTaskStop(void)
+{
+	l_stop_task = true;
+	sysTaskNotifyGive(l_task_event);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Gets data acquisition statistics of a sensor
+/// @param in_sensor_index Index of the detected sensor
+/// @param out_statistics Statistics of the sensor
+/// @return True if sensor exists
+bool imuGetStatistics(uint8_t in_sensor_index, drvIMUStatisticsParameter* out_statistics)
+{
+	if (in_sensor_index >= drvIMU_MaxSensorCount || !l_sensor_info[in_sensor_index].IsValid)
+		return false;
+
+	l_sensor_info[in_sensor_index].Control(drvIMU_CF_GetStatistics, out_statistics);
+
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Gets self test result of a sensor
+/// @param in_sensor_index Index of the detected sensor
+/// @return True if sensor exists and its self test was successful
+bool imuIsSelfTestPassed(uint8_t in_sensor_index)
+{
+	if (in_sensor_index >= drvIMU_MaxSensorCount || !l_sensor_info[in_sensor_index].IsValid)
+		return false;
+
+	return l_sensor_info[in_sensor_index].SelfTestPassed;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 /// @brief Main IMU data processing task
-static void tskIMU(void* in_argument)
+static sysTaskRetval tskIMU(sysTaskParam in_argument)
 {
 	uint8_t sensor_index;
 	uint8_t driver_index;
 	drvIMUDetectParameter param;
 	drvIMUSelfTestParameter self_test_param;
+	drvIMUAcquisitionParameter acquisition_param;
+	bool attitude_sensor_found = false;
+	sysTick read_tick;
+	uint32_t elapsed_time;
+
+	sysUNUSED(in_argument);
 
 	// initialize
 	for(sensor_index = 0; sensor_index < drvIMU_MaxSensorCount; sensor_index++)
@@ -89,6 +248,7 @@ static void tskIMU(void* in_argument)
 	while( l_imu_sensor_config_functions[driver_index] != sysNULL)
 	{
 		param.Success = false;
+		param.Read = sysNULL;
 		l_imu_sensor_config_functions[driver_index](drvIMU_CF_Detect, &param);
 
 		if(param.Success)
@@ -97,6 +257,7 @@ static void tskIMU(void* in_argument)
 			l_sensor_info[sensor_index].Class = param.Class;
 			l_sensor_info[sensor_index].Control = param.Control;
 			l_sensor_info[sensor_index].Read = param.Read;
+			l_sensor_info[sensor_index].ReadDelay = drvIMU_READ_AT_TASK_CYCLE;
 
 			sensor_index++;
 		}
@@ -109,15 +270,385 @@ static void tskIMU(void* in_argument)
 	{
 		if(l_sensor_info[sensor_index].IsValid)
 		{
+			self_test_param.Success = false;
 			l_sensor_info[sensor_index].Control(drvIMU_CF_SelfTest, &self_test_param);
+			l_sensor_info[sensor_index].SelfTestPassed = self_test_param.Success;
+		}
+	}
+
+	// start data acquisition
+	for(sensor_index=0; sensor_index<drvIMU_MaxSensorCount; sensor_index++)
+	{
+		if(l_sensor_info[sensor_index].IsValid && l_sensor_info[sensor_index].Read != sysNULL)
+		{
+			acquisition_param.Success = false;
+			acquisition_param.SampleRate = imuSAMPLE_RATE;
+			acquisition_param.FilterFrequency = imuFILTER_FREQUENCY;
+			acquisition_param.Watermark = imuSENSOR_WATERMARK;
+			acquisition_param.Oversampling = l_barometer_oversampling;
+			acquisition_param.SensorIndex = sensor_index;
+			acquisition_param.SampleCallback = imuSampleReceived;
+			acquisition_param.BarometerCallback = imuBarometerSampleReceived;
+
+			l_sensor_info[sensor_index].Control(drvIMU_CF_StartAcquisition, &acquisition_param);
+
+			if(!acquisition_param.Success)
+			{
+				l_sensor_info[sensor_index].Read = sysNULL;
+			}
+			else
+			{
+				// the first sensor with acceleration and gyro is used for attitude estimation
+				if(!attitude_sensor_found && (l_sensor_info[sensor_index].Class & (drvIMU_SC_ACCELERATION | drvIMU_SC_GYRO)) == (drvIMU_SC_ACCELERATION | drvIMU_SC_GYRO))
+				{
+					l_attitude_sensor_index = sensor_index;
+					l_acceleration_scale = acquisition_param.AccelerationScale;
+					l_gyro_scale = acquisition_param.GyroScale * imuDEG_TO_RAD;
+					if(acquisition_param.ActualSampleRate > 0)
+						l_nominal_sample_period = 1000000ul / acquisition_param.ActualSampleRate;
+
+					attitude_sensor_found = true;
+				}
+			}
+		}
+	}
+
+	// read sensors at fixed rate and process samples as they arrive
+	read_tick = sysGetSystemTick();
+	while(!l_stop_task)
+	{
+		// start sensor reads (samples are delivered asynchronously)
+		elapsed_time = sysGetSystemTickSince(read_tick);
+		if(elapsed_time >= imuTASK_CYCLE_TIME)
+		{
+			// restart schedule when the task was blocked for more than one cycle
+			if(elapsed_time >= 2 * imuTASK_CYCLE_TIME)
+				read_tick = sysGetSystemTick();
+			else
+				read_tick += imuTASK_CYCLE_TIME;
+
+			for(sensor_index=0; sensor_index<drvIMU_MaxSensorCount && !l_stop_task; sensor_index++)
+			{
+				if(l_sensor_info[sensor_index].IsValid && l_sensor_info[sensor_index].Read != sysNULL)
+				{
+					imuReadSensor(sensor_index);
+				}
+			}
+
+			elapsed_time = sysGetSystemTickSince(read_tick);
+		}
+		else
+		{
+			// read sensors which requested read before the next cycle
+			for(sensor_index=0; sensor_index<drvIMU_MaxSensorCount && !l_stop_task; sensor_index++)
+			{
+				if(l_sensor_info[sensor_index].IsValid && l_sensor_info[sensor_index].Read != sysNULL && l_sensor_info[sensor_index].ReadDelay != drvIMU_READ_AT_TASK_CYCLE
+						&& sysHighresTimerGetTimeSince(l_sensor_info[sensor_index].ReadTimestamp) >= l_sensor_info[sensor_index].ReadDelay)
+				{
+					imuReadSensor(sensor_index);
+				}
+			}
+		}
+
+		// recover bus transaction queue when a transfer completion is lost
+		imuCommunicationCheckTimeout();
+
+		// update attitude
+		imuProcessSamples();
+
+		// publish pressure
+		imuProcessBarometerSample();
+
+		// wait for samples, for the next read cycle or for the next requested read
+		sysTaskNotifyTake(l_task_event, imuGetReadWaitTime((elapsed_time < imuTASK_CYCLE_TIME) ? (imuTASK_CYCLE_TIME - elapsed_time) : 0));
+	}
+
+	return (sysTaskRetval)0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Calls read function of the sensor and stores the time of the next requested read
+/// @param in_sensor_index Index of the sensor
+static void imuReadSensor(uint8_t in_sensor_index)
+{
+	l_sensor_info[in_sensor_index].ReadTimestamp = sysHighresTimerGetTimestamp();
+	l_sensor_info[in_sensor_index].ReadDelay = l_sensor_info[in_sensor_index].Read();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Calculates task wait time considering the read times requested by the sensors
+/// @param in_cycle_wait_time Time until the next read cycle [ms]
+/// @return Wait time [ms]
+static uint32_t imuGetReadWaitTime(uint32_t in_cycle_wait_time)
+{
+	uint8_t sensor_index;
+	uint32_t wait_time = in_cycle_wait_time;
+	uint32_t elapsed_time;
+	uint32_t sensor_wait_time;
+
+	for(sensor_index=0; sensor_index<drvIMU_MaxSensorCount; sensor_index++)
+	{
+		if(l_sensor_info[sensor_index].IsValid && l_sensor_info[sensor_index].Read != sysNULL && l_sensor_info[sensor_index].ReadDelay != drvIMU_READ_AT_TASK_CYCLE)
+		{
+			// round up to the next tick (the sensor must not be read earlier than requested)
+			elapsed_time = sysHighresTimerGetTimeSince(l_sensor_info[sensor_index].ReadTimestamp);
+			if(elapsed_time >= l_sensor_info[sensor_index].ReadDelay)
+				sensor_wait_time = 0;
+			else
+				sensor_wait_time = (l_sensor_info[sensor_index].ReadDelay - elapsed_time + 999) / 1000;
+
+			if(sensor_wait_time < wait_time)
+				wait_time = sensor_wait_time;
 		}
 	}
 
+	return wait_time;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Sample callback of the sensor drivers (called from the bus interrupt)
+/// @param in_sensor_index Index of the sensor
+/// @param in_sample Sensor sample
+/// @param in_interrupt_param Interrupt parameter
+static void imuSampleReceived(uint8_t in_sensor_index, drvIMUSample* in_sample, void* in_interrupt_param)
+{
+	fdrRECORD(fdrRT_SENSOR, in_sensor_index, in_sample, sizeof(drvIMUSample));
+
+	// sensor samples are ignored while recorded samples are replayed
+	if (in_sensor_index != l_attitude_sensor_index || l_replay_active)
+		return;
+
+	imuStoreSample(in_sample);
+
+	sysTaskNotifyGiveFromISR(l_task_event, in_interrupt_param);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Barometric sample callback of the sensor drivers (called from the bus interrupt)
+/// @param in_sensor_index Index of the sensor
+/// @param in_sample Compensated sensor sample
+/// @param in_interrupt_param Interrupt parameter
+static void imuBarometerSampleReceived(uint8_t in_sensor_index, drvIMUBarometerSample* in_sample, void* in_interrupt_param)
+{
+	fdrRECORD(fdrRT_SENSOR, in_sensor_index, in_sample, sizeof(drvIMUBarometerSample));
+
+	// only the newest sample is kept
+	sysCriticalSectionBeginFromISR();
+	l_barometer_sample = *in_sample;
+	l_barometer_sample_valid = true;
+	sysCriticalSectionEndFromISR();
+
+	sysTaskNotifyGiveFromISR(l_task_event, in_interrupt_param);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Feeds recorded sensor sample to the attitude estimation (can be used as flight data replay sensor callback).
+/// Samples of the sensors are ignored after the first replayed sample.
+/// @param in_sensor_index Index of the sensor
+/// @param in_data Sample data (drvIMUSample)
+/// @param in_length Length of the sample data
+void imuReplaySample(uint8_t in_sensor_index, uint8_t* in_data, uint16_t in_length)
+{
+	drvIMUSample sample;
+
+	if (in_sensor_index != l_attitude_sensor_index || in_length != sizeof(drvIMUSample))
+		return;
+
+	// restart estimation from the replayed data
+	if (!l_replay_active)
+	{
+		l_replay_active = true;
+		l_realign_requested = true;
+	}
+
+	sysMemCopy(&sample, in_data, sizeof(drvIMUSample));
+	imuStoreSample(&sample);
+
+	sysTaskNotifyGive(l_task_event);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Gets attitude estimation statistics
+/// @param out_statistics Statistics
+void imuGetAttitudeStatistics(imuAttitudeStatistics* out_statistics)
+{
+	sysCriticalSectionBegin();
+	*out_statistics = l_attitude_statistics;
+	sysCriticalSectionEnd();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Stores sample in the sample buffer (single writer)
+/// @param in_sample Sample to store
+static void imuStoreSample(drvIMUSample* in_sample)
+{
+	uint16_t push_index;
 
+	push_index = l_sample_buffer_push_index + 1;
+	if (push_index >= imuSAMPLE_BUFFER_LENGTH)
+		push_index = 0;
 
-	while(1)
+	// buffer is full
+	if (push_index == l_sample_buffer_pop_index)
 	{
-			sysDelay(1000);
+		l_attitude_statistics.DroppedSampleCount++;
+		return;
 	}
+
+	l_sample_buffer[l_sample_buffer_push_index] = *in_sample;
+
+	// sample must be stored before the index is changed
+	sysMemoryBarrier();
+	l_sample_buffer_push_index = push_index;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Updates attitude estimation with all buffered samples and publishes the result
+static void imuProcessSamples(void)
+{
+	sysHighresTimestamp start_timestamp;
+	uint32_t processing_time;
+	uint32_t latency;
+	uint16_t pop_index;
+	drvIMUSample* sample;
+	mathVector3f rate;
+	mathVector3f acceleration;
+	uint32_t sample_time_difference;
+	uint32_t timestamp = 0;
+	uint16_t sample_count = 0;
+
+	start_timestamp = sysHighresTimerGetTimestamp();
+
+	if (l_realign_requested)
+	{
+		l_realign_requested = false;
+		l_attitude_aligned = false;
+	}
+
+	pop_index = l_sample_buffer_pop_index;
+	while (pop_index != l_sample_buffer_push_index)
+	{
+		// sample must be read after the index
+		sysMemoryBarrier();
+		sample = &l_sample_buffer[pop_index];
+
+		// convert to physical units
+		mathVector3FromInt16(&acceleration, sample->Acceleration, l_acceleration_scale);
+		mathVector3FromInt16(&rate, sample->Gyro, l_gyro_scale);
+		timestamp = sample->Timestamp;
+
+		// release buffer entry
+		sysMemoryBarrier();
+		pop_index++;
+		if (pop_index >= imuSAMPLE_BUFFER_LENGTH)
+			pop_index = 0;
+		l_sample_buffer_pop_index = pop_index;
+
+		if (l_attitude_aligned)
+		{
+			// use sample timestamps for integration (the result doesn't depend on the processing time)
+			sample_time_difference = timestamp - l_previous_sample_timestamp;
+			if (sample_time_difference == 0 || sample_time_difference > imuMAX_SAMPLE_GAP)
+				sample_time_difference = l_nominal_sample_period;
+
+			imuAttitudeUpdate(&l_attitude, &rate, &acceleration, sample_time_difference * 1e-6f);
+		}
+		else
+		{
+			// start from the measured gravity direction
+			imuAttitudeAlign(&l_attitude, &acceleration);
+			l_attitude_aligned = true;
+		}
+
+		l_previous_sample_timestamp = timestamp;
+		sample_count++;
+	}
+
+	if (sample_count == 0)
+		return;
+
+	imuPublishAttitude(timestamp, &rate, &acceleration);
+
+	// update statistics
+	processing_time = sysHighresTimerGetTimestamp() - start_timestamp;
+
+	sysCriticalSectionBegin();
+	l_attitude_statistics.UpdateCount += sample_count;
+	l_attitude_statistics.PublishCount++;
+	l_attitude_statistics.TotalProcessingTime += processing_time;
+	if (processing_time > l_attitude_statistics.MaxProcessingTime)
+		l_attitude_statistics.MaxProcessingTime = processing_time;
+
+	// latency is meaningful only for the samples of the sensors
+	if (!l_replay_active)
+	{
+		latency = sysHighresTimerGetTimestamp() - timestamp;
+		l_attitude_statistics.TotalLatency += latency;
+		if (latency > l_attitude_statistics.MaxLatency)
+			l_attitude_statistics.MaxLatency = latency;
+	}
+	sysCriticalSectionEnd();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Calculates altitude of the newest barometric sample and writes it into the barometer object
+static void imuProcessBarometerSample(void)
+{
+	drvIMUBarometerSample sample;
+	float pressure;
+	float altitude;
+
+	if (!l_barometer_sample_valid)
+		return;
+
+	sysCriticalSectionBegin();
+	sample = l_barometer_sample;
+	l_barometer_sample_valid = false;
+	sysCriticalSectionEnd();
+
+	// international standard atmosphere (troposphere)
+	pressure = (float)sample.Pressure;
+	altitude = 44330.0f * (1.0f - mathPower(pressure / imuSEA_LEVEL_PRESSURE, 0.190295f));
+
+	if (!roxObjectWriteBegin(imuBAROMETER_OBJECT_INDEX))
+		return;
+
+	roxSetUInt32(imuBAROMETER_OBJECT_INDEX, imuBOM_TIMESTAMP, sample.Timestamp);
+	roxSetFloat(imuBAROMETER_OBJECT_INDEX, imuBOM_PRESSURE, pressure);
+	roxSetFloat(imuBAROMETER_OBJECT_INDEX, imuBOM_TEMPERATURE, sample.Temperature * 0.01f);
+	roxSetFloat(imuBAROMETER_OBJECT_INDEX, imuBOM_ALTITUDE, altitude);
+
+	roxObjectWriteEnd(imuBAROMETER_OBJECT_INDEX);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Writes the current attitude, angular rate and acceleration into the attitude object
+/// @param in_timestamp Sampling time of the newest sample [us]
+/// @param in_rate Angular rate of the newest sample [rad/s]
+/// @param in_acceleration Acceleration of the newest sample [g]
+static void imuPublishAttitude(uint32_t in_timestamp, const mathVector3f* in_rate, const mathVector3f* in_acceleration)
+{
+	float roll, pitch, yaw;
+
+	imuAttitudeGetEulerAngles(&l_attitude, &roll, &pitch, &yaw);
+
+	if (!roxObjectWriteBegin(imuATTITUDE_OBJECT_INDEX))
+		return;
+
+	roxSetUInt32(imuATTITUDE_OBJECT_INDEX, imuAOM_TIMESTAMP, in_timestamp);
+	roxSetFloat(imuATTITUDE_OBJECT_INDEX, imuAOM_QUATERNION_W, l_attitude.Quaternion.W);
+	roxSetFloat(imuATTITUDE_OBJECT_INDEX, imuAOM_QUATERNION_X, l_attitude.Quaternion.X);
+	roxSetFloat(imuATTITUDE_OBJECT_INDEX, imuAOM_QUATERNION_Y, l_attitude.Quaternion.Y);
+	roxSetFloat(imuATTITUDE_OBJECT_INDEX, imuAOM_QUATERNION_Z, l_attitude.Quaternion.Z);
+	roxSetFloat(imuATTITUDE_OBJECT_INDEX, imuAOM_ROLL, roll);
+	roxSetFloat(imuATTITUDE_OBJECT_INDEX, imuAOM_PITCH, pitch);
+	roxSetFloat(imuATTITUDE_OBJECT_INDEX, imuAOM_YAW, yaw);
+	roxSetFloat(imuATTITUDE_OBJECT_INDEX, imuAOM_RATE_X, in_rate->X);
+	roxSetFloat(imuATTITUDE_OBJECT_INDEX, imuAOM_RATE_Y, in_rate->Y);
+	roxSetFloat(imuATTITUDE_OBJECT_INDEX, imuAOM_RATE_Z, in_rate->Z);
+	roxSetFloat(imuATTITUDE_OBJECT_INDEX, imuAOM_ACCELERATION_X, in_acceleration->X);
+	roxSetFloat(imuATTITUDE_OBJECT_INDEX, imuAOM_ACCELERATION_Y, in_acceleration->Y);
+	roxSetFloat(imuATTITUDE_OBJECT_INDEX, imuAOM_ACCELERATION_Z, in_acceleration->Z);
+
+	roxObjectWriteEnd(imuATTITUDE_OBJECT_INDEX);
+}
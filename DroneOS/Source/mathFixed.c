@@ -0,0 +1,181 @@
+/*****************************************************************************/
+/* Fixed point (Q format) vector and quaternion math                         */
+/*                                                                           */
+/* Copyright (C) 2016 Laszlo Arvai                                           */
+/* All rights reserved.                                                      */
+/*                                                                           */
+/* This software may be modified and distributed under the terms             */
+/* of the GNU General Public License.  See the LICENSE file for details.     */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/* Includes                                                                  */
+/*****************************************************************************/
+#include <mathFixed.h>
+#include <string.h>
+#if mathUSE_CMSIS
+#include <stm32f4xx.h>
+#endif
+
+/*****************************************************************************/
+/* Constants                                                                 */
+/*****************************************************************************/
+#define mathQ30_ROUND 0x20000000
+#define mathQ30_ONE_AND_HALF 0x60000000
+
+/*****************************************************************************/
+/* Array functions                                                           */
+/*****************************************************************************/
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Calculates dot product of Q15 arrays
+/// @param in_a First array
+/// @param in_b Second array
+/// @param in_count Number of elements
+/// @return Dot product in Q30 format (not rounded, doesn't overflow)
+int64_t mathQ15DotProduct(const mathQ15* in_a, const mathQ15* in_b, uint16_t in_count)
+{
+	int64_t result = 0;
+	uint16_t i = 0;
+
+#if mathUSE_CMSIS
+	uint32_t a;
+	uint32_t b;
+
+	// two multiply-accumulate per instruction
+	while (i + 2 <= in_count)
+	{
+		memcpy(&a, &in_a[i], sizeof(a));
+		memcpy(&b, &in_b[i], sizeof(b));
+		result = (int64_t)__SMLALD(a, b, (uint64_t)result);
+		i += 2;
+	}
+#endif
+
+	while (i < in_count)
+	{
+		result += (int32_t)in_a[i] * in_b[i];
+		i++;
+	}
+
+	return result;
+}
+
+/*****************************************************************************/
+/* Vector functions                                                          */
+/*****************************************************************************/
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Converts raw sensor reading to physical units
+/// @param out_vector Converted vector
+/// @param in_raw Raw X, Y, Z values
+/// @param in_scale Resolution of the raw values in Q30 format (Q16 would have only a few significant bits for typical sensor resolutions)
+void mathVector3Q16FromInt16(mathVector3Q16* out_vector, const int16_t in_raw[3], mathQ30 in_scale)
+{
+	out_vector->X = (mathQ16)(((int64_t)in_raw[0] * in_scale + 0x2000) >> 14);
+	out_vector->Y = (mathQ16)(((int64_t)in_raw[1] * in_scale + 0x2000) >> 14);
+	out_vector->Z = (mathQ16)(((int64_t)in_raw[2] * in_scale + 0x2000) >> 14);
+}
+
+/*****************************************************************************/
+/* Quaternion functions                                                      */
+/*****************************************************************************/
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Sets quaternion to identity (no rotation)
+void mathQuaternionQ30SetIdentity(mathQuaternionQ30* out_quaternion)
+{
+	out_quaternion->W = mathQ30_ONE;
+	out_quaternion->X = 0;
+	out_quaternion->Y = 0;
+	out_quaternion->Z = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Converts floating point quaternion components to Q30 format
+void mathQuaternionQ30FromFloat(mathQuaternionQ30* out_quaternion, float in_w, float in_x, float in_y, float in_z)
+{
+	out_quaternion->W = mathQ30FromFloat(in_w);
+	out_quaternion->X = mathQ30FromFloat(in_x);
+	out_quaternion->Y = mathQ30FromFloat(in_y);
+	out_quaternion->Z = mathQ30FromFloat(in_z);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Calculates quaternion product out = a * b (rotation b followed by rotation a)
+void mathQuaternionQ30Multiply(mathQuaternionQ30* out_quaternion, const mathQuaternionQ30* in_a, const mathQuaternionQ30* in_b)
+{
+	int64_t w, x, y, z;
+
+	w = (int64_t)in_a->W * in_b->W - (int64_t)in_a->X * in_b->X - (int64_t)in_a->Y * in_b->Y - (int64_t)in_a->Z * in_b->Z;
+	x = (int64_t)in_a->W * in_b->X + (int64_t)in_a->X * in_b->W + (int64_t)in_a->Y * in_b->Z - (int64_t)in_a->Z * in_b->Y;
+	y = (int64_t)in_a->W * in_b->Y - (int64_t)in_a->X * in_b->Z + (int64_t)in_a->Y * in_b->W + (int64_t)in_a->Z * in_b->X;
+	z = (int64_t)in_a->W * in_b->Z + (int64_t)in_a->X * in_b->Y - (int64_t)in_a->Y * in_b->X + (int64_t)in_a->Z * in_b->W;
+
+	out_quaternion->W = (mathQ30)((w + mathQ30_ROUND) >> 30);
+	out_quaternion->X = (mathQ30)((x + mathQ30_ROUND) >> 30);
+	out_quaternion->Y = (mathQ30)((y + mathQ30_ROUND) >> 30);
+	out_quaternion->Z = (mathQ30)((z + mathQ30_ROUND) >> 30);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Scales quaternion to unit length. The inverse square root is calculated by two Newton
+/// iterations started from one, the quaternion must be close to unit length (squared norm in 0.99..1.01).
+void mathQuaternionQ30Normalize(mathQuaternionQ30* inout_quaternion)
+{
+	int64_t norm_square;
+	mathQ30 half_norm_square;
+	mathQ30 scale;
+
+	norm_square = (int64_t)inout_quaternion->W * inout_quaternion->W + (int64_t)inout_quaternion->X * inout_quaternion->X + (int64_t)inout_quaternion->Y * inout_quaternion->Y + (int64_t)inout_quaternion->Z * inout_quaternion->Z;
+	half_norm_square = (mathQ30)((norm_square + ((int64_t)1 << 30)) >> 31);
+
+	// scale = 1.5 - 0.5 * n, then scale = scale * (1.5 - 0.5 * n * scale^2)
+	scale = mathQ30_ONE_AND_HALF - half_norm_square;
+	scale = mathQ30Multiply(scale, mathQ30_ONE_AND_HALF - mathQ30Multiply(half_norm_square, mathQ30Multiply(scale, scale)));
+
+	inout_quaternion->W = mathQ30Multiply(inout_quaternion->W, scale);
+	inout_quaternion->X = mathQ30Multiply(inout_quaternion->X, scale);
+	inout_quaternion->Y = mathQ30Multiply(inout_quaternion->Y, scale);
+	inout_quaternion->Z = mathQ30Multiply(inout_quaternion->Z, scale);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Calculates half rotation angle in Q30 format (rounded to the nearest)
+/// @param in_angular_rate Angular rate [rad/s]
+/// @param in_dt_us Integration time [us]
+static mathQ30 mathQ30HalfAngle(mathQ16 in_angular_rate, uint32_t in_dt_us)
+{
+	int64_t product = (int64_t)in_angular_rate * in_dt_us * 8192;
+
+	return (mathQ30)((product + ((product >= 0) ? 500000 : -500000)) / 1000000);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Integrates angular rate (first order) and normalizes the result
+/// @param inout_quaternion Attitude (body to earth frame)
+/// @param in_angular_rate Angular rate in body frame [rad/s]
+/// @param in_dt_us Integration time [us] (rotation angle during this time must be less than 0.1 rad, otherwise
+/// the squared norm of the integrated quaternion is out of the range of mathQuaternionQ30Normalize)
+void mathQuaternionQ30Integrate(mathQuaternionQ30* inout_quaternion, const mathVector3Q16* in_angular_rate, uint32_t in_dt_us)
+{
+	int64_t w, x, y, z;
+	mathQ30 hx, hy, hz;
+
+	// half rotation angle in Q30: rate[Q16] * dt[us] * 2^14 / 10^6 / 2 (rounded)
+	hx = mathQ30HalfAngle(in_angular_rate->X, in_dt_us);
+	hy = mathQ30HalfAngle(in_angular_rate->Y, in_dt_us);
+	hz = mathQ30HalfAngle(in_angular_rate->Z, in_dt_us);
+
+	w = inout_quaternion->W;
+	x = inout_quaternion->X;
+	y = inout_quaternion->Y;
+	z = inout_quaternion->Z;
+
+	inout_quaternion->W += (mathQ30)((-x * hx - y * hy - z * hz + mathQ30_ROUND) >> 30);
+	inout_quaternion->X += (mathQ30)((w * hx + y * hz - z * hy + mathQ30_ROUND) >> 30);
+	inout_quaternion->Y += (mathQ30)((w * hy - x * hz + z * hx + mathQ30_ROUND) >> 30);
+	inout_quaternion->Z += (mathQ30)((w * hz + x * hy - y * hx + mathQ30_ROUND) >> 30);
+
+	mathQuaternionQ30Normalize(inout_quaternion);
+}
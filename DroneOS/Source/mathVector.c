@@ -0,0 +1,368 @@
+/*****************************************************************************/
+/* Vector, quaternion and matrix math (single precision floating point)      */
+/*                                                                           */
+/* Copyright (C) 2016 Laszlo Arvai                                           */
+/* All rights reserved.                                                      */
+/*                                                                           */
+/* This software may be modified and distributed under the terms             */
+/* of the GNU General Public License.  See the LICENSE file for details.     */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/* Includes                                                                  */
+/*****************************************************************************/
+#include <mathVector.h>
+#include <string.h>
+
+/*****************************************************************************/
+/* Types                                                                     */
+/*****************************************************************************/
+#if mathUSE_SIMD
+typedef float mathFloat4 __attribute__((vector_size(16)));
+typedef int32_t mathInt4 __attribute__((vector_size(16)));
+#endif
+
+/*****************************************************************************/
+/* Local functions                                                           */
+/*****************************************************************************/
+#if mathUSE_SIMD
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Multiplies quaternions stored in SIMD registers (lane order: W, X, Y, Z)
+static mathFloat4 mathQuaternionMultiplyFloat4(mathFloat4 in_a, mathFloat4 in_b)
+{
+	static const mathInt4 x_mask = { 1, 0, 3, 2 };
+	static const mathInt4 y_mask = { 2, 3, 0, 1 };
+	static const mathInt4 z_mask = { 3, 2, 1, 0 };
+	static const mathFloat4 x_sign = { -1.0f, 1.0f, -1.0f, 1.0f };
+	static const mathFloat4 y_sign = { -1.0f, 1.0f, 1.0f, -1.0f };
+	static const mathFloat4 z_sign = { -1.0f, -1.0f, 1.0f, 1.0f };
+
+	return in_a[0] * in_b
+		+ in_a[1] * __builtin_shuffle(in_b, x_mask) * x_sign
+		+ in_a[2] * __builtin_shuffle(in_b, y_mask) * y_sign
+		+ in_a[3] * __builtin_shuffle(in_b, z_mask) * z_sign;
+}
+
+#endif
+
+/*****************************************************************************/
+/* Scalar functions                                                          */
+/*****************************************************************************/
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Calculates approximate 1/sqrt(x) without division and square root instruction. Two Newton
+/// iterations are used, the relative error is less than mathFAST_INVERSE_SQUARE_ROOT_ERROR.
+/// @param in_value Input value (must be positive and normalized)
+/// @return Inverse square root
+float mathFastInverseSquareRoot(float in_value)
+{
+	float half_value = 0.5f * in_value;
+	float result;
+	uint32_t bits;
+
+	memcpy(&bits, &in_value, sizeof(bits));
+	bits = 0x5f3759df - (bits >> 1);
+	memcpy(&result, &bits, sizeof(result));
+
+	result = result * (1.5f - half_value * result * result);
+	result = result * (1.5f - half_value * result * result);
+
+	return result;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Calculates base^exponent as 2^(exponent * log2(base)) using polynomials instead of the powf library
+/// function (which is calculated in double precision by some C libraries). The relative error is less than
+/// mathPOWER_ERROR within mathPOWER_RANGE.
+/// @param in_base Base (must be positive and normalized)
+/// @param in_exponent Exponent
+/// @return Power
+float mathPower(float in_base, float in_exponent)
+{
+	float mantissa;
+	float s, s2;
+	float log2_value;
+	float fraction;
+	float scale;
+	float result;
+	int32_t exponent;
+	uint32_t bits;
+
+	// log2: base = mantissa * 2^exponent, where mantissa is in sqrt(0.5)..sqrt(2) range
+	memcpy(&bits, &in_base, sizeof(bits));
+	exponent = (int32_t)((bits >> 23) & 0xff) - 127;
+	bits = (bits & 0x007fffff) | 0x3f800000;
+	memcpy(&mantissa, &bits, sizeof(mantissa));
+
+	if (mantissa > 1.41421356f)
+	{
+		mantissa *= 0.5f;
+		exponent++;
+	}
+
+	// log2(mantissa) = 2 / ln(2) * atanh(s), where s = (mantissa - 1) / (mantissa + 1)
+	s = (mantissa - 1.0f) / (mantissa + 1.0f);
+	s2 = s * s;
+	log2_value = exponent + s * (2.88539008f + s2 * (0.961796694f + s2 * (0.577078016f + s2 * 0.412198583f)));
+
+	// exp2: 2^(integer part) * 2^(fractional part in -0.5..0.5 range)
+	log2_value *= in_exponent;
+	if (log2_value > 127.0f)
+		log2_value = 127.0f;
+	if (log2_value < -126.0f)
+		log2_value = -126.0f;
+
+	exponent = (int32_t)(log2_value + ((log2_value >= 0) ? 0.5f : -0.5f));
+	fraction = log2_value - exponent;
+
+	result = 1.0f + fraction * (0.693147181f + fraction * (0.240226507f + fraction * (0.0555041087f + fraction * (0.00961812911f + fraction * (0.00133335581f + fraction * (0.000154035304f + fraction * 0.0000152527338f))))));
+
+	bits = (uint32_t)(exponent + 127) << 23;
+	memcpy(&scale, &bits, sizeof(scale));
+
+	return result * scale;
+}
+
+/*****************************************************************************/
+/* Vector functions                                                          */
+/*****************************************************************************/
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Returns length of the vector
+float mathVector3Length(const mathVector3f* in_vector)
+{
+	return sqrtf(mathVector3Dot(in_vector, in_vector));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Scales vector to unit length
+/// @param inout_vector Vector to normalize
+/// @return False if the vector has zero length (vector is not changed)
+bool mathVector3Normalize(mathVector3f* inout_vector)
+{
+	float length_square = mathVector3Dot(inout_vector, inout_vector);
+
+	if (length_square <= 0.0f)
+		return false;
+
+	mathVector3Scale(inout_vector, inout_vector, mathInverseSquareRoot(length_square));
+
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Converts array of raw sensor values to physical units
+/// @param out_values Converted values
+/// @param in_raw Raw values
+/// @param in_count Number of values to convert
+/// @param in_scale Resolution of the raw values
+void mathConvertInt16Array(float* out_values, const int16_t* in_raw, uint16_t in_count, float in_scale)
+{
+	uint16_t i = 0;
+
+#if mathUSE_SIMD
+	mathFloat4 scale = { in_scale, in_scale, in_scale, in_scale };
+	mathFloat4 values;
+
+	while (i + 4 <= in_count)
+	{
+		values = (mathFloat4){ (float)in_raw[i], (float)in_raw[i + 1], (float)in_raw[i + 2], (float)in_raw[i + 3] } * scale;
+		memcpy(&out_values[i], &values, sizeof(values));
+		i += 4;
+	}
+#endif
+
+	while (i < in_count)
+	{
+		out_values[i] = in_raw[i] * in_scale;
+		i++;
+	}
+}
+
+/*****************************************************************************/
+/* Quaternion functions                                                      */
+/*****************************************************************************/
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Calculates quaternion product out = a * b (rotation b followed by rotation a)
+void mathQuaternionMultiply(mathQuaternionf* out_quaternion, const mathQuaternionf* in_a, const mathQuaternionf* in_b)
+{
+#if mathUSE_SIMD
+	mathFloat4 a;
+	mathFloat4 b;
+
+	memcpy(&a, in_a, sizeof(a));
+	memcpy(&b, in_b, sizeof(b));
+	a = mathQuaternionMultiplyFloat4(a, b);
+	memcpy(out_quaternion, &a, sizeof(a));
+#else
+	float w, x, y, z;
+
+	w = in_a->W * in_b->W - in_a->X * in_b->X - in_a->Y * in_b->Y - in_a->Z * in_b->Z;
+	x = in_a->W * in_b->X + in_a->X * in_b->W + in_a->Y * in_b->Z - in_a->Z * in_b->Y;
+	y = in_a->W * in_b->Y - in_a->X * in_b->Z + in_a->Y * in_b->W + in_a->Z * in_b->X;
+	z = in_a->W * in_b->Z + in_a->X * in_b->Y - in_a->Y * in_b->X + in_a->Z * in_b->W;
+
+	out_quaternion->W = w;
+	out_quaternion->X = x;
+	out_quaternion->Y = y;
+	out_quaternion->Z = z;
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Scales quaternion to unit length
+void mathQuaternionNormalize(mathQuaternionf* inout_quaternion)
+{
+	float norm;
+
+	norm = inout_quaternion->W * inout_quaternion->W + inout_quaternion->X * inout_quaternion->X + inout_quaternion->Y * inout_quaternion->Y + inout_quaternion->Z * inout_quaternion->Z;
+	norm = mathInverseSquareRoot(norm);
+
+	inout_quaternion->W *= norm;
+	inout_quaternion->X *= norm;
+	inout_quaternion->Y *= norm;
+	inout_quaternion->Z *= norm;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Rotates vector by a unit quaternion (out = q * v * q')
+/// @param out_vector Rotated vector (can be the same as the input)
+/// @param in_quaternion Rotation
+/// @param in_vector Vector to rotate
+void mathQuaternionRotate(mathVector3f* out_vector, const mathQuaternionf* in_quaternion, const mathVector3f* in_vector)
+{
+	mathVector3f axis;
+	mathVector3f t;
+	mathVector3f u;
+
+	// t = 2 * (q.xyz x v), out = v + w * t + q.xyz x t
+	mathVector3Set(&axis, in_quaternion->X, in_quaternion->Y, in_quaternion->Z);
+	mathVector3Cross(&t, &axis, in_vector);
+	mathVector3Scale(&t, &t, 2.0f);
+	mathVector3Cross(&u, &axis, &t);
+
+	out_vector->X = in_vector->X + in_quaternion->W * t.X + u.X;
+	out_vector->Y = in_vector->Y + in_quaternion->W * t.Y + u.Y;
+	out_vector->Z = in_vector->Z + in_quaternion->W * t.Z + u.Z;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Creates quaternion from Euler angles (Z-Y-X order)
+/// @param out_quaternion Attitude (body to earth frame)
+/// @param in_roll Roll angle [rad]
+/// @param in_pitch Pitch angle [rad]
+/// @param in_yaw Yaw angle [rad]
+void mathQuaternionFromEulerAngles(mathQuaternionf* out_quaternion, float in_roll, float in_pitch, float in_yaw)
+{
+	float cr = cosf(in_roll * 0.5f);
+	float sr = sinf(in_roll * 0.5f);
+	float cp = cosf(in_pitch * 0.5f);
+	float sp = sinf(in_pitch * 0.5f);
+	float cy = cosf(in_yaw * 0.5f);
+	float sy = sinf(in_yaw * 0.5f);
+
+	out_quaternion->W = cr * cp * cy + sr * sp * sy;
+	out_quaternion->X = sr * cp * cy - cr * sp * sy;
+	out_quaternion->Y = cr * sp * cy + sr * cp * sy;
+	out_quaternion->Z = cr * cp * sy - sr * sp * cy;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Converts quaternion to Euler angles (Z-Y-X order)
+/// @param in_quaternion Attitude (body to earth frame)
+/// @param out_roll Roll angle [rad]
+/// @param out_pitch Pitch angle [rad]
+/// @param out_yaw Yaw angle [rad]
+void mathQuaternionToEulerAngles(const mathQuaternionf* in_quaternion, float* out_roll, float* out_pitch, float* out_yaw)
+{
+	const mathQuaternionf* q = in_quaternion;
+	float sin_pitch;
+
+	*out_roll = atan2f(2.0f * (q->W * q->X + q->Y * q->Z), 1.0f - 2.0f * (q->X * q->X + q->Y * q->Y));
+
+	sin_pitch = 2.0f * (q->W * q->Y - q->Z * q->X);
+	if (sin_pitch > 1.0f)
+		sin_pitch = 1.0f;
+	if (sin_pitch < -1.0f)
+		sin_pitch = -1.0f;
+	*out_pitch = asinf(sin_pitch);
+
+	*out_yaw = atan2f(2.0f * (q->W * q->Z + q->X * q->Y), 1.0f - 2.0f * (q->Y * q->Y + q->Z * q->Z));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Converts unit quaternion to rotation matrix
+/// @param out_matrix Rotation matrix (body to earth frame)
+/// @param in_quaternion Attitude (body to earth frame)
+void mathQuaternionToMatrix(mathMatrix3f* out_matrix, const mathQuaternionf* in_quaternion)
+{
+	const mathQuaternionf* q = in_quaternion;
+	float xx = q->X * q->X;
+	float yy = q->Y * q->Y;
+	float zz = q->Z * q->Z;
+	float xy = q->X * q->Y;
+	float xz = q->X * q->Z;
+	float yz = q->Y * q->Z;
+	float wx = q->W * q->X;
+	float wy = q->W * q->Y;
+	float wz = q->W * q->Z;
+
+	out_matrix->M[0][0] = 1.0f - 2.0f * (yy + zz);
+	out_matrix->M[0][1] = 2.0f * (xy - wz);
+	out_matrix->M[0][2] = 2.0f * (xz + wy);
+
+	out_matrix->M[1][0] = 2.0f * (xy + wz);
+	out_matrix->M[1][1] = 1.0f - 2.0f * (xx + zz);
+	out_matrix->M[1][2] = 2.0f * (yz - wx);
+
+	out_matrix->M[2][0] = 2.0f * (xz - wy);
+	out_matrix->M[2][1] = 2.0f * (yz + wx);
+	out_matrix->M[2][2] = 1.0f - 2.0f * (xx + yy);
+}
+
+/*****************************************************************************/
+/* Matrix functions                                                          */
+/*****************************************************************************/
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Calculates out = M * v (out must not be the same as the input vector)
+void mathMatrix3MultiplyVector(mathVector3f* out_vector, const mathMatrix3f* in_matrix, const mathVector3f* in_vector)
+{
+	out_vector->X = in_matrix->M[0][0] * in_vector->X + in_matrix->M[0][1] * in_vector->Y + in_matrix->M[0][2] * in_vector->Z;
+	out_vector->Y = in_matrix->M[1][0] * in_vector->X + in_matrix->M[1][1] * in_vector->Y + in_matrix->M[1][2] * in_vector->Z;
+	out_vector->Z = in_matrix->M[2][0] * in_vector->X + in_matrix->M[2][1] * in_vector->Y + in_matrix->M[2][2] * in_vector->Z;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Calculates out = A * B (out must not be the same as any of the inputs)
+void mathMatrix3Multiply(mathMatrix3f* out_matrix, const mathMatrix3f* in_a, const mathMatrix3f* in_b)
+{
+	uint8_t row;
+	uint8_t column;
+
+	for (row = 0; row < 3; row++)
+	{
+		for (column = 0; column < 3; column++)
+		{
+			out_matrix->M[row][column] = in_a->M[row][0] * in_b->M[0][column] + in_a->M[row][1] * in_b->M[1][column] + in_a->M[row][2] * in_b->M[2][column];
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Calculates transpose (inverse of a rotation matrix). Out must not be the same as the input.
+void mathMatrix3Transpose(mathMatrix3f* out_matrix, const mathMatrix3f* in_matrix)
+{
+	uint8_t row;
+	uint8_t column;
+
+	for (row = 0; row < 3; row++)
+	{
+		for (column = 0; column < 3; column++)
+		{
+			out_matrix->M[row][column] = in_matrix->M[column][row];
+		}
+	}
+}
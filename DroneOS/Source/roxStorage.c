@@ -15,14 +15,23 @@
 #include <sysRTOS.h>
 #include <roxTelemetry.h>
 #include <comSystemPacketDefinitions.h>
+#include <fdrRecorder.h>
 
 /*****************************************************************************/
 /* Constants                                                                 */
 /*****************************************************************************/
 #define roxOBJECT_STORAGE_COUNT 2
-#define roxTOTAL_STORAGE_SIZE 1024
+#define roxSTORAGE_TASK_PRIORITY 2
+#define roxSTORAGE_TASK_MAX_CYCLE_TIME 100
+
+// number of callbacks which can be added by roxCallbackFunctionAdd (subscriptions of roxCallbackSubscribe are not limited)
+#ifndef roxTOTAL_CALLBACK_FUNCTION_COUNT
 #define roxTOTAL_CALLBACK_FUNCTION_COUNT 20
-#define roxSTORAGE_INVALID_CALLBACK_INDEX 0xffff
+#endif
+
+// storage index used by the readers and by the writer of the given object version
+#define roxREAD_STORAGE_INDEX(version) ((version) & 1)
+#define roxWRITE_STORAGE_INDEX(version) (((version) + 1) & 1)
 
 /*****************************************************************************/
 /* Types                                                                     */
@@ -42,31 +51,24 @@ typedef struct
 	float MagnetoZ;
 } roxIMURawData;
 
-typedef enum
-{
-	roxOWS_Unlocked,
-	roxOWS_LockedForWrite,
-	roxOWS_PendingAfterWrite
-} roxObjectWriteState;
-
-typedef struct
-{
-	roxObjectChangedCallbackFunction Callback;
-	uint16_t NextCallbackFunctionIndex;
-} roxCallbackFunctionColectionEntry;
-
 typedef struct
 {
-	roxObjectWriteState WriteState;
-	uint8_t ReaderCount;
-	uint16_t VersionNumber;
+	volatile roxObjectVersion Version;	// incremented by every write (lowest bit selects the storage used by the readers)
+	volatile bool WriteLocked;					// object is locked by a writer
 	uint16_t Address;
-	uint8_t ReadStorageIndex;
-	uint8_t WriteStorageIndex;
-	uint16_t FirstCallbackFunctionIndex;
+	bool NotificationPending;						// object is in the changed object queue
+	roxCallbackSubscription* FirstSubscription;
 } roxObjectStorageInfo;
 
-typedef uint16_t roxCallbackIndex;
+/*****************************************************************************/
+/* Local function prototypes                                                 */
+/*****************************************************************************/
+static sysTaskRetval roxStorageTask(sysTaskParam in_param);
+static bool roxObjectWriteLock(roxObjectIndex in_object_index);
+static void roxCallbackListAppend(roxObjectIndex in_object_index, roxCallbackSubscription* in_subscription);
+static void roxCallbackListRemove(roxObjectIndex in_object_index, roxCallbackSubscription* in_subscription);
+static uint8_t* roxGetMemberReadAddress(roxObjectIndex in_object_index, roxMemberAddress in_member_address);
+static uint8_t* roxGetMemberWriteAddress(roxObjectIndex in_object_index, roxMemberAddress in_member_address);
 
 /*****************************************************************************/
 /* Module global variables                                                   */
@@ -75,8 +77,19 @@ static uint8_t l_realtime_object_value_storage[roxOBJECT_STORAGE_COUNT][roxTOTAL
 static roxObjectStorageInfo l_object_storage_info[roxTOTAL_OBJECT_COUNT];
 
 // callback variables
-static roxCallbackFunctionColectionEntry l_callback_collection[roxTOTAL_CALLBACK_FUNCTION_COUNT];
 static sysMutex l_callback_collection_lock;
+static roxCallbackSubscription l_callback_collection[roxTOTAL_CALLBACK_FUNCTION_COUNT]; // subscriptions of roxCallbackFunctionAdd
+
+// changed object queue (every object is stored at most once)
+static roxObjectIndex l_changed_object_queue[roxTOTAL_OBJECT_COUNT];
+static uint16_t l_changed_object_queue_push_index;
+static uint16_t l_changed_object_queue_pop_index;
+static uint16_t l_changed_object_queue_length;
+static roxStorageStatistics l_storage_statistics;
+
+// task variables
+static bool l_stop_task = false;
+static sysTaskNotify l_task_event;
 
 /*****************************************************************************/
 /* Function implementation                                                   */
@@ -87,14 +100,33 @@ static sysMutex l_callback_collection_lock;
 void roxStorageInitialize(void)
 {
 	uint16_t i;
+	sysTask task_handle;
+
+	for (i = 0; i < roxTOTAL_OBJECT_COUNT; i++)
+	{
+		l_object_storage_info[i].Version = 0;
+		l_object_storage_info[i].WriteLocked = false;
+		l_object_storage_info[i].Address = i * roxOBJECT_SIZE;
+		l_object_storage_info[i].NotificationPending = false;
+		l_object_storage_info[i].FirstSubscription = sysNULL;
+	}
 
 	for (i = 0; i < roxTOTAL_CALLBACK_FUNCTION_COUNT; i++)
 	{
 		l_callback_collection[i].Callback = sysNULL;
-		l_callback_collection[i].NextCallbackFunctionIndex = roxSTORAGE_INVALID_CALLBACK_INDEX;
+		l_callback_collection[i].Next = sysNULL;
 	}
 
+	l_changed_object_queue_push_index = 0;
+	l_changed_object_queue_pop_index = 0;
+	l_changed_object_queue_length = 0;
+	sysMemZero(&l_storage_statistics, sizeof(l_storage_statistics));
+
 	sysMutexCreate(l_callback_collection_lock);
+	sysTaskNotifyCreate(l_task_event);
+
+	// start change notification dispatcher task
+	sysTaskCreate(roxStorageTask, "roxStorage", sysDEFAULT_STACK_SIZE, sysNULL, roxSTORAGE_TASK_PRIORITY, &task_handle, roxStorageTaskStop);
 }
 
 /*****************************************************************************/
@@ -102,118 +134,271 @@ void roxStorageInitialize(void)
 /*****************************************************************************/
 
 ///////////////////////////////////////////////////////////////////////////////
-/// @brief Adds change callback function to a given object
+/// @brief Adds change callback function to a given object. The subscription storage is provided by the caller
+/// and it must be valid until the callback is removed (there is no limit on the number of callbacks).
+/// Callbacks are called from the storage dispatcher task after the object write is finished, they must not
+/// add or remove callbacks.
 /// @param in_object_index Index of the object to receive a new change callback
+/// @param in_subscription Subscription storage for the callback
 /// @param in_callback_function Callback function pointer
-void roxCallbackFunctionAdd(roxObjectIndex in_object_index, roxObjectChangedCallbackFunction in_callback_function)
+void roxCallbackSubscribe(roxObjectIndex in_object_index, roxCallbackSubscription* in_subscription, roxObjectChangedCallbackFunction in_callback_function)
 {
-	roxCallbackIndex callback_to_append_index;
-	roxObjectIndex prev_callback_index;
-	roxObjectIndex callback_index;
+	// sanity check
+	sysASSERT(in_object_index < roxTOTAL_OBJECT_COUNT);
+	sysASSERT(in_subscription != sysNULL);
+
+	in_subscription->Callback = in_callback_function;
 
-	// update list of changed object in a critical section
 	sysMutexTake(l_callback_collection_lock, sysINFINITE_TIMEOUT);
+	roxCallbackListAppend(in_object_index, in_subscription);
+	sysMutexGive(l_callback_collection_lock);
+}
 
-	// find free storage in the callback list
-	callback_to_append_index = 0;
-	while (callback_to_append_index < roxTOTAL_CALLBACK_FUNCTION_COUNT)
-	{
-		if (l_callback_collection[callback_to_append_index].Callback == sysNULL)
-		{
-			l_callback_collection[callback_to_append_index].Callback = in_callback_function;
-			l_callback_collection[callback_to_append_index].NextCallbackFunctionIndex = roxSTORAGE_INVALID_CALLBACK_INDEX;
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Removes change callback function from a given object
+/// @param in_object_index Index of the object from remove the change callback
+/// @param in_subscription Subscription storage used when the callback was added
+void roxCallbackUnsubscribe(roxObjectIndex in_object_index, roxCallbackSubscription* in_subscription)
+{
+	// sanity check
+	sysASSERT(in_object_index < roxTOTAL_OBJECT_COUNT);
 
-			break;
-		}
+	sysMutexTake(l_callback_collection_lock, sysINFINITE_TIMEOUT);
+	roxCallbackListRemove(in_object_index, in_subscription);
+	sysMutexGive(l_callback_collection_lock);
+}
 
-		callback_to_append_index++;
-	}
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Adds change callback function to a given object. The subscription is allocated from the internal
+/// collection (roxTOTAL_CALLBACK_FUNCTION_COUNT entries), use roxCallbackSubscribe for unlimited number of callbacks.
+/// @param in_object_index Index of the object to receive a new change callback
+/// @param in_callback_function Callback function pointer
+void roxCallbackFunctionAdd(roxObjectIndex in_object_index, roxObjectChangedCallbackFunction in_callback_function)
+{
+	uint8_t i;
+
+	// sanity check
+	sysASSERT(in_object_index < roxTOTAL_OBJECT_COUNT);
+	sysASSERT(in_callback_function != sysNULL);
+
+	sysMutexTake(l_callback_collection_lock, sysINFINITE_TIMEOUT);
+
+	// find free entry in the collection
+	i = 0;
+	while (i < roxTOTAL_CALLBACK_FUNCTION_COUNT && l_callback_collection[i].Callback != sysNULL)
+		i++;
 
 	// check free space
-	sysASSERT(callback_to_append_index < roxTOTAL_CALLBACK_FUNCTION_COUNT);
+	sysASSERT(i < roxTOTAL_CALLBACK_FUNCTION_COUNT);
 
-	if (callback_to_append_index < roxTOTAL_CALLBACK_FUNCTION_COUNT)
+	if (i < roxTOTAL_CALLBACK_FUNCTION_COUNT)
 	{
-		if (l_object_storage_info[in_object_index].FirstCallbackFunctionIndex == roxSTORAGE_INVALID_CALLBACK_INDEX)
-		{
-			// if it is the first callback for the object
-			l_object_storage_info[in_object_index].FirstCallbackFunctionIndex = callback_to_append_index;
-		}
-		else
-		{
-			// append callback to the end of the list
-			prev_callback_index = roxSTORAGE_INVALID_CALLBACK_INDEX;
-			callback_index = l_object_storage_info[in_object_index].FirstCallbackFunctionIndex;
-			while (callback_index != roxSTORAGE_INVALID_CALLBACK_INDEX)
-			{
-				prev_callback_index = callback_index;
-				callback_index = l_callback_collection[callback_index].NextCallbackFunctionIndex;
-			}
-
-			l_callback_collection[prev_callback_index].NextCallbackFunctionIndex = callback_to_append_index;
-		}
+		l_callback_collection[i].Callback = in_callback_function;
+		roxCallbackListAppend(in_object_index, &l_callback_collection[i]);
 	}
 
-	// release lock
 	sysMutexGive(l_callback_collection_lock);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-/// @brief Removes change callback function from a given object
-/// @param in_object_index Index of the object from remove the change callback
+/// @brief Removes change callback function (added by roxCallbackFunctionAdd) from a given object
 /// @param in_callback_function Callback function pointer
+/// @param in_object_index Index of the object from remove the change callback
 void roxCallbackFunctionDelete(roxObjectChangedCallbackFunction in_callback_function, roxObjectIndex in_object_index)
 {
-	roxCallbackIndex prev_callback_index;
-	roxCallbackIndex callback_index;
+	roxCallbackSubscription* subscription;
+
+	// sanity check
+	sysASSERT(in_object_index < roxTOTAL_OBJECT_COUNT);
 
-	// update list of changed object in a critical section
 	sysMutexTake(l_callback_collection_lock, sysINFINITE_TIMEOUT);
 
-	// find callback
-	prev_callback_index = roxSTORAGE_INVALID_CALLBACK_INDEX;
-	callback_index = l_object_storage_info[in_object_index].FirstCallbackFunctionIndex;
-	while (callback_index != roxSTORAGE_INVALID_CALLBACK_INDEX && l_callback_collection[callback_index].Callback != in_callback_function)
+	// find the collection entry of the callback
+	subscription = l_object_storage_info[in_object_index].FirstSubscription;
+	while (subscription != sysNULL && (subscription->Callback != in_callback_function || subscription < &l_callback_collection[0] || subscription >= &l_callback_collection[roxTOTAL_CALLBACK_FUNCTION_COUNT]))
+		subscription = subscription->Next;
+
+	// remove callback and release the entry
+	if (subscription != sysNULL)
 	{
-		prev_callback_index = callback_index;
-		callback_index = l_callback_collection[callback_index].NextCallbackFunctionIndex;
+		roxCallbackListRemove(in_object_index, subscription);
+		subscription->Callback = sysNULL;
 	}
 
-	// remove callback from the list
-	if (prev_callback_index == roxSTORAGE_INVALID_CALLBACK_INDEX)
+	sysMutexGive(l_callback_collection_lock);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Appends subscription to the end of the callback list of the object (callback collection lock must be taken)
+/// @param in_object_index Object index
+/// @param in_subscription Subscription to append
+static void roxCallbackListAppend(roxObjectIndex in_object_index, roxCallbackSubscription* in_subscription)
+{
+	roxCallbackSubscription** subscription;
+
+	in_subscription->Next = sysNULL;
+
+	subscription = &l_object_storage_info[in_object_index].FirstSubscription;
+	while (*subscription != sysNULL)
+		subscription = &(*subscription)->Next;
+
+	*subscription = in_subscription;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Removes subscription from the callback list of the object (callback collection lock must be taken)
+/// @param in_object_index Object index
+/// @param in_subscription Subscription to remove
+static void roxCallbackListRemove(roxObjectIndex in_object_index, roxCallbackSubscription* in_subscription)
+{
+	roxCallbackSubscription** subscription;
+
+	// find subscription
+	subscription = &l_object_storage_info[in_object_index].FirstSubscription;
+	while (*subscription != sysNULL && *subscription != in_subscription)
+		subscription = &(*subscription)->Next;
+
+	// remove it from the list
+	if (*subscription != sysNULL)
+		*subscription = in_subscription->Next;
+
+	in_subscription->Next = sysNULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Call all callback function of the given object
+/// @param in_object_index Object index to call
+static void roxStorageCallbackExecute(roxObjectIndex in_object_index)
+{
+	roxCallbackSubscription* subscription;
+
+	sysASSERT(in_object_index < roxTOTAL_OBJECT_COUNT);
+
+	sysMutexTake(l_callback_collection_lock, sysINFINITE_TIMEOUT);
+
+	subscription = l_object_storage_info[in_object_index].FirstSubscription;
+	while (subscription != sysNULL)
 	{
-		l_object_storage_info[in_object_index].FirstCallbackFunctionIndex = roxSTORAGE_INVALID_CALLBACK_INDEX;
+		if (subscription->Callback != sysNULL)
+			(subscription->Callback)(in_object_index);
+
+		subscription = subscription->Next;
+	}
+
+	sysMutexGive(l_callback_collection_lock);
+}
+
+/*****************************************************************************/
+/* Change notification dispatcher                                            */
+/*****************************************************************************/
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Appends object to the changed object queue. The queue holds every object at most once, multiple
+/// changes of the same object are coalesced into one notification.
+/// @param in_object_index Index of the changed object
+static void roxStorageNotifyObjectChanged(roxObjectIndex in_object_index)
+{
+	sysCriticalSectionBegin();
+
+	if (l_object_storage_info[in_object_index].NotificationPending)
+	{
+		l_storage_statistics.CoalescedNotificationCount++;
 	}
 	else
 	{
-		l_callback_collection[prev_callback_index].NextCallbackFunctionIndex = l_callback_collection[callback_index].NextCallbackFunctionIndex;
+		l_object_storage_info[in_object_index].NotificationPending = true;
+
+		l_changed_object_queue[l_changed_object_queue_push_index] = in_object_index;
+		l_changed_object_queue_push_index = (l_changed_object_queue_push_index + 1) % roxTOTAL_OBJECT_COUNT;
+		l_changed_object_queue_length++;
+
+		if (l_changed_object_queue_length > l_storage_statistics.MaxQueueLength)
+			l_storage_statistics.MaxQueueLength = l_changed_object_queue_length;
 	}
 
-	// delete callback
-	l_callback_collection[callback_index].Callback = sysNULL;
-	l_callback_collection[callback_index].NextCallbackFunctionIndex = roxSTORAGE_INVALID_CALLBACK_INDEX;
+	sysCriticalSectionEnd();
 
-	// release lock
-	sysMutexGive(l_callback_collection_lock);
+	// wake up dispatcher
+	sysTaskNotifyGive(l_task_event);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-/// @brief Call all callback function of the given object
-/// @param in_object_index Object index to call
-static void roxStorageCallbackExecute(roxObjectIndex in_object_index)
+/// @brief Gets the next object from the changed object queue
+/// @return Index of the changed object or roxSTORAGE_INVALID_OBJECT_INDEX when the queue is empty
+static roxObjectIndex roxStorageGetChangedObject(void)
 {
-	roxCallbackIndex callback_index;
+	roxObjectIndex object_index = roxSTORAGE_INVALID_OBJECT_INDEX;
 
-	sysASSERT(in_object_index < roxTOTAL_OBJECT_COUNT);
+	sysCriticalSectionBegin();
+
+	if (l_changed_object_queue_length > 0)
+	{
+		object_index = l_changed_object_queue[l_changed_object_queue_pop_index];
+		l_changed_object_queue_pop_index = (l_changed_object_queue_pop_index + 1) % roxTOTAL_OBJECT_COUNT;
+		l_changed_object_queue_length--;
+
+		// clear pending flag before calling the callbacks, changes during the callbacks will be notified again
+		l_object_storage_info[object_index].NotificationPending = false;
+	}
+
+	sysCriticalSectionEnd();
+
+	return object_index;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Stops storage dispatcher task
+void roxStorageTaskStop(void)
+{
+	l_stop_task = true;
+	sysTaskNotifyGive(l_task_event);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Storage dispatcher task function (calls change callbacks of the written objects)
+static sysTaskRetval roxStorageTask(sysTaskParam in_param)
+{
+	roxObjectIndex object_index;
+
+	sysUNUSED(in_param);
 
-	callback_index = l_object_storage_info[in_object_index].FirstCallbackFunctionIndex;
-	while (callback_index != roxSTORAGE_INVALID_CALLBACK_INDEX)
+	// task loop
+	while (!l_stop_task)
 	{
-		if (l_callback_collection[callback_index].Callback != sysNULL)
-			(l_callback_collection[callback_index].Callback)(in_object_index);
+		// wait for event
+		sysTaskNotifyTake(l_task_event, roxSTORAGE_TASK_MAX_CYCLE_TIME);
+
+		// stop task is requested
+		if (l_stop_task)
+			break;
+
+		// process all changed objects
+		object_index = roxStorageGetChangedObject();
+		while (object_index != roxSTORAGE_INVALID_OBJECT_INDEX)
+		{
+			// call callbacks
+			roxStorageCallbackExecute(object_index);
 
-		callback_index = l_callback_collection[callback_index].NextCallbackFunctionIndex;
+			// update telemetry object list
+			roxTelemetrySetObjectChanged(object_index);
+
+			l_storage_statistics.NotificationCount++;
+
+			object_index = roxStorageGetChangedObject();
+		}
 	}
+
+	return (sysTaskRetval)0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Gets change notification statistics
+/// @param out_statistics Statistics structure to fill
+void roxGetStorageStatistics(roxStorageStatistics* out_statistics)
+{
+	sysCriticalSectionBegin();
+	*out_statistics = l_storage_statistics;
+	sysCriticalSectionEnd();
 }
 
 /*****************************************************************************/
@@ -221,71 +406,93 @@ static void roxStorageCallbackExecute(roxObjectIndex in_object_index)
 /*****************************************************************************/
 
 ///////////////////////////////////////////////////////////////////////////////
-/// @brief Start object read operation
+/// @brief Starts object read operation. Reading never blocks the writer, the read must be repeated when 
+/// roxObjectReadEnd reports that the object was changed during the read:
+///   do {
+///     version = roxObjectReadBegin(index);
+///     value = roxGetFloat(index, member);
+///   } while (!roxObjectReadEnd(index, version));
 /// @param in_object_index Index of the object which will be read
-void roxObjectReadBegin(roxObjectIndex in_object_index)
+/// @return Version of the object (must be passed to roxObjectReadEnd)
+roxObjectVersion roxObjectReadBegin(roxObjectIndex in_object_index)
 {
-	roxObjectStorageInfo* object_storage_info;
+	roxObjectVersion version;
 
 	// sanity check
 	sysASSERT(in_object_index < roxTOTAL_OBJECT_COUNT);
 
-	// cache object info pointer
-	object_storage_info = &l_object_storage_info[in_object_index];
+	version = l_object_storage_info[in_object_index].Version;
 
-	// increment read counter
-	sysCriticalSectionBegin();
-	object_storage_info->ReaderCount++;
-	sysCriticalSectionEnd();
+	// object values must be read after the version
+	sysMemoryBarrier();
+
+	return version;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-/// @param End of object read operation. If there is no more read access and object values are pending after a write operation then the values for read will be updated.
+/// @brief Ends object read operation
 /// @param in_object_index Index of the object which reading will be ended
-void roxObjectReadEnd(roxObjectIndex in_object_index)
+/// @param in_version Object version returned by roxObjectReadBegin
+/// @return True if the read values are consistent, false if the object was changed and read must be repeated
+bool roxObjectReadEnd(roxObjectIndex in_object_index, roxObjectVersion in_version)
 {
-	roxObjectStorageInfo* object_storage_info;
-
 	// sanity check
 	sysASSERT(in_object_index < roxTOTAL_OBJECT_COUNT);
 
-	// cache object info pointer
-	object_storage_info = &l_object_storage_info[in_object_index];
+	// object values must be read before the version
+	sysMemoryBarrier();
 
-	// update states in a critical section
-	sysCriticalSectionBegin();
+	return l_object_storage_info[in_object_index].Version == in_version;
+}
 
-	if (object_storage_info->ReaderCount > 0)
-	{
-		// decrement read state counter
-		object_storage_info->ReaderCount--;
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Gets size of the object storage
+/// @param in_object_index Index of the object
+/// @return Size of the object in bytes
+uint16_t roxGetObjectSize(roxObjectIndex in_object_index)
+{
+	sysUNUSED(in_object_index);
 
-		if (object_storage_info->ReaderCount == 0)
-		{
-			// if data pending after write then update read data
-			if (object_storage_info->WriteState == roxOWS_PendingAfterWrite)
-			{
-				// set read data to the most current data
-				l_object_storage_info->ReadStorageIndex = l_object_storage_info->WriteStorageIndex;
-				l_object_storage_info->WriteState = roxOWS_Unlocked;
-
-				// call callbacks
-				roxStorageCallbackExecute(in_object_index);
-
-				// update telemetry object list
-				roxTelemetrySetObjectChanged(in_object_index);
-			}
-		}
-	}
+	return roxOBJECT_SIZE;
+}
 
-	sysCriticalSectionEnd();
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Copies consistent snapshot of all members of the object
+/// @param in_object_index Index of the object to copy
+/// @param out_buffer Buffer receiving the object data (must be at least roxGetObjectSize bytes long)
+void roxObjectCopy(roxObjectIndex in_object_index, uint8_t* out_buffer)
+{
+	roxObjectVersion version;
+
+	do
+	{
+		version = roxObjectReadBegin(in_object_index);
+		sysMemCopy(out_buffer, roxGetMemberReadAddress(in_object_index, 0), roxOBJECT_SIZE);
+	} while (!roxObjectReadEnd(in_object_index, version));
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-/// @brief Lock object for write (reading of the actual values ais still possible)
+/// @brief Lock object for write. Values are written into the storage not used by the readers, the readers
+/// get the new values only when roxObjectWriteEnd is called. The current values are copied into the write
+/// storage, so the members which are not written keep their values (the storage alternates between the writes).
 /// @param in_object_index Index of the object to write
 /// @return true if lock is accquired, false when object is already locked for write
 bool roxObjectWriteBegin(roxObjectIndex in_object_index)
+{
+	if (!roxObjectWriteLock(in_object_index))
+		return false;
+
+	// readers use the other storage, it can't change while the object is locked
+	sysMemCopy(roxGetMemberWriteAddress(in_object_index, 0), roxGetMemberReadAddress(in_object_index, 0), roxOBJECT_SIZE);
+
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Lock object for write without copying the current values (all members will be written)
+/// @param in_object_index Index of the object to write
+/// @return true if lock is accquired, false when object is already locked for write
+static bool roxObjectWriteLock(roxObjectIndex in_object_index)
 {
 	roxObjectStorageInfo* object_storage_info;
 
@@ -297,28 +504,23 @@ bool roxObjectWriteBegin(roxObjectIndex in_object_index)
 
 	// check for object lock
 	sysCriticalSectionBegin();
-	if (l_object_storage_info->WriteState == roxOWS_LockedForWrite)
+	if (object_storage_info->WriteLocked)
 	{
 		// object is locked -> exit with error
 		sysCriticalSectionEnd();
 		return false;
 	}
-	else
-	{
-		// object unlocked -> lock it
-		l_object_storage_info->WriteState = roxOWS_LockedForWrite;
-		sysCriticalSectionEnd();
-	}
 
-	// set write storage index to the unused (not used for read) storage
-	l_object_storage_info->WriteStorageIndex = 1 - l_object_storage_info->ReadStorageIndex;
+	// object unlocked -> lock it
+	object_storage_info->WriteLocked = true;
+	sysCriticalSectionEnd();
 
 	// object lock is accuired and ready for write
 	return true;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-/// @brief Releases object write lock
+/// @brief Releases object write lock and makes the written values available for the readers
 /// @param Objec index to release write lock
 void roxObjectWriteEnd(roxObjectIndex in_object_index)
 {
@@ -330,79 +532,342 @@ void roxObjectWriteEnd(roxObjectIndex in_object_index)
 	// cache object info pointer
 	object_storage_info = &l_object_storage_info[in_object_index];
 
-	// update state and version in a critical sections
-	sysCriticalSectionBegin();
-	if (object_storage_info->ReaderCount == 0)
-	{
-		// there is no active reader -> switch to the newly refreshed buffer
-		object_storage_info->ReadStorageIndex = object_storage_info->WriteStorageIndex;
-		object_storage_info->WriteState = roxOWS_Unlocked;
+	// object values must be written before the version (it switches the storage used by the readers)
+	sysMemoryBarrier();
+	object_storage_info->Version++;
+	sysMemoryBarrier();
 
-		// call callbacks
-		roxStorageCallbackExecute(in_object_index);
+	// record the new object content (storage can't be changed until the lock is released)
+	fdrRECORD(fdrRT_OBJECT, (uint8_t)in_object_index, roxGetMemberReadAddress(in_object_index, 0), roxOBJECT_SIZE);
 
-		// update telemetry object list
-		roxTelemetrySetObjectChanged(in_object_index);
-	}
-	else
-	{
-		// there is active reader -> mark it as pending data
-		object_storage_info->WriteState = roxOWS_PendingAfterWrite;
-	}
+	object_storage_info->WriteLocked = false;
 
-	// increment version number
-	object_storage_info->VersionNumber++;
+	// callbacks are called from the dispatcher task
+	roxStorageNotifyObjectChanged(in_object_index);
+}
 
-	sysCriticalSectionEnd();
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Writes all members of the object in one operation
+/// @param in_object_index Index of the object to write
+/// @param in_buffer Object data (must be roxGetObjectSize bytes long)
+/// @return True if object was written, false if it is locked by an other writer
+bool roxObjectWrite(roxObjectIndex in_object_index, const uint8_t* in_buffer)
+{
+	if (!roxObjectWriteLock(in_object_index))
+		return false;
+
+	sysMemCopy(roxGetMemberWriteAddress(in_object_index, 0), in_buffer, roxOBJECT_SIZE);
+
+	roxObjectWriteEnd(in_object_index);
+
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Gets address of a member in the storage used for reading
+/// @param in_object_index Index of the object
+/// @param in_member_address Address of the member within the object
+/// @return Pointer to the member value
+static uint8_t* roxGetMemberReadAddress(roxObjectIndex in_object_index, roxMemberAddress in_member_address)
+{
+	roxObjectStorageInfo* object_storage_info;
+
+	// sanity check
+	sysASSERT(in_object_index < roxTOTAL_OBJECT_COUNT);
+	sysASSERT(in_member_address < roxOBJECT_SIZE);
+
+	object_storage_info = &l_object_storage_info[in_object_index];
+
+	return &l_realtime_object_value_storage[roxREAD_STORAGE_INDEX(object_storage_info->Version)][object_storage_info->Address + in_member_address];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Gets address of a member in the storage used for writing
+/// @param in_object_index Index of the object
+/// @param in_member_address Address of the member within the object
+/// @return Pointer to the member value or sysNULL if the object is not locked for write
+static uint8_t* roxGetMemberWriteAddress(roxObjectIndex in_object_index, roxMemberAddress in_member_address)
+{
+	roxObjectStorageInfo* object_storage_info;
+
+	// sanity check
+	sysASSERT(in_object_index < roxTOTAL_OBJECT_COUNT);
+	sysASSERT(in_member_address < roxOBJECT_SIZE);
+
+	object_storage_info = &l_object_storage_info[in_object_index];
+
+	// the object must be locked at this pont
+	if (!object_storage_info->WriteLocked)
+		return sysNULL;
+
+	return &l_realtime_object_value_storage[roxWRITE_STORAGE_INDEX(object_storage_info->Version)][object_storage_info->Address + in_member_address];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Copies value into the write storage of the object
+/// @param in_object_index Index of the object to change
+/// @param in_member_address Address of the member variable to change
+/// @param in_value Pointer to the new value
+/// @param in_value_size Size of the value in bytes
+/// @return True if operation was success, false if member can't be modified (e.q. object is not in write state)
+static bool roxSetMember(roxObjectIndex in_object_index, roxMemberAddress in_member_address, const void* in_value, uint8_t in_value_size)
+{
+	uint8_t* member;
+
+	// sanity check
+	sysASSERT(in_member_address + in_value_size <= roxOBJECT_SIZE);
+
+	member = roxGetMemberWriteAddress(in_object_index, in_member_address);
+	if (member == sysNULL)
+		return false;
+
+	sysMemCopy(member, in_value, in_value_size);
+
+	return true;
 }
 
 /*****************************************************************************/
 /* Member access functions                                                   */
 /*****************************************************************************/
 
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Gets member value as uint8_t
+/// @param in_object_index Index of the object to get value
+/// @param in_member_address Member address to get value
+/// @return Member value
+uint8_t roxGetUInt8(roxObjectIndex in_object_index, roxMemberAddress in_member_address)
+{
+	return *roxGetMemberReadAddress(in_object_index, in_member_address);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Gets member value as int8_t
+/// @param in_object_index Index of the object to get value
+/// @param in_member_address Member address to get value
+/// @return Member value
+int8_t roxGetInt8(roxObjectIndex in_object_index, roxMemberAddress in_member_address)
+{
+	return (int8_t)*roxGetMemberReadAddress(in_object_index, in_member_address);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Gets member value as uint16_t
+/// @param in_object_index Index of the object to get value
+/// @param in_member_address Member address to get value
+/// @return Member value
+uint16_t roxGetUInt16(roxObjectIndex in_object_index, roxMemberAddress in_member_address)
+{
+	uint16_t value;
+
+	sysMemCopy(&value, roxGetMemberReadAddress(in_object_index, in_member_address), sizeof(value));
+
+	return value;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Gets member value as int16_t
+/// @param in_object_index Index of the object to get value
+/// @param in_member_address Member address to get value
+/// @return Member value
+int16_t roxGetInt16(roxObjectIndex in_object_index, roxMemberAddress in_member_address)
+{
+	int16_t value;
+
+	sysMemCopy(&value, roxGetMemberReadAddress(in_object_index, in_member_address), sizeof(value));
+
+	return value;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Gets member value as uint32_t
+/// @param in_object_index Index of the object to get value
+/// @param in_member_address Member address to get value
+/// @return Member value
+uint32_t roxGetUInt32(roxObjectIndex in_object_index, roxMemberAddress in_member_address)
+{
+	uint32_t value;
+
+	sysMemCopy(&value, roxGetMemberReadAddress(in_object_index, in_member_address), sizeof(value));
+
+	return value;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Gets member value as int32_t
+/// @param in_object_index Index of the object to get value
+/// @param in_member_address Member address to get value
+/// @return Member value
+int32_t roxGetInt32(roxObjectIndex in_object_index, roxMemberAddress in_member_address)
+{
+	int32_t value;
+
+	sysMemCopy(&value, roxGetMemberReadAddress(in_object_index, in_member_address), sizeof(value));
+
+	return value;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Gets member value as uint64_t
+/// @param in_object_index Index of the object to get value
+/// @param in_member_address Member address to get value
+/// @return Member value
+uint64_t roxGetUInt64(roxObjectIndex in_object_index, roxMemberAddress in_member_address)
+{
+	uint64_t value;
+
+	sysMemCopy(&value, roxGetMemberReadAddress(in_object_index, in_member_address), sizeof(value));
+
+	return value;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Gets member value as int64_t
+/// @param in_object_index Index of the object to get value
+/// @param in_member_address Member address to get value
+/// @return Member value
+int64_t roxGetInt64(roxObjectIndex in_object_index, roxMemberAddress in_member_address)
+{
+	int64_t value;
+
+	sysMemCopy(&value, roxGetMemberReadAddress(in_object_index, in_member_address), sizeof(value));
+
+	return value;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 /// @brief Gets member value as float
-/// @param in_object_address Object address to get value
+/// @param in_object_index Index of the object to get value
 /// @param in_member_address Member address to get value
-/// @return Member value as float number
+/// @return Member value
 float roxGetFloat(roxObjectIndex in_object_index, roxMemberAddress in_member_address)
 {
-	roxObjectStorageInfo* object_storage_info;
+	float value;
 
-	// sanity check
-	sysASSERT(in_object_index < roxTOTAL_OBJECT_COUNT);
+	sysMemCopy(&value, roxGetMemberReadAddress(in_object_index, in_member_address), sizeof(value));
 
-	// cache object info pointer
-	object_storage_info = &l_object_storage_info[in_object_index];
+	return value;
+}
 
-	return *(float*)&l_realtime_object_value_storage[object_storage_info->ReadStorageIndex][object_storage_info->Address + in_member_address];
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Gets member value as double
+/// @param in_object_index Index of the object to get value
+/// @param in_member_address Member address to get value
+/// @return Member value
+double roxGetDouble(roxObjectIndex in_object_index, roxMemberAddress in_member_address)
+{
+	double value;
+
+	sysMemCopy(&value, roxGetMemberReadAddress(in_object_index, in_member_address), sizeof(value));
+
+	return value;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-/// @brief Sets meber value as a float number
+/// @brief Sets member value as uint8_t
 /// @param in_object_index Index of the object to change
 /// @param in_member_address Address of the member variable to change
 /// @param in_value New value of the member
-/// @param true if operation was success, false if member can't be modified (e.q. object is not in write state)
-bool roxSetFloat(roxObjectIndex in_object_address, roxMemberAddress in_member_address, float in_value)
+/// @return True if operation was success, false if member can't be modified (e.q. object is not in write state)
+bool roxSetUInt8(roxObjectIndex in_object_index, roxMemberAddress in_member_address, uint8_t in_value)
 {
-	roxObjectStorageInfo* object_storage_info;
+	return roxSetMember(in_object_index, in_member_address, &in_value, sizeof(in_value));
+}
 
-	// sanity check
-	sysASSERT(in_object_address < roxTOTAL_OBJECT_COUNT);
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Sets member value as int8_t
+/// @param in_object_index Index of the object to change
+/// @param in_member_address Address of the member variable to change
+/// @param in_value New value of the member
+/// @return True if operation was success, false if member can't be modified (e.q. object is not in write state)
+bool roxSetInt8(roxObjectIndex in_object_index, roxMemberAddress in_member_address, int8_t in_value)
+{
+	return roxSetMember(in_object_index, in_member_address, &in_value, sizeof(in_value));
+}
 
-	// cache object info pointer
-	object_storage_info = &l_object_storage_info[in_object_address];
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Sets member value as uint16_t
+/// @param in_object_index Index of the object to change
+/// @param in_member_address Address of the member variable to change
+/// @param in_value New value of the member
+/// @return True if operation was success, false if member can't be modified (e.q. object is not in write state)
+bool roxSetUInt16(roxObjectIndex in_object_index, roxMemberAddress in_member_address, uint16_t in_value)
+{
+	return roxSetMember(in_object_index, in_member_address, &in_value, sizeof(in_value));
+}
 
-	// the object must be locked at this pont
-	if (object_storage_info->WriteState == roxOWS_LockedForWrite)
-		return false;
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Sets member value as int16_t
+/// @param in_object_index Index of the object to change
+/// @param in_member_address Address of the member variable to change
+/// @param in_value New value of the member
+/// @return True if operation was success, false if member can't be modified (e.q. object is not in write state)
+bool roxSetInt16(roxObjectIndex in_object_index, roxMemberAddress in_member_address, int16_t in_value)
+{
+	return roxSetMember(in_object_index, in_member_address, &in_value, sizeof(in_value));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Sets member value as uint32_t
+/// @param in_object_index Index of the object to change
+/// @param in_member_address Address of the member variable to change
+/// @param in_value New value of the member
+/// @return True if operation was success, false if member can't be modified (e.q. object is not in write state)
+bool roxSetUInt32(roxObjectIndex in_object_index, roxMemberAddress in_member_address, uint32_t in_value)
+{
+	return roxSetMember(in_object_index, in_member_address, &in_value, sizeof(in_value));
+}
 
-	// change object value
-	*(float*)&l_realtime_object_value_storage[object_storage_info->WriteStorageIndex][object_storage_info->Address + in_member_address] = in_value;
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Sets member value as int32_t
+/// @param in_object_index Index of the object to change
+/// @param in_member_address Address of the member variable to change
+/// @param in_value New value of the member
+/// @return True if operation was success, false if member can't be modified (e.q. object is not in write state)
+bool roxSetInt32(roxObjectIndex in_object_index, roxMemberAddress in_member_address, int32_t in_value)
+{
+	return roxSetMember(in_object_index, in_member_address, &in_value, sizeof(in_value));
+}
 
-	return true;
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Sets member value as uint64_t
+/// @param in_object_index Index of the object to change
+/// @param in_member_address Address of the member variable to change
+/// @param in_value New value of the member
+/// @return True if operation was success, false if member can't be modified (e.q. object is not in write state)
+bool roxSetUInt64(roxObjectIndex in_object_index, roxMemberAddress in_member_address, uint64_t in_value)
+{
+	return roxSetMember(in_object_index, in_member_address, &in_value, sizeof(in_value));
+}
 
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Sets member value as int64_t
+/// @param in_object_index Index of the object to change
+/// @param in_member_address Address of the member variable to change
+/// @param in_value New value of the member
+/// @return True if operation was success, false if member can't be modified (e.q. object is not in write state)
+bool roxSetInt64(roxObjectIndex in_object_index, roxMemberAddress in_member_address, int64_t in_value)
+{
+	return roxSetMember(in_object_index, in_member_address, &in_value, sizeof(in_value));
 }
 
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Sets member value as float
+/// @param in_object_index Index of the object to change
+/// @param in_member_address Address of the member variable to change
+/// @param in_value New value of the member
+/// @return True if operation was success, false if member can't be modified (e.q. object is not in write state)
+bool roxSetFloat(roxObjectIndex in_object_index, roxMemberAddress in_member_address, float in_value)
+{
+	return roxSetMember(in_object_index, in_member_address, &in_value, sizeof(in_value));
+}
 
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Sets member value as double
+/// @param in_object_index Index of the object to change
+/// @param in_member_address Address of the member variable to change
+/// @param in_value New value of the member
+/// @return True if operation was success, false if member can't be modified (e.q. object is not in write state)
+bool roxSetDouble(roxObjectIndex in_object_index, roxMemberAddress in_member_address, double in_value)
+{
+	return roxSetMember(in_object_index, in_member_address, &in_value, sizeof(in_value));
+}
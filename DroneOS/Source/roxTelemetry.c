@@ -0,0 +1,465 @@
+/*****************************************************************************/
+/* Real time object storage telemetry functions                              */
+/*                                                                           */
+/* Copyright (C) 2017 Laszlo Arvai                                           */
+/* All rights reserved.                                                      */
+/*                                                                           */
+/* This software may be modified and distributed under the terms             */
+/* of the GNU General Public License.  See the LICENSE file for details.     */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/* Includes                                                                  */
+/*****************************************************************************/
+#include <sysRTOS.h>
+//#include <sysTimer.h>
+#include <comSystemPacketDefinitions.h>
+#include <comManager.h>
+#include <roxTelemetry.h>
+
+/*****************************************************************************/
+/* Constants                                                                 */
+/*****************************************************************************/
+#define roxTELEMETRY_INVALID_HEAP_POSITION 0xffff
+#define roxTELEMETRY_TASK_PRIORITY 2
+#define comTELEMETRY_TASK_MAX_CYCLE_TIME 100
+
+// delay before retrying transmission when the transmitter queue is full [ms]
+#define roxTELEMETRY_RETRY_DELAY 5
+
+// telemetry packet size must fit into the one byte packet size field
+sysSTATIC_ASSERT(sizeof(comPacketTelemetryObjectHeader) + roxOBJECT_SIZE <= comMAX_PACKET_SIZE);
+
+/*****************************************************************************/
+/* Types                                                                     */
+/*****************************************************************************/
+
+// object information for terlemetry transmission
+typedef struct
+{
+	uint16_t MinimumPeriod;
+	uint8_t Priority;
+	bool Transmitted;
+	sysTick LastTransmissionTimestamp;
+	sysTick DueTimestamp;
+	uint16_t HeapPosition;
+} roxObjectTransmissionInfo;
+
+/*****************************************************************************/
+/* Local function prototypes                                                 */
+/*****************************************************************************/
+static sysTaskRetval roxTelemetryTask(sysTaskParam in_param);
+static bool roxTelemetrySendObject(roxObjectIndex in_object_index);
+static void roxTelemetryHeapInsert(roxObjectIndex in_object_index, sysTick in_due_timestamp);
+static roxObjectIndex roxTelemetryHeapRemoveFirst(void);
+static void roxTelemetryHeapSiftUp(uint16_t in_position);
+static void roxTelemetryHeapSiftDown(uint16_t in_position);
+static bool roxTelemetryIsEarlier(roxObjectIndex in_object_index1, roxObjectIndex in_object_index2);
+static void roxTelemetryUpdateBandwidth(void);
+static uint16_t roxTelemetryGetPacketSize(roxObjectIndex in_object_index);
+
+/*****************************************************************************/
+/* Module global variables                                                   */
+/*****************************************************************************/
+
+// object scheduling variables
+static roxObjectTransmissionInfo g_telemetry_object_info[roxTOTAL_OBJECT_COUNT];
+static roxObjectIndex l_schedule_heap[roxTOTAL_OBJECT_COUNT];
+static uint16_t l_schedule_heap_length;
+static sysMutex g_list_lock;
+
+// bandwidth limiter variables (available bandwidth is stored in 1/1000 byte units)
+static uint32_t l_available_bandwidth;
+static sysTick l_bandwidth_update_timestamp;
+
+static roxTelemetryStatistics l_telemetry_statistics;
+
+// task variables
+static bool l_stop_task = false;
+static sysTaskNotify l_task_event;
+
+/*****************************************************************************/
+/* Function implementation                                                   */
+/*****************************************************************************/
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Initialize telemetry functionality
+void roxTelemetryInitialize(void)
+{
+	int i;
+	sysTask task_handle;
+
+	// intialize all object
+	for (i = 0; i < roxTOTAL_OBJECT_COUNT; i++)
+	{
+		g_telemetry_object_info[i].MinimumPeriod = 0;
+		g_telemetry_object_info[i].Priority = 0;
+		g_telemetry_object_info[i].Transmitted = false;
+		g_telemetry_object_info[i].HeapPosition = roxTELEMETRY_INVALID_HEAP_POSITION;
+	}
+
+	// initialize scheduler
+	l_schedule_heap_length = 0;
+	l_available_bandwidth = roxTELEMETRY_LINK_BURST_SIZE * 1000ul;
+	l_bandwidth_update_timestamp = sysGetSystemTick();
+	sysMemZero(&l_telemetry_statistics, sizeof(l_telemetry_statistics));
+
+	// mutex for list locking
+	sysMutexCreate(g_list_lock);
+	sysTaskNotifyCreate(l_task_event);
+
+	// initialize telemetry tasks
+	sysTaskCreate(roxTelemetryTask, "roxTelemetry", sysDEFAULT_STACK_SIZE, sysNULL, roxTELEMETRY_TASK_PRIORITY, &task_handle, roxTelemetryTaskStop);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Sets transmission parameters of the object
+/// @param in_object_index Index of the object
+/// @param in_minimum_period Minimum time between two transmission of the object [ms] (0 - no limit)
+/// @param in_priority Transmission priority (higher value is sent first when objects are due at the same time)
+void roxTelemetrySetObjectParameters(roxObjectIndex in_object_index, uint16_t in_minimum_period, uint8_t in_priority)
+{
+	sysASSERT(in_object_index < roxTOTAL_OBJECT_COUNT);
+
+	sysMutexTake(g_list_lock, sysINFINITE_TIMEOUT);
+
+	g_telemetry_object_info[in_object_index].MinimumPeriod = in_minimum_period;
+	g_telemetry_object_info[in_object_index].Priority = in_priority;
+
+	sysMutexGive(g_list_lock);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Schedules transmission of the changed object. If the object is already scheduled the changes are
+/// coalesced, the latest value is sent when the object is due.
+/// @param in_object_index Index of the changed object
+void roxTelemetrySetObjectChanged(roxObjectIndex in_object_index)
+{
+	roxObjectTransmissionInfo* object_info;
+	sysTick due_timestamp;
+	bool wake_up_task = false;
+
+	sysASSERT(in_object_index < roxTOTAL_OBJECT_COUNT);
+
+	object_info = &g_telemetry_object_info[in_object_index];
+
+	// update schedule in a critical section
+	sysMutexTake(g_list_lock, sysINFINITE_TIMEOUT);
+
+	if (object_info->HeapPosition == roxTELEMETRY_INVALID_HEAP_POSITION)
+	{
+		// send immediately unless the minimum period since the last transmission is not expired
+		due_timestamp = sysGetSystemTick();
+		if (object_info->Transmitted && sysGetSystemTickSince(object_info->LastTransmissionTimestamp) < object_info->MinimumPeriod)
+			due_timestamp = object_info->LastTransmissionTimestamp + object_info->MinimumPeriod;
+
+		roxTelemetryHeapInsert(in_object_index, due_timestamp);
+
+		// wake up task only when the next transmission time is changed
+		wake_up_task = (object_info->HeapPosition == 0);
+	}
+	else
+	{
+		// object is already scheduled
+		l_telemetry_statistics.CoalescedChangeCount++;
+	}
+
+	// release lock
+	sysMutexGive(g_list_lock);
+
+	if (wake_up_task)
+		sysTaskNotifyGive(l_task_event);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Gets telemetry statistics
+/// @param out_statistics Statistics structure to fill
+void roxTelemetryGetStatistics(roxTelemetryStatistics* out_statistics)
+{
+	sysMutexTake(g_list_lock, sysINFINITE_TIMEOUT);
+	*out_statistics = l_telemetry_statistics;
+	sysMutexGive(g_list_lock);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Stops telemetry task
+void roxTelemetryTaskStop(void)
+{
+	l_stop_task = true;
+	sysTaskNotifyGive(l_task_event);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief telemetry task function
+static sysTaskRetval roxTelemetryTask(sysTaskParam in_param)
+{
+	uint32_t delay_time;
+	uint32_t required_bandwidth;
+	int32_t remaining_time;
+	roxObjectIndex object_index_to_send;
+	roxObjectTransmissionInfo* object_info;
+
+	sysUNUSED(in_param);
+
+	delay_time = comTELEMETRY_TASK_MAX_CYCLE_TIME;
+
+	// task loop
+	while (!l_stop_task)
+	{
+		// wait for event
+		sysTaskNotifyTake(l_task_event, delay_time);
+		delay_time = comTELEMETRY_TASK_MAX_CYCLE_TIME;
+
+		// stop task is requested
+		if (l_stop_task)
+			break;
+
+		roxTelemetryUpdateBandwidth();
+
+		// send all due objects
+		while (true)
+		{
+			sysMutexTake(g_list_lock, sysINFINITE_TIMEOUT);
+
+			// check schedule
+			if (l_schedule_heap_length == 0)
+			{
+				sysMutexGive(g_list_lock);
+				break;
+			}
+
+			object_index_to_send = l_schedule_heap[0];
+			object_info = &g_telemetry_object_info[object_index_to_send];
+
+			// if the first object is not due -> wait for it
+			remaining_time = (int32_t)(object_info->DueTimestamp - sysGetSystemTick());
+			if (remaining_time > 0)
+			{
+				sysMutexGive(g_list_lock);
+
+				if ((uint32_t)remaining_time < delay_time)
+					delay_time = (uint32_t)remaining_time;
+				break;
+			}
+
+			// if there is no bandwidth available -> wait until it is replenished
+			required_bandwidth = roxTelemetryGetPacketSize(object_index_to_send) * 1000ul;
+			if (l_available_bandwidth < required_bandwidth)
+			{
+				l_telemetry_statistics.BandwidthLimitedCount++;
+				sysMutexGive(g_list_lock);
+
+				delay_time = (required_bandwidth - l_available_bandwidth) / roxTELEMETRY_LINK_BANDWIDTH + 1;
+				break;
+			}
+
+			// remove from the schedule and update transmission time (changes during the transmission will be scheduled after the minimum period)
+			roxTelemetryHeapRemoveFirst();
+			object_info->LastTransmissionTimestamp = sysGetSystemTick();
+			object_info->Transmitted = true;
+
+			sysMutexGive(g_list_lock);
+
+			// send object
+			if (roxTelemetrySendObject(object_index_to_send))
+			{
+				l_available_bandwidth -= required_bandwidth;
+			}
+			else
+			{
+				// transmitter queue is full -> retry later
+				sysMutexTake(g_list_lock, sysINFINITE_TIMEOUT);
+
+				l_telemetry_statistics.QueueFullCount++;
+				if (object_info->HeapPosition == roxTELEMETRY_INVALID_HEAP_POSITION)
+					roxTelemetryHeapInsert(object_index_to_send, sysGetSystemTick() + roxTELEMETRY_RETRY_DELAY);
+
+				sysMutexGive(g_list_lock);
+
+				delay_time = roxTELEMETRY_RETRY_DELAY;
+				break;
+			}
+		}
+	}
+
+	return (sysTaskRetval)0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Replenishes available bandwidth according to the elapsed time
+static void roxTelemetryUpdateBandwidth(void)
+{
+	uint32_t elapsed_time;
+
+	elapsed_time = sysGetSystemTickSince(l_bandwidth_update_timestamp);
+	l_bandwidth_update_timestamp += elapsed_time;
+
+	if (elapsed_time >= roxTELEMETRY_LINK_BURST_SIZE * 1000ul / roxTELEMETRY_LINK_BANDWIDTH)
+	{
+		l_available_bandwidth = roxTELEMETRY_LINK_BURST_SIZE * 1000ul;
+	}
+	else
+	{
+		l_available_bandwidth += elapsed_time * roxTELEMETRY_LINK_BANDWIDTH;
+		if (l_available_bandwidth > roxTELEMETRY_LINK_BURST_SIZE * 1000ul)
+			l_available_bandwidth = roxTELEMETRY_LINK_BURST_SIZE * 1000ul;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Gets transmitted size of the telemetry packet of the object
+/// @param in_object_index Index of the object
+/// @return Packet size including CRC
+static uint16_t roxTelemetryGetPacketSize(roxObjectIndex in_object_index)
+{
+	return sizeof(comPacketTelemetryObjectHeader) + roxGetObjectSize(in_object_index) + comCRC_BYTE_COUNT;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @param Sends object over the telemetery channel
+/// @param in_object_index Object to send
+/// @return True if packet is sent, false when transmitter queue is full
+static bool roxTelemetrySendObject(roxObjectIndex in_object_index)
+{
+	comPacketTelemetryObjectHeader* packet;
+	uint16_t packet_index;
+	uint16_t object_size;
+
+	object_size = roxGetObjectSize(in_object_index);
+
+	packet = (comPacketTelemetryObjectHeader*)comManagerTransmitPacketPushStart((uint8_t)(sizeof(comPacketTelemetryObjectHeader) + object_size), comINVALID_INTERFACE_INDEX, comPT_TELEMETRY_OBJECT, &packet_index);
+
+	if (packet == sysNULL)
+		return false;
+
+	// fill out packet
+	packet->ObjectIndex = in_object_index;
+	roxObjectCopy(in_object_index, (uint8_t*)packet + sizeof(comPacketTelemetryObjectHeader));
+
+	comManagerTransmitPacketPushEnd(packet_index);
+
+	// update statistics
+	l_telemetry_statistics.TransmittedObjectCount++;
+	l_telemetry_statistics.TransmittedByteCount += roxTelemetryGetPacketSize(in_object_index);
+
+	return true;
+}
+
+/*****************************************************************************/
+/* Schedule heap functions                                                   */
+/*****************************************************************************/
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Inserts object into the schedule
+/// @param in_object_index Index of the object
+/// @param in_due_timestamp Earliest transmission time of the object
+static void roxTelemetryHeapInsert(roxObjectIndex in_object_index, sysTick in_due_timestamp)
+{
+	sysASSERT(l_schedule_heap_length < roxTOTAL_OBJECT_COUNT);
+
+	g_telemetry_object_info[in_object_index].DueTimestamp = in_due_timestamp;
+	g_telemetry_object_info[in_object_index].HeapPosition = l_schedule_heap_length;
+	l_schedule_heap[l_schedule_heap_length] = in_object_index;
+	l_schedule_heap_length++;
+
+	roxTelemetryHeapSiftUp(l_schedule_heap_length - 1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Removes the first (earliest) object from the schedule
+/// @return Index of the removed object
+static roxObjectIndex roxTelemetryHeapRemoveFirst(void)
+{
+	roxObjectIndex object_index;
+
+	sysASSERT(l_schedule_heap_length > 0);
+
+	object_index = l_schedule_heap[0];
+	g_telemetry_object_info[object_index].HeapPosition = roxTELEMETRY_INVALID_HEAP_POSITION;
+
+	l_schedule_heap_length--;
+	if (l_schedule_heap_length > 0)
+	{
+		l_schedule_heap[0] = l_schedule_heap[l_schedule_heap_length];
+		g_telemetry_object_info[l_schedule_heap[0]].HeapPosition = 0;
+
+		roxTelemetryHeapSiftDown(0);
+	}
+
+	return object_index;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Moves heap entry towards the root until the heap order is restored
+/// @param in_position Position of the entry
+static void roxTelemetryHeapSiftUp(uint16_t in_position)
+{
+	uint16_t parent;
+	roxObjectIndex object_index;
+
+	object_index = l_schedule_heap[in_position];
+
+	while (in_position > 0)
+	{
+		parent = (in_position - 1) / 2;
+
+		if (!roxTelemetryIsEarlier(object_index, l_schedule_heap[parent]))
+			break;
+
+		l_schedule_heap[in_position] = l_schedule_heap[parent];
+		g_telemetry_object_info[l_schedule_heap[in_position]].HeapPosition = in_position;
+		in_position = parent;
+	}
+
+	l_schedule_heap[in_position] = object_index;
+	g_telemetry_object_info[object_index].HeapPosition = in_position;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Moves heap entry towards the leaves until the heap order is restored
+/// @param in_position Position of the entry
+static void roxTelemetryHeapSiftDown(uint16_t in_position)
+{
+	uint16_t child;
+	roxObjectIndex object_index;
+
+	object_index = l_schedule_heap[in_position];
+
+	while (true)
+	{
+		child = 2 * in_position + 1;
+		if (child >= l_schedule_heap_length)
+			break;
+
+		// select the earlier child
+		if (child + 1 < l_schedule_heap_length && roxTelemetryIsEarlier(l_schedule_heap[child + 1], l_schedule_heap[child]))
+			child++;
+
+		if (!roxTelemetryIsEarlier(l_schedule_heap[child], object_index))
+			break;
+
+		l_schedule_heap[in_position] = l_schedule_heap[child];
+		g_telemetry_object_info[l_schedule_heap[in_position]].HeapPosition = in_position;
+		in_position = child;
+	}
+
+	l_schedule_heap[in_position] = object_index;
+	g_telemetry_object_info[object_index].HeapPosition = in_position;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Compares transmission order of two objects (earlier due time first, higher priority first on equal due time)
+/// @param in_object_index1 First object
+/// @param in_object_index2 Second object
+/// @return True if the first object must be sent before the second
+static bool roxTelemetryIsEarlier(roxObjectIndex in_object_index1, roxObjectIndex in_object_index2)
+{
+	int32_t difference;
+
+	difference = (int32_t)(g_telemetry_object_info[in_object_index1].DueTimestamp - g_telemetry_object_info[in_object_index2].DueTimestamp);
+
+	if (difference != 0)
+		return difference < 0;
+
+	return g_telemetry_object_info[in_object_index1].Priority > g_telemetry_object_info[in_object_index2].Priority;
+}
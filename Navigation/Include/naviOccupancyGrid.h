@@ -38,7 +38,7 @@ extern naviOGElementType g_navi_occupancy_grid[naviOG_GRID_SIZE][naviOG_GRID_SIZ
 /*****************************************************************************/
 /* Function prototypes                                                       */
 /*****************************************************************************/
-bool naviOGFileHandler(fileCallbackRequest in_request, void* in_buffer, uint16_t in_buffer_length, uint16_t in_start_pos);
+bool naviOGFileHandler(fileCallbackRequest in_request, void* in_buffer, uint16_t in_buffer_length, uint32_t in_start_pos);
 
 
 #endif
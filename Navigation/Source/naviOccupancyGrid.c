@@ -11,6 +11,7 @@
 /*****************************************************************************/
 /* Includes                                                                  */
 /*****************************************************************************/
+#include <sysRTOS.h>
 #include <naviOccupancyGrid.h>
 #include <sysTimer.h>
 #include <crcMD5.h>
@@ -108,13 +109,13 @@ void naviOGUpdateClose(void)
 /// @param in_buffer_length Length of the buffer in bytes used for data transfer
 /// @param in_start_position The position within the file where operation must be started
 /// @return True if file operation was success
-bool naviOGFileHandler(fileCallbackRequest in_request, void* in_buffer, uint16_t in_buffer_length, uint16_t in_start_pos)
+bool naviOGFileHandler(fileCallbackRequest in_request, void* in_buffer, uint16_t in_buffer_length, uint32_t in_start_pos)
 {
 	switch (in_request)
 	{
 		// Get length of the file
 		case fileCF_GetLength:
-			*((uint32_t*)in_buffer) = naviOG_GRID_SIZE * naviOG_GRID_SIZE;
+			*((uint32_t*)in_buffer) = sizeof(g_navi_occupancy_grid);
 			return true;
 
 			// Get MD5 checksum
@@ -130,12 +131,19 @@ bool naviOGFileHandler(fileCallbackRequest in_request, void* in_buffer, uint16_t
 
 		// gets content
 		case fileCF_GetContent:
+			*((uint8_t**)in_buffer) = (uint8_t*)g_navi_occupancy_grid;
 			return true;
 
-			// reads data block
+		// reads data block
 		case fileCF_ReadBlock:
+			if (in_start_pos + in_buffer_length > sizeof(g_navi_occupancy_grid))
+				return false;
+
+			sysMemCopy(in_buffer, ((uint8_t*)g_navi_occupancy_grid) + in_start_pos, in_buffer_length);
+			return true;
+
+		default:
 			return false;
 	}
-
 }
 
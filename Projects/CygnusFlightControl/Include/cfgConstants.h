@@ -29,6 +29,7 @@
 
 // Configuration constants
 #define cfg_XML_DATA_FILE_LENGTH 628
+#define cfg_XML_DATA_FILE_HASH 0x30, 0xE7, 0x73, 0x80, 0xF3, 0xFD, 0x53, 0xA7, 0x03, 0xB3, 0xF9, 0xB2, 0x87, 0x4F, 0xCC, 0xF9
 #define cfg_VALUE_INFO_DATA_FILE_LENGTH 56
 #define cfg_VALUE_DATA_FILE_LENGTH 131
 #define cfg_VALUE_COUNT 14
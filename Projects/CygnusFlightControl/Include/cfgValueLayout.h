@@ -0,0 +1,73 @@
+/*****************************************************************************/
+/* Configuration value layout (offsets and types of the typed accessors)     */
+/*                                                                           */
+/* Copyright (C) 2017 Laszlo Arvai                                           */
+/* All rights reserved.                                                      */
+/*                                                                           */
+/* This software may be modified and distributed under the terms             */
+/* of the GNU General Public License.  See the LICENSE file for details.     */
+/*****************************************************************************/
+
+#ifndef __cfgValueLayout_h
+#define __cfgValueLayout_h
+
+/*****************************************************************************/
+/* Constants                                                                 */
+/*****************************************************************************/
+
+// This file is not generated by the SettingsParser, it must be updated when the configuration XML is changed.
+// The layout is checked against cfgConstants.h at compile time and against cfgValueInfo.inl by cfgLoadDefaultConfiguration.
+
+// length of the value data described by this layout
+#define cfgVALUE_LAYOUT_DATA_FILE_LENGTH 131
+
+// Value offsets
+#define cfgOFS_SYS_UID 0
+#define cfgOFS_SYS_NAME 4
+#define cfgOFS_WIFI_SSID 37
+#define cfgOFS_WIFI_PWD 70
+#define cfgOFS_WIFI_LOCAL 103
+#define cfgOFS_WIFI_REMOTE 107
+#define cfgOFS_UART_U1F 111
+#define cfgOFS_UART_U1B 112
+#define cfgOFS_UART_U2F 116
+#define cfgOFS_UART_U2B 117
+#define cfgOFS_UART_U3F 121
+#define cfgOFS_UART_U3B 122
+#define cfgOFS_UART_U4F 126
+#define cfgOFS_UART_U4B 127
+
+// Value types
+#define cfgTYP_SYS_UID Int32
+#define cfgTYP_SYS_NAME String
+#define cfgTYP_WIFI_SSID String
+#define cfgTYP_WIFI_PWD String
+#define cfgTYP_WIFI_LOCAL Int32
+#define cfgTYP_WIFI_REMOTE Int32
+#define cfgTYP_UART_U1F UInt8
+#define cfgTYP_UART_U1B Int32
+#define cfgTYP_UART_U2F UInt8
+#define cfgTYP_UART_U2B Int32
+#define cfgTYP_UART_U3F UInt8
+#define cfgTYP_UART_U3B Int32
+#define cfgTYP_UART_U4F UInt8
+#define cfgTYP_UART_U4B Int32
+
+// all values in value index order
+#define cfgVALUE_LAYOUT(entry) \
+	entry(SYS_UID) \
+	entry(SYS_NAME) \
+	entry(WIFI_SSID) \
+	entry(WIFI_PWD) \
+	entry(WIFI_LOCAL) \
+	entry(WIFI_REMOTE) \
+	entry(UART_U1F) \
+	entry(UART_U1B) \
+	entry(UART_U2F) \
+	entry(UART_U2B) \
+	entry(UART_U3F) \
+	entry(UART_U3B) \
+	entry(UART_U4F) \
+	entry(UART_U4B)
+
+#endif
@@ -19,6 +19,7 @@
 #include <sysHighresTimer.h>
 #include <drvServo.h>
 #include <cfgStorage.h>
+#include <fileSystemFiles.h>
 #include <halUART.h>
 #include <comUART.h>
 #include <halRTC.h>
@@ -76,6 +77,9 @@ void sysInitialize(void)
   //imuInitialize();
 
 
+	// init system files
+	fileSystemFileInit();
+
 	// load configuration
 	cfgStorageInit();
 	cfgLoadDefaultConfiguration();
@@ -0,0 +1,47 @@
+/*****************************************************************************/
+/* Linux console checks and benchmarks                                       */
+/*                                                                           */
+/* Copyright (C) 2016 Laszlo Arvai                                           */
+/* All rights reserved.                                                      */
+/*                                                                           */
+/* This software may be modified and distributed under the terms             */
+/* of the GNU General Public License.  See the LICENSE file for details.     */
+/*****************************************************************************/
+
+#ifndef __cfcCheck_h
+#define __cfcCheck_h
+
+/*****************************************************************************/
+/* Includes                                                                  */
+/*****************************************************************************/
+#include <sysTypes.h>
+
+/*****************************************************************************/
+/* Types                                                                     */
+/*****************************************************************************/
+typedef bool (*cfcCheckFunction)(void);
+
+/*****************************************************************************/
+/* Function prototypes                                                       */
+/*****************************************************************************/
+
+// helpers
+bool cfcCheckReport(const char* in_name, bool in_passed, const char* in_format, ...);
+uint32_t cfcCheckRandom(void);
+
+// checks
+bool sysBarometerCheck(void);
+bool sysClockCheck(void);
+bool sysComManagerCheck(void);
+bool sysCRCCheck(void);
+bool sysFileTableCheck(void);
+bool sysFileTransferCheck(void);
+bool sysMathCheck(void);
+bool sysPacketQueueCheck(void);
+bool sysRoxCheck(void);
+bool sysSLIPCheck(void);
+bool sysTelemetryCheck(void);
+bool sysUARTCheck(void);
+bool sysUDPCheck(void);
+
+#endif
@@ -42,6 +42,7 @@
 
 // Configuration constants
 #define cfg_XML_DATA_FILE_LENGTH 829
+#define cfg_XML_DATA_FILE_HASH 0xB1, 0xE7, 0xF1, 0x28, 0x40, 0xDC, 0xF5, 0x08, 0xCE, 0xF9, 0x33, 0x19, 0xD1, 0xD2, 0x39, 0x64
 #define cfg_VALUE_INFO_DATA_FILE_LENGTH 88
 #define cfg_VALUE_DATA_FILE_LENGTH 157
 #define cfg_VALUE_COUNT 22
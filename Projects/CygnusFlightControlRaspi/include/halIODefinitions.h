@@ -25,6 +25,29 @@
 #define halUART_MAX_COUNT 2
 #define halUART_INIT_NAMES { "/dev/ttyAMA0", "/dev/ttyusb0" }
 
+/*****************************************************************************/
+/* Task definitions                                                          */
+/*****************************************************************************/
+
+// CPU affinity of the tasks ({ task name, CPU mask }), tasks not listed here can run on any CPU
+//#define halTASK_CPU_AFFINITY_INIT { { "comManager", 0x02 }, { "halUDP", 0x02 } }
+
+/*****************************************************************************/
+/* UDP definitions                                                           */
+/*****************************************************************************/
+
+// number of UDP packets can be queued for transmission
+#ifndef drvUDP_TRANSMITTER_SLOT_COUNT
+#define drvUDP_TRANSMITTER_SLOT_COUNT 8
+#endif
+
+/*****************************************************************************/
+/* Flight data recorder definitions                                          */
+/*****************************************************************************/
+
+// compiles the recording points of the realtime objects and communication packets (recording is started by the -record argument)
+#define fdrRECORDER_ENABLED
+
 
 
 #endif
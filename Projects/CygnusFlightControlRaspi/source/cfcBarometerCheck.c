@@ -0,0 +1,114 @@
+/*****************************************************************************/
+/* Barometer acquisition check (Linux console)                               */
+/*                                                                           */
+/* Copyright (C) 2017 Laszlo Arvai                                           */
+/* All rights reserved.                                                      */
+/*                                                                           */
+/* This software may be modified and distributed under the terms             */
+/* of the GNU General Public License.  See the LICENSE file for details.     */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/* Includes                                                                  */
+/*****************************************************************************/
+#include <stdio.h>
+#include <sysRTOS.h>
+#include <sysHighresTimer.h>
+#include <roxStorage.h>
+#include <imuTask.h>
+#include <halIMUEmulator.h>
+#include <cfcCheck.h>
+
+/*****************************************************************************/
+/* Constants                                                                 */
+/*****************************************************************************/
+#define cfcBAROMETER_CHECK_PRESSURE_PER_TEMPERATURE 8
+#define cfcBAROMETER_CHECK_STARTUP_TIME 500				// sensor detection and first conversions [ms]
+#define cfcBAROMETER_CHECK_DURATION 2000					// rate measurement time [ms]
+#define cfcBAROMETER_CHECK_MIN_RATE 0.65f				// minimum ratio of the measured and the limit rate (tick scheduled MS5611 reads reach 0.45)
+
+// the lowest oversampling is the most sensitive to the read scheduling, the expected values are the datasheet examples
+#if !halIMUEmulator_BMP085
+#define cfcBAROMETER_CHECK_NAME "MS5611"
+#define cfcBAROMETER_CHECK_OVERSAMPLING 256
+#define cfcBAROMETER_CHECK_PRESSURE_TIME 600					// pressure conversion time (driver) [us]
+#define cfcBAROMETER_CHECK_TEMPERATURE_TIME 600				// temperature conversion time (driver) [us]
+#define cfcBAROMETER_CHECK_TRANSFER_TIME 195					// ADC read (6 bytes) and conversion command (2 bytes) at 400kHz [us]
+#define cfcBAROMETER_CHECK_PRESSURE 100009.0f					// D1 = 9085466, D2 = 8569150 [Pa]
+#define cfcBAROMETER_CHECK_TEMPERATURE 20.07f					// [degC]
+#define cfcBAROMETER_CHECK_PRESSURE_CONVERSIONS(statistics) (statistics).MS5611PressureConversionCount
+#define cfcBAROMETER_CHECK_INVALID_READS(statistics) (statistics).MS5611InvalidReadCount
+#define cfcBAROMETER_CHECK_COMMAND_ERRORS(statistics) (statistics).MS5611CommandErrorCount
+#else
+#define cfcBAROMETER_CHECK_NAME "BMP085"
+#define cfcBAROMETER_CHECK_OVERSAMPLING 1
+#define cfcBAROMETER_CHECK_PRESSURE_TIME 4500					// pressure conversion time at oss 0 (driver) [us]
+#define cfcBAROMETER_CHECK_TEMPERATURE_TIME 4500			// temperature conversion time (driver) [us]
+#define cfcBAROMETER_CHECK_TRANSFER_TIME 263					// result read (8 bytes) and conversion command (3 bytes) at 400kHz [us]
+#define cfcBAROMETER_CHECK_PRESSURE 69964.0f					// UT = 27898, UP = 23843 at oss 0 [Pa]
+#define cfcBAROMETER_CHECK_TEMPERATURE 15.0f					// [degC]
+#define cfcBAROMETER_CHECK_PRESSURE_CONVERSIONS(statistics) (statistics).BMP085PressureConversionCount
+#define cfcBAROMETER_CHECK_INVALID_READS(statistics) (statistics).BMP085InvalidReadCount
+#define cfcBAROMETER_CHECK_COMMAND_ERRORS(statistics) (statistics).BMP085CommandErrorCount
+#endif
+
+/*****************************************************************************/
+/* Function implementation                                                   */
+/*****************************************************************************/
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Runs the IMU task with the emulated barometer (MS5611 or BMP085) at the lowest oversampling. The pressure
+/// conversion rate must be close to the rate limited by the conversion and transfer time, reads must never hit a running
+/// conversion and the published values must match the datasheet example.
+/// @return True if all results are within the limits
+bool sysBarometerCheck(void)
+{
+	halIMUEmulatorStatistics start_statistics;
+	halIMUEmulatorStatistics end_statistics;
+	sysHighresTimestamp start_time;
+	uint32_t elapsed_time;
+	float rate;
+	float expected_rate;
+	float pressure;
+	float temperature;
+	bool passed = true;
+
+	printf("Barometer acquisition check (%s, oversampling %u)\n", cfcBAROMETER_CHECK_NAME, cfcBAROMETER_CHECK_OVERSAMPLING);
+
+	sysHighresTimerInit();
+	roxStorageInitialize();
+
+	imuSetBarometerOversampling(cfcBAROMETER_CHECK_OVERSAMPLING);
+	imuInitialize();
+
+	sysDelay(cfcBAROMETER_CHECK_STARTUP_TIME);
+
+	// measure pressure conversion rate
+	halIMUEmulatorGetStatistics(&start_statistics);
+	start_time = sysHighresTimerGetTimestamp();
+
+	sysDelay(cfcBAROMETER_CHECK_DURATION);
+
+	halIMUEmulatorGetStatistics(&end_statistics);
+	elapsed_time = sysHighresTimerGetTimeSince(start_time);
+
+	rate = (cfcBAROMETER_CHECK_PRESSURE_CONVERSIONS(end_statistics) - cfcBAROMETER_CHECK_PRESSURE_CONVERSIONS(start_statistics)) * 1000000.0f / elapsed_time;
+	expected_rate = 1000000.0f * cfcBAROMETER_CHECK_PRESSURE_PER_TEMPERATURE / (cfcBAROMETER_CHECK_PRESSURE_PER_TEMPERATURE * (cfcBAROMETER_CHECK_PRESSURE_TIME + cfcBAROMETER_CHECK_TRANSFER_TIME)
+		+ cfcBAROMETER_CHECK_TEMPERATURE_TIME + cfcBAROMETER_CHECK_TRANSFER_TIME);
+
+	passed &= cfcCheckReport("pressure conversion rate", rate >= cfcBAROMETER_CHECK_MIN_RATE * expected_rate, "%.0f/s (limit %.0f/s, bus load %.1f%%)", rate, expected_rate,
+		(end_statistics.ElapsedTime > 0) ? 100.0f * end_statistics.BusyTime / end_statistics.ElapsedTime : 0.0f);
+
+	passed &= cfcCheckReport("no read during conversion", cfcBAROMETER_CHECK_INVALID_READS(end_statistics) == 0 && cfcBAROMETER_CHECK_COMMAND_ERRORS(end_statistics) == 0, "%u invalid reads, %u command errors",
+		cfcBAROMETER_CHECK_INVALID_READS(end_statistics), cfcBAROMETER_CHECK_COMMAND_ERRORS(end_statistics));
+
+	// published values
+	pressure = roxGetFloat(imuBAROMETER_OBJECT_INDEX, imuBOM_PRESSURE);
+	temperature = roxGetFloat(imuBAROMETER_OBJECT_INDEX, imuBOM_TEMPERATURE);
+
+	passed &= cfcCheckReport("compensated pressure", pressure == cfcBAROMETER_CHECK_PRESSURE, "%.0fPa (expected %.0fPa)", pressure, cfcBAROMETER_CHECK_PRESSURE);
+	passed &= cfcCheckReport("compensated temperature", temperature > cfcBAROMETER_CHECK_TEMPERATURE - 0.005f && temperature < cfcBAROMETER_CHECK_TEMPERATURE + 0.005f, "%.2fdegC (expected %.2fdegC)",
+		temperature, cfcBAROMETER_CHECK_TEMPERATURE);
+
+	return passed;
+}
@@ -0,0 +1,152 @@
+/*****************************************************************************/
+/* CRC calculation check and benchmark (Linux console)                       */
+/*                                                                           */
+/* Copyright (C) 2017 Laszlo Arvai                                           */
+/* All rights reserved.                                                      */
+/*                                                                           */
+/* This software may be modified and distributed under the terms             */
+/* of the GNU General Public License.  See the LICENSE file for details.     */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/* Includes                                                                  */
+/*****************************************************************************/
+#include <stdio.h>
+#include <sysHighresTimer.h>
+#include <crcCITT16.h>
+#include <cfcCheck.h>
+
+/*****************************************************************************/
+/* Constants                                                                 */
+/*****************************************************************************/
+#define cfcCRC_CHECK_BUFFER_LENGTH 264				// length of the random buffer (longest block plus unaligned start)
+#define cfcCRC_CHECK_COUNT 100000							// number of random blocks of the accuracy check
+#define cfcCRC_BENCHMARK_BYTE_COUNT 20000000ul	// number of processed bytes of one benchmark
+#define cfcCRC_CHECK_VECTOR "123456789"				// check vector of the CRC-CCITT (0xffff init)
+#define cfcCRC_CHECK_VECTOR_CRC 0x29b1
+
+/*****************************************************************************/
+/* Module global variables                                                   */
+/*****************************************************************************/
+static uint8_t l_buffer[cfcCRC_CHECK_BUFFER_LENGTH];
+static volatile uint16_t l_crc_sink;
+
+// block lengths of the benchmark (from the shortest to the longest packet)
+static const uint16_t l_block_lengths[] = { 8, 16, 32, 64, 128, 255 };
+
+/*****************************************************************************/
+/* Local functions                                                           */
+/*****************************************************************************/
+static uint16_t cfcCRCCalculateBytewise(uint16_t in_crc, uint8_t* in_buffer, uint16_t in_buffer_length);
+static float cfcCRCBenchmark(bool in_block, uint16_t in_block_length);
+
+/*****************************************************************************/
+/* Function implementation                                                   */
+/*****************************************************************************/
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Checks the slicing-by-8 block CRC calculation against the byte-by-byte calculation (random blocks
+/// with random start position, length and initial CRC) and prints the throughput of both implementations
+/// @return True if the results are identical and the block calculation is faster for the longest packets
+bool sysCRCCheck(void)
+{
+	uint32_t i;
+	uint32_t error_count;
+	uint16_t offset;
+	uint16_t length;
+	uint16_t crc;
+	float bytewise_speed;
+	float block_speed;
+	bool passed = true;
+
+	sysHighresTimerInit();
+
+	printf("CRC-CCITT16 check (%u random blocks)\n", cfcCRC_CHECK_COUNT);
+
+	for (i = 0; i < cfcCRC_CHECK_BUFFER_LENGTH; i++)
+		l_buffer[i] = (uint8_t)cfcCheckRandom();
+
+	// check vector
+	crc = crc16CalculateForBlock(crc16_INIT_VALUE, (uint8_t*)cfcCRC_CHECK_VECTOR, sizeof(cfcCRC_CHECK_VECTOR) - 1);
+	passed &= cfcCheckReport("check vector", crc == cfcCRC_CHECK_VECTOR_CRC, "0x%04x", crc);
+
+	// random blocks
+	error_count = 0;
+	for (i = 0; i < cfcCRC_CHECK_COUNT; i++)
+	{
+		offset = cfcCheckRandom() % 8;
+		length = cfcCheckRandom() % 256;
+		crc = (uint16_t)cfcCheckRandom();
+
+		if (crc16CalculateForBlock(crc, l_buffer + offset, length) != cfcCRCCalculateBytewise(crc, l_buffer + offset, length))
+			error_count++;
+	}
+	passed &= cfcCheckReport("block equals bytewise calculation", error_count == 0, "%u errors", error_count);
+
+	// benchmark
+	block_speed = 0;
+	bytewise_speed = 0;
+	for (i = 0; i < sizeof(l_block_lengths) / sizeof(l_block_lengths[0]); i++)
+	{
+		bytewise_speed = cfcCRCBenchmark(false, l_block_lengths[i]);
+		block_speed = cfcCRCBenchmark(true, l_block_lengths[i]);
+
+		printf("  %3uB blocks: bytewise %7.1fMB/s, block %7.1fMB/s\n", l_block_lengths[i], bytewise_speed, block_speed);
+	}
+
+	passed &= cfcCheckReport("block calculation is faster", block_speed > bytewise_speed, "%.1fx at %uB", block_speed / bytewise_speed,
+		l_block_lengths[sizeof(l_block_lengths) / sizeof(l_block_lengths[0]) - 1]);
+
+	return passed;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Reference calculation: adds the buffer content to the CRC byte by byte
+/// @param in_crc Current value of the CRC
+/// @param in_buffer Buffer (data) to add to the CRC
+/// @param in_buffer_length Number of bytes in the buffer
+/// @return New value of the CRC
+static uint16_t cfcCRCCalculateBytewise(uint16_t in_crc, uint8_t* in_buffer, uint16_t in_buffer_length)
+{
+	while (in_buffer_length > 0)
+	{
+		in_crc = crc16Calculate(in_crc, *in_buffer++);
+		in_buffer_length--;
+	}
+
+	return in_crc;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Measures the throughput of the CRC calculation
+/// @param in_block True to measure the block calculation, false to measure the bytewise calculation
+/// @param in_block_length Length of the processed blocks
+/// @return Throughput [MB/s]
+static float cfcCRCBenchmark(bool in_block, uint16_t in_block_length)
+{
+	sysHighresTimestamp start_time;
+	uint32_t block_count;
+	uint32_t time;
+	uint32_t i;
+
+	block_count = cfcCRC_BENCHMARK_BYTE_COUNT / in_block_length;
+
+	start_time = sysHighresTimerGetTimestamp();
+
+	if (in_block)
+	{
+		for (i = 0; i < block_count; i++)
+			l_crc_sink = crc16CalculateForBlock(crc16_INIT_VALUE, l_buffer, in_block_length);
+	}
+	else
+	{
+		for (i = 0; i < block_count; i++)
+			l_crc_sink = cfcCRCCalculateBytewise(crc16_INIT_VALUE, l_buffer, in_block_length);
+	}
+
+	time = sysHighresTimerGetTimeSince(start_time);
+	if (time == 0)
+		time = 1;
+
+	return (float)block_count * in_block_length / time;
+}
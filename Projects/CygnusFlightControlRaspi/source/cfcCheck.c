@@ -0,0 +1,115 @@
+/*****************************************************************************/
+/* Linux console checks and benchmarks                                       */
+/*                                                                           */
+/* Copyright (C) 2016 Laszlo Arvai                                           */
+/* All rights reserved.                                                      */
+/*                                                                           */
+/* This software may be modified and distributed under the terms             */
+/* of the GNU General Public License.  See the LICENSE file for details.     */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/* Includes                                                                  */
+/*****************************************************************************/
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <sysInitialize.h>
+#include <cfcCheck.h>
+
+/*****************************************************************************/
+/* Types                                                                     */
+/*****************************************************************************/
+typedef struct
+{
+	const char* Name;
+	cfcCheckFunction Function;
+} cfcCheckInfo;
+
+/*****************************************************************************/
+/* Module global variables                                                   */
+/*****************************************************************************/
+
+// list of the available checks (every check starts the system components it needs, so only one check can run in a process)
+static const cfcCheckInfo l_checks[] =
+{
+	{ "barometer", sysBarometerCheck },
+	{ "clock", sysClockCheck },
+	{ "commanager", sysComManagerCheck },
+	{ "crc", sysCRCCheck },
+	{ "filetable", sysFileTableCheck },
+	{ "filetransfer", sysFileTransferCheck },
+	{ "math", sysMathCheck },
+	{ "packetqueue", sysPacketQueueCheck },
+	{ "rox", sysRoxCheck },
+	{ "slip", sysSLIPCheck },
+	{ "telemetry", sysTelemetryCheck },
+	{ "uart", sysUARTCheck },
+	{ "udp", sysUDPCheck }
+};
+
+static uint32_t l_random_seed = 1;
+
+/*****************************************************************************/
+/* Function implementation                                                   */
+/*****************************************************************************/
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Runs the given check
+/// @param in_name Name of the check
+/// @return True if the check is passed
+bool sysRunCheck(const char* in_name)
+{
+	uint8_t i;
+	bool passed;
+
+	for (i = 0; i < sizeof(l_checks) / sizeof(l_checks[0]); i++)
+	{
+		if (strcmp(l_checks[i].Name, in_name) == 0)
+		{
+			passed = l_checks[i].Function();
+
+			printf("Check '%s' %s\n", in_name, (passed) ? "passed" : "FAILED");
+
+			return passed;
+		}
+	}
+
+	printf("Unknown check '%s'. Available checks:", in_name);
+	for (i = 0; i < sizeof(l_checks) / sizeof(l_checks[0]); i++)
+		printf(" %s", l_checks[i].Name);
+	printf("\n");
+
+	return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Prints result of one check step
+/// @param in_name Name of the check step
+/// @param in_passed Result of the check step
+/// @param in_format Format string of the measured values (printf style)
+/// @return Result of the check step
+bool cfcCheckReport(const char* in_name, bool in_passed, const char* in_format, ...)
+{
+	va_list args;
+
+	printf("  %-36s ", in_name);
+
+	va_start(args, in_format);
+	vprintf(in_format, args);
+	va_end(args);
+
+	printf(" %s\n", (in_passed) ? "ok" : "FAILED");
+
+	return in_passed;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Generates pseudo random number (reproducible sequence)
+/// @return Random number (24 bits)
+uint32_t cfcCheckRandom(void)
+{
+	l_random_seed = l_random_seed * 1103515245ul + 12345ul;
+
+	return l_random_seed >> 8;
+}
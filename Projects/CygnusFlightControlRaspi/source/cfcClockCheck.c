@@ -0,0 +1,218 @@
+/*****************************************************************************/
+/* System tick check with wall clock changes (Linux console)                 */
+/*                                                                           */
+/* Copyright (C) 2017 Laszlo Arvai                                           */
+/* All rights reserved.                                                      */
+/*                                                                           */
+/* This software may be modified and distributed under the terms             */
+/* of the GNU General Public License.  See the LICENSE file for details.     */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/* Includes                                                                  */
+/*****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/time.h>
+#include <sysRTOS.h>
+#include <sysHighresTimer.h>
+#include <cfgStorage.h>
+#include <comManager.h>
+#include <comSystemPacketDefinitions.h>
+#include <cfcCheck.h>
+
+/*****************************************************************************/
+/* Constants                                                                 */
+/*****************************************************************************/
+#define cfcCLOCK_CHECK_DURATION 1500						// duration of the check [ms]
+#define cfcCLOCK_CHECK_FORWARD_TIME 500				// time of the forward wall clock step [ms]
+#define cfcCLOCK_CHECK_BACKWARD_TIME 1000			// time of the backward wall clock step (restores the wall clock) [ms]
+#define cfcCLOCK_CHECK_STEP 60									// wall clock step [s]
+#define cfcCLOCK_CHECK_HOLD_TIME 20							// link refuses the packets before and after the wall clock steps (packets are pending during the step) [ms]
+#define cfcCLOCK_CHECK_PACKET_PERIOD 4					// time between the packets [ms]
+#define cfcCLOCK_CHECK_PACKET_SIZE 16						// size of the packets (without CRC)
+#define cfcCLOCK_CHECK_MAX_DELAY 50							// maximum duration of the packet period delay [ms]
+#define cfcCLOCK_CHECK_MAX_TICK_ERROR 5					// maximum difference of the system tick and high resolution time steps [ms]
+#define cfcCLOCK_CHECK_DRAIN_TIME 200						// time to wait for the pending packets [ms]
+
+/*****************************************************************************/
+/* Module global variables                                                   */
+/*****************************************************************************/
+static volatile uint32_t l_received_count;
+static volatile bool l_link_blocked;
+
+/*****************************************************************************/
+/* Local functions                                                           */
+/*****************************************************************************/
+static bool cfcClockStep(int32_t in_step);
+static bool cfcClockPacketSend(uint8_t* in_packet, uint16_t in_packet_length);
+
+/*****************************************************************************/
+/* Function implementation                                                   */
+/*****************************************************************************/
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Sends packets through a loopback interface while the wall clock is moved forward and back (root is
+/// required). The link refuses the packets around the steps, so packets are pending while the wall clock is moved.
+/// The system tick must not follow the wall clock: it must step together with the high resolution timer, no packet
+/// may expire and delays must not be longer.
+/// @return True if all checks are passed
+bool sysClockCheck(void)
+{
+	comInterfaceDescription interface_description;
+	comManagerStatistics statistics;
+	sysHighresTimestamp start_time;
+	sysHighresTimestamp delay_start_time;
+	uint32_t elapsed_time;
+	int32_t step_difference;
+	uint32_t delay_time;
+	uint32_t max_delay_time;
+	uint32_t pushed_count;
+	uint32_t push_failed_count;
+	uint32_t tick_error;
+	sysTick tick;
+	sysTick previous_tick;
+	uint32_t previous_time;
+	uint16_t packet_index;
+	uint8_t* packet;
+	bool forward_stepped = false;
+	bool backward_stepped = false;
+	bool step_success = true;
+	bool passed = true;
+
+	printf("System tick check (wall clock is moved by +%us and -%us)\n", cfcCLOCK_CHECK_STEP, cfcCLOCK_CHECK_STEP);
+
+	sysHighresTimerInit();
+
+	// start communication with a loopback interface
+	cfgStorageInit();
+	cfgLoadDefaultConfiguration();
+
+	comManagerInit();
+
+	interface_description.PacketSendFunction = cfcClockPacketSend;
+	comAddInterface(&interface_description);
+
+	comManagerResetStatistics();
+
+	l_received_count = 0;
+	pushed_count = 0;
+	push_failed_count = 0;
+	max_delay_time = 0;
+	tick_error = 0;
+
+	previous_tick = sysGetSystemTick();
+	previous_time = 0;
+	start_time = sysHighresTimerGetTimestamp();
+
+	while ((elapsed_time = sysHighresTimerGetTimeSince(start_time) / 1000) < cfcCLOCK_CHECK_DURATION)
+	{
+		// compare system tick step with the high resolution timer step
+		tick = sysGetSystemTick();
+		step_difference = (int32_t)(tick - previous_tick) - (int32_t)(elapsed_time - previous_time);
+		previous_tick = tick;
+		previous_time = elapsed_time;
+
+		if (step_difference < 0)
+			step_difference = -step_difference;
+
+		if ((uint32_t)step_difference > tick_error)
+			tick_error = step_difference;
+
+		// hold the packets around the wall clock steps
+		l_link_blocked = (elapsed_time + cfcCLOCK_CHECK_HOLD_TIME >= cfcCLOCK_CHECK_FORWARD_TIME && elapsed_time < cfcCLOCK_CHECK_FORWARD_TIME + cfcCLOCK_CHECK_HOLD_TIME) ||
+			(elapsed_time + cfcCLOCK_CHECK_HOLD_TIME >= cfcCLOCK_CHECK_BACKWARD_TIME && elapsed_time < cfcCLOCK_CHECK_BACKWARD_TIME + cfcCLOCK_CHECK_HOLD_TIME);
+
+		// move wall clock
+		if (!forward_stepped && elapsed_time >= cfcCLOCK_CHECK_FORWARD_TIME)
+		{
+			step_success &= cfcClockStep(cfcCLOCK_CHECK_STEP);
+			forward_stepped = true;
+		}
+
+		if (!backward_stepped && elapsed_time >= cfcCLOCK_CHECK_BACKWARD_TIME)
+		{
+			step_success &= cfcClockStep(-cfcCLOCK_CHECK_STEP);
+			backward_stepped = true;
+		}
+
+		// send packet
+		packet = comManagerTransmitPacketPushStart(cfcCLOCK_CHECK_PACKET_SIZE, comINVALID_INTERFACE_INDEX, comPT_TELEMETRY_OBJECT, &packet_index);
+		if (packet != sysNULL)
+		{
+			sysMemZero(packet + sizeof(comPacketHeader), cfcCLOCK_CHECK_PACKET_SIZE - sizeof(comPacketHeader));
+			comManagerTransmitPacketPushEnd(packet_index);
+			pushed_count++;
+		}
+		else
+		{
+			push_failed_count++;
+		}
+
+		// wait for the next packet
+		delay_start_time = sysHighresTimerGetTimestamp();
+		sysDelay(cfcCLOCK_CHECK_PACKET_PERIOD);
+		delay_time = sysHighresTimerGetTimeSince(delay_start_time);
+
+		if (delay_time > max_delay_time)
+			max_delay_time = delay_time;
+	}
+
+	l_link_blocked = false;
+
+	sysDelay(cfcCLOCK_CHECK_DRAIN_TIME);
+
+	comManagerGetStatistics(&statistics);
+
+	printf("  %u pushed, %u received, %u transmitter wakeups\n", pushed_count, l_received_count, statistics.TransmitWakeupCount);
+
+	passed &= cfcCheckReport("wall clock is moved", step_success, "%s", (step_success) ? "+/-" : "root required");
+	passed &= cfcCheckReport("system tick is monotonic", tick_error <= cfcCLOCK_CHECK_MAX_TICK_ERROR, "max. %ums step difference", tick_error);
+	passed &= cfcCheckReport("delays are not affected", max_delay_time <= cfcCLOCK_CHECK_MAX_DELAY * 1000, "max. %.1fms", max_delay_time / 1000.0);
+	passed &= cfcCheckReport("no expired packets", statistics.ExpiredPacketCount == 0, "%u", statistics.ExpiredPacketCount);
+	passed &= cfcCheckReport("all packets are sent", push_failed_count == 0 && l_received_count == pushed_count, "%u push failed, %u lost", push_failed_count,
+		pushed_count - l_received_count);
+
+	return passed;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Moves the wall clock
+/// @param in_step Wall clock step [s]
+/// @return True if the wall clock was set
+static bool cfcClockStep(int32_t in_step)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, sysNULL);
+	tv.tv_sec += in_step;
+
+	if (settimeofday(&tv, sysNULL) != 0)
+	{
+		printf("  Wall clock can't be set: %s\n", strerror(errno));
+		return false;
+	}
+
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Loopback interface packet send function, counts the packets of the check (packets are refused while the
+/// link is blocked)
+static bool cfcClockPacketSend(uint8_t* in_packet, uint16_t in_packet_length)
+{
+	comPacketHeader* header = (comPacketHeader*)in_packet;
+
+	sysUNUSED(in_packet_length);
+
+	if (header->PacketType != comPT_TELEMETRY_OBJECT)
+		return true;
+
+	if (l_link_blocked)
+		return false;
+
+	l_received_count++;
+
+	return true;
+}
@@ -0,0 +1,210 @@
+/*****************************************************************************/
+/* Communication manager transmitter check (Linux console)                   */
+/*                                                                           */
+/* Copyright (C) 2017 Laszlo Arvai                                           */
+/* All rights reserved.                                                      */
+/*                                                                           */
+/* This software may be modified and distributed under the terms             */
+/* of the GNU General Public License.  See the LICENSE file for details.     */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/* Includes                                                                  */
+/*****************************************************************************/
+#include <stdio.h>
+#include <sysRTOS.h>
+#include <cfgStorage.h>
+#include <comManager.h>
+#include <comSystemPacketDefinitions.h>
+#include <cfcCheck.h>
+
+/*****************************************************************************/
+/* Constants                                                                 */
+/*****************************************************************************/
+#define cfcCOM_CHECK_BURST_COUNT 100						// number of bursts in one phase
+#define cfcCOM_CHECK_BURST_SIZE 16							// number of packets in one burst (a whole burst fits into the transmitter queue)
+#define cfcCOM_CHECK_BURST_PERIOD 5							// time between bursts [ms]
+#define cfcCOM_CHECK_PACKET_SIZE 24							// size of the packets (without CRC)
+#define cfcCOM_CHECK_BLOCKED_TIME 300						// time while the link refuses the packets [ms]
+#define cfcCOM_CHECK_DRAIN_TIME 200							// time to wait for the pending packets [ms]
+#define cfcCOM_CHECK_PRODUCER_PRIORITY 3				// producer preempts the communication manager (whole burst is queued before the wakeup)
+
+/*****************************************************************************/
+/* Types                                                                     */
+/*****************************************************************************/
+
+/// Packet of the check (telemetry packet type, sequence number in the payload)
+typedef struct
+{
+	comPacketHeader Header;
+	uint32_t Sequence;
+	uint8_t Payload[cfcCOM_CHECK_PACKET_SIZE - sizeof(comPacketHeader) - sizeof(uint32_t)];
+} cfcComCheckPacket;
+
+/*****************************************************************************/
+/* Module global variables                                                   */
+/*****************************************************************************/
+static volatile bool l_producer_running;
+static volatile bool l_link_blocked;
+static uint32_t l_pushed_count;
+static uint32_t l_push_failed_count;
+static volatile uint32_t l_received_count;
+static volatile uint32_t l_sequence_error_count;
+static uint32_t l_next_sequence;
+static uint32_t l_expected_sequence;
+
+/*****************************************************************************/
+/* Local functions                                                           */
+/*****************************************************************************/
+static void cfcComManagerRun(bool in_block_link);
+static sysTaskRetval cfcComManagerProducerTask(sysTaskParam in_param);
+static bool cfcComManagerPacketSend(uint8_t* in_packet, uint16_t in_packet_length);
+
+/*****************************************************************************/
+/* Function implementation                                                   */
+/*****************************************************************************/
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Checks the transmitter of the communication manager. Bursts of packets are sent through a loopback
+/// interface: a whole burst must be sent in one wakeup without expired packets. Then the link refuses the packets
+/// for a while: the expired packets must be dropped and the transmission must continue when the link recovers.
+/// @return True if all checks are passed
+bool sysComManagerCheck(void)
+{
+	comInterfaceDescription interface_description;
+	comManagerStatistics statistics;
+	uint32_t received_count;
+	bool passed = true;
+
+	printf("Communication manager transmitter check (%u bursts of %u packets, %uB/packet)\n", cfcCOM_CHECK_BURST_COUNT, cfcCOM_CHECK_BURST_SIZE, cfcCOM_CHECK_PACKET_SIZE);
+
+	// start communication with a loopback interface
+	cfgStorageInit();
+	cfgLoadDefaultConfiguration();
+
+	comManagerInit();
+
+	interface_description.PacketSendFunction = cfcComManagerPacketSend;
+	comAddInterface(&interface_description);
+
+	// link accepts all packets
+	cfcComManagerRun(false);
+	comManagerGetStatistics(&statistics);
+
+	printf("  Idle link: %u pushed, %u received, %u wakeups, max. %u packets/wakeup, max. queue depth %uB\n", l_pushed_count, l_received_count, statistics.TransmitWakeupCount,
+		statistics.MaxWakeupPacketCount, statistics.TransmitQueueMaxDepth);
+
+	passed &= cfcCheckReport("all packets are sent", l_push_failed_count == 0 && l_received_count == l_pushed_count && l_sequence_error_count == 0,
+		"%u push failed, %u lost, %u out of order", l_push_failed_count, l_pushed_count - l_received_count, l_sequence_error_count);
+	passed &= cfcCheckReport("burst is sent in one wakeup", statistics.MaxWakeupPacketCount >= cfcCOM_CHECK_BURST_SIZE, "max. %u packets", statistics.MaxWakeupPacketCount);
+	passed &= cfcCheckReport("no expired packets", statistics.ExpiredPacketCount == 0, "%u", statistics.ExpiredPacketCount);
+
+	// link refuses packets at the beginning
+	cfcComManagerRun(true);
+	comManagerGetStatistics(&statistics);
+
+	received_count = l_received_count;
+
+	printf("  Blocked link: %u pushed, %u push failed, %u received, %u expired\n", l_pushed_count, l_push_failed_count, received_count, statistics.ExpiredPacketCount);
+
+	passed &= cfcCheckReport("expired packets are dropped", statistics.ExpiredPacketCount > 0 && statistics.StalledCycleCount == 0, "%u expired, %u stalled cycles",
+		statistics.ExpiredPacketCount, statistics.StalledCycleCount);
+	passed &= cfcCheckReport("transmission recovers", received_count > 0 && l_sequence_error_count == 0 && received_count + statistics.ExpiredPacketCount == l_pushed_count,
+		"%u received, %u lost", received_count, l_pushed_count - received_count - statistics.ExpiredPacketCount);
+
+	return passed;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Runs the producer task and waits until all packets are sent
+/// @param in_block_link True if the link refuses the packets for cfcCOM_CHECK_BLOCKED_TIME
+static void cfcComManagerRun(bool in_block_link)
+{
+	sysTask task_handle;
+	sysTick start_tick;
+
+	comManagerResetStatistics();
+
+	l_pushed_count = 0;
+	l_push_failed_count = 0;
+	l_received_count = 0;
+	l_sequence_error_count = 0;
+	l_expected_sequence = l_next_sequence;
+	l_link_blocked = in_block_link;
+	l_producer_running = true;
+
+	sysTaskCreate(cfcComManagerProducerTask, "cfcProducer", sysDEFAULT_STACK_SIZE, sysNULL, cfcCOM_CHECK_PRODUCER_PRIORITY, &task_handle, sysNULL);
+
+	start_tick = sysGetSystemTick();
+	while (l_producer_running)
+	{
+		if (l_link_blocked && sysGetSystemTickSince(start_tick) >= cfcCOM_CHECK_BLOCKED_TIME)
+			l_link_blocked = false;
+
+		sysDelay(10);
+	}
+
+	l_link_blocked = false;
+
+	sysDelay(cfcCOM_CHECK_DRAIN_TIME);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Producer task: pushes bursts of packets into the transmitter queue
+static sysTaskRetval cfcComManagerProducerTask(sysTaskParam in_param)
+{
+	cfcComCheckPacket* packet;
+	uint16_t packet_index;
+	uint16_t burst;
+	uint8_t i;
+
+	sysUNUSED(in_param);
+
+	for (burst = 0; burst < cfcCOM_CHECK_BURST_COUNT; burst++)
+	{
+		for (i = 0; i < cfcCOM_CHECK_BURST_SIZE; i++)
+		{
+			packet = (cfcComCheckPacket*)comManagerTransmitPacketPushStart(sizeof(cfcComCheckPacket), comINVALID_INTERFACE_INDEX, comPT_TELEMETRY_OBJECT, &packet_index);
+			if (packet == sysNULL)
+			{
+				l_push_failed_count++;
+				continue;
+			}
+
+			packet->Sequence = l_next_sequence++;
+			sysMemZero(packet->Payload, sizeof(packet->Payload));
+
+			comManagerTransmitPacketPushEnd(packet_index);
+
+			l_pushed_count++;
+		}
+
+		sysDelay(cfcCOM_CHECK_BURST_PERIOD);
+	}
+
+	l_producer_running = false;
+
+	return (sysTaskRetval)0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Loopback interface packet send function, counts the packets of the check and checks their order
+static bool cfcComManagerPacketSend(uint8_t* in_packet, uint16_t in_packet_length)
+{
+	cfcComCheckPacket* packet = (cfcComCheckPacket*)in_packet;
+
+	if (packet->Header.PacketType != comPT_TELEMETRY_OBJECT || in_packet_length < sizeof(cfcComCheckPacket))
+		return true;
+
+	if (l_link_blocked)
+		return false;
+
+	// packets can be dropped (expired) but the order must be kept
+	if (packet->Sequence < l_expected_sequence)
+		l_sequence_error_count++;
+
+	l_expected_sequence = packet->Sequence + 1;
+	l_received_count++;
+
+	return true;
+}
@@ -0,0 +1,238 @@
+/*****************************************************************************/
+/* System file table check and benchmark (Linux console)                     */
+/*                                                                           */
+/* Copyright (C) 2017 Laszlo Arvai                                           */
+/* All rights reserved.                                                      */
+/*                                                                           */
+/* This software may be modified and distributed under the terms             */
+/* of the GNU General Public License.  See the LICENSE file for details.     */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/* Includes                                                                  */
+/*****************************************************************************/
+#include <stdio.h>
+#include <sysRTOS.h>
+#include <sysString.h>
+#include <sysHighresTimer.h>
+#include <fileSystemFiles.h>
+#include <cfcCheck.h>
+
+/*****************************************************************************/
+/* Constants                                                                 */
+/*****************************************************************************/
+#define cfcFILE_TABLE_CHECK_MAX_FILE_COUNT 200						// number of files of the large synthetic table
+#define cfcFILE_TABLE_CHECK_INDEXED_FILE_COUNT 31					// number of files of the largest table fitting the default (32 entry) name index
+#define cfcFILE_TABLE_CHECK_NAME_LENGTH 24								// maximum length of the synthetic file names
+#define cfcFILE_TABLE_CHECK_LOOKUP_COUNT 200000						// number of file name lookups of one benchmark
+#define cfcFILE_TABLE_CHECK_ACCESS_COUNT 10000000					// number of file property reads of one benchmark
+
+/*****************************************************************************/
+/* Module global variables                                                   */
+/*****************************************************************************/
+static fileInternalFileTableEntry l_file_table[cfcFILE_TABLE_CHECK_MAX_FILE_COUNT + 1];
+static char l_file_names[cfcFILE_TABLE_CHECK_MAX_FILE_COUNT][cfcFILE_TABLE_CHECK_NAME_LENGTH];
+static char l_upper_case_file_names[cfcFILE_TABLE_CHECK_MAX_FILE_COUNT][cfcFILE_TABLE_CHECK_NAME_LENGTH];
+static uint16_t l_file_count;
+static volatile uint32_t l_sink;
+
+// sizes of the synthetic tables (smallest, largest indexed and large table)
+static const uint16_t l_file_counts[] = { 4, cfcFILE_TABLE_CHECK_INDEXED_FILE_COUNT, cfcFILE_TABLE_CHECK_MAX_FILE_COUNT };
+
+/*****************************************************************************/
+/* Local functions                                                           */
+/*****************************************************************************/
+static void cfcFileTableCreate(uint16_t in_file_count);
+static uint32_t cfcFileTableCheckAccess(void);
+static uint8_t cfcFileTableLinearGetIndex(sysString in_file_name);
+static float cfcFileTableBenchmarkLookup(bool in_indexed);
+static float cfcFileTableBenchmarkLength(void);
+
+/*****************************************************************************/
+/* Function implementation                                                   */
+/*****************************************************************************/
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Checks the system file functions on synthetic file tables of different sizes and compares the time of the
+/// indexed file name lookup with the linear search of the table. The largest table doesn't fit into the name index
+/// (linear search fallback is used).
+/// @return True if all file operations give the correct results, file name index is faster than the linear search
+/// and the file property access time doesn't depend on the table size
+bool sysFileTableCheck(void)
+{
+	uint32_t error_count;
+	float indexed_lookup_time;
+	float linear_lookup_time;
+	float length_time;
+	float indexed_speedup = 0;
+	float min_length_time = 0;
+	float max_length_time = 0;
+	uint8_t i;
+	bool passed = true;
+
+	sysHighresTimerInit();
+
+	printf("System file table check (%u lookups per benchmark)\n", cfcFILE_TABLE_CHECK_LOOKUP_COUNT);
+
+	error_count = 0;
+	for (i = 0; i < sizeof(l_file_counts) / sizeof(l_file_counts[0]); i++)
+	{
+		cfcFileTableCreate(l_file_counts[i]);
+		fileSystemFileSetTable(l_file_table);
+
+		error_count += cfcFileTableCheckAccess();
+
+		indexed_lookup_time = cfcFileTableBenchmarkLookup(true);
+		linear_lookup_time = cfcFileTableBenchmarkLookup(false);
+		length_time = cfcFileTableBenchmarkLength();
+
+		printf("  %3u files: lookup %6.1fns (linear search: %6.1fns), length %4.1fns\n", l_file_count, indexed_lookup_time, linear_lookup_time, length_time);
+
+		if (l_file_count == cfcFILE_TABLE_CHECK_INDEXED_FILE_COUNT)
+			indexed_speedup = linear_lookup_time / indexed_lookup_time;
+
+		if (i == 0 || length_time < min_length_time)
+			min_length_time = length_time;
+
+		if (i == 0 || length_time > max_length_time)
+			max_length_time = length_time;
+	}
+
+	// restore system file table
+	fileSystemFileSetTable(g_system_files_info_table);
+
+	passed &= cfcCheckReport("file operations", error_count == 0, "%u errors", error_count);
+	passed &= cfcCheckReport("indexed lookup is faster", indexed_speedup > 1, "%.1fx at %u files", indexed_speedup, cfcFILE_TABLE_CHECK_INDEXED_FILE_COUNT);
+
+	// file count is cached, property access time must not grow with the table (2x margin for timing noise)
+	passed &= cfcCheckReport("length is independent of file count", max_length_time < min_length_time * 2, "%.1fns - %.1fns", min_length_time, max_length_time);
+
+	return passed;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Creates synthetic file table (file names differ only at the end)
+/// @param in_file_count Number of files in the table
+static void cfcFileTableCreate(uint16_t in_file_count)
+{
+	uint16_t i;
+	uint8_t pos;
+
+	for (i = 0; i < in_file_count; i++)
+	{
+		snprintf(l_file_names[i], cfcFILE_TABLE_CHECK_NAME_LENGTH, "SyntheticFile%03u", i);
+
+		for (pos = 0; l_file_names[i][pos] != '\0'; pos++)
+			l_upper_case_file_names[i][pos] = sysCharToUpper(l_file_names[i][pos]);
+
+		l_upper_case_file_names[i][pos] = '\0';
+
+		l_file_table[i].Name = l_file_names[i];
+		l_file_table[i].Content = (uint8_t*)l_file_names[i];
+		l_file_table[i].Callback = sysNULL;
+		l_file_table[i].Length = i * 7 + 1;
+		l_file_table[i].Flags = (i % 2 == 0) ? fileSFF_READ_ONLY : fileSFF_READ_WRITE;
+	}
+
+	sysMemZero(&l_file_table[in_file_count], sizeof(l_file_table[in_file_count]));
+
+	l_file_count = in_file_count;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Checks the results of the system file functions on the current synthetic table
+/// @return Number of errors
+static uint32_t cfcFileTableCheckAccess(void)
+{
+	uint32_t error_count = 0;
+	uint16_t i;
+
+	if (fileSystemFileGetCount() != l_file_count)
+		error_count++;
+
+	for (i = 0; i < l_file_count; i++)
+	{
+		if (fileSystemFileGetIndex(l_file_names[i]) != i || fileSystemFileGetIndex(l_upper_case_file_names[i]) != i)
+			error_count++;
+
+		if (fileSystemFileGetLength((uint8_t)i) != l_file_table[i].Length || fileSystemFileGetFlag((uint8_t)i) != l_file_table[i].Flags ||
+			fileSystemFileGetContent((uint8_t)i) != l_file_table[i].Content)
+			error_count++;
+	}
+
+	// unknown files
+	if (fileSystemFileGetIndex("SyntheticFile") != fileINVALID_SYSTEM_FILE_ID || fileSystemFileGetIndex("SyntheticFile999") != fileINVALID_SYSTEM_FILE_ID)
+		error_count++;
+
+	if (fileSystemFileGetLength((uint8_t)l_file_count) != 0 || fileSystemFileGetContent((uint8_t)l_file_count) != sysNULL)
+		error_count++;
+
+	return error_count;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Reference lookup: compares the file name with the names of the table one by one
+/// @param in_file_name File name to find
+/// @return File index (0xff if file name is invalid)
+static uint8_t cfcFileTableLinearGetIndex(sysString in_file_name)
+{
+	uint8_t index = 0;
+
+	while (l_file_table[index].Name != sysNULL)
+	{
+		if (sysCompareConstStringNoCase(in_file_name, l_file_table[index].Name) == 0)
+			return index;
+
+		index++;
+	}
+
+	return fileINVALID_SYSTEM_FILE_ID;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Measures the file name lookup time (all files are searched evenly)
+/// @param in_indexed True to measure the system file function, false to measure the linear search
+/// @return Time of one lookup [ns]
+static float cfcFileTableBenchmarkLookup(bool in_indexed)
+{
+	sysHighresTimestamp start_time;
+	uint32_t time;
+	uint32_t i;
+
+	start_time = sysHighresTimerGetTimestamp();
+
+	if (in_indexed)
+	{
+		for (i = 0; i < cfcFILE_TABLE_CHECK_LOOKUP_COUNT; i++)
+			l_sink = fileSystemFileGetIndex(l_file_names[i % l_file_count]);
+	}
+	else
+	{
+		for (i = 0; i < cfcFILE_TABLE_CHECK_LOOKUP_COUNT; i++)
+			l_sink = cfcFileTableLinearGetIndex(l_file_names[i % l_file_count]);
+	}
+
+	time = sysHighresTimerGetTimeSince(start_time);
+
+	return time * 1000.0f / cfcFILE_TABLE_CHECK_LOOKUP_COUNT;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Measures the file length access time (the last file of the table is accessed)
+/// @return Time of one access [ns]
+static float cfcFileTableBenchmarkLength(void)
+{
+	sysHighresTimestamp start_time;
+	uint32_t time;
+	uint32_t i;
+	uint8_t index = (uint8_t)(l_file_count - 1);
+
+	start_time = sysHighresTimerGetTimestamp();
+
+	for (i = 0; i < cfcFILE_TABLE_CHECK_ACCESS_COUNT; i++)
+		l_sink = fileSystemFileGetLength(index);
+
+	time = sysHighresTimerGetTimeSince(start_time);
+
+	return time * 1000.0f / cfcFILE_TABLE_CHECK_ACCESS_COUNT;
+}
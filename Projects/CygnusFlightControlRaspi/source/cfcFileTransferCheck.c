@@ -0,0 +1,269 @@
+/*****************************************************************************/
+/* Windowed file transfer check and benchmark (Linux console)                */
+/*                                                                           */
+/* Copyright (C) 2017 Laszlo Arvai                                           */
+/* All rights reserved.                                                      */
+/*                                                                           */
+/* This software may be modified and distributed under the terms             */
+/* of the GNU General Public License.  See the LICENSE file for details.     */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/* Includes                                                                  */
+/*****************************************************************************/
+#include <stdio.h>
+#include <sysRTOS.h>
+#include <sysHighresTimer.h>
+#include <cfgStorage.h>
+#include <comManager.h>
+#include <comSystemPacketDefinitions.h>
+#include <fileSystemFiles.h>
+#include <cfcCheck.h>
+
+/*****************************************************************************/
+/* Constants                                                                 */
+/*****************************************************************************/
+#define cfcFILE_TRANSFER_CHECK_FILE "ConfigurationXML"		// file read by the check
+#define cfcFILE_TRANSFER_CHECK_BLOCK_LENGTH 16						// length of the requested blocks [byte]
+#define cfcFILE_TRANSFER_CHECK_MAX_BLOCK_COUNT 256				// maximum number of blocks of the file
+#define cfcFILE_TRANSFER_CHECK_LOSS 20										// packet loss in both directions [%]
+#define cfcFILE_TRANSFER_CHECK_TIMEOUT 5									// time to wait for the requested blocks before the next request [ms]
+#define cfcFILE_TRANSFER_CHECK_DRAIN_TIME 20							// time to wait for the late responses between the runs [ms]
+#define cfcFILE_TRANSFER_CHECK_MIN_SPEEDUP 2							// minimum speedup of the largest window compared to the single block transfer
+
+/*****************************************************************************/
+/* Types                                                                     */
+/*****************************************************************************/
+
+/// Result of one transfer
+typedef struct
+{
+	uint32_t CompletionTime;		// [us]
+	uint32_t RequestCount;			// number of sent (including the lost) requests
+	uint32_t LostPacketCount;		// number of dropped requests and responses
+	uint32_t ErrorCount;				// number of received blocks with wrong content
+} cfcFileTransferResult;
+
+/*****************************************************************************/
+/* Module global variables                                                   */
+/*****************************************************************************/
+static uint8_t l_interface_index;
+static uint8_t l_file_id;
+static uint32_t l_file_length;
+static const uint8_t* l_file_content;
+static uint8_t l_packet_counter;
+static volatile uint32_t l_lost_packet_count;
+static volatile uint32_t l_error_count;
+static volatile bool l_block_received[cfcFILE_TRANSFER_CHECK_MAX_BLOCK_COUNT];
+
+// window sizes of the measurements (the single block window is the reference)
+static const uint8_t l_window_sizes[] = { 1, 4, 16, comFILE_TRANSFER_MAX_WINDOW_SIZE };
+
+/*****************************************************************************/
+/* Local functions                                                           */
+/*****************************************************************************/
+static void cfcFileTransferRead(uint8_t in_window_size, cfcFileTransferResult* out_result);
+static void cfcFileTransferSendRequest(uint32_t in_first_block, uint32_t in_block_mask);
+static bool cfcFileTransferPacketSend(uint8_t* in_packet, uint16_t in_packet_length);
+static bool cfcFileTransferIsLost(void);
+
+/*****************************************************************************/
+/* Function implementation                                                   */
+/*****************************************************************************/
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Reads a file through a loopback interface with the windowed file transfer. Requests and responses are
+/// dropped randomly, missing blocks are requested again by the next window. Completion time is measured for
+/// different window sizes.
+/// @return True if the content of the file is received correctly and the windowed transfer is faster
+bool sysFileTransferCheck(void)
+{
+	comInterfaceDescription interface_description;
+	cfcFileTransferResult results[sizeof(l_window_sizes)];
+	uint32_t block_count;
+	uint8_t i;
+	bool passed = true;
+
+	sysHighresTimerInit();
+
+	// start communication with a loopback interface
+	cfgStorageInit();
+	cfgLoadDefaultConfiguration();
+
+	comManagerInit();
+
+	interface_description.PacketSendFunction = cfcFileTransferPacketSend;
+	l_interface_index = comAddInterface(&interface_description);
+
+	// file to read
+	l_file_id = fileSystemFileGetIndex(cfcFILE_TRANSFER_CHECK_FILE);
+	if (l_file_id == fileINVALID_SYSTEM_FILE_ID)
+		return cfcCheckReport("file found", false, "%s", cfcFILE_TRANSFER_CHECK_FILE);
+
+	l_file_length = fileSystemFileGetLength(l_file_id);
+	l_file_content = fileSystemFileGetContent(l_file_id);
+	block_count = (l_file_length + cfcFILE_TRANSFER_CHECK_BLOCK_LENGTH - 1) / cfcFILE_TRANSFER_CHECK_BLOCK_LENGTH;
+
+	if (l_file_content == sysNULL || block_count > cfcFILE_TRANSFER_CHECK_MAX_BLOCK_COUNT)
+		return cfcCheckReport("file content", false, "%s", cfcFILE_TRANSFER_CHECK_FILE);
+
+	printf("File transfer check (%s, %uB, %u blocks, %u%% loss)\n", cfcFILE_TRANSFER_CHECK_FILE, l_file_length, block_count, cfcFILE_TRANSFER_CHECK_LOSS);
+
+	for (i = 0; i < sizeof(l_window_sizes); i++)
+	{
+		cfcFileTransferRead(l_window_sizes[i], &results[i]);
+
+		printf("  Window %2u: %6.1fms, %4u requests, %4u lost packets\n", l_window_sizes[i], results[i].CompletionTime / 1000.0, results[i].RequestCount, results[i].LostPacketCount);
+
+		passed &= cfcCheckReport("content is received", results[i].ErrorCount == 0, "%u errors", results[i].ErrorCount);
+	}
+
+	passed &= cfcCheckReport("windowed transfer is faster", results[sizeof(l_window_sizes) - 1].CompletionTime * cfcFILE_TRANSFER_CHECK_MIN_SPEEDUP < results[0].CompletionTime,
+		"%.1fx speedup", (float)results[0].CompletionTime / results[sizeof(l_window_sizes) - 1].CompletionTime);
+
+	return passed;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Reads the whole file with the given window size. The window always starts at the first missing block
+/// and only the missing blocks are requested.
+/// @param in_window_size Maximum number of requested blocks
+/// @param out_result Result of the transfer
+static void cfcFileTransferRead(uint8_t in_window_size, cfcFileTransferResult* out_result)
+{
+	sysHighresTimestamp start_time;
+	sysTick request_timestamp;
+	uint32_t block_count;
+	uint32_t first_block;
+	uint32_t block_mask;
+	uint32_t pending_mask;
+	uint32_t block;
+
+	block_count = (l_file_length + cfcFILE_TRANSFER_CHECK_BLOCK_LENGTH - 1) / cfcFILE_TRANSFER_CHECK_BLOCK_LENGTH;
+
+	// wait for the late responses of the previous run
+	sysDelay(cfcFILE_TRANSFER_CHECK_DRAIN_TIME);
+
+	for (block = 0; block < block_count; block++)
+		l_block_received[block] = false;
+
+	l_lost_packet_count = 0;
+	l_error_count = 0;
+	out_result->RequestCount = 0;
+
+	start_time = sysHighresTimerGetTimestamp();
+
+	first_block = 0;
+	while (true)
+	{
+		// find the first missing block
+		while (first_block < block_count && l_block_received[first_block])
+			first_block++;
+
+		if (first_block >= block_count)
+			break;
+
+		// request the missing blocks of the window
+		block_mask = 0;
+		for (block = 0; block < in_window_size && first_block + block < block_count; block++)
+		{
+			if (!l_block_received[first_block + block])
+				block_mask |= (1ul << block);
+		}
+
+		cfcFileTransferSendRequest(first_block, block_mask);
+		out_result->RequestCount++;
+
+		// wait for the requested blocks
+		request_timestamp = sysGetSystemTick();
+		do
+		{
+			sysDelay(1);
+
+			pending_mask = 0;
+			for (block = 0; block < in_window_size && first_block + block < block_count; block++)
+			{
+				if ((block_mask & (1ul << block)) != 0 && !l_block_received[first_block + block])
+					pending_mask |= (1ul << block);
+			}
+		} while (pending_mask != 0 && sysGetSystemTickSince(request_timestamp) < cfcFILE_TRANSFER_CHECK_TIMEOUT);
+	}
+
+	out_result->CompletionTime = sysHighresTimerGetTimeSince(start_time);
+	out_result->LostPacketCount = l_lost_packet_count;
+	out_result->ErrorCount = l_error_count;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Sends window read request to the communication manager (the request can be lost)
+/// @param in_first_block Index of the first block of the window
+/// @param in_block_mask Requested blocks of the window
+static void cfcFileTransferSendRequest(uint32_t in_first_block, uint32_t in_block_mask)
+{
+	uint8_t packet[sizeof(comPacketFileDataWindowReadRequest) + comCRC_BYTE_COUNT];
+	comPacketFileDataWindowReadRequest* request = (comPacketFileDataWindowReadRequest*)packet;
+
+	sysMemZero(packet, sizeof(packet));
+
+	request->Header.Header.PacketLength = sizeof(packet);
+	request->Header.Header.PacketType = comPT_FILE_DATA_WINDOW_READ_REQUEST;
+	request->Header.Header.PacketCounter = ++l_packet_counter;
+	request->Header.ID = l_file_id;
+	request->Pos = in_first_block * cfcFILE_TRANSFER_CHECK_BLOCK_LENGTH;
+	request->BlockLength = cfcFILE_TRANSFER_CHECK_BLOCK_LENGTH;
+	request->BlockMask = in_block_mask;
+
+	if (cfcFileTransferIsLost())
+		l_lost_packet_count++;
+	else
+		comManagerStoreReceivedPacket(l_interface_index, packet, sizeof(packet));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Loopback interface packet send function, checks the received blocks (the response can be lost)
+static bool cfcFileTransferPacketSend(uint8_t* in_packet, uint16_t in_packet_length)
+{
+	comFileDataReadResponseHeader* response = (comFileDataReadResponseHeader*)in_packet;
+	uint32_t expected_length;
+
+	if (response->Header.Header.PacketType != comPT_FILE_DATA_READ_RESPONSE || in_packet_length < sizeof(comFileDataReadResponseHeader) + response->Length)
+		return true;
+
+	if (cfcFileTransferIsLost())
+	{
+		l_lost_packet_count++;
+		return true;
+	}
+
+	// check block (the last block is shorter)
+	if (response->Header.ID != l_file_id || response->Pos % cfcFILE_TRANSFER_CHECK_BLOCK_LENGTH != 0 || response->Pos >= l_file_length)
+	{
+		l_error_count++;
+		return true;
+	}
+
+	expected_length = l_file_length - response->Pos;
+	if (expected_length > cfcFILE_TRANSFER_CHECK_BLOCK_LENGTH)
+		expected_length = cfcFILE_TRANSFER_CHECK_BLOCK_LENGTH;
+
+	if (response->Length != expected_length || sysMemCompare(in_packet + sizeof(comFileDataReadResponseHeader), l_file_content + response->Pos, response->Length) != 0)
+		l_error_count++;
+	else
+		l_block_received[response->Pos / cfcFILE_TRANSFER_CHECK_BLOCK_LENGTH] = true;
+
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Decides if a packet is dropped (called from the check and from the communication manager task)
+/// @return True if packet is lost
+static bool cfcFileTransferIsLost(void)
+{
+	bool lost;
+
+	sysCriticalSectionBegin();
+	lost = (cfcCheckRandom() % 100) < cfcFILE_TRANSFER_CHECK_LOSS;
+	sysCriticalSectionEnd();
+
+	return lost;
+}
@@ -0,0 +1,499 @@
+/*****************************************************************************/
+/* Math library check and benchmark (Linux console)                          */
+/*                                                                           */
+/* Copyright (C) 2016 Laszlo Arvai                                           */
+/* All rights reserved.                                                      */
+/*                                                                           */
+/* This software may be modified and distributed under the terms             */
+/* of the GNU General Public License.  See the LICENSE file for details.     */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/* Includes                                                                  */
+/*****************************************************************************/
+#include <stdio.h>
+#include <math.h>
+#include <cfcCheck.h>
+#include <sysHighresTimer.h>
+#include <mathVector.h>
+#include <mathFixed.h>
+#include <imuAttitude.h>
+
+/*****************************************************************************/
+/* Constants                                                                 */
+/*****************************************************************************/
+#define cfcMATH_CHECK_COUNT 100000		// number of random inputs of the accuracy checks
+#define cfcMATH_BENCHMARK_COUNT 1000000	// number of calls of the benchmarks
+#define cfcMATH_ARRAY_LENGTH 768				// number of raw values of the array conversion (128 samples of six channels)
+
+// absolute error bound of the matrix functions for rotation matrices and vectors shorter than two (not documented in the library header)
+#define cfcMATH_MATRIX_ERROR 2e-6f
+
+/*****************************************************************************/
+/* Module global variables                                                   */
+/*****************************************************************************/
+static uint32_t l_random_seed = 1;
+static bool l_check_passed;
+static volatile float l_float_sink;
+static volatile int32_t l_int_sink;
+
+/*****************************************************************************/
+/* Local functions                                                           */
+/*****************************************************************************/
+static float cfcMathRandom(float in_min, float in_max);
+static void cfcMathRandomQuaternion(mathQuaternionf* out_quaternion);
+static void cfcMathReport(const char* in_name, double in_error, double in_bound);
+static void cfcMathBenchmark(const char* in_name, sysHighresTimestamp in_start_time, uint32_t in_count);
+static void cfcMathQuaternionMultiplyReference(mathQuaternionf* out_quaternion, const mathQuaternionf* in_a, const mathQuaternionf* in_b);
+static void cfcMathCheckFloat(void);
+static void cfcMathCheckFixed(void);
+static void cfcMathBenchmarkVariants(void);
+
+/*****************************************************************************/
+/* Function implementation                                                   */
+/*****************************************************************************/
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Checks the SIMD and fixed point variants of the math library against the scalar
+/// reference (maximum error must be within the bounds documented in mathVector.h and mathFixed.h)
+/// and prints the execution time of the variants
+/// @return True if all results are within the error bounds
+bool sysMathCheck(void)
+{
+	sysHighresTimerInit();
+
+	l_check_passed = true;
+
+	printf("Math library check (SIMD: %d, CMSIS: %d)\n", mathUSE_SIMD, mathUSE_CMSIS);
+
+	cfcMathCheckFloat();
+	cfcMathCheckFixed();
+	cfcMathBenchmarkVariants();
+
+	return l_check_passed;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Checks floating point functions
+static void cfcMathCheckFloat(void)
+{
+	mathQuaternionf a, b, result, reference;
+	mathMatrix3f matrix, transpose, product;
+	mathVector3f vector, rotated, reference_vector;
+	int16_t raw[cfcMATH_ARRAY_LENGTH];
+	float converted[cfcMATH_ARRAY_LENGTH];
+	double error;
+	double max_error;
+	float value;
+	float scale;
+	uint32_t i;
+	uint16_t j;
+	uint8_t row, column;
+
+	// quaternion multiply (SIMD when enabled) against the double precision product
+	max_error = 0;
+	for (i = 0; i < cfcMATH_CHECK_COUNT; i++)
+	{
+		cfcMathRandomQuaternion(&a);
+		cfcMathRandomQuaternion(&b);
+
+		mathQuaternionMultiply(&result, &a, &b);
+
+		error = fabs(result.W - ((double)a.W * b.W - (double)a.X * b.X - (double)a.Y * b.Y - (double)a.Z * b.Z));
+		error = fmax(error, fabs(result.X - ((double)a.W * b.X + (double)a.X * b.W + (double)a.Y * b.Z - (double)a.Z * b.Y)));
+		error = fmax(error, fabs(result.Y - ((double)a.W * b.Y - (double)a.X * b.Z + (double)a.Y * b.W + (double)a.Z * b.X)));
+		error = fmax(error, fabs(result.Z - ((double)a.W * b.Z + (double)a.X * b.Y - (double)a.Y * b.X + (double)a.Z * b.W)));
+		max_error = fmax(max_error, error);
+	}
+	cfcMathReport("mathQuaternionMultiply", max_error, mathQUATERNION_MULTIPLY_ERROR);
+
+	// fast inverse square root (relative error)
+	max_error = 0;
+	for (i = 0; i < cfcMATH_CHECK_COUNT; i++)
+	{
+		value = expf(cfcMathRandom(-10.0f, 10.0f));
+		error = fabs(mathFastInverseSquareRoot(value) * sqrt((double)value) - 1.0);
+		max_error = fmax(max_error, error);
+	}
+	cfcMathReport("mathFastInverseSquareRoot", max_error, mathFAST_INVERSE_SQUARE_ROOT_ERROR);
+
+	// power (relative error, the range includes the pressure ratio of the altitude calculation and the MPU6050 trim conversion)
+	max_error = 0;
+	for (i = 0; i < cfcMATH_CHECK_COUNT; i++)
+	{
+		value = expf(cfcMathRandom(-10.0f, 10.0f));
+		scale = cfcMathRandom(-4.0f, 4.0f);
+		if (fabs(scale * log2(value)) <= mathPOWER_RANGE)
+		{
+			error = fabs(mathPower(value, scale) / pow(value, scale) - 1.0);
+			max_error = fmax(max_error, error);
+		}
+
+		value = cfcMathRandom(0.3f, 1.2f);
+		error = fabs(mathPower(value, 0.190295f) / pow(value, 0.190295) - 1.0);
+		max_error = fmax(max_error, error);
+	}
+	cfcMathReport("mathPower", max_error, mathPOWER_ERROR);
+
+	// array conversion must give the same result as the scalar conversion
+	scale = 1.0f / 16384.0f;
+	for (j = 0; j < cfcMATH_ARRAY_LENGTH; j++)
+		raw[j] = (int16_t)cfcMathRandom(-32768.0f, 32767.0f);
+
+	mathConvertInt16Array(converted, raw, cfcMATH_ARRAY_LENGTH, scale);
+
+	max_error = 0;
+	for (j = 0; j < cfcMATH_ARRAY_LENGTH; j++)
+		max_error = fmax(max_error, fabs(converted[j] - raw[j] * scale));
+	cfcMathReport("mathConvertInt16Array", max_error, 0);
+
+	// matrix functions: rotation by matrix and by quaternion, R * R' = I
+	max_error = 0;
+	for (i = 0; i < cfcMATH_CHECK_COUNT; i++)
+	{
+		cfcMathRandomQuaternion(&a);
+		mathVector3Set(&vector, cfcMathRandom(-1.0f, 1.0f), cfcMathRandom(-1.0f, 1.0f), cfcMathRandom(-1.0f, 1.0f));
+
+		mathQuaternionToMatrix(&matrix, &a);
+		mathMatrix3MultiplyVector(&rotated, &matrix, &vector);
+		mathQuaternionRotate(&reference_vector, &a, &vector);
+
+		max_error = fmax(max_error, fabs(rotated.X - reference_vector.X));
+		max_error = fmax(max_error, fabs(rotated.Y - reference_vector.Y));
+		max_error = fmax(max_error, fabs(rotated.Z - reference_vector.Z));
+
+		mathMatrix3Transpose(&transpose, &matrix);
+		mathMatrix3Multiply(&product, &matrix, &transpose);
+
+		for (row = 0; row < 3; row++)
+		{
+			for (column = 0; column < 3; column++)
+			{
+				max_error = fmax(max_error, fabs(product.M[row][column] - ((row == column) ? 1.0 : 0.0)));
+			}
+		}
+	}
+	cfcMathReport("mathMatrix3 functions", max_error, cfcMATH_MATRIX_ERROR);
+
+	// SIMD and scalar quaternion product
+	max_error = 0;
+	for (i = 0; i < cfcMATH_CHECK_COUNT; i++)
+	{
+		cfcMathRandomQuaternion(&a);
+		cfcMathRandomQuaternion(&b);
+
+		mathQuaternionMultiply(&result, &a, &b);
+		cfcMathQuaternionMultiplyReference(&reference, &a, &b);
+
+		max_error = fmax(max_error, fabs(result.W - reference.W));
+		max_error = fmax(max_error, fabs(result.X - reference.X));
+		max_error = fmax(max_error, fabs(result.Y - reference.Y));
+		max_error = fmax(max_error, fabs(result.Z - reference.Z));
+	}
+	cfcMathReport("mathQuaternionMultiply vs. scalar", max_error, mathQUATERNION_MULTIPLY_ERROR);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Checks fixed point functions (errors are in LSB of the result)
+static void cfcMathCheckFixed(void)
+{
+	mathQuaternionf float_quaternion;
+	mathQuaternionQ30 a, b, result;
+	mathVector3Q16 rate;
+	mathVector3Q16 converted;
+	mathQ15 q15_a[64], q15_b[64];
+	int16_t raw[3];
+	int64_t sum;
+	double reference[4];
+	double norm;
+	double half_dt;
+	double error;
+	double max_multiply_error = 0;
+	double max_quaternion_error = 0;
+	double max_normalize_error = 0;
+	double max_integrate_error = 0;
+	double max_convert_error = 0;
+	double max_dot_error = 0;
+	mathQ30 scale;
+	int32_t x, y;
+	uint32_t dt;
+	uint32_t i;
+	uint8_t j;
+
+	for (i = 0; i < cfcMATH_CHECK_COUNT; i++)
+	{
+		// scalar multiply
+		x = (int32_t)cfcMathRandom(-32768.0f, 32767.0f);
+		y = (int32_t)cfcMathRandom(-32768.0f, 32767.0f);
+		error = fabs(mathQ15Multiply((mathQ15)x, (mathQ15)y) - fmin((double)x * y / 32768.0, 32767.0));
+		max_multiply_error = fmax(max_multiply_error, error);
+
+		x = mathQ16FromFloat(cfcMathRandom(-100.0f, 100.0f));
+		y = mathQ16FromFloat(cfcMathRandom(-100.0f, 100.0f));
+		error = fabs(mathQ16Multiply(x, y) - (double)x * y / 65536.0);
+		max_multiply_error = fmax(max_multiply_error, error);
+
+		x = mathQ30FromFloat(cfcMathRandom(-1.4f, 1.4f));
+		y = mathQ30FromFloat(cfcMathRandom(-1.4f, 1.4f));
+		error = fabs(mathQ30Multiply(x, y) - (double)x * y / 1073741824.0);
+		max_multiply_error = fmax(max_multiply_error, error);
+
+		// quaternion multiply
+		cfcMathRandomQuaternion(&float_quaternion);
+		mathQuaternionQ30FromFloat(&a, float_quaternion.W, float_quaternion.X, float_quaternion.Y, float_quaternion.Z);
+		cfcMathRandomQuaternion(&float_quaternion);
+		mathQuaternionQ30FromFloat(&b, float_quaternion.W, float_quaternion.X, float_quaternion.Y, float_quaternion.Z);
+
+		mathQuaternionQ30Multiply(&result, &a, &b);
+
+		reference[0] = ((double)a.W * b.W - (double)a.X * b.X - (double)a.Y * b.Y - (double)a.Z * b.Z) / 1073741824.0;
+		reference[1] = ((double)a.W * b.X + (double)a.X * b.W + (double)a.Y * b.Z - (double)a.Z * b.Y) / 1073741824.0;
+		reference[2] = ((double)a.W * b.Y - (double)a.X * b.Z + (double)a.Y * b.W + (double)a.Z * b.X) / 1073741824.0;
+		reference[3] = ((double)a.W * b.Z + (double)a.X * b.Y - (double)a.Y * b.X + (double)a.Z * b.W) / 1073741824.0;
+
+		error = fmax(fmax(fabs(result.W - reference[0]), fabs(result.X - reference[1])), fmax(fabs(result.Y - reference[2]), fabs(result.Z - reference[3])));
+		max_quaternion_error = fmax(max_quaternion_error, error);
+
+		// normalize (squared norm in 0.99..1.01 range)
+		norm = sqrt(cfcMathRandom(0.99f, 1.01f));
+		a.W = (mathQ30)(result.W * norm);
+		a.X = (mathQ30)(result.X * norm);
+		a.Y = (mathQ30)(result.Y * norm);
+		a.Z = (mathQ30)(result.Z * norm);
+		b = a;
+
+		mathQuaternionQ30Normalize(&a);
+
+		norm = sqrt((double)b.W * b.W + (double)b.X * b.X + (double)b.Y * b.Y + (double)b.Z * b.Z) / 1073741824.0;
+		error = fmax(fmax(fabs(a.W - b.W / norm), fabs(a.X - b.X / norm)), fmax(fabs(a.Y - b.Y / norm), fabs(a.Z - b.Z / norm)));
+		max_normalize_error = fmax(max_normalize_error, error);
+
+		// integrate one step (angular rate up to 2000deg/s per axis, rotation angle is less than 0.1 rad, the reference uses the same quantized angular rate)
+		a = result;
+		rate.X = mathQ16FromFloat(cfcMathRandom(-35.0f, 35.0f));
+		rate.Y = mathQ16FromFloat(cfcMathRandom(-35.0f, 35.0f));
+		rate.Z = mathQ16FromFloat(cfcMathRandom(-35.0f, 35.0f));
+		dt = (uint32_t)cfcMathRandom(100.0f, 1600.0f);
+
+		mathQuaternionQ30Integrate(&a, &rate, dt);
+
+		half_dt = dt * 0.5e-6 / 65536.0;
+		reference[0] = result.W - (result.X * (double)rate.X + result.Y * (double)rate.Y + result.Z * (double)rate.Z) * half_dt;
+		reference[1] = result.X + (result.W * (double)rate.X + result.Y * (double)rate.Z - result.Z * (double)rate.Y) * half_dt;
+		reference[2] = result.Y + (result.W * (double)rate.Y - result.X * (double)rate.Z + result.Z * (double)rate.X) * half_dt;
+		reference[3] = result.Z + (result.W * (double)rate.Z + result.X * (double)rate.Y - result.Y * (double)rate.X) * half_dt;
+		norm = sqrt(reference[0] * reference[0] + reference[1] * reference[1] + reference[2] * reference[2] + reference[3] * reference[3]) / 1073741824.0;
+
+		error = fmax(fmax(fabs(a.W - reference[0] / norm), fabs(a.X - reference[1] / norm)), fmax(fabs(a.Y - reference[2] / norm), fabs(a.Z - reference[3] / norm)));
+		max_integrate_error = fmax(max_integrate_error, error);
+
+		// raw value conversion
+		raw[0] = (int16_t)cfcMathRandom(-32768.0f, 32767.0f);
+		raw[1] = (int16_t)cfcMathRandom(-32768.0f, 32767.0f);
+		raw[2] = (int16_t)cfcMathRandom(-32768.0f, 32767.0f);
+		scale = mathQ30FromFloat(cfcMathRandom(1e-5f, 1e-2f));
+
+		mathVector3Q16FromInt16(&converted, raw, scale);
+
+		error = fmax(fmax(fabs(converted.X - (double)raw[0] * scale / 16384.0), fabs(converted.Y - (double)raw[1] * scale / 16384.0)), fabs(converted.Z - (double)raw[2] * scale / 16384.0));
+		max_convert_error = fmax(max_convert_error, error);
+	}
+
+	// dot product (exact)
+	for (i = 0; i < cfcMATH_CHECK_COUNT / 64; i++)
+	{
+		sum = 0;
+		for (j = 0; j < 64; j++)
+		{
+			q15_a[j] = (mathQ15)cfcMathRandom(-32768.0f, 32767.0f);
+			q15_b[j] = (mathQ15)cfcMathRandom(-32768.0f, 32767.0f);
+			sum += (int32_t)q15_a[j] * q15_b[j];
+		}
+
+		max_dot_error = fmax(max_dot_error, fabs((double)(mathQ15DotProduct(q15_a, q15_b, 64) - sum)));
+	}
+
+	cfcMathReport("mathQ15/Q16/Q30Multiply [LSB]", max_multiply_error, 0.5);
+	cfcMathReport("mathQuaternionQ30Multiply [LSB]", max_quaternion_error, 0.5);
+	cfcMathReport("mathQuaternionQ30Normalize [LSB]", max_normalize_error, 4);
+	cfcMathReport("mathQuaternionQ30Integrate [LSB]", max_integrate_error, 2);
+	cfcMathReport("mathVector3Q16FromInt16 [LSB]", max_convert_error, 0.5);
+	cfcMathReport("mathQ15DotProduct", max_dot_error, 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Measures execution time of the variants
+static void cfcMathBenchmarkVariants(void)
+{
+	static int16_t raw[cfcMATH_ARRAY_LENGTH];
+	static float converted[cfcMATH_ARRAY_LENGTH];
+	static float values[1024];
+	mathQuaternionf a, b;
+	mathQuaternionQ30 a_q30, b_q30;
+	mathVector3f rate;
+	mathVector3f acceleration;
+	mathVector3Q16 rate_q16;
+	imuAttitudeState attitude;
+	sysHighresTimestamp start_time;
+	float sum;
+	uint32_t i;
+	uint16_t j;
+
+	cfcMathRandomQuaternion(&a);
+	cfcMathRandomQuaternion(&b);
+	mathQuaternionQ30FromFloat(&a_q30, a.W, a.X, a.Y, a.Z);
+	mathQuaternionQ30FromFloat(&b_q30, b.W, b.X, b.Y, b.Z);
+
+	// quaternion multiply (dependent chain)
+	start_time = sysHighresTimerGetTimestamp();
+	for (i = 0; i < cfcMATH_BENCHMARK_COUNT; i++)
+		cfcMathQuaternionMultiplyReference(&a, &a, &b);
+	cfcMathBenchmark("quaternion multiply, scalar", start_time, cfcMATH_BENCHMARK_COUNT);
+	l_float_sink = a.W;
+
+	mathQuaternionNormalize(&a);
+	start_time = sysHighresTimerGetTimestamp();
+	for (i = 0; i < cfcMATH_BENCHMARK_COUNT; i++)
+		mathQuaternionMultiply(&a, &a, &b);
+	cfcMathBenchmark("quaternion multiply, library", start_time, cfcMATH_BENCHMARK_COUNT);
+	l_float_sink = a.W;
+
+	start_time = sysHighresTimerGetTimestamp();
+	for (i = 0; i < cfcMATH_BENCHMARK_COUNT; i++)
+		mathQuaternionQ30Multiply(&a_q30, &a_q30, &b_q30);
+	cfcMathBenchmark("quaternion multiply, Q30", start_time, cfcMATH_BENCHMARK_COUNT);
+	l_int_sink = a_q30.W;
+
+	// inverse square root
+	for (j = 0; j < 1024; j++)
+		values[j] = cfcMathRandom(0.25f, 4.0f);
+
+	sum = 0;
+	start_time = sysHighresTimerGetTimestamp();
+	for (i = 0; i < cfcMATH_BENCHMARK_COUNT; i++)
+		sum += mathInverseSquareRoot(values[i & 1023]);
+	cfcMathBenchmark("inverse square root, 1/sqrtf", start_time, cfcMATH_BENCHMARK_COUNT);
+	l_float_sink = sum;
+
+	sum = 0;
+	start_time = sysHighresTimerGetTimestamp();
+	for (i = 0; i < cfcMATH_BENCHMARK_COUNT; i++)
+		sum += mathFastInverseSquareRoot(values[i & 1023]);
+	cfcMathBenchmark("inverse square root, fast", start_time, cfcMATH_BENCHMARK_COUNT);
+	l_float_sink = sum;
+
+	// power (pressure to altitude conversion)
+	for (j = 0; j < 1024; j++)
+		values[j] = cfcMathRandom(0.5f, 1.1f);
+
+	sum = 0;
+	start_time = sysHighresTimerGetTimestamp();
+	for (i = 0; i < cfcMATH_BENCHMARK_COUNT; i++)
+		sum += powf(values[i & 1023], 0.190295f);
+	cfcMathBenchmark("power, powf", start_time, cfcMATH_BENCHMARK_COUNT);
+	l_float_sink = sum;
+
+	sum = 0;
+	start_time = sysHighresTimerGetTimestamp();
+	for (i = 0; i < cfcMATH_BENCHMARK_COUNT; i++)
+		sum += mathPower(values[i & 1023], 0.190295f);
+	cfcMathBenchmark("power, mathPower", start_time, cfcMATH_BENCHMARK_COUNT);
+	l_float_sink = sum;
+
+	// integration (dependent chain)
+	mathVector3Set(&rate, 0.5f, -0.25f, 0.125f);
+	rate_q16.X = mathQ16FromFloat(rate.X);
+	rate_q16.Y = mathQ16FromFloat(rate.Y);
+	rate_q16.Z = mathQ16FromFloat(rate.Z);
+
+	start_time = sysHighresTimerGetTimestamp();
+	for (i = 0; i < cfcMATH_BENCHMARK_COUNT; i++)
+		mathQuaternionIntegrate(&a, &rate, 0.001f);
+	cfcMathBenchmark("quaternion integrate, float", start_time, cfcMATH_BENCHMARK_COUNT);
+	l_float_sink = a.W;
+
+	start_time = sysHighresTimerGetTimestamp();
+	for (i = 0; i < cfcMATH_BENCHMARK_COUNT; i++)
+		mathQuaternionQ30Integrate(&a_q30, &rate_q16, 1000);
+	cfcMathBenchmark("quaternion integrate, Q30", start_time, cfcMATH_BENCHMARK_COUNT);
+	l_int_sink = a_q30.W;
+
+	// attitude update with accelerometer correction
+	mathVector3Set(&acceleration, 0.1f, -0.05f, 0.98f);
+	imuAttitudeInit(&attitude, 1.0f, 0.01f);
+
+	start_time = sysHighresTimerGetTimestamp();
+	for (i = 0; i < cfcMATH_BENCHMARK_COUNT; i++)
+		imuAttitudeUpdate(&attitude, &rate, &acceleration, 0.001f);
+	cfcMathBenchmark("attitude update", start_time, cfcMATH_BENCHMARK_COUNT);
+	l_float_sink = attitude.Quaternion.W;
+
+	// raw value conversion
+	for (j = 0; j < cfcMATH_ARRAY_LENGTH; j++)
+		raw[j] = (int16_t)cfcMathRandom(-32768.0f, 32767.0f);
+
+	start_time = sysHighresTimerGetTimestamp();
+	for (i = 0; i < cfcMATH_BENCHMARK_COUNT / 1000; i++)
+	{
+		for (j = 0; j < cfcMATH_ARRAY_LENGTH; j++)
+			converted[j] = raw[j] * (1.0f / 16384.0f);
+		l_float_sink = converted[i % cfcMATH_ARRAY_LENGTH];
+	}
+	cfcMathBenchmark("convert 768 values, scalar", start_time, cfcMATH_BENCHMARK_COUNT / 1000);
+
+	start_time = sysHighresTimerGetTimestamp();
+	for (i = 0; i < cfcMATH_BENCHMARK_COUNT / 1000; i++)
+	{
+		mathConvertInt16Array(converted, raw, cfcMATH_ARRAY_LENGTH, 1.0f / 16384.0f);
+		l_float_sink = converted[i % cfcMATH_ARRAY_LENGTH];
+	}
+	cfcMathBenchmark("convert 768 values, library", start_time, cfcMATH_BENCHMARK_COUNT / 1000);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Scalar quaternion product (reference of the SIMD variant)
+static void cfcMathQuaternionMultiplyReference(mathQuaternionf* out_quaternion, const mathQuaternionf* in_a, const mathQuaternionf* in_b)
+{
+	float w, x, y, z;
+
+	w = in_a->W * in_b->W - in_a->X * in_b->X - in_a->Y * in_b->Y - in_a->Z * in_b->Z;
+	x = in_a->W * in_b->X + in_a->X * in_b->W + in_a->Y * in_b->Z - in_a->Z * in_b->Y;
+	y = in_a->W * in_b->Y - in_a->X * in_b->Z + in_a->Y * in_b->W + in_a->Z * in_b->X;
+	z = in_a->W * in_b->Z + in_a->X * in_b->Y - in_a->Y * in_b->X + in_a->Z * in_b->W;
+
+	out_quaternion->W = w;
+	out_quaternion->X = x;
+	out_quaternion->Y = y;
+	out_quaternion->Z = z;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Generates pseudo random number (reproducible sequence)
+static float cfcMathRandom(float in_min, float in_max)
+{
+	l_random_seed = l_random_seed * 1103515245ul + 12345ul;
+
+	return in_min + (in_max - in_min) * ((l_random_seed >> 8) / 16777216.0f);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Generates random unit quaternion
+static void cfcMathRandomQuaternion(mathQuaternionf* out_quaternion)
+{
+	mathQuaternionFromEulerAngles(out_quaternion, cfcMathRandom(-3.14f, 3.14f), cfcMathRandom(-1.57f, 1.57f), cfcMathRandom(-3.14f, 3.14f));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Prints check result and updates the overall result
+static void cfcMathReport(const char* in_name, double in_error, double in_bound)
+{
+	if (!cfcCheckReport(in_name, in_error <= in_bound, "max. error %.3g (bound %.3g)", in_error, in_bound))
+		l_check_passed = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Prints execution time of one call
+static void cfcMathBenchmark(const char* in_name, sysHighresTimestamp in_start_time, uint32_t in_count)
+{
+	printf("  %-36s %.1fns\n", in_name, sysHighresTimerGetTimeSince(in_start_time) * 1000.0 / in_count);
+}
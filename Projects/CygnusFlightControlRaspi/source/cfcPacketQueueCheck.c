@@ -0,0 +1,248 @@
+/*****************************************************************************/
+/* Communication packet queue check and benchmark (Linux console)            */
+/*                                                                           */
+/* Copyright (C) 2016 Laszlo Arvai                                           */
+/* All rights reserved.                                                      */
+/*                                                                           */
+/* This software may be modified and distributed under the terms             */
+/* of the GNU General Public License.  See the LICENSE file for details.     */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/* Includes                                                                  */
+/*****************************************************************************/
+#include <stdio.h>
+#include <sched.h>
+#include <sysRTOS.h>
+#include <sysHighresTimer.h>
+#include <comPacketQueue.h>
+#include <cfcCheck.h>
+
+/*****************************************************************************/
+/* Constants                                                                 */
+/*****************************************************************************/
+#define cfcPACKET_QUEUE_CHECK_LENGTH 1024					// size of the queue buffer
+#define cfcPACKET_QUEUE_CHECK_PACKET_COUNT 200000	// number of packets pushed by one producer
+#define cfcPACKET_QUEUE_CHECK_MAX_PRODUCER 2			// maximum number of producer tasks
+#define cfcPACKET_QUEUE_CHECK_CANCEL_PERIOD 7			// every 7th push is cancelled
+#define cfcPACKET_QUEUE_CHECK_TASK_PRIORITY 2			// priority of the producer and consumer tasks
+
+/*****************************************************************************/
+/* Module global variables                                                   */
+/*****************************************************************************/
+static comPacketQueue l_queue;
+static uint8_t l_queue_buffer[cfcPACKET_QUEUE_CHECK_LENGTH];
+static uint8_t l_producer_count;
+static volatile uint8_t l_running_producer_count;
+static volatile bool l_consumer_running;
+static uint32_t l_received_count;
+static uint32_t l_error_count;
+
+/*****************************************************************************/
+/* Local functions                                                           */
+/*****************************************************************************/
+static bool cfcPacketQueueRun(const char* in_name, bool in_single_producer, uint8_t in_producer_count);
+static sysTaskRetval cfcPacketQueueConsumerTask(sysTaskParam in_param);
+static sysTaskRetval cfcPacketQueueProducerTask(sysTaskParam in_param);
+static uint8_t cfcPacketQueueGetPacketSize(uint32_t in_sequence);
+
+/*****************************************************************************/
+/* Function implementation                                                   */
+/*****************************************************************************/
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Checks packet queue in locked (multiple producer) and single producer mode. Producer tasks push
+/// packets of varying size (some of them are cancelled) while the consumer checks order and content of the
+/// packets. Throughput of the two modes is printed.
+/// @return True if all packets are received in order without corruption
+bool sysPacketQueueCheck(void)
+{
+	bool passed = true;
+
+	sysHighresTimerInit();
+
+	printf("Packet queue check (%u packets/producer, %u byte queue)\n", cfcPACKET_QUEUE_CHECK_PACKET_COUNT, cfcPACKET_QUEUE_CHECK_LENGTH);
+
+	passed &= cfcPacketQueueRun("locked, one producer", false, 1);
+	passed &= cfcPacketQueueRun("single producer", true, 1);
+	passed &= cfcPacketQueueRun("locked, two producers", false, 2);
+
+	return passed;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Runs producer and consumer tasks (at the same priority, they yield to each other when the queue is full or empty)
+/// @param in_name Name of the check step
+/// @param in_single_producer True for single producer queue mode
+/// @param in_producer_count Number of producer tasks
+/// @return True if all packets are received in order without corruption
+static bool cfcPacketQueueRun(const char* in_name, bool in_single_producer, uint8_t in_producer_count)
+{
+	uint8_t producer;
+	sysTask task_handle;
+	sysHighresTimestamp start_time;
+	sysHighresTimestamp elapsed_time;
+
+	if (in_single_producer)
+		comPacketQueueInitializeSingleProducer(&l_queue, l_queue_buffer, sizeof(l_queue_buffer));
+	else
+		comPacketQueueInitialize(&l_queue, l_queue_buffer, sizeof(l_queue_buffer));
+
+	start_time = sysHighresTimerGetTimestamp();
+
+	l_producer_count = in_producer_count;
+	l_running_producer_count = in_producer_count;
+	l_consumer_running = true;
+
+	sysTaskCreate(cfcPacketQueueConsumerTask, "cfcConsumer", sysDEFAULT_STACK_SIZE, sysNULL, cfcPACKET_QUEUE_CHECK_TASK_PRIORITY, &task_handle, sysNULL);
+
+	for (producer = 0; producer < in_producer_count; producer++)
+		sysTaskCreate(cfcPacketQueueProducerTask, "cfcProducer", sysDEFAULT_STACK_SIZE, (sysTaskParam)(uintptr_t)producer, cfcPACKET_QUEUE_CHECK_TASK_PRIORITY, &task_handle, sysNULL);
+
+	while (l_consumer_running)
+		sysDelay(10);
+
+	elapsed_time = sysHighresTimerGetTimeSince(start_time);
+
+	return cfcCheckReport(in_name, l_error_count == 0, "%u packets, %u errors, %.0f packets/s", l_received_count, l_error_count, l_received_count * 1000000.0 / elapsed_time);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Consumer task: pops packets and checks their order and content until all producers are finished and the queue is empty
+/// @param in_param Not used
+static sysTaskRetval cfcPacketQueueConsumerTask(sysTaskParam in_param)
+{
+	uint32_t expected_sequence[cfcPACKET_QUEUE_CHECK_MAX_PRODUCER];
+	uint32_t sequence;
+	uint16_t packet_index;
+	comPacketInfo* packet_info;
+	uint8_t* packet;
+	uint8_t producer;
+	uint8_t i;
+
+	sysUNUSED(in_param);
+
+	l_received_count = 0;
+	l_error_count = 0;
+
+	for (producer = 0; producer < l_producer_count; producer++)
+		expected_sequence[producer] = 0;
+
+	while (true)
+	{
+		packet_index = comPacketQueuePopBegin(&l_queue);
+		if (packet_index == comINVALID_PACKET_INDEX)
+		{
+			if (l_running_producer_count == 0 && comPacketQueuePopBegin(&l_queue) == comINVALID_PACKET_INDEX)
+				break;
+
+			sched_yield();
+			continue;
+		}
+
+		packet_info = comPacketQueueGetPacketInfo(&l_queue, packet_index);
+		packet = comPacketQueueGetPacketBuffer(&l_queue, packet_index);
+		producer = packet_info->Interface;
+
+		if (producer < l_producer_count)
+		{
+			// cancelled packets are never received
+			while (expected_sequence[producer] % cfcPACKET_QUEUE_CHECK_CANCEL_PERIOD == cfcPACKET_QUEUE_CHECK_CANCEL_PERIOD - 1)
+				expected_sequence[producer]++;
+
+			sequence = packet[0] | (packet[1] << 8) | (packet[2] << 16) | ((uint32_t)packet[3] << 24);
+
+			if (sequence != expected_sequence[producer] || packet_info->Size != cfcPacketQueueGetPacketSize(sequence))
+			{
+				l_error_count++;
+			}
+			else
+			{
+				for (i = 4; i < packet_info->Size; i++)
+				{
+					if (packet[i] != (uint8_t)(sequence + i))
+					{
+						l_error_count++;
+						break;
+					}
+				}
+			}
+
+			expected_sequence[producer] = sequence + 1;
+		}
+		else
+		{
+			l_error_count++;
+		}
+
+		l_received_count++;
+
+		comPacketQueuePopEnd(&l_queue);
+	}
+
+	// all packets must be received except the cancelled ones
+	for (producer = 0; producer < l_producer_count; producer++)
+	{
+		if (expected_sequence[producer] + 1 < cfcPACKET_QUEUE_CHECK_PACKET_COUNT)
+			l_error_count++;
+	}
+
+	l_consumer_running = false;
+
+	return (sysTaskRetval)0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Producer task: pushes packets with sequence number and sequence dependent content (retries when the queue is full)
+/// @param in_param Producer index (stored as the interface index of the packets)
+static sysTaskRetval cfcPacketQueueProducerTask(sysTaskParam in_param)
+{
+	uint8_t producer = (uint8_t)(uintptr_t)in_param;
+	uint32_t sequence = 0;
+	uint16_t packet_index;
+	uint8_t* packet;
+	uint8_t size;
+	uint8_t i;
+
+	while (sequence < cfcPACKET_QUEUE_CHECK_PACKET_COUNT)
+	{
+		size = cfcPacketQueueGetPacketSize(sequence);
+
+		packet_index = comPacketQueuePushBegin(&l_queue, size, producer);
+		if (packet_index == comINVALID_PACKET_INDEX)
+		{
+			sched_yield();
+			continue;
+		}
+
+		packet = comPacketQueueGetPacketBuffer(&l_queue, packet_index);
+
+		packet[0] = sysLOW(sequence);
+		packet[1] = sysLOW(sequence >> 8);
+		packet[2] = sysLOW(sequence >> 16);
+		packet[3] = sysLOW(sequence >> 24);
+
+		for (i = 4; i < size; i++)
+			packet[i] = (uint8_t)(sequence + i);
+
+		if (sequence % cfcPACKET_QUEUE_CHECK_CANCEL_PERIOD == cfcPACKET_QUEUE_CHECK_CANCEL_PERIOD - 1)
+			comPacketQueuePushCancel(&l_queue, packet_index);
+		else
+			comPacketQueuePushEnd(&l_queue, packet_index);
+
+		sequence++;
+	}
+
+	sysCriticalSectionBegin();
+	l_running_producer_count--;
+	sysCriticalSectionEnd();
+
+	return (sysTaskRetval)0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Gets size of the packet with the given sequence number
+static uint8_t cfcPacketQueueGetPacketSize(uint32_t in_sequence)
+{
+	return (uint8_t)(in_sequence % 250 + 5);
+}
@@ -0,0 +1,454 @@
+/*****************************************************************************/
+/* Realtime object storage check and benchmark (Linux console)               */
+/*                                                                           */
+/* Copyright (C) 2017 Laszlo Arvai                                           */
+/* All rights reserved.                                                      */
+/*                                                                           */
+/* This software may be modified and distributed under the terms             */
+/* of the GNU General Public License.  See the LICENSE file for details.     */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/* Includes                                                                  */
+/*****************************************************************************/
+#include <stdio.h>
+#include <unistd.h>
+#include <sysRTOS.h>
+#include <sysHighresTimer.h>
+#include <roxStorage.h>
+#include <cfcCheck.h>
+
+/*****************************************************************************/
+/* Constants                                                                 */
+/*****************************************************************************/
+#define cfcROX_CHECK_DURATION 3000				// duration of the read/write stress test [ms]
+#define cfcROX_CHECK_READER_COUNT 3				// number of reader tasks
+#define cfcROX_CHECK_OBJECT 0							// object used by the checks
+#define cfcROX_CHECK_COUNTER_COUNT 24			// number of uint32 members of the stress test
+#define cfcROX_CHECK_DOUBLE_ADDRESS (cfcROX_CHECK_COUNTER_COUNT * 4)
+#define cfcROX_CHECK_UINT16_ADDRESS (cfcROX_CHECK_DOUBLE_ADDRESS + 8)
+#define cfcROX_CHECK_WRITER_PRIORITY 3		// writer preempts the readers (it sleeps between the writes)
+#define cfcROX_CHECK_READER_PRIORITY 2
+#define cfcROX_CHECK_WRITE_PERIOD 20			// sleep time between the writes [us]
+
+#define cfcROX_CHECK_CALLBACK_OBJECT 1								// object used by the change callback check
+#define cfcROX_CHECK_CALLBACK_WRITE_COUNT 1000				// number of writes (one write in every millisecond)
+#define cfcROX_CHECK_SUBSCRIBER_COUNT 4								// number of slow subscribers (the last one is added by roxCallbackFunctionAdd)
+#define cfcROX_CHECK_CALLBACK_TIME 2000								// execution time of one callback [us]
+#define cfcROX_CHECK_CALLBACK_DRAIN_TIME 100					// time to wait for the pending notifications [ms]
+#define cfcROX_CHECK_MAX_WRITE_LATENCY 500						// maximum time of one object write [us]
+#define cfcROX_CHECK_MAX_CALLBACK_LATENCY (4 * cfcROX_CHECK_SUBSCRIBER_COUNT * cfcROX_CHECK_CALLBACK_TIME) // maximum time between the write and the callback [us]
+#define cfcROX_CHECK_COUNTER_ADDRESS 0
+#define cfcROX_CHECK_TIMESTAMP_ADDRESS 4
+
+/*****************************************************************************/
+/* Types                                                                     */
+/*****************************************************************************/
+
+/// Result of one reader task
+typedef struct
+{
+	uint32_t ReadCount;			// number of accepted snapshots
+	uint32_t RetryCount;		// number of snapshots rejected by roxObjectReadEnd
+	uint32_t TornCount;			// number of accepted inconsistent snapshots (must be zero)
+	uint32_t DetectedCount;	// number of rejected inconsistent snapshots
+} cfcRoxReaderResult;
+
+/*****************************************************************************/
+/* Module global variables                                                   */
+/*****************************************************************************/
+static volatile uint8_t l_running_task_count;
+static uint32_t l_write_count;
+static cfcRoxReaderResult l_reader_results[cfcROX_CHECK_READER_COUNT];
+
+// change callback check
+static roxCallbackSubscription l_subscriptions[cfcROX_CHECK_SUBSCRIBER_COUNT - 1];
+static uint32_t l_write_max_latency;
+static uint32_t l_write_total_latency;
+static uint32_t l_last_written_counter;
+static volatile uint32_t l_callback_count;
+static volatile uint32_t l_legacy_callback_count;
+static volatile uint32_t l_last_notified_counter;
+static uint32_t l_callback_max_latency;
+static uint32_t l_callback_total_latency;
+
+/*****************************************************************************/
+/* Local functions                                                           */
+/*****************************************************************************/
+static bool cfcRoxCheckPartialWrite(void);
+static bool cfcRoxCheckConcurrentAccess(void);
+static sysTaskRetval cfcRoxWriterTask(sysTaskParam in_param);
+static sysTaskRetval cfcRoxReaderTask(sysTaskParam in_param);
+static void cfcRoxWriteCounter(uint32_t in_counter);
+static void cfcRoxTaskFinished(void);
+static bool cfcRoxCheckCallbacks(void);
+static sysTaskRetval cfcRoxCallbackWriterTask(sysTaskParam in_param);
+static void cfcRoxWriteTimestamp(uint32_t in_counter);
+static void cfcRoxSlowCallback(roxObjectIndex in_object_index);
+static void cfcRoxLegacyCallback(roxObjectIndex in_object_index);
+
+/*****************************************************************************/
+/* Function implementation                                                   */
+/*****************************************************************************/
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Checks the versioned double buffer of the object storage: partially written objects must keep the
+/// members which are not written, readers must never accept a snapshot torn by a concurrent write. Checks that
+/// slow change callbacks don't block the writer and the last change is always notified.
+/// @return True if all checks are passed
+bool sysRoxCheck(void)
+{
+	bool passed = true;
+
+	printf("Realtime object storage check (object size %uB)\n", roxOBJECT_SIZE);
+
+	sysHighresTimerInit();
+	roxStorageInitialize();
+
+	passed &= cfcRoxCheckPartialWrite();
+	passed &= cfcRoxCheckConcurrentAccess();
+	passed &= cfcRoxCheckCallbacks();
+
+	return passed;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Writes a pattern into the whole object then changes one member in every write
+/// @return True if the members which are not written keep their values
+static bool cfcRoxCheckPartialWrite(void)
+{
+	uint8_t buffer[roxOBJECT_SIZE];
+	roxMemberAddress address;
+	uint16_t error_count = 0;
+	uint8_t write;
+
+	for (address = 0; address < roxOBJECT_SIZE; address++)
+		buffer[address] = (uint8_t)(address * 7 + 1);
+
+	roxObjectWrite(cfcROX_CHECK_OBJECT, buffer);
+
+	// every write changes one byte (both storages are used twice)
+	for (write = 0; write < 4; write++)
+	{
+		roxObjectWriteBegin(cfcROX_CHECK_OBJECT);
+		roxSetUInt8(cfcROX_CHECK_OBJECT, write, (uint8_t)(0xa0 + write));
+		roxObjectWriteEnd(cfcROX_CHECK_OBJECT);
+
+		buffer[write] = (uint8_t)(0xa0 + write);
+	}
+
+	for (address = 0; address < roxOBJECT_SIZE; address++)
+	{
+		if (roxGetUInt8(cfcROX_CHECK_OBJECT, address) != buffer[address])
+			error_count++;
+	}
+
+	return cfcCheckReport("partial write keeps members", error_count == 0, "%u bytes differ", error_count);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Runs a writer and reader tasks concurrently. The writer sets all members to the same counter value,
+/// the readers check that the accepted snapshots are consistent.
+/// @return True if no torn snapshot is accepted
+static bool cfcRoxCheckConcurrentAccess(void)
+{
+	sysTask task_handle;
+	uint32_t read_count = 0;
+	uint32_t retry_count = 0;
+	uint32_t torn_count = 0;
+	uint32_t detected_count = 0;
+	uint8_t reader;
+
+	// object must be consistent before the first write
+	cfcRoxWriteCounter(0);
+
+	l_running_task_count = cfcROX_CHECK_READER_COUNT + 1;
+
+	for (reader = 0; reader < cfcROX_CHECK_READER_COUNT; reader++)
+		sysTaskCreate(cfcRoxReaderTask, "cfcRoxReader", sysDEFAULT_STACK_SIZE, (sysTaskParam)&l_reader_results[reader], cfcROX_CHECK_READER_PRIORITY, &task_handle, sysNULL);
+
+	sysTaskCreate(cfcRoxWriterTask, "cfcRoxWriter", sysDEFAULT_STACK_SIZE, sysNULL, cfcROX_CHECK_WRITER_PRIORITY, &task_handle, sysNULL);
+
+	while (l_running_task_count > 0)
+		sysDelay(10);
+
+	for (reader = 0; reader < cfcROX_CHECK_READER_COUNT; reader++)
+	{
+		read_count += l_reader_results[reader].ReadCount;
+		retry_count += l_reader_results[reader].RetryCount;
+		torn_count += l_reader_results[reader].TornCount;
+		detected_count += l_reader_results[reader].DetectedCount;
+	}
+
+	printf("  %u writes, %u reads (%u reader tasks) in %ums\n", l_write_count, read_count, cfcROX_CHECK_READER_COUNT, cfcROX_CHECK_DURATION);
+
+	cfcCheckReport("concurrent writes are detected", detected_count <= retry_count, "%u retries, %u inconsistent", retry_count, detected_count);
+
+	return cfcCheckReport("no torn snapshot is accepted", torn_count == 0 && read_count > 0, "%u torn", torn_count);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Writer task: sets all members of the object to the same counter value
+static sysTaskRetval cfcRoxWriterTask(sysTaskParam in_param)
+{
+	sysTick start_tick;
+	uint32_t counter = 0;
+
+	sysUNUSED(in_param);
+
+	start_tick = sysGetSystemTick();
+	while (sysGetSystemTickSince(start_tick) < cfcROX_CHECK_DURATION)
+	{
+		counter++;
+
+		cfcRoxWriteCounter(counter);
+
+		// readers are preempted at random points when the writer wakes up
+		usleep(cfcROX_CHECK_WRITE_PERIOD);
+	}
+
+	l_write_count = counter;
+
+	cfcRoxTaskFinished();
+
+	return (sysTaskRetval)0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Sets all members of the stress test to the same counter value
+static void cfcRoxWriteCounter(uint32_t in_counter)
+{
+	uint8_t i;
+
+	roxObjectWriteBegin(cfcROX_CHECK_OBJECT);
+
+	for (i = 0; i < cfcROX_CHECK_COUNTER_COUNT; i++)
+		roxSetUInt32(cfcROX_CHECK_OBJECT, i * 4, in_counter);
+
+	roxSetDouble(cfcROX_CHECK_OBJECT, cfcROX_CHECK_DOUBLE_ADDRESS, (double)in_counter);
+	roxSetUInt16(cfcROX_CHECK_OBJECT, cfcROX_CHECK_UINT16_ADDRESS, (uint16_t)in_counter);
+
+	roxObjectWriteEnd(cfcROX_CHECK_OBJECT);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Reader task: reads snapshots of the object and checks their consistency
+/// @param in_param Pointer to the result of the reader
+static sysTaskRetval cfcRoxReaderTask(sysTaskParam in_param)
+{
+	cfcRoxReaderResult* result = (cfcRoxReaderResult*)in_param;
+	roxObjectVersion version;
+	sysTick start_tick;
+	uint32_t counter;
+	bool consistent;
+	uint8_t i;
+
+	result->ReadCount = 0;
+	result->RetryCount = 0;
+	result->TornCount = 0;
+	result->DetectedCount = 0;
+
+	start_tick = sysGetSystemTick();
+	while (sysGetSystemTickSince(start_tick) < cfcROX_CHECK_DURATION + 10)
+	{
+		version = roxObjectReadBegin(cfcROX_CHECK_OBJECT);
+
+		counter = roxGetUInt32(cfcROX_CHECK_OBJECT, 0);
+		consistent = true;
+
+		for (i = 1; i < cfcROX_CHECK_COUNTER_COUNT; i++)
+		{
+			if (roxGetUInt32(cfcROX_CHECK_OBJECT, i * 4) != counter)
+				consistent = false;
+		}
+
+		if (roxGetDouble(cfcROX_CHECK_OBJECT, cfcROX_CHECK_DOUBLE_ADDRESS) != (double)counter || roxGetUInt16(cfcROX_CHECK_OBJECT, cfcROX_CHECK_UINT16_ADDRESS) != (uint16_t)counter)
+			consistent = false;
+
+		if (roxObjectReadEnd(cfcROX_CHECK_OBJECT, version))
+		{
+			result->ReadCount++;
+
+			if (!consistent)
+				result->TornCount++;
+		}
+		else
+		{
+			result->RetryCount++;
+
+			if (!consistent)
+				result->DetectedCount++;
+		}
+	}
+
+	cfcRoxTaskFinished();
+
+	return (sysTaskRetval)0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Decrements the number of running tasks
+static void cfcRoxTaskFinished(void)
+{
+	sysCriticalSectionBegin();
+	l_running_task_count--;
+	sysCriticalSectionEnd();
+}
+
+/*****************************************************************************/
+/* Change callback check                                                     */
+/*****************************************************************************/
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Writes the object in every millisecond while slow subscribers are attached. Measures the write time
+/// and the time between the write and the callback of the latest value.
+/// @return True if the writer is not blocked and every subscriber receives the last change
+static bool cfcRoxCheckCallbacks(void)
+{
+	roxStorageStatistics start_statistics;
+	roxStorageStatistics statistics;
+	sysTask task_handle;
+	uint32_t callback_count;
+	uint32_t legacy_callback_count;
+	uint8_t i;
+	bool passed = true;
+
+	printf("  Change callbacks: %u subscribers (%uus each), %u writes\n", cfcROX_CHECK_SUBSCRIBER_COUNT, cfcROX_CHECK_CALLBACK_TIME, cfcROX_CHECK_CALLBACK_WRITE_COUNT);
+
+	cfcRoxWriteTimestamp(0);
+	sysDelay(cfcROX_CHECK_CALLBACK_DRAIN_TIME);
+
+	l_callback_count = 0;
+	l_legacy_callback_count = 0;
+	l_callback_max_latency = 0;
+	l_callback_total_latency = 0;
+
+	roxGetStorageStatistics(&start_statistics);
+
+	for (i = 0; i < cfcROX_CHECK_SUBSCRIBER_COUNT - 1; i++)
+		roxCallbackSubscribe(cfcROX_CHECK_CALLBACK_OBJECT, &l_subscriptions[i], cfcRoxSlowCallback);
+
+	roxCallbackFunctionAdd(cfcROX_CHECK_CALLBACK_OBJECT, cfcRoxLegacyCallback);
+
+	// run writer
+	l_running_task_count = 1;
+
+	sysTaskCreate(cfcRoxCallbackWriterTask, "cfcRoxWriter", sysDEFAULT_STACK_SIZE, sysNULL, cfcROX_CHECK_WRITER_PRIORITY, &task_handle, sysNULL);
+
+	while (l_running_task_count > 0)
+		sysDelay(10);
+
+	sysDelay(cfcROX_CHECK_CALLBACK_DRAIN_TIME);
+
+	roxGetStorageStatistics(&statistics);
+
+	statistics.NotificationCount -= start_statistics.NotificationCount;
+	statistics.CoalescedNotificationCount -= start_statistics.CoalescedNotificationCount;
+
+	printf("  write latency avg. %.1fus max. %uus, callback latency avg. %.0fus max. %uus\n", (float)l_write_total_latency / cfcROX_CHECK_CALLBACK_WRITE_COUNT, l_write_max_latency,
+		(l_callback_count > 0) ? (float)l_callback_total_latency / l_callback_count : 0.0f, l_callback_max_latency);
+	printf("  %u callbacks, %u notifications, %u coalesced, max. queue length %u\n", l_callback_count, statistics.NotificationCount, statistics.CoalescedNotificationCount, statistics.MaxQueueLength);
+
+	passed &= cfcCheckReport("writer is not blocked by callbacks", l_write_max_latency < cfcROX_CHECK_MAX_WRITE_LATENCY, "max. %uus", l_write_max_latency);
+	passed &= cfcCheckReport("callback latency", l_callback_count > 0 && l_callback_max_latency < cfcROX_CHECK_MAX_CALLBACK_LATENCY, "max. %uus", l_callback_max_latency);
+	passed &= cfcCheckReport("changes are coalesced", statistics.CoalescedNotificationCount > 0, "%u", statistics.CoalescedNotificationCount);
+	passed &= cfcCheckReport("last change is notified", l_last_notified_counter == l_last_written_counter && l_legacy_callback_count > 0, "%u (written %u)", l_last_notified_counter, l_last_written_counter);
+
+	// deleted callback must not be called
+	roxCallbackFunctionDelete(cfcRoxLegacyCallback, cfcROX_CHECK_CALLBACK_OBJECT);
+
+	callback_count = l_callback_count;
+	legacy_callback_count = l_legacy_callback_count;
+
+	cfcRoxWriteTimestamp(l_last_written_counter + 1);
+	sysDelay(cfcROX_CHECK_CALLBACK_DRAIN_TIME);
+
+	passed &= cfcCheckReport("deleted callback is not called", l_legacy_callback_count == legacy_callback_count && l_callback_count - callback_count == cfcROX_CHECK_SUBSCRIBER_COUNT - 1,
+		"%u callbacks", l_callback_count - callback_count);
+
+	for (i = 0; i < cfcROX_CHECK_SUBSCRIBER_COUNT - 1; i++)
+		roxCallbackUnsubscribe(cfcROX_CHECK_CALLBACK_OBJECT, &l_subscriptions[i]);
+
+	return passed;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Writer task of the callback check: writes the object in every millisecond and measures the write time
+static sysTaskRetval cfcRoxCallbackWriterTask(sysTaskParam in_param)
+{
+	sysHighresTimestamp start_time;
+	uint32_t latency;
+	uint32_t counter;
+
+	sysUNUSED(in_param);
+
+	l_write_max_latency = 0;
+	l_write_total_latency = 0;
+
+	for (counter = 1; counter <= cfcROX_CHECK_CALLBACK_WRITE_COUNT; counter++)
+	{
+		start_time = sysHighresTimerGetTimestamp();
+
+		cfcRoxWriteTimestamp(counter);
+
+		latency = sysHighresTimerGetTimeSince(start_time);
+
+		l_write_total_latency += latency;
+		if (latency > l_write_max_latency)
+			l_write_max_latency = latency;
+
+		sysDelay(1);
+	}
+
+	cfcRoxTaskFinished();
+
+	return (sysTaskRetval)0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Writes the counter and the write timestamp into the object of the callback check
+static void cfcRoxWriteTimestamp(uint32_t in_counter)
+{
+	roxObjectWriteBegin(cfcROX_CHECK_CALLBACK_OBJECT);
+
+	roxSetUInt32(cfcROX_CHECK_CALLBACK_OBJECT, cfcROX_CHECK_COUNTER_ADDRESS, in_counter);
+	roxSetUInt32(cfcROX_CHECK_CALLBACK_OBJECT, cfcROX_CHECK_TIMESTAMP_ADDRESS, sysHighresTimerGetTimestamp());
+
+	roxObjectWriteEnd(cfcROX_CHECK_CALLBACK_OBJECT);
+
+	l_last_written_counter = in_counter;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Slow subscriber: reads the latest value, measures the notification latency then spends the callback time
+static void cfcRoxSlowCallback(roxObjectIndex in_object_index)
+{
+	roxObjectVersion version;
+	uint32_t counter;
+	uint32_t latency;
+
+	do
+	{
+		version = roxObjectReadBegin(in_object_index);
+
+		counter = roxGetUInt32(in_object_index, cfcROX_CHECK_COUNTER_ADDRESS);
+		latency = sysHighresTimerGetTimeSince(roxGetUInt32(in_object_index, cfcROX_CHECK_TIMESTAMP_ADDRESS));
+	} while (!roxObjectReadEnd(in_object_index, version));
+
+	l_last_notified_counter = counter;
+	l_callback_count++;
+	l_callback_total_latency += latency;
+	if (latency > l_callback_max_latency)
+		l_callback_max_latency = latency;
+
+	usleep(cfcROX_CHECK_CALLBACK_TIME);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Slow subscriber added by roxCallbackFunctionAdd
+static void cfcRoxLegacyCallback(roxObjectIndex in_object_index)
+{
+	l_legacy_callback_count++;
+
+	cfcRoxSlowCallback(in_object_index);
+}
@@ -0,0 +1,387 @@
+/*****************************************************************************/
+/* SLIP encoder/decoder check and benchmark (Linux console)                  */
+/*                                                                           */
+/* Copyright (C) 2017 Laszlo Arvai                                           */
+/* All rights reserved.                                                      */
+/*                                                                           */
+/* This software may be modified and distributed under the terms             */
+/* of the GNU General Public License.  See the LICENSE file for details.     */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/* Includes                                                                  */
+/*****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <sysRTOS.h>
+#include <sysHighresTimer.h>
+#include <comSLIP.h>
+#include <cfcCheck.h>
+
+/*****************************************************************************/
+/* Constants                                                                 */
+/*****************************************************************************/
+#define cfcSLIP_CHECK_STREAM_COUNT 2000						// number of random streams of the fuzz check
+#define cfcSLIP_CHECK_PACKET_COUNT 32							// number of packets in one stream
+#define cfcSLIP_CHECK_MAX_PACKET_LENGTH 255				// maximum length of the packets (length of slipEncodeBlock is 8 bit)
+#define cfcSLIP_CHECK_MAX_ENCODED_LENGTH (2 * cfcSLIP_CHECK_MAX_PACKET_LENGTH + 2)
+#define cfcSLIP_CHECK_MAX_CHUNK_LENGTH 64					// maximum length of the received chunks passed to the block decoder
+#define cfcSLIP_CHECK_GUARD_LENGTH 16							// number of guard bytes after the target buffers
+#define cfcSLIP_CHECK_GUARD_BYTE 0xa5
+#define cfcSLIP_BENCHMARK_BYTE_COUNT 20000000ul		// number of processed bytes of one benchmark
+
+/*****************************************************************************/
+/* Module global variables                                                   */
+/*****************************************************************************/
+static uint8_t l_packets[cfcSLIP_CHECK_PACKET_COUNT][cfcSLIP_CHECK_MAX_PACKET_LENGTH];
+static uint8_t l_packet_lengths[cfcSLIP_CHECK_PACKET_COUNT];
+static bool l_packet_encoded[cfcSLIP_CHECK_PACKET_COUNT];
+static uint8_t l_stream[cfcSLIP_CHECK_PACKET_COUNT * cfcSLIP_CHECK_MAX_ENCODED_LENGTH];
+static uint8_t l_target[cfcSLIP_CHECK_MAX_ENCODED_LENGTH + cfcSLIP_CHECK_GUARD_LENGTH];
+static uint8_t l_reference[cfcSLIP_CHECK_MAX_ENCODED_LENGTH];
+static volatile uint16_t l_length_sink;
+
+// probability of the special characters in the random packets [%]
+static const uint8_t l_special_densities[] = { 0, 1, 10, 50, 100 };
+
+/*****************************************************************************/
+/* Local functions                                                           */
+/*****************************************************************************/
+static void cfcSLIPGeneratePackets(uint8_t in_special_density);
+static uint16_t cfcSLIPEncodeBytewise(uint8_t* out_buffer, uint8_t* in_packet, uint8_t in_length);
+static bool cfcSLIPCheckGuard(uint16_t in_length);
+static uint32_t cfcSLIPDecodeStream(bool in_block, uint16_t in_stream_length, uint16_t in_target_size);
+static float cfcSLIPBenchmarkEncoder(bool in_block);
+static float cfcSLIPBenchmarkDecoder(bool in_block, uint16_t in_stream_length);
+
+/*****************************************************************************/
+/* Function implementation                                                   */
+/*****************************************************************************/
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Round-trip fuzz check of the SLIP block encoder and decoder. Random packets (with different density of the
+/// special characters) are encoded and compared to the bytewise encoding, the stream is decoded in random chunks and
+/// compared to the original packets. Target buffers are followed by guard bytes to detect writes out of the bounds.
+/// @return True if all packets are decoded, no write is out of the bounds and the block functions are faster
+bool sysSLIPCheck(void)
+{
+	slipEncoderState encoder;
+	uint32_t stream;
+	uint32_t encode_error_count;
+	uint32_t bounds_error_count;
+	uint32_t decode_error_count;
+	uint16_t stream_length;
+	uint16_t encoded_length;
+	uint16_t target_size;
+	uint8_t packet;
+	bool success;
+	float bytewise_speed;
+	float block_speed;
+	bool passed = true;
+
+	sysHighresTimerInit();
+
+	printf("SLIP check (%u random streams of %u packets)\n", cfcSLIP_CHECK_STREAM_COUNT, cfcSLIP_CHECK_PACKET_COUNT);
+
+	encode_error_count = 0;
+	bounds_error_count = 0;
+	decode_error_count = 0;
+	for (stream = 0; stream < cfcSLIP_CHECK_STREAM_COUNT; stream++)
+	{
+		cfcSLIPGeneratePackets(l_special_densities[stream % sizeof(l_special_densities)]);
+
+		// encode packets
+		stream_length = 0;
+		for (packet = 0; packet < cfcSLIP_CHECK_PACKET_COUNT; packet++)
+		{
+			encoded_length = cfcSLIPEncodeBytewise(l_reference, l_packets[packet], l_packet_lengths[packet]);
+
+			// encoding into exact size buffer must succeed, into smaller buffer must fail without writing out of the buffer
+			target_size = encoded_length - (cfcCheckRandom() % 2) * (1 + cfcCheckRandom() % encoded_length);
+
+			memset(l_target, cfcSLIP_CHECK_GUARD_BYTE, sizeof(l_target));
+			encoder.TargetBuffer = l_target;
+			encoder.TargetBufferSize = target_size;
+			encoder.TargetBufferPos = 0;
+
+			success = slipEncodeBlock(&encoder, l_packets[packet], l_packet_lengths[packet]);
+			l_packet_encoded[packet] = false;
+
+			if (!cfcSLIPCheckGuard(target_size) || encoder.TargetBufferPos > target_size)
+				bounds_error_count++;
+
+			if (target_size < encoded_length)
+			{
+				if (success)
+					encode_error_count++;
+
+				continue;
+			}
+
+			if (!success || encoder.TargetBufferPos != encoded_length || sysMemCompare(l_target, l_reference, encoded_length) != 0)
+				encode_error_count++;
+
+			sysMemCopy(&l_stream[stream_length], l_target, encoded_length);
+			stream_length += encoded_length;
+			l_packet_encoded[packet] = true;
+		}
+
+		// decode stream (the failed encodings are missing from the stream)
+		decode_error_count += cfcSLIPDecodeStream(false, stream_length, cfcSLIP_CHECK_MAX_PACKET_LENGTH + 1);
+		decode_error_count += cfcSLIPDecodeStream(true, stream_length, cfcSLIP_CHECK_MAX_PACKET_LENGTH + 1);
+
+		// decode into short buffer, the long packets are dropped but the buffer must not overflow
+		target_size = 1 + cfcCheckRandom() % cfcSLIP_CHECK_MAX_PACKET_LENGTH;
+		decode_error_count += cfcSLIPDecodeStream(false, stream_length, target_size);
+		if (!cfcSLIPCheckGuard(target_size))
+			bounds_error_count++;
+
+		decode_error_count += cfcSLIPDecodeStream(true, stream_length, target_size);
+		if (!cfcSLIPCheckGuard(target_size))
+			bounds_error_count++;
+	}
+
+	passed &= cfcCheckReport("block encoder", encode_error_count == 0, "%u errors", encode_error_count);
+	passed &= cfcCheckReport("round trip", decode_error_count == 0, "%u errors", decode_error_count);
+	passed &= cfcCheckReport("target buffer bounds", bounds_error_count == 0, "%u overflows", bounds_error_count);
+
+	// benchmark with random data
+	cfcSLIPGeneratePackets(l_special_densities[1]);
+
+	bytewise_speed = cfcSLIPBenchmarkEncoder(false);
+	block_speed = cfcSLIPBenchmarkEncoder(true);
+	printf("  Encoder: bytewise %7.1fMB/s, block %7.1fMB/s\n", bytewise_speed, block_speed);
+	passed &= cfcCheckReport("block encoder is faster", block_speed > bytewise_speed, "%.1fx", block_speed / bytewise_speed);
+
+	stream_length = 0;
+	for (packet = 0; packet < cfcSLIP_CHECK_PACKET_COUNT; packet++)
+		stream_length += cfcSLIPEncodeBytewise(&l_stream[stream_length], l_packets[packet], l_packet_lengths[packet]);
+
+	bytewise_speed = cfcSLIPBenchmarkDecoder(false, stream_length);
+	block_speed = cfcSLIPBenchmarkDecoder(true, stream_length);
+	printf("  Decoder: bytewise %7.1fMB/s, block %7.1fMB/s\n", bytewise_speed, block_speed);
+	passed &= cfcCheckReport("block decoder is faster", block_speed > bytewise_speed, "%.1fx", block_speed / bytewise_speed);
+
+	return passed;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Generates random packets
+/// @param in_special_density Probability of the special characters [%]
+static void cfcSLIPGeneratePackets(uint8_t in_special_density)
+{
+	uint8_t packet;
+	uint16_t i;
+
+	for (packet = 0; packet < cfcSLIP_CHECK_PACKET_COUNT; packet++)
+	{
+		l_packet_lengths[packet] = 1 + cfcCheckRandom() % cfcSLIP_CHECK_MAX_PACKET_LENGTH;
+
+		for (i = 0; i < l_packet_lengths[packet]; i++)
+		{
+			if (cfcCheckRandom() % 100 < in_special_density)
+				l_packets[packet][i] = (cfcCheckRandom() % 2 == 0) ? slip_END : slip_ESC;
+			else
+				l_packets[packet][i] = (uint8_t)cfcCheckRandom();
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Reference encoder: encodes packet byte by byte
+/// @param out_buffer Buffer of the encoded packet (must be large enough)
+/// @param in_packet Packet to encode
+/// @param in_length Length of the packet
+/// @return Length of the encoded packet
+static uint16_t cfcSLIPEncodeBytewise(uint8_t* out_buffer, uint8_t* in_packet, uint8_t in_length)
+{
+	slipEncoderState encoder;
+	uint8_t i;
+
+	encoder.TargetBuffer = out_buffer;
+	encoder.TargetBufferSize = cfcSLIP_CHECK_MAX_ENCODED_LENGTH;
+	encoder.TargetBufferPos = 0;
+
+	encoder.TargetBuffer[encoder.TargetBufferPos++] = slip_END;
+
+	for (i = 0; i < in_length; i++)
+		slipEncodeByte(&encoder, in_packet[i]);
+
+	encoder.TargetBuffer[encoder.TargetBufferPos++] = slip_END;
+
+	return encoder.TargetBufferPos;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Checks the guard bytes after the target buffer
+/// @param in_length Length of the target buffer
+/// @return True if guard bytes are not overwritten
+static bool cfcSLIPCheckGuard(uint16_t in_length)
+{
+	uint16_t i;
+
+	for (i = 0; i < cfcSLIP_CHECK_GUARD_LENGTH; i++)
+	{
+		if (l_target[in_length + i] != cfcSLIP_CHECK_GUARD_BYTE)
+			return false;
+	}
+
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Decodes the encoded stream and compares the packets with the original packets. The packets missing from
+/// the stream (encoder target buffer was too small) and the packets which fill the whole decoder target buffer are
+/// not expected (full buffer is cleared before the packet end is processed).
+/// @param in_block True to use the block decoder with random chunks, false to use the bytewise decoder
+/// @param in_stream_length Length of the encoded stream
+/// @param in_target_size Size of the decoder target buffer
+/// @return Number of errors (missing, unexpected or wrong packets)
+static uint32_t cfcSLIPDecodeStream(bool in_block, uint16_t in_stream_length, uint16_t in_target_size)
+{
+	slipDecoderState decoder;
+	uint32_t error_count = 0;
+	uint16_t pos;
+	uint16_t chunk_length;
+	uint16_t processed_length;
+	uint8_t packet = 0;
+	bool packet_found;
+
+	memset(l_target, cfcSLIP_CHECK_GUARD_BYTE, sizeof(l_target));
+	decoder.TargetBuffer = l_target;
+	decoder.TargetBufferSize = in_target_size;
+	slipDecodeInitialize(&decoder);
+
+	pos = 0;
+	while (pos < in_stream_length)
+	{
+		if (in_block)
+		{
+			chunk_length = 1 + cfcCheckRandom() % cfcSLIP_CHECK_MAX_CHUNK_LENGTH;
+			if (chunk_length > in_stream_length - pos)
+				chunk_length = in_stream_length - pos;
+
+			packet_found = slipDecodeBlock(&decoder, &l_stream[pos], chunk_length, &processed_length);
+			pos += processed_length;
+		}
+		else
+		{
+			packet_found = slipDecodeByte(&decoder, l_stream[pos++]);
+		}
+
+		if (!packet_found)
+			continue;
+
+		// find the next expected packet
+		while (packet < cfcSLIP_CHECK_PACKET_COUNT && (!l_packet_encoded[packet] || l_packet_lengths[packet] >= in_target_size))
+			packet++;
+
+		if (packet >= cfcSLIP_CHECK_PACKET_COUNT || decoder.LastPacketLength != l_packet_lengths[packet] || sysMemCompare(l_target, l_packets[packet], decoder.LastPacketLength) != 0)
+			error_count++;
+
+		packet++;
+	}
+
+	// all expected packets must be decoded
+	while (packet < cfcSLIP_CHECK_PACKET_COUNT)
+	{
+		if (l_packet_encoded[packet] && l_packet_lengths[packet] < in_target_size)
+			error_count++;
+
+		packet++;
+	}
+
+	return error_count;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Measures the throughput of the encoder
+/// @param in_block True to measure the block encoder, false to measure the bytewise encoder
+/// @return Throughput of the packet data [MB/s]
+static float cfcSLIPBenchmarkEncoder(bool in_block)
+{
+	sysHighresTimestamp start_time;
+	slipEncoderState encoder;
+	uint32_t byte_count = 0;
+	uint32_t time;
+	uint8_t packet = 0;
+
+	encoder.TargetBuffer = l_target;
+	encoder.TargetBufferSize = cfcSLIP_CHECK_MAX_ENCODED_LENGTH;
+
+	start_time = sysHighresTimerGetTimestamp();
+
+	while (byte_count < cfcSLIP_BENCHMARK_BYTE_COUNT)
+	{
+		if (in_block)
+		{
+			encoder.TargetBufferPos = 0;
+			slipEncodeBlock(&encoder, l_packets[packet], l_packet_lengths[packet]);
+			l_length_sink = encoder.TargetBufferPos;
+		}
+		else
+		{
+			l_length_sink = cfcSLIPEncodeBytewise(l_target, l_packets[packet], l_packet_lengths[packet]);
+		}
+
+		byte_count += l_packet_lengths[packet];
+		packet = (packet + 1) % cfcSLIP_CHECK_PACKET_COUNT;
+	}
+
+	time = sysHighresTimerGetTimeSince(start_time);
+	if (time == 0)
+		time = 1;
+
+	return (float)byte_count / time;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Measures the throughput of the decoder
+/// @param in_block True to measure the block decoder (whole stream is passed), false to measure the bytewise decoder
+/// @param in_stream_length Length of the encoded stream
+/// @return Throughput of the encoded data [MB/s]
+static float cfcSLIPBenchmarkDecoder(bool in_block, uint16_t in_stream_length)
+{
+	sysHighresTimestamp start_time;
+	slipDecoderState decoder;
+	uint32_t byte_count = 0;
+	uint32_t time;
+	uint16_t pos;
+	uint16_t processed_length;
+
+	decoder.TargetBuffer = l_target;
+	decoder.TargetBufferSize = cfcSLIP_CHECK_MAX_PACKET_LENGTH;
+	slipDecodeInitialize(&decoder);
+
+	start_time = sysHighresTimerGetTimestamp();
+
+	while (byte_count < cfcSLIP_BENCHMARK_BYTE_COUNT)
+	{
+		pos = 0;
+		while (pos < in_stream_length)
+		{
+			if (in_block)
+			{
+				if (slipDecodeBlock(&decoder, &l_stream[pos], in_stream_length - pos, &processed_length))
+					l_length_sink = decoder.LastPacketLength;
+
+				pos += processed_length;
+			}
+			else
+			{
+				if (slipDecodeByte(&decoder, l_stream[pos]))
+					l_length_sink = decoder.LastPacketLength;
+
+				pos++;
+			}
+		}
+
+		byte_count += in_stream_length;
+	}
+
+	time = sysHighresTimerGetTimeSince(start_time);
+	if (time == 0)
+		time = 1;
+
+	return (float)byte_count / time;
+}
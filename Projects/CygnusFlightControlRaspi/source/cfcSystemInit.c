@@ -18,6 +18,16 @@
 #include <comUDP.h>
 #include <comUART.h>
 #include <cfgStorage.h>
+#include <fileSystemFiles.h>
+#include <sysHighresTimer.h>
+#include <fdrRecorder.h>
+#include <fdrReplay.h>
+#include <roxStorage.h>
+#include <roxTelemetry.h>
+#include <imuTask.h>
+#include <imuCommunication.h>
+#include <halIMUEmulator.h>
+#include <stdio.h>
 
 /*****************************************************************************/
 /* External functions                                                        */
@@ -29,11 +39,22 @@
 // Initializes all system components
 void sysInitialize(void)
 {
+	// init timers
+	sysHighresTimerInit();
+
+	// init system files
+	fileSystemFileInit();
+
 	// load configuration
 	cfgStorageInit();
 	cfgLoadDefaultConfiguration();
 	cfgLoadConfiguration();
 
+#ifdef fdrRECORDER_ENABLED
+	// init flight data recorder (recording is started on request)
+	fdrRecorderInitialize();
+#endif
+
 	// init uarts
 	halUARTInit();
 
@@ -42,6 +63,17 @@ void sysInitialize(void)
 	comUDPInit();
 	comUARTInit();
 
+	// init realtime object storage
+	roxStorageInitialize();
+	roxTelemetryInitialize();
+
+	// init sensors (emulated sensor bus) and attitude estimation
+	imuInitialize();
+
+	// replayed sensor samples are processed by the attitude estimation (the recorded attitude is not replayed)
+	fdrReplaySetSensorCallback(imuReplaySample);
+	fdrReplaySetRepublishedObject(imuATTITUDE_OBJECT_INDEX);
+
 
 	//comESP8266Init();
 
@@ -64,3 +96,116 @@ void sysCreateTasks(void)
 
 	//rtosStartScheduler();
 }
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Gets CPU clock frequency (maximum frequency when CPU frequency scaling is used)
+/// @return CPU frequency [kHz] or zero when it is not available
+static uint32_t sysGetCPUFrequency(void)
+{
+	FILE* file;
+	char line[128];
+	float frequency_in_mhz;
+	uint32_t frequency = 0;
+
+	// frequency scaling driver
+	file = fopen("/sys/devices/system/cpu/cpu0/cpufreq/cpuinfo_max_freq", "r");
+	if (file != NULL)
+	{
+		if (fscanf(file, "%u", &frequency) != 1)
+			frequency = 0;
+
+		fclose(file);
+	}
+
+	// CPU info (not available on all architectures)
+	if (frequency == 0)
+	{
+		file = fopen("/proc/cpuinfo", "r");
+		if (file != NULL)
+		{
+			while (frequency == 0 && fgets(line, sizeof(line), file) != NULL)
+			{
+				if (sscanf(line, "cpu MHz : %f", &frequency_in_mhz) == 1)
+					frequency = (uint32_t)(frequency_in_mhz * 1000.0f);
+			}
+
+			fclose(file);
+		}
+	}
+
+	return frequency;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Prints statistics of the sensor acquisition, attitude estimation and flight data recorder
+void sysPrintStatistics(void)
+{
+	imuAttitudeStatistics attitude_statistics;
+	drvIMUStatisticsParameter sensor_statistics;
+	imuCommunicationStatistics communication_statistics;
+	halIMUEmulatorStatistics emulator_statistics;
+	roxTelemetryStatistics telemetry_statistics;
+	uint8_t sensor_index;
+	uint32_t cpu_frequency;
+	float time_per_update;
+#ifdef fdrRECORDER_ENABLED
+	fdrRecorderStatistics recorder_statistics;
+#endif
+
+	// attitude estimation
+	imuGetAttitudeStatistics(&attitude_statistics);
+
+	printf("Attitude: updates %u, publishes %u, dropped samples %u\n", attitude_statistics.UpdateCount, attitude_statistics.PublishCount, attitude_statistics.DroppedSampleCount);
+
+	if (attitude_statistics.UpdateCount > 0 && attitude_statistics.PublishCount > 0)
+	{
+		time_per_update = (float)attitude_statistics.TotalProcessingTime / attitude_statistics.UpdateCount;
+
+		printf("  processing: %.2fus/update, max. %uus/publish, latency avg. %uus max. %uus\n", time_per_update, attitude_statistics.MaxProcessingTime, attitude_statistics.TotalLatency / attitude_statistics.PublishCount, attitude_statistics.MaxLatency);
+
+		// convert processing time to CPU cycles
+		cpu_frequency = sysGetCPUFrequency();
+		if (cpu_frequency > 0)
+			printf("  cycles: %.0f/update at %uMHz\n", time_per_update * cpu_frequency / 1000.0f, cpu_frequency / 1000);
+	}
+
+	// sensors
+	for (sensor_index = 0; sensor_index < drvIMU_MaxSensorCount; sensor_index++)
+	{
+		if (imuGetStatistics(sensor_index, &sensor_statistics))
+		{
+			printf("Sensor %u: samples %u, burst reads %u, transactions %u, overflows %u, lost samples %u, errors %u, self test %s\n", sensor_index, sensor_statistics.SampleCount, sensor_statistics.BurstReadCount, sensor_statistics.TransactionCount,
+				sensor_statistics.OverflowCount, sensor_statistics.LostSampleCount, sensor_statistics.ErrorCount, (imuIsSelfTestPassed(sensor_index)) ? "passed" : "failed");
+		}
+	}
+
+	// sensor bus
+	imuCommunicationGetStatistics(&communication_statistics);
+
+	printf("Transactions: %u, failed %u, aborted %u, timeouts %u, late completions %u, max. queue length %u\n", communication_statistics.TransactionCount, communication_statistics.FailedTransactionCount, communication_statistics.AbortedTransactionCount,
+		communication_statistics.TimeoutCount, communication_statistics.LateCompletionCount, communication_statistics.MaxQueueLength);
+
+	halIMUEmulatorGetStatistics(&emulator_statistics);
+
+	printf("Emulated bus: transactions %u, bytes %u, NACKs %u, collisions %u, load %.1f%%\n", emulator_statistics.TransactionCount, emulator_statistics.ByteCount, emulator_statistics.NackCount, emulator_statistics.CollisionCount,
+		(emulator_statistics.ElapsedTime > 0) ? 100.0f * emulator_statistics.BusyTime / emulator_statistics.ElapsedTime : 0.0f);
+	printf("  MPU6050: samples %u, FIFO overflows %u\n", emulator_statistics.MPU6050SampleCount, emulator_statistics.MPU6050FIFOOverflowCount);
+	printf("  MS5611: pressure conversions %u, temperature conversions %u, invalid reads %u, command errors %u\n", emulator_statistics.MS5611PressureConversionCount, emulator_statistics.MS5611TemperatureConversionCount,
+		emulator_statistics.MS5611InvalidReadCount, emulator_statistics.MS5611CommandErrorCount);
+	printf("  BMP085: pressure conversions %u, temperature conversions %u, invalid reads %u, command errors %u\n", emulator_statistics.BMP085PressureConversionCount, emulator_statistics.BMP085TemperatureConversionCount,
+		emulator_statistics.BMP085InvalidReadCount, emulator_statistics.BMP085CommandErrorCount);
+
+	// telemetry
+	roxTelemetryGetStatistics(&telemetry_statistics);
+
+	printf("Telemetry: objects %u, bytes %u, coalesced changes %u, bandwidth limited %u, queue full %u\n", telemetry_statistics.TransmittedObjectCount, telemetry_statistics.TransmittedByteCount,
+		telemetry_statistics.CoalescedChangeCount, telemetry_statistics.BandwidthLimitedCount, telemetry_statistics.QueueFullCount);
+
+#ifdef fdrRECORDER_ENABLED
+	// flight data recorder
+	fdrRecorderGetStatistics(&recorder_statistics);
+
+	printf("Recorder: records %u, dropped %u, blocks %u, write errors %u, max. ring usage %u bytes%s\n", recorder_statistics.RecordCount, recorder_statistics.DroppedRecordCount, recorder_statistics.BlockCount,
+		recorder_statistics.WriteErrorCount, recorder_statistics.MaxRingUsage, (recorder_statistics.LogFull) ? ", log full" : "");
+#endif
+}
@@ -0,0 +1,218 @@
+/*****************************************************************************/
+/* Telemetry scheduler check (Linux console)                                 */
+/*                                                                           */
+/* Copyright (C) 2017 Laszlo Arvai                                           */
+/* All rights reserved.                                                      */
+/*                                                                           */
+/* This software may be modified and distributed under the terms             */
+/* of the GNU General Public License.  See the LICENSE file for details.     */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/* Includes                                                                  */
+/*****************************************************************************/
+#include <stdio.h>
+#include <sysRTOS.h>
+#include <cfgStorage.h>
+#include <comManager.h>
+#include <comSystemPacketDefinitions.h>
+#include <roxStorage.h>
+#include <roxTelemetry.h>
+#include <cfcCheck.h>
+
+/*****************************************************************************/
+/* Constants                                                                 */
+/*****************************************************************************/
+#define cfcTELEMETRY_CHECK_DURATION 4000			// time while the objects are changed [ms]
+#define cfcTELEMETRY_CHECK_WINDOW 1000				// length of the bandwidth measurement window [ms]
+#define cfcTELEMETRY_CHECK_DRAIN_TIME 200			// time to wait for the pending transmissions [ms]
+#define cfcTELEMETRY_CHECK_MAX_RECORD 20000		// maximum number of recorded packets
+#define cfcTELEMETRY_CHECK_PERIOD_OBJECT 3		// object used for the minimum period check
+
+/*****************************************************************************/
+/* Types                                                                     */
+/*****************************************************************************/
+
+// transmitted telemetry packet
+typedef struct
+{
+	sysTick Timestamp;
+	roxObjectIndex ObjectIndex;
+	uint16_t Size;
+} cfcTelemetryRecord;
+
+/*****************************************************************************/
+/* Module global variables                                                   */
+/*****************************************************************************/
+static cfcTelemetryRecord l_records[cfcTELEMETRY_CHECK_MAX_RECORD];
+static volatile uint32_t l_record_count;
+
+// minimum transmission period of the objects [ms]
+static const uint16_t l_object_periods[roxTOTAL_OBJECT_COUNT] = { 0, 20, 50, 100, 0 };
+
+/*****************************************************************************/
+/* Local functions                                                           */
+/*****************************************************************************/
+static uint32_t cfcTelemetryChangeObjects(uint16_t in_object_mask, uint32_t* out_packet_count, uint32_t* out_min_interval);
+static bool cfcTelemetryPacketSend(uint8_t* in_packet, uint16_t in_packet_length);
+
+/*****************************************************************************/
+/* Function implementation                                                   */
+/*****************************************************************************/
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Checks the telemetry scheduler. First all objects are changed continuously (faster than the link bandwidth)
+/// then only one object is changed (faster than its minimum period). The packets received by a loopback interface are
+/// checked against the minimum period of the objects and against the bandwidth budget of the link.
+/// @return True if all results are within the limits
+bool sysTelemetryCheck(void)
+{
+	comInterfaceDescription interface_description;
+	roxTelemetryStatistics statistics;
+	uint32_t packet_count[roxTOTAL_OBJECT_COUNT];
+	uint32_t min_interval[roxTOTAL_OBJECT_COUNT];
+	uint32_t write_count;
+	uint32_t window_bytes;
+	uint32_t max_window_bytes;
+	uint32_t i, j;
+	roxObjectIndex object_index;
+	bool passed = true;
+
+	printf("Telemetry scheduler check (bandwidth %uB/s, burst %uB)\n", roxTELEMETRY_LINK_BANDWIDTH, roxTELEMETRY_LINK_BURST_SIZE);
+
+	// start communication with a loopback interface
+	cfgStorageInit();
+	cfgLoadDefaultConfiguration();
+
+	comManagerInit();
+
+	interface_description.PacketSendFunction = cfcTelemetryPacketSend;
+	comAddInterface(&interface_description);
+
+	// start object storage and telemetry
+	roxStorageInitialize();
+	roxTelemetryInitialize();
+
+	for (object_index = 0; object_index < roxTOTAL_OBJECT_COUNT; object_index++)
+		roxTelemetrySetObjectParameters(object_index, l_object_periods[object_index], (uint8_t)object_index);
+
+	// all objects are changed: bandwidth is the limit
+	write_count = cfcTelemetryChangeObjects(0xffff, packet_count, min_interval);
+
+	for (object_index = 0; object_index < roxTOTAL_OBJECT_COUNT; object_index++)
+	{
+		printf("  Object %u: period %ums, packets %u\n", object_index, l_object_periods[object_index], packet_count[object_index]);
+
+		passed &= cfcCheckReport("object is transmitted", packet_count[object_index] > 1, "%u packets", packet_count[object_index]);
+	}
+
+	// bytes transmitted in any window must be within the burst size + bandwidth
+	max_window_bytes = 0;
+	for (i = 0; i < l_record_count; i++)
+	{
+		window_bytes = 0;
+		for (j = i; j < l_record_count && l_records[j].Timestamp - l_records[i].Timestamp < cfcTELEMETRY_CHECK_WINDOW; j++)
+			window_bytes += l_records[j].Size;
+
+		if (window_bytes > max_window_bytes)
+			max_window_bytes = window_bytes;
+	}
+
+	passed &= cfcCheckReport("bandwidth", max_window_bytes <= roxTELEMETRY_LINK_BURST_SIZE + roxTELEMETRY_LINK_BANDWIDTH * cfcTELEMETRY_CHECK_WINDOW / 1000,
+		"max. %uB/%ums (limit %uB)", max_window_bytes, cfcTELEMETRY_CHECK_WINDOW, roxTELEMETRY_LINK_BURST_SIZE + roxTELEMETRY_LINK_BANDWIDTH * cfcTELEMETRY_CHECK_WINDOW / 1000);
+
+	roxTelemetryGetStatistics(&statistics);
+
+	printf("  Writes %u, transmitted %u (%uB), coalesced %u, bandwidth limited %u, queue full %u\n", write_count, statistics.TransmittedObjectCount, statistics.TransmittedByteCount, statistics.CoalescedChangeCount,
+		statistics.BandwidthLimitedCount, statistics.QueueFullCount);
+
+	passed &= cfcCheckReport("changes are coalesced", statistics.CoalescedChangeCount > 0 && statistics.TransmittedObjectCount < write_count, "%u", statistics.CoalescedChangeCount);
+
+	// only the object with the longest period is changed: minimum period is the limit
+	object_index = cfcTELEMETRY_CHECK_PERIOD_OBJECT;
+
+	cfcTelemetryChangeObjects(1u << object_index, packet_count, min_interval);
+
+	printf("  Object %u: period %ums, packets %u, min. interval %ums\n", object_index, l_object_periods[object_index], packet_count[object_index], min_interval[object_index]);
+
+	// one tick tolerance for the wake up jitter of the communication manager
+	passed &= cfcCheckReport("minimum period", packet_count[object_index] > 1 && min_interval[object_index] + 1 >= l_object_periods[object_index],
+		"%ums (period %ums)", min_interval[object_index], l_object_periods[object_index]);
+	passed &= cfcCheckReport("transmission rate", packet_count[object_index] * l_object_periods[object_index] >= cfcTELEMETRY_CHECK_DURATION * 9 / 10,
+		"%u packets in %ums", packet_count[object_index], cfcTELEMETRY_CHECK_DURATION);
+
+	return passed;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Changes the selected objects in every millisecond and records the transmitted packets
+/// @param in_object_mask Bit mask of the objects to change
+/// @param out_packet_count Number of the transmitted packets of each object
+/// @param out_min_interval Minimum time between two transmissions of each object [ms]
+/// @return Number of object changes
+static uint32_t cfcTelemetryChangeObjects(uint16_t in_object_mask, uint32_t* out_packet_count, uint32_t* out_min_interval)
+{
+	sysTick start_timestamp;
+	sysTick last_timestamp[roxTOTAL_OBJECT_COUNT];
+	uint32_t write_count = 0;
+	roxObjectIndex object_index;
+	uint32_t i;
+
+	l_record_count = 0;
+
+	start_timestamp = sysGetSystemTick();
+	while (sysGetSystemTickSince(start_timestamp) < cfcTELEMETRY_CHECK_DURATION)
+	{
+		for (object_index = 0; object_index < roxTOTAL_OBJECT_COUNT; object_index++)
+		{
+			if ((in_object_mask & (1u << object_index)) != 0 && roxObjectWriteBegin(object_index))
+			{
+				roxSetUInt32(object_index, 0, write_count++);
+				roxObjectWriteEnd(object_index);
+			}
+		}
+
+		sysDelay(1);
+	}
+
+	// wait for the pending transmissions
+	sysDelay(cfcTELEMETRY_CHECK_DRAIN_TIME);
+
+	// count packets and determine minimum interval between the transmissions
+	for (object_index = 0; object_index < roxTOTAL_OBJECT_COUNT; object_index++)
+	{
+		out_packet_count[object_index] = 0;
+		out_min_interval[object_index] = 0;
+	}
+
+	for (i = 0; i < l_record_count; i++)
+	{
+		object_index = l_records[i].ObjectIndex;
+
+		if (out_packet_count[object_index] == 1 || (out_packet_count[object_index] > 1 && l_records[i].Timestamp - last_timestamp[object_index] < out_min_interval[object_index]))
+			out_min_interval[object_index] = l_records[i].Timestamp - last_timestamp[object_index];
+
+		last_timestamp[object_index] = l_records[i].Timestamp;
+		out_packet_count[object_index]++;
+	}
+
+	return write_count;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Loopback interface packet send function, records transmitted telemetry packets
+static bool cfcTelemetryPacketSend(uint8_t* in_packet, uint16_t in_packet_length)
+{
+	comPacketTelemetryObjectHeader* packet = (comPacketTelemetryObjectHeader*)in_packet;
+
+	if (packet->Header.PacketType == comPT_TELEMETRY_OBJECT && l_record_count < cfcTELEMETRY_CHECK_MAX_RECORD)
+	{
+		l_records[l_record_count].Timestamp = sysGetSystemTick();
+		l_records[l_record_count].ObjectIndex = packet->ObjectIndex;
+		l_records[l_record_count].Size = in_packet_length;
+
+		l_record_count++;
+	}
+
+	return true;
+}
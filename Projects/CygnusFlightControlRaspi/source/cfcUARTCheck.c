@@ -0,0 +1,273 @@
+/*****************************************************************************/
+/* UART pseudo terminal loopback check and benchmark (Linux console)         */
+/*                                                                           */
+/* Copyright (C) 2017 Laszlo Arvai                                           */
+/* All rights reserved.                                                      */
+/*                                                                           */
+/* This software may be modified and distributed under the terms             */
+/* of the GNU General Public License.  See the LICENSE file for details.     */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/* Includes                                                                  */
+/*****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sysRTOS.h>
+#include <sysHighresTimer.h>
+#include <halUART.h>
+#include <comSLIP.h>
+#include <crcCITT16.h>
+#include <cfcCheck.h>
+
+/*****************************************************************************/
+/* Constants                                                                 */
+/*****************************************************************************/
+#define cfcUART_CHECK_UART_INDEX 1									// index of the UART connected to the pseudo terminal (used by the UART communication)
+#define cfcUART_CHECK_STREAM_TIME 1000							// duration of the host to device stream [ms]
+#define cfcUART_CHECK_PACKET_SIZE 64								// size of the stream packets (including CRC)
+#define cfcUART_CHECK_MAX_PACKET_COUNT 2000					// maximum number of packets of one stream (longer than the stream at the highest baud rate)
+#define cfcUART_CHECK_BITS_PER_BYTE 10							// start bit, 8 data bits, stop bit
+#define cfcUART_CHECK_MIN_THROUGHPUT 95							// minimum received bytes/s [% of the line rate]
+#define cfcUART_CHECK_MAX_P99_LATENCY 2000					// maximum 99th percentile of the packet latency [us]
+#define cfcUART_CHECK_DRAIN_TIME 100								// time to wait for the pending bytes [ms]
+
+/*****************************************************************************/
+/* Types                                                                     */
+/*****************************************************************************/
+
+/// Stream packet of the check (sequence number and send time, random payload including SLIP and terminal control characters)
+typedef struct
+{
+	uint32_t Sequence;
+	sysHighresTimestamp Timestamp;
+	uint8_t Payload[cfcUART_CHECK_PACKET_SIZE - sizeof(uint32_t) - sizeof(sysHighresTimestamp) - sizeof(uint16_t)];
+	uint16_t CRC;
+} cfcUARTCheckPacket;
+
+/*****************************************************************************/
+/* Module global variables                                                   */
+/*****************************************************************************/
+static slipDecoderState l_slip_decoder_state;
+static uint8_t l_receive_buffer[cfcUART_CHECK_PACKET_SIZE + 1];
+static volatile uint32_t l_received_byte_count;
+static volatile uint32_t l_received_block_count;
+static volatile uint32_t l_received_packet_count;
+static volatile uint32_t l_packet_error_count;
+static volatile uint32_t l_sequence_error_count;
+static volatile sysHighresTimestamp l_last_block_timestamp;
+static uint32_t l_expected_sequence;
+static uint32_t l_latencies[cfcUART_CHECK_MAX_PACKET_COUNT];
+
+// baud rates of the check (default and highest rate of the UART communication)
+static const uint32_t l_baud_rates[] = { 115200, 921600 };
+
+/*****************************************************************************/
+/* Local functions                                                           */
+/*****************************************************************************/
+static bool cfcUARTStream(int in_host_descriptor, uint32_t in_baud_rate);
+static void cfcUARTRxBlockCallback(uint8_t* in_buffer, uint16_t in_buffer_length, sysHighresTimestamp in_timestamp, void* in_interrupt_param);
+static int cfcUARTCompareLatency(const void* in_a, const void* in_b);
+
+/*****************************************************************************/
+/* Function implementation                                                   */
+/*****************************************************************************/
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Checks the block reception of the UART driver through a pseudo terminal pair. The check emulates
+/// the host on the master side: sends SLIP encoded packets paced to the line rate of the baud rate and measures
+/// the received bytes/s and the latency between sending and decoding the packets. (Pseudo terminals do not
+/// emulate the baud rate, the latency doesn't contain the transmission time of the packet.)
+/// @return True if all checks are passed
+bool sysUARTCheck(void)
+{
+	halUARTConfigInfo uart_config;
+	int host_descriptor;
+	uint8_t i;
+	bool passed = true;
+
+	sysHighresTimerInit();
+
+	// open pseudo terminal, the slave side is used as device UART (terminal settings are left to the UART driver)
+	host_descriptor = posix_openpt(O_RDWR | O_NOCTTY);
+	if (host_descriptor < 0 || grantpt(host_descriptor) != 0 || unlockpt(host_descriptor) != 0)
+		return cfcCheckReport("pseudo terminal", false, "can't be opened");
+
+	printf("UART pseudo terminal loopback check (%s)\n", ptsname(host_descriptor));
+
+	halUARTSetDeviceName(cfcUART_CHECK_UART_INDEX, ptsname(host_descriptor));
+	halUARTInit();
+
+	slipDecodeInitialize(&l_slip_decoder_state);
+	l_slip_decoder_state.TargetBuffer = l_receive_buffer;
+	l_slip_decoder_state.TargetBufferSize = sizeof(l_receive_buffer);
+
+	halUARTConfigInfoInit(&uart_config);
+	uart_config.RxBlockReceivedCallback = cfcUARTRxBlockCallback;
+	halUARTConfig(cfcUART_CHECK_UART_INDEX, &uart_config);
+
+	for (i = 0; i < sizeof(l_baud_rates) / sizeof(l_baud_rates[0]); i++)
+		passed &= cfcUARTStream(host_descriptor, l_baud_rates[i]);
+
+	close(host_descriptor);
+
+	return passed;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Sends a stream of packets from the host to the device at the line rate of the given baud rate
+/// @param in_host_descriptor Host (master) side of the pseudo terminal
+/// @param in_baud_rate Baud rate of the stream
+/// @return True if all checks are passed
+static bool cfcUARTStream(int in_host_descriptor, uint32_t in_baud_rate)
+{
+	cfcUARTCheckPacket packet;
+	uint8_t encoded_packet[cfcUART_CHECK_PACKET_SIZE * 2 + 2];
+	slipEncoderState slip_encoder_state;
+	sysHighresTimestamp start_time;
+	uint64_t sent_byte_count;
+	uint32_t sent_packet_count;
+	uint32_t line_rate;
+	uint32_t throughput;
+	uint32_t stream_time;
+	uint32_t packet_count;
+	uint32_t send_time;
+	char check_name[40];
+	uint8_t i;
+	bool baud_rate_set;
+	bool passed = true;
+
+	baud_rate_set = halUARTSetBaudRate(cfcUART_CHECK_UART_INDEX, in_baud_rate);
+	line_rate = in_baud_rate / cfcUART_CHECK_BITS_PER_BYTE;
+
+	l_received_byte_count = 0;
+	l_received_block_count = 0;
+	l_received_packet_count = 0;
+	l_packet_error_count = 0;
+	l_sequence_error_count = 0;
+	l_expected_sequence = 0;
+
+	sent_byte_count = 0;
+	sent_packet_count = 0;
+	start_time = sysHighresTimerGetTimestamp();
+	l_last_block_timestamp = start_time;
+
+	while (sysHighresTimerGetTimeSince(start_time) < cfcUART_CHECK_STREAM_TIME * 1000ul && sent_packet_count < cfcUART_CHECK_MAX_PACKET_COUNT)
+	{
+		// wait until the previous packet leaves the line
+		send_time = (uint32_t)(sent_byte_count * cfcUART_CHECK_BITS_PER_BYTE * 1000000ul / in_baud_rate);
+		while (sysHighresTimerGetTimeSince(start_time) < send_time)
+			usleep(50);
+
+		// build packet
+		packet.Sequence = sent_packet_count;
+		for (i = 0; i < sizeof(packet.Payload); i++)
+			packet.Payload[i] = (uint8_t)cfcCheckRandom();
+
+		packet.Timestamp = sysHighresTimerGetTimestamp();
+		packet.CRC = crc16CalculateForBlock(crc16_INIT_VALUE, (uint8_t*)&packet, sizeof(packet) - sizeof(packet.CRC));
+
+		slip_encoder_state.TargetBuffer = encoded_packet;
+		slip_encoder_state.TargetBufferSize = sizeof(encoded_packet);
+		slip_encoder_state.TargetBufferPos = 0;
+		slipEncodeBlock(&slip_encoder_state, (uint8_t*)&packet, sizeof(packet));
+
+		if (write(in_host_descriptor, encoded_packet, slip_encoder_state.TargetBufferPos) != slip_encoder_state.TargetBufferPos)
+			break;
+
+		sent_byte_count += slip_encoder_state.TargetBufferPos;
+		sent_packet_count++;
+	}
+
+	sysDelay(cfcUART_CHECK_DRAIN_TIME);
+
+	stream_time = l_last_block_timestamp - start_time;
+	if (stream_time == 0)
+		stream_time = 1;
+
+	throughput = (uint32_t)((uint64_t)l_received_byte_count * 1000000ul / stream_time);
+
+	packet_count = l_received_packet_count;
+	qsort(l_latencies, packet_count, sizeof(l_latencies[0]), cfcUARTCompareLatency);
+
+	printf("  %6u baud: %u packets, %u bytes/s (line rate: %u bytes/s), %.1f bytes/block\n", in_baud_rate, packet_count, throughput, line_rate,
+		(l_received_block_count > 0) ? (float)l_received_byte_count / l_received_block_count : 0.0f);
+
+	if (packet_count > 0)
+		printf("  %6u baud: latency p50 %uus, p99 %uus, max. %uus\n", in_baud_rate, l_latencies[packet_count / 2], l_latencies[packet_count * 99 / 100],
+			l_latencies[packet_count - 1]);
+
+	snprintf(check_name, sizeof(check_name), "%u baud rate is set", in_baud_rate);
+	passed &= cfcCheckReport(check_name, baud_rate_set, "%s", (baud_rate_set) ? "yes" : "no");
+
+	snprintf(check_name, sizeof(check_name), "%u baud stream is received", in_baud_rate);
+	passed &= cfcCheckReport(check_name, packet_count == sent_packet_count && l_packet_error_count == 0 && l_sequence_error_count == 0,
+		"%u lost, %u corrupted, %u out of order", sent_packet_count - packet_count, l_packet_error_count, l_sequence_error_count);
+
+	snprintf(check_name, sizeof(check_name), "%u baud throughput", in_baud_rate);
+	passed &= cfcCheckReport(check_name, throughput * 100ull >= (uint64_t)line_rate * cfcUART_CHECK_MIN_THROUGHPUT, "%u%% of line rate",
+		(uint32_t)((uint64_t)throughput * 100 / line_rate));
+
+	snprintf(check_name, sizeof(check_name), "%u baud latency p99", in_baud_rate);
+	passed &= cfcCheckReport(check_name, packet_count > 0 && l_latencies[packet_count * 99 / 100] <= cfcUART_CHECK_MAX_P99_LATENCY, "%uus",
+		(packet_count > 0) ? l_latencies[packet_count * 99 / 100] : 0);
+
+	return passed;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief UART block received callback: decodes, checks and timestamps the stream packets
+/// @param in_buffer Received data
+/// @param in_buffer_length Number of bytes received
+/// @param in_timestamp Time when the data is received
+/// @param in_interrupt_param Not used
+static void cfcUARTRxBlockCallback(uint8_t* in_buffer, uint16_t in_buffer_length, sysHighresTimestamp in_timestamp, void* in_interrupt_param)
+{
+	cfcUARTCheckPacket* packet = (cfcUARTCheckPacket*)l_receive_buffer;
+	uint16_t processed_length;
+
+	sysUNUSED(in_interrupt_param);
+
+	l_received_byte_count += in_buffer_length;
+	l_received_block_count++;
+	l_last_block_timestamp = in_timestamp;
+
+	while (in_buffer_length > 0)
+	{
+		if (slipDecodeBlock(&l_slip_decoder_state, in_buffer, in_buffer_length, &processed_length))
+		{
+			if (l_slip_decoder_state.LastPacketLength != sizeof(cfcUARTCheckPacket) ||
+				packet->CRC != crc16CalculateForBlock(crc16_INIT_VALUE, l_receive_buffer, sizeof(cfcUARTCheckPacket) - sizeof(packet->CRC)))
+			{
+				l_packet_error_count++;
+			}
+			else
+			{
+				if (packet->Sequence != l_expected_sequence)
+					l_sequence_error_count++;
+
+				l_expected_sequence = packet->Sequence + 1;
+
+				if (l_received_packet_count < cfcUART_CHECK_MAX_PACKET_COUNT)
+					l_latencies[l_received_packet_count] = sysHighresTimerGetTimeSince(packet->Timestamp);
+
+				l_received_packet_count++;
+			}
+		}
+
+		in_buffer += processed_length;
+		in_buffer_length -= processed_length;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Compares two latencies (qsort callback)
+static int cfcUARTCompareLatency(const void* in_a, const void* in_b)
+{
+	uint32_t a = *(const uint32_t*)in_a;
+	uint32_t b = *(const uint32_t*)in_b;
+
+	return (a > b) - (a < b);
+}
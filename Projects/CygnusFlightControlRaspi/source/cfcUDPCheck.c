@@ -0,0 +1,438 @@
+/*****************************************************************************/
+/* UDP communication loopback check and benchmark (Linux console)            */
+/*                                                                           */
+/* Copyright (C) 2017 Laszlo Arvai                                           */
+/* All rights reserved.                                                      */
+/*                                                                           */
+/* This software may be modified and distributed under the terms             */
+/* of the GNU General Public License.  See the LICENSE file for details.     */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/* Includes                                                                  */
+/*****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sysRTOS.h>
+#include <sysHighresTimer.h>
+#include <cfgStorage.h>
+#include <comManager.h>
+#include <comUDP.h>
+#include <drvUDP.h>
+#include <comSystemPacketDefinitions.h>
+#include <crcCITT16.h>
+#include <cfcCheck.h>
+#include "cfgConstants.h"
+
+/*****************************************************************************/
+/* Constants                                                                 */
+/*****************************************************************************/
+#define cfcUDP_CHECK_HOST_ADDRESS INADDR_LOOPBACK		// address of the emulated host
+#define cfcUDP_CHECK_PING_COUNT 1000								// number of the request-response round trips
+#define cfcUDP_CHECK_BURST_COUNT 100								// number of request bursts
+#define cfcUDP_CHECK_BURST_SIZE 20									// number of requests in one burst (more than one receiver batch)
+#define cfcUDP_CHECK_STREAM_TIME 1000								// duration of the device to host stream [ms]
+#define cfcUDP_CHECK_STREAM_PACKET_SIZE 64					// size of the stream packets (without CRC)
+#define cfcUDP_CHECK_RESPONSE_TIMEOUT 100						// time to wait for the responses [ms]
+#define cfcUDP_CHECK_ANNOUNCE_COUNT 10							// maximum number of host announces (device socket is opened by the UDP task)
+#define cfcUDP_CHECK_DRAIN_TIME 200									// time to wait for the pending packets [ms]
+#define cfcUDP_CHECK_MAX_P99_LATENCY 2000						// maximum 99th percentile of the round trip time [us]
+#define cfcUDP_CHECK_HOST_TASK_PRIORITY 3						// host receiver preempts the device tasks
+#define cfcUDP_CHECK_PRODUCER_PRIORITY 3						// stream producer preempts the device tasks (transmitter queue is kept full)
+#define cfcUDP_CHECK_PRODUCER_PERIOD 100						// time between the refills of the transmitter queue [us]
+#define cfcUDP_CHECK_HOST_RECEIVE_TIMEOUT 10				// receive timeout of the host socket (stop flag is checked) [ms]
+
+/*****************************************************************************/
+/* Types                                                                     */
+/*****************************************************************************/
+
+/// Stream packet of the check (telemetry packet type, sequence number in the payload)
+typedef struct
+{
+	comPacketHeader Header;
+	uint32_t Sequence;
+	uint8_t Payload[cfcUDP_CHECK_STREAM_PACKET_SIZE - sizeof(comPacketHeader) - sizeof(uint32_t)];
+} cfcUDPCheckPacket;
+
+/*****************************************************************************/
+/* Module global variables                                                   */
+/*****************************************************************************/
+static int l_host_socket = -1;
+static struct sockaddr_in l_device_address;
+static uint8_t l_host_packet_counter;
+static volatile bool l_host_running;
+static volatile bool l_host_stopped;
+static volatile uint32_t l_response_count;
+static volatile sysHighresTimestamp l_response_timestamp;
+static volatile uint32_t l_stream_received_count;
+static volatile uint32_t l_stream_sequence_error_count;
+static volatile uint32_t l_crc_error_count;
+static uint32_t l_stream_expected_sequence;
+static volatile bool l_producer_running;
+static volatile bool l_producer_stopped;
+static uint32_t l_pushed_count;
+static uint32_t l_latencies[cfcUDP_CHECK_PING_COUNT];
+
+/*****************************************************************************/
+/* Local functions                                                           */
+/*****************************************************************************/
+static bool cfcUDPHostOpen(void);
+static void cfcUDPHostClose(void);
+static void cfcUDPHostSend(uint8_t* in_packet, uint8_t in_packet_size, uint8_t in_packet_type);
+static void cfcUDPHostSendRequest(void);
+static bool cfcUDPWaitForResponses(uint32_t in_response_count);
+static sysTaskRetval cfcUDPHostReceiverTask(sysTaskParam in_param);
+static sysTaskRetval cfcUDPProducerTask(sysTaskParam in_param);
+static int cfcUDPCompareLatency(const void* in_a, const void* in_b);
+
+/*****************************************************************************/
+/* Function implementation                                                   */
+/*****************************************************************************/
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Checks the UDP communication through the loopback network interface. The check emulates the host:
+/// announces itself, measures the round trip time of the device name requests, sends bursts of requests
+/// (more than one receiver batch) and measures the packet rate and the transmitter retries of a device to host
+/// stream which saturates the link.
+/// @return True if all checks are passed
+bool sysUDPCheck(void)
+{
+	comManagerStatistics statistics;
+	sysHighresTimestamp start_time;
+	sysHighresTimestamp request_time;
+	sysTask task_handle;
+	uint32_t response_count;
+	uint32_t ping_count;
+	uint32_t stream_time;
+	uint32_t received_count;
+	uint16_t burst;
+	uint16_t i;
+	bool passed = true;
+
+	sysHighresTimerInit();
+
+	// start device communication
+	cfgStorageInit();
+	cfgLoadDefaultConfiguration();
+
+	printf("UDP loopback check (local port: %u, remote port: %u)\n", cfgGetUInt16Value(cfgVAL_WIFI_LOCAL), cfgGetUInt16Value(cfgVAL_WIFI_REMOTE));
+
+	comManagerInit();
+	comUDPInit();
+
+	// start host
+	if (!cfcUDPHostOpen())
+		return cfcCheckReport("host socket", false, "port %u", cfgGetUInt16Value(cfgVAL_WIFI_REMOTE));
+
+	// announce host until the device responds
+	i = 0;
+	do
+	{
+		response_count = l_response_count;
+		cfcUDPHostSend(sysNULL, sizeof(comPacketHostAnnounce), comPT_HOST_ANNOUNCE);
+		cfcUDPHostSendRequest();
+		i++;
+	} while (!cfcUDPWaitForResponses(response_count + 1) && i < cfcUDP_CHECK_ANNOUNCE_COUNT);
+
+	if (l_response_count == response_count)
+	{
+		cfcUDPHostClose();
+		return cfcCheckReport("device is connected", false, "no response");
+	}
+
+	// request-response round trip time
+	ping_count = 0;
+	for (i = 0; i < cfcUDP_CHECK_PING_COUNT; i++)
+	{
+		response_count = l_response_count;
+		request_time = sysHighresTimerGetTimestamp();
+
+		cfcUDPHostSendRequest();
+
+		if (!cfcUDPWaitForResponses(response_count + 1))
+			continue;
+
+		l_latencies[ping_count++] = (uint32_t)(l_response_timestamp - request_time);
+	}
+
+	qsort(l_latencies, ping_count, sizeof(l_latencies[0]), cfcUDPCompareLatency);
+
+	if (ping_count > 0)
+		printf("  Round trip: %u requests, p50 %uus, p99 %uus, max. %uus\n", ping_count, l_latencies[ping_count / 2], l_latencies[ping_count * 99 / 100], l_latencies[ping_count - 1]);
+
+	passed &= cfcCheckReport("all requests are answered", ping_count == cfcUDP_CHECK_PING_COUNT, "%u lost", cfcUDP_CHECK_PING_COUNT - ping_count);
+	passed &= cfcCheckReport("round trip p99", ping_count > 0 && l_latencies[ping_count * 99 / 100] <= cfcUDP_CHECK_MAX_P99_LATENCY, "%uus",
+		(ping_count > 0) ? l_latencies[ping_count * 99 / 100] : 0);
+
+	// bursts of requests (received in more than one batch)
+	response_count = l_response_count;
+	for (burst = 0; burst < cfcUDP_CHECK_BURST_COUNT; burst++)
+	{
+		for (i = 0; i < cfcUDP_CHECK_BURST_SIZE; i++)
+			cfcUDPHostSendRequest();
+
+		cfcUDPWaitForResponses(response_count + (burst + 1) * cfcUDP_CHECK_BURST_SIZE);
+	}
+
+	response_count = l_response_count - response_count;
+
+	passed &= cfcCheckReport("request bursts are answered", response_count == cfcUDP_CHECK_BURST_COUNT * cfcUDP_CHECK_BURST_SIZE, "%u of %u",
+		response_count, cfcUDP_CHECK_BURST_COUNT * cfcUDP_CHECK_BURST_SIZE);
+
+	// device to host stream (link is saturated)
+	comManagerResetStatistics();
+
+	l_stream_received_count = 0;
+	l_stream_sequence_error_count = 0;
+	l_stream_expected_sequence = 0;
+	l_pushed_count = 0;
+	l_producer_running = true;
+	l_producer_stopped = false;
+
+	start_time = sysHighresTimerGetTimestamp();
+	sysTaskCreate(cfcUDPProducerTask, "cfcUDPProducer", sysDEFAULT_STACK_SIZE, sysNULL, cfcUDP_CHECK_PRODUCER_PRIORITY, &task_handle, sysNULL);
+
+	sysDelay(cfcUDP_CHECK_STREAM_TIME);
+
+	l_producer_running = false;
+	while (!l_producer_stopped)
+		sysDelay(1);
+
+	stream_time = sysHighresTimerGetTimeSince(start_time) / 1000;
+	received_count = l_stream_received_count;
+
+	sysDelay(cfcUDP_CHECK_DRAIN_TIME);
+
+	comManagerGetStatistics(&statistics);
+
+	printf("  Stream: %u pushed, %u received (%u packets/s), %u wakeups, %u retries, %u expired (%u transmitter slots)\n", l_pushed_count, l_stream_received_count,
+		received_count * 1000 / stream_time, statistics.TransmitWakeupCount, statistics.RetryCount, statistics.ExpiredPacketCount, drvUDP_TRANSMITTER_SLOT_COUNT);
+
+	passed &= cfcCheckReport("stream is received", l_stream_sequence_error_count == 0 && l_stream_received_count + statistics.ExpiredPacketCount == l_pushed_count,
+		"%u lost, %u out of order", l_pushed_count - statistics.ExpiredPacketCount - l_stream_received_count, l_stream_sequence_error_count);
+	passed &= cfcCheckReport("no CRC errors", l_crc_error_count == 0, "%u", l_crc_error_count);
+
+	// a single slot is refused after every packet, more slots must accept more than one packet between the retries
+	passed &= cfcCheckReport("packets sent between retries", drvUDP_TRANSMITTER_SLOT_COUNT == 1 || statistics.RetryCount < received_count, "%.1f",
+		(statistics.RetryCount > 0) ? (float)received_count / statistics.RetryCount : (float)received_count);
+
+	cfcUDPHostClose();
+
+	return passed;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Opens host socket and starts host receiver task
+/// @return True if socket is opened
+static bool cfcUDPHostOpen(void)
+{
+	struct sockaddr_in host_address;
+	struct timeval timeout;
+	sysTask task_handle;
+	int one = 1;
+
+	l_host_socket = socket(AF_INET, SOCK_DGRAM, 0);
+	if (l_host_socket < 0)
+		return false;
+
+	setsockopt(l_host_socket, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+	timeout.tv_sec = 0;
+	timeout.tv_usec = cfcUDP_CHECK_HOST_RECEIVE_TIMEOUT * 1000;
+	setsockopt(l_host_socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+	sysMemZero(&host_address, sizeof(host_address));
+	host_address.sin_family = AF_INET;
+	host_address.sin_addr.s_addr = htonl(cfcUDP_CHECK_HOST_ADDRESS);
+	host_address.sin_port = htons(cfgGetUInt16Value(cfgVAL_WIFI_REMOTE));
+
+	if (bind(l_host_socket, (struct sockaddr*)&host_address, sizeof(host_address)) < 0)
+	{
+		close(l_host_socket);
+		l_host_socket = -1;
+		return false;
+	}
+
+	sysMemZero(&l_device_address, sizeof(l_device_address));
+	l_device_address.sin_family = AF_INET;
+	l_device_address.sin_addr.s_addr = htonl(cfcUDP_CHECK_HOST_ADDRESS);
+	l_device_address.sin_port = htons(cfgGetUInt16Value(cfgVAL_WIFI_LOCAL));
+
+	l_host_running = true;
+	l_host_stopped = false;
+	sysTaskCreate(cfcUDPHostReceiverTask, "cfcUDPHost", sysDEFAULT_STACK_SIZE, sysNULL, cfcUDP_CHECK_HOST_TASK_PRIORITY, &task_handle, sysNULL);
+
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Stops host receiver task and closes host socket
+static void cfcUDPHostClose(void)
+{
+	l_host_running = false;
+	while (!l_host_stopped)
+		sysDelay(1);
+
+	close(l_host_socket);
+	l_host_socket = -1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Sends packet from the host to the device
+/// @param in_packet Packet content (sysNULL for host announce packet)
+/// @param in_packet_size Size of the packet (without CRC)
+/// @param in_packet_type Type of the packet
+static void cfcUDPHostSend(uint8_t* in_packet, uint8_t in_packet_size, uint8_t in_packet_type)
+{
+	uint8_t packet[comMAX_PACKET_SIZE];
+	comPacketHeader* header = (comPacketHeader*)packet;
+	comPacketHostAnnounce* announce = (comPacketHostAnnounce*)packet;
+	uint16_t crc;
+
+	if (in_packet != sysNULL)
+	{
+		sysMemCopy(packet, in_packet, in_packet_size);
+	}
+	else
+	{
+		sysMemZero(packet, in_packet_size);
+		announce->Address = cfcUDP_CHECK_HOST_ADDRESS;
+	}
+
+	header->PacketLength = in_packet_size + comCRC_BYTE_COUNT;
+	header->PacketType = in_packet_type;
+	header->PacketCounter = ++l_host_packet_counter;
+
+	crc = crc16CalculateForBlock(crc16_INIT_VALUE, packet, in_packet_size);
+	packet[in_packet_size] = sysLOW(crc);
+	packet[in_packet_size + 1] = sysHIGH(crc);
+
+	sendto(l_host_socket, packet, in_packet_size + comCRC_BYTE_COUNT, 0, (struct sockaddr*)&l_device_address, sizeof(l_device_address));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Sends device name request from the host
+static void cfcUDPHostSendRequest(void)
+{
+	comPacketDeviceNameRequest request;
+
+	cfcUDPHostSend((uint8_t*)&request, sizeof(request), comPT_DEVICE_NAME_REQUEST);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Waits for the device name responses
+/// @param in_response_count Total number of the responses to wait for
+/// @return True if the responses are received
+static bool cfcUDPWaitForResponses(uint32_t in_response_count)
+{
+	sysTick start_tick;
+
+	start_tick = sysGetSystemTick();
+	while ((int32_t)(l_response_count - in_response_count) < 0)
+	{
+		if (sysGetSystemTickSince(start_tick) > cfcUDP_CHECK_RESPONSE_TIMEOUT)
+			return false;
+
+		sysDelay(1);
+	}
+
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Host receiver task: checks and counts the packets received from the device
+static sysTaskRetval cfcUDPHostReceiverTask(sysTaskParam in_param)
+{
+	uint8_t packet[comMAX_PACKET_SIZE + 1];
+	comPacketHeader* header = (comPacketHeader*)packet;
+	cfcUDPCheckPacket* stream_packet = (cfcUDPCheckPacket*)packet;
+	uint16_t crc;
+	ssize_t length;
+
+	sysUNUSED(in_param);
+
+	while (l_host_running)
+	{
+		length = recv(l_host_socket, packet, sizeof(packet), 0);
+		if (length <= 0)
+			continue;
+
+		// check packet
+		crc = crc16CalculateForBlock(crc16_INIT_VALUE, packet, (uint16_t)length - comCRC_BYTE_COUNT);
+		if (length < (ssize_t)sizeof(comPacketHeader) + comCRC_BYTE_COUNT || header->PacketLength != length || sysLOW(crc) != packet[length - 2] || sysHIGH(crc) != packet[length - 1])
+		{
+			l_crc_error_count++;
+			continue;
+		}
+
+		switch (header->PacketType)
+		{
+			case comPT_DEVICE_NAME_RESPONSE:
+				l_response_timestamp = sysHighresTimerGetTimestamp();
+				sysMemoryBarrier();
+				l_response_count++;
+				break;
+
+			case comPT_TELEMETRY_OBJECT:
+				if (length != sizeof(cfcUDPCheckPacket) + comCRC_BYTE_COUNT)
+					break;
+
+				// packets can be dropped (expired) but the order must be kept
+				if (stream_packet->Sequence < l_stream_expected_sequence)
+					l_stream_sequence_error_count++;
+
+				l_stream_expected_sequence = stream_packet->Sequence + 1;
+				l_stream_received_count++;
+				break;
+		}
+	}
+
+	l_host_stopped = true;
+
+	return (sysTaskRetval)0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Stream producer task: keeps the transmitter queue full
+static sysTaskRetval cfcUDPProducerTask(sysTaskParam in_param)
+{
+	cfcUDPCheckPacket* packet;
+	uint16_t packet_index;
+	uint32_t sequence = 0;
+
+	sysUNUSED(in_param);
+
+	while (l_producer_running)
+	{
+		packet = (cfcUDPCheckPacket*)comManagerTransmitPacketPushStart(sizeof(cfcUDPCheckPacket), comINVALID_INTERFACE_INDEX, comPT_TELEMETRY_OBJECT, &packet_index);
+		if (packet == sysNULL)
+		{
+			// queue is full, let the device tasks send the packets
+			usleep(cfcUDP_CHECK_PRODUCER_PERIOD);
+			continue;
+		}
+
+		packet->Sequence = sequence++;
+		sysMemZero(packet->Payload, sizeof(packet->Payload));
+
+		comManagerTransmitPacketPushEnd(packet_index);
+		l_pushed_count++;
+	}
+
+	l_producer_stopped = true;
+
+	return (sysTaskRetval)0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// @brief Compares latencies (qsort callback)
+static int cfcUDPCompareLatency(const void* in_a, const void* in_b)
+{
+	uint32_t a = *(const uint32_t*)in_a;
+	uint32_t b = *(const uint32_t*)in_b;
+
+	return (a > b) - (a < b);
+}